@@ -16,6 +16,39 @@ SOURCES += \
     $$PWD/utilFuncs/copyrightdialog.cpp \
     $$PWD/utilFuncs/singlelinedialog.cpp \
     $$PWD/ae_globals.cpp \   
+    $$PWD/netOps/remotelanepool.cpp \
+    $$PWD/netOps/agaverestsession.cpp \
+    $$PWD/netOps/resttask.cpp \
+    $$PWD/netOps/ratelimiter.cpp \
+    $$PWD/netOps/throttledfiledevice.cpp \
+    $$PWD/transferOps/transferqueue.cpp \
+    $$PWD/transferOps/transferlistmodel.cpp \
+    $$PWD/transferOps/transfermanifest.cpp \
+    $$PWD/transferOps/chunkeduploader.cpp \
+    $$PWD/transferOps/segmenteddownload.cpp \
+    $$PWD/transferOps/fileretriever.cpp \
+    $$PWD/transferOps/remotefiletail.cpp \
+    $$PWD/transferOps/foldercrawler.cpp \
+    $$PWD/transferOps/folderuploader.cpp \
+    $$PWD/transferOps/bundledupload.cpp \
+    $$PWD/transferOps/compresseddownload.cpp \
+    $$PWD/transferOps/foldersync.cpp \
+    $$PWD/fileCache/listingcache.cpp \
+    $$PWD/fileCache/remotefoldermodel.cpp \
+    $$PWD/fileCache/listingprefetcher.cpp \
+    $$PWD/fileCache/pathindex.cpp \
+    $$PWD/fileCache/deepindexcrawler.cpp \
+    $$PWD/fileOps/batchfileoperation.cpp \
+    $$PWD/fileOps/fileopscheduler.cpp \
+    $$PWD/jobOps/jobstore.cpp \
+    $$PWD/jobOps/jobpoller.cpp \
+    $$PWD/jobOps/joblistmodel.cpp \
+    $$PWD/jobOps/parametersweep.cpp \
+    $$PWD/utilFuncs/tarwriter.cpp \
+    $$PWD/utilFuncs/crc32c.cpp \
+    $$PWD/utilFuncs/pagedfilereader.cpp \
+    $$PWD/utilFuncs/pagedfileviewer.cpp \
+    $$PWD/utilFuncs/fileviewerdialog.cpp \
     $$PWD/commonUI/FooterWidget.cpp \
     $$PWD/commonUI/HeaderWidget.cpp
 
@@ -25,13 +58,47 @@ HEADERS += \
     $$PWD/utilFuncs/copyrightdialog.h \
     $$PWD/utilFuncs/singlelinedialog.h \
     $$PWD/ae_globals.h \
+    $$PWD/netOps/remotelanepool.h \
+    $$PWD/netOps/agaverestsession.h \
+    $$PWD/netOps/resttask.h \
+    $$PWD/netOps/ratelimiter.h \
+    $$PWD/netOps/throttledfiledevice.h \
+    $$PWD/transferOps/transferqueue.h \
+    $$PWD/transferOps/transferlistmodel.h \
+    $$PWD/transferOps/transfermanifest.h \
+    $$PWD/transferOps/chunkeduploader.h \
+    $$PWD/transferOps/segmenteddownload.h \
+    $$PWD/transferOps/fileretriever.h \
+    $$PWD/transferOps/remotefiletail.h \
+    $$PWD/transferOps/foldercrawler.h \
+    $$PWD/transferOps/folderuploader.h \
+    $$PWD/transferOps/bundledupload.h \
+    $$PWD/transferOps/compresseddownload.h \
+    $$PWD/transferOps/foldersync.h \
+    $$PWD/fileCache/listingcache.h \
+    $$PWD/fileCache/remotefoldermodel.h \
+    $$PWD/fileCache/listingprefetcher.h \
+    $$PWD/fileCache/pathindex.h \
+    $$PWD/fileCache/deepindexcrawler.h \
+    $$PWD/fileOps/batchfileoperation.h \
+    $$PWD/fileOps/fileopscheduler.h \
+    $$PWD/jobOps/jobstore.h \
+    $$PWD/jobOps/jobpoller.h \
+    $$PWD/jobOps/joblistmodel.h \
+    $$PWD/jobOps/parametersweep.h \
+    $$PWD/utilFuncs/tarwriter.h \
+    $$PWD/utilFuncs/crc32c.h \
+    $$PWD/utilFuncs/pagedfilereader.h \
+    $$PWD/utilFuncs/pagedfileviewer.h \
+    $$PWD/utilFuncs/fileviewerdialog.h \
     $$PWD/commonUI/FooterWidget.h \
     $$PWD/commonUI/HeaderWidget.h
 
 FORMS += \
     $$PWD/utilFuncs/authform.ui \
     $$PWD/utilFuncs/copyrightdialog.ui \
-    $$PWD/utilFuncs/singlelinedialog.ui
+    $$PWD/utilFuncs/singlelinedialog.ui \
+    $$PWD/utilFuncs/fileviewerdialog.ui
 
 RESOURCES += \
     $$PWD/commonUI/commonResources.qrc \
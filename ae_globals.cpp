@@ -36,6 +36,7 @@
 #include "ae_globals.h"
 
 #include "utilFuncs/agavesetupdriver.h"
+#include "netOps/remotelanepool.h"
 
 AgaveSetupDriver * ae_globals::theDriver = nullptr;
 
@@ -144,3 +145,64 @@ FileOperator * ae_globals::get_file_handle()
     if (theDriver == nullptr) return nullptr;
     return theDriver->getFileHandler();
 }
+
+RemoteLanePool * ae_globals::get_lane_pool()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getLanePool();
+}
+
+RemoteDataInterface * ae_globals::get_bulk_connection()
+{
+    RemoteLanePool * thePool = get_lane_pool();
+    if (thePool == nullptr) return get_connection();
+    return thePool->getLane(LaneType::BULK);
+}
+
+TransferQueue * ae_globals::get_transfer_queue()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getTransferQueue();
+}
+
+ChunkedUploader * ae_globals::get_chunked_uploader()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getChunkedUploader();
+}
+
+FileRetriever * ae_globals::get_file_retriever()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getFileRetriever();
+}
+
+ListingCache * ae_globals::get_listing_cache()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getListingCache();
+}
+
+PathIndex * ae_globals::get_path_index()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getPathIndex();
+}
+
+TransferManifest * ae_globals::get_transfer_manifest()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getTransferManifest();
+}
+
+JobStore * ae_globals::get_job_store()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobStore();
+}
+
+JobPoller * ae_globals::get_job_poller()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobPoller();
+}
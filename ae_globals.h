@@ -45,6 +45,15 @@ class AgaveSetupDriver;
 class RemoteDataInterface;
 class FileOperator;
 class JobOperator;
+class RemoteLanePool;
+class TransferQueue;
+class ChunkedUploader;
+class FileRetriever;
+class ListingCache;
+class PathIndex;
+class TransferManifest;
+class JobStore;
+class JobPoller;
 
 /*! \brief The ae_globals are a set of static methods, intended as global functions for AgaveExplorer programs.
  *
@@ -80,6 +89,17 @@ public:
     static JobOperator * get_job_handle();
     static FileOperator * get_file_handle();
 
+    static RemoteLanePool * get_lane_pool();
+    static RemoteDataInterface * get_bulk_connection();
+    static TransferQueue * get_transfer_queue();
+    static ChunkedUploader * get_chunked_uploader();
+    static FileRetriever * get_file_retriever();
+    static ListingCache * get_listing_cache();
+    static PathIndex * get_path_index();
+    static TransferManifest * get_transfer_manifest();
+    static JobStore * get_job_store();
+    static JobPoller * get_job_poller();
+
 private:    
     static AgaveSetupDriver * theDriver;
 };
@@ -0,0 +1,235 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "deepindexcrawler.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "fileCache/remotefoldermodel.h"
+#include "fileCache/pathindex.h"
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "ae_globals.h"
+
+const int DeepIndexCrawler::maxActive;
+const qint64 DeepIndexCrawler::freshListingAge;
+
+DeepIndexCrawler::DeepIndexCrawler(QString newRootFolder, QObject *parent) : QObject(parent)
+{
+    rootFolder = newRootFolder;
+}
+
+void DeepIndexCrawler::start()
+{
+    if (running) return;
+    running = true;
+
+    foldersListed = 0;
+    foldersFound = 1;
+    folderQueue.append(rootFolder);
+    startListings();
+}
+
+void DeepIndexCrawler::cancel()
+{
+    if (!running) return;
+    running = false;
+
+    folderQueue.clear();
+    partialListings.clear();
+    QList<ActiveListing> cancelList = activeListings.values();
+    activeListings.clear();
+    for (const ActiveListing &aListing : cancelList)
+    {
+        if (aListing.session != nullptr) aListing.session->cancelTask(aListing.taskID);
+    }
+    emit crawlFinished(false);
+}
+
+bool DeepIndexCrawler::isRunning()
+{
+    return running;
+}
+
+void DeepIndexCrawler::restListingReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!activeListings.contains(sender())) return;
+    ActiveListing theListing = activeListings.take(sender());
+
+    if (replyState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Deep index could not list: %s", qPrintable(theListing.folderPath));
+        partialListings.remove(theListing.folderPath);
+        foldersListed++;
+        startListings();
+        return;
+    }
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    partialListings[theListing.folderPath].append(RemoteFolderModel::parseRestListing(resultList));
+
+    if (resultList.size() >= RemoteFolderModel::listPageSize)
+    {
+        listFolder(theListing.folderPath, theListing.offset + resultList.size());
+        startListings();
+        return;
+    }
+    folderDone(theListing.folderPath, partialListings.take(theListing.folderPath), (theListing.offset == 0));
+}
+
+void DeepIndexCrawler::lsReply(RequestState replyState, QList<FileMetaData> fileList)
+{
+    if (!activeListings.contains(sender())) return;
+    ActiveListing theListing = activeListings.take(sender());
+
+    //A failed listing is not an empty folder, so nothing is stored for it
+    if (replyState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Deep index could not list: %s", qPrintable(theListing.folderPath));
+        foldersListed++;
+        startListings();
+        return;
+    }
+
+    QVector<CachedFileEntry> allEntries;
+    for (FileMetaData aFile : fileList)
+    {
+        CachedFileEntry anEntry;
+        anEntry.name = aFile.getFileName();
+        if (anEntry.name.isEmpty() || (anEntry.name == ".") || (anEntry.name == "..")) continue;
+        anEntry.type = aFile.getFileType();
+        anEntry.size = aFile.getSize();
+        allEntries.append(anEntry);
+    }
+    folderDone(theListing.folderPath, allEntries, (allEntries.size() <= RemoteFolderModel::listPageSize));
+}
+
+void DeepIndexCrawler::startListings()
+{
+    if (!running) return;
+    ListingCache * theCache = ae_globals::get_listing_cache();
+
+    while (!folderQueue.isEmpty() && (activeListings.size() < maxActive))
+    {
+        QString nextFolder = folderQueue.takeFirst();
+
+        //A recent cached listing is as good as a new one here
+        if ((theCache != nullptr) && theCache->hasListing(nextFolder) &&
+                (QDateTime::currentMSecsSinceEpoch() - theCache->listingTime(nextFolder) < freshListingAge))
+        {
+            foldersListed++;
+            for (const CachedFileEntry &anEntry : theCache->getListing(nextFolder))
+            {
+                if (anEntry.type != FileType::DIR) continue;
+                folderQueue.append(nextFolder + "/" + anEntry.name);
+                foldersFound++;
+            }
+            continue;
+        }
+        listFolder(nextFolder, 0);
+    }
+    checkFinished();
+}
+
+void DeepIndexCrawler::listFolder(QString folderPath, int offset)
+{
+    ActiveListing newListing;
+    newListing.folderPath = folderPath;
+    newListing.offset = offset;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    if (theSession != nullptr)
+    {
+        RestTask * lsTask = theSession->newListing(folderPath, offset, RemoteFolderModel::listPageSize);
+        QObject::connect(lsTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(restListingReply(RequestState,QByteArray,qint64)));
+        newListing.session = theSession;
+        newListing.taskID = lsTask->getTaskID();
+        activeListings.insert(lsTask, newListing);
+        theSession->submitTask(lsTask);
+        return;
+    }
+
+    RemoteDataReply * theReply = ae_globals::get_bulk_connection()->remoteLS(folderPath);
+    if (theReply == nullptr)
+    {
+        partialListings.remove(folderPath);
+        foldersListed++;
+        return;
+    }
+    QObject::connect(theReply, SIGNAL(haveLSReply(RequestState,QList<FileMetaData>)),
+                     this, SLOT(lsReply(RequestState,QList<FileMetaData>)));
+    activeListings.insert(theReply, newListing);
+}
+
+void DeepIndexCrawler::folderDone(QString folderPath, const QVector<CachedFileEntry> &entries, bool fitsOnePage)
+{
+    foldersListed++;
+
+    //Large folders are paged in the tree, so only the index gets them
+    if (fitsOnePage && (ae_globals::get_listing_cache() != nullptr))
+    {
+        ae_globals::get_listing_cache()->storeListing(folderPath, entries);
+    }
+    else if (ae_globals::get_path_index() != nullptr)
+    {
+        ae_globals::get_path_index()->setFolderContents(folderPath, entries);
+    }
+
+    for (const CachedFileEntry &anEntry : entries)
+    {
+        if (anEntry.type != FileType::DIR) continue;
+        folderQueue.append(folderPath + "/" + anEntry.name);
+        foldersFound++;
+    }
+    emit crawlProgress(foldersListed, foldersFound);
+    startListings();
+}
+
+void DeepIndexCrawler::checkFinished()
+{
+    if (!running) return;
+    if (!folderQueue.isEmpty() || !activeListings.isEmpty()) return;
+
+    running = false;
+    emit crawlProgress(foldersListed, foldersFound);
+    emit crawlFinished(true);
+}
@@ -0,0 +1,101 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef DEEPINDEXCRAWLER_H
+#define DEEPINDEXCRAWLER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "filemetadata.h"
+
+#include "fileCache/listingcache.h"
+
+class AgaveRestSession;
+enum class RequestState;
+
+/*! \brief The DeepIndexCrawler lists every folder under a remote folder in the background, so that the PathIndex can search all of it.
+ *
+ *  Folders are listed a few at a time on the bulk lanes. Listings which fit in one page go into the ListingCache, which also brings them into the index and lets the tree show them at once later. Larger folders are paged through and go into the index only. Folders with a recent cached listing are not listed again; their cached subfolders are followed instead.
+ */
+
+class DeepIndexCrawler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeepIndexCrawler(QString rootFolder, QObject *parent = nullptr);
+
+    void start();
+    void cancel();
+    bool isRunning();
+
+    static const int maxActive = 2;
+    static const qint64 freshListingAge = 15 * 60 * 1000;
+
+signals:
+    void crawlProgress(int foldersListed, int foldersFound);
+    void crawlFinished(bool completed);
+
+private slots:
+    void restListingReply(RequestState replyState, QByteArray body, qint64);
+    void lsReply(RequestState replyState, QList<FileMetaData> fileList);
+
+private:
+    struct ActiveListing
+    {
+        QString folderPath;
+        int offset = 0;
+        AgaveRestSession * session = nullptr;
+        int taskID = -1;
+    };
+
+    void startListings();
+    void listFolder(QString folderPath, int offset);
+    void folderDone(QString folderPath, const QVector<CachedFileEntry> &entries, bool fitsOnePage);
+    void checkFinished();
+
+    QString rootFolder;
+    QList<QString> folderQueue;
+    QHash<QObject *, ActiveListing> activeListings;
+    QHash<QString, QVector<CachedFileEntry>> partialListings;
+
+    int foldersListed = 0;
+    int foldersFound = 0;
+    bool running = false;
+};
+
+#endif // DEEPINDEXCRAWLER_H
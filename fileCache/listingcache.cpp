@@ -0,0 +1,277 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "listingcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include "filemetadata.h"
+
+#include "ae_globals.h"
+
+const quint32 ListingCache::cacheMagic;
+const quint32 ListingCache::cacheVersion;
+const int ListingCache::saveDelay;
+const int ListingCache::minEntryBytes;
+
+class ListingCache::SaveTask : public QRunnable
+{
+public:
+    SaveTask(QString newFilePath, QHash<QString, CachedFolder> newFolderCopy, QSharedPointer<SaveState> newState, quint64 newGeneration)
+    {
+        filePath = newFilePath;
+        folderCopy = newFolderCopy;
+        theState = newState;
+        generation = newGeneration;
+    }
+
+    void run()
+    {
+        if (!writeCache(filePath, folderCopy, theState, generation))
+        {
+            qCDebug(agaveAppLayer, "Unable to write listing cache: %s", qPrintable(filePath));
+        }
+    }
+
+private:
+    QString filePath;
+    QHash<QString, CachedFolder> folderCopy;
+    QSharedPointer<SaveState> theState;
+    quint64 generation;
+};
+
+ListingCache::ListingCache(QObject *parent) : QObject(parent)
+{
+    saveState = QSharedPointer<SaveState>(new SaveState());
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDelay);
+    QObject::connect(&saveTimer, SIGNAL(timeout()), this, SLOT(saveTimeout()));
+}
+
+void ListingCache::openCache(QString userName, QString storageSystem)
+{
+    saveNow();
+    folderList.clear();
+
+    QByteArray cacheKey = QString("%1@%2").arg(userName, storageSystem).toUtf8();
+    cachePath = QDir(cacheFolder()).filePath(QCryptographicHash::hash(cacheKey, QCryptographicHash::Sha1).toHex() + ".cache");
+
+    QFile cacheFile(cachePath);
+    if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+        emit cacheOpened();
+        return;
+    }
+
+    QDataStream cacheStream(&cacheFile);
+    cacheStream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    cacheStream >> fileMagic >> fileVersion;
+    if ((fileMagic != cacheMagic) || (fileVersion != cacheVersion))
+    {
+        qCDebug(agaveAppLayer, "Ignoring listing cache of another format: %s", qPrintable(cachePath));
+        emit cacheOpened();
+        return;
+    }
+
+    quint32 folderCount = 0;
+    cacheStream >> folderCount;
+    for (quint32 i = 0; (i < folderCount) && (cacheStream.status() == QDataStream::Ok); i++)
+    {
+        QString folderPath;
+        CachedFolder aFolder;
+        quint32 entryCount = 0;
+        cacheStream >> folderPath >> aFolder.fetchedAt >> entryCount;
+
+        //A damaged count is not trusted with an allocation larger than the rest of the file could fill
+        aFolder.entries.reserve((int) qMin((qint64) entryCount, cacheFile.bytesAvailable() / minEntryBytes));
+        for (quint32 j = 0; (j < entryCount) && (cacheStream.status() == QDataStream::Ok); j++)
+        {
+            CachedFileEntry anEntry;
+            qint32 entryType = 0;
+            cacheStream >> anEntry.name >> entryType >> anEntry.size >> anEntry.lastModified;
+            anEntry.type = (FileType) entryType;
+            aFolder.entries.append(anEntry);
+        }
+        folderList.insert(folderPath, aFolder);
+    }
+
+    //A truncated file is dropped as a whole, rather than trusted in part
+    if (cacheStream.status() != QDataStream::Ok)
+    {
+        qCDebug(agaveAppLayer, "Listing cache is damaged, starting empty: %s", qPrintable(cachePath));
+        folderList.clear();
+        emit cacheOpened();
+        return;
+    }
+    qCDebug(agaveAppLayer, "Loaded %d cached folder listings", folderList.size());
+    emit cacheOpened();
+}
+
+bool ListingCache::hasListing(QString folderPath)
+{
+    return folderList.contains(normalizePath(folderPath));
+}
+
+QVector<CachedFileEntry> ListingCache::getListing(QString folderPath)
+{
+    return folderList.value(normalizePath(folderPath)).entries;
+}
+
+qint64 ListingCache::listingTime(QString folderPath)
+{
+    return folderList.value(normalizePath(folderPath)).fetchedAt;
+}
+
+void ListingCache::storeListing(QString folderPath, QVector<CachedFileEntry> newListing)
+{
+    CachedFolder newFolder;
+    newFolder.fetchedAt = QDateTime::currentMSecsSinceEpoch();
+    newFolder.entries = newListing;
+    folderList.insert(normalizePath(folderPath), newFolder);
+
+    cacheDirty = true;
+    if (!saveTimer.isActive()) saveTimer.start();
+    emit listingStored(normalizePath(folderPath));
+}
+
+void ListingCache::removeListing(QString folderPath)
+{
+    folderPath = normalizePath(folderPath);
+    QString folderPrefix = folderPath + "/";
+
+    for (auto itr = folderList.begin(); itr != folderList.end();)
+    {
+        if ((itr.key() == folderPath) || itr.key().startsWith(folderPrefix))
+        {
+            itr = folderList.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+
+    cacheDirty = true;
+    if (!saveTimer.isActive()) saveTimer.start();
+    emit listingRemoved(folderPath);
+}
+
+QStringList ListingCache::cachedFolders()
+{
+    return folderList.keys();
+}
+
+void ListingCache::saveNow()
+{
+    saveTimer.stop();
+    if (cachePath.isEmpty()) return;
+
+    if (cacheDirty)
+    {
+        cacheDirty = false;
+        saveGeneration++;
+    }
+    else
+    {
+        //A background write which failed, or is still running, is made good here
+        QMutexLocker stateLock(&(saveState->writeLock));
+        if (saveState->lastWritten >= saveGeneration) return;
+    }
+
+    if (!writeCache(cachePath, folderList, saveState, saveGeneration))
+    {
+        qCDebug(agaveAppLayer, "Unable to write listing cache: %s", qPrintable(cachePath));
+    }
+}
+
+void ListingCache::saveTimeout()
+{
+    if (cachePath.isEmpty() || !cacheDirty) return;
+    cacheDirty = false;
+    saveGeneration++;
+
+    //The copy shares its data with the live listings until either is changed, so taking it is cheap
+    QThreadPool::globalInstance()->start(new SaveTask(cachePath, folderList, saveState, saveGeneration));
+}
+
+bool ListingCache::writeCache(QString filePath, const QHash<QString, CachedFolder> &folderCopy, QSharedPointer<SaveState> theState, quint64 generation)
+{
+    QMutexLocker stateLock(&(theState->writeLock));
+    if (generation <= theState->lastWritten) return true;
+
+    QDir().mkpath(cacheFolder());
+    QSaveFile cacheFile(filePath);
+    if (!cacheFile.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream cacheStream(&cacheFile);
+    cacheStream.setVersion(QDataStream::Qt_5_6);
+    cacheStream << cacheMagic << cacheVersion << (quint32) folderCopy.size();
+
+    for (auto itr = folderCopy.cbegin(); itr != folderCopy.cend(); itr++)
+    {
+        cacheStream << itr.key() << itr.value().fetchedAt << (quint32) itr.value().entries.size();
+        for (const CachedFileEntry &anEntry : itr.value().entries)
+        {
+            cacheStream << anEntry.name << (qint32) anEntry.type << anEntry.size << anEntry.lastModified;
+        }
+    }
+
+    if (!cacheFile.commit()) return false;
+    theState->lastWritten = generation;
+    return true;
+}
+
+QString ListingCache::cacheFolder()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("listingCache");
+}
+
+QString ListingCache::normalizePath(QString folderPath)
+{
+    while ((folderPath.size() > 1) && folderPath.endsWith('/')) folderPath.chop(1);
+    if (!folderPath.startsWith('/')) folderPath.prepend('/');
+    return folderPath;
+}
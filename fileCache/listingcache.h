@@ -0,0 +1,132 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef LISTINGCACHE_H
+#define LISTINGCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QMutex>
+#include <QSharedPointer>
+
+enum class FileType;
+
+struct CachedFileEntry
+{
+    QString name;
+    FileType type;
+    qint64 size = 0;
+    qint64 lastModified = 0;
+};
+
+/*! \brief The ListingCache keeps the remote folder listings seen so far, on disk between sessions.
+ *
+ *  There is one cache file for each user and storage system. It is a compact binary file, written with QDataStream, and is rewritten a short time after the listings change, and at shutdown.
+ *
+ *  The rewrite after a change runs on a QThreadPool thread, from a copy of the listings taken when it starts, so a crawl which stores many listings never holds up the GUI thread. Writes are made one at a time, and an older copy is never written over a newer one. saveNow() writes in the calling thread, after any write still running.
+ *
+ *  Cached listings may be stale. They are meant to be shown at once, and then replaced when a fresh listing arrives.
+ */
+
+class ListingCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ListingCache(QObject *parent = nullptr);
+
+    /*! \brief Loads the cache file for this user and storage system, replacing any listings held now.
+     */
+    void openCache(QString userName, QString storageSystem);
+
+    bool hasListing(QString folderPath);
+    QVector<CachedFileEntry> getListing(QString folderPath);
+
+    /*! \brief Returns the time the listing was fetched, in ms since the epoch, or 0 if there is none.
+     */
+    qint64 listingTime(QString folderPath);
+
+    void storeListing(QString folderPath, QVector<CachedFileEntry> newListing);
+
+    /*! \brief Drops the listing of folderPath, and of every folder under it.
+     */
+    void removeListing(QString folderPath);
+
+    QStringList cachedFolders();
+
+    void saveNow();
+
+    static const quint32 cacheMagic = 0x41454c43;
+    static const quint32 cacheVersion = 1;
+    static const int saveDelay = 2000;
+    static const int minEntryBytes = 24;
+
+signals:
+    void cacheOpened();
+    void listingStored(QString folderPath);
+    void listingRemoved(QString folderPath);
+
+private slots:
+    void saveTimeout();
+
+private:
+    struct CachedFolder
+    {
+        qint64 fetchedAt = 0;
+        QVector<CachedFileEntry> entries;
+    };
+
+    struct SaveState
+    {
+        QMutex writeLock;
+        quint64 lastWritten = 0;
+    };
+
+    class SaveTask;
+
+    static bool writeCache(QString filePath, const QHash<QString, CachedFolder> &folderCopy, QSharedPointer<SaveState> theState, quint64 generation);
+    static QString cacheFolder();
+    static QString normalizePath(QString folderPath);
+
+    QString cachePath;
+    QHash<QString, CachedFolder> folderList;
+    QTimer saveTimer;
+    bool cacheDirty = false;
+    quint64 saveGeneration = 0;
+    QSharedPointer<SaveState> saveState;
+};
+
+#endif // LISTINGCACHE_H
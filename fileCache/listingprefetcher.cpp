@@ -0,0 +1,168 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "listingprefetcher.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "fileCache/remotefoldermodel.h"
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "ae_globals.h"
+
+const int ListingPrefetcher::defaultDepth;
+const int ListingPrefetcher::defaultBudget;
+
+ListingPrefetcher::ListingPrefetcher(RemoteFolderModel * theModel, QObject *parent) : QObject(parent)
+{
+    myModel = theModel;
+    QObject::connect(myModel, SIGNAL(folderRefreshed(QString,RequestState)), this, SLOT(folderLoaded(QString,RequestState)));
+}
+
+void ListingPrefetcher::setMaxDepth(int newDepth)
+{
+    if (newDepth < 0) newDepth = 0;
+    maxDepth = newDepth;
+}
+
+void ListingPrefetcher::setRequestBudget(int newBudget)
+{
+    if (newBudget < 0) newBudget = 0;
+    requestBudget = newBudget;
+}
+
+void ListingPrefetcher::setMaxActive(int newMax)
+{
+    if (newMax < 1) newMax = 1;
+    maxActive = newMax;
+}
+
+void ListingPrefetcher::setFocusFolder(QString folderPath)
+{
+    while ((folderPath.size() > 1) && folderPath.endsWith('/')) folderPath.chop(1);
+    if (folderPath == focusFolder) return;
+
+    cancelAll();
+    focusFolder = folderPath;
+    requestsMade = 0;
+
+    //The focus may already be loaded, in which case its subfolders can go at once
+    folderLoaded(focusFolder, RequestState::GOOD);
+}
+
+void ListingPrefetcher::cancelAll()
+{
+    prefetchQueue.clear();
+    QList<ActivePrefetch> cancelList = activePrefetches.values();
+    activePrefetches.clear();
+
+    for (const ActivePrefetch &aPrefetch : cancelList)
+    {
+        aPrefetch.session->cancelTask(aPrefetch.taskID);
+    }
+}
+
+void ListingPrefetcher::folderLoaded(QString folderPath, RequestState finalState)
+{
+    if (finalState != RequestState::GOOD) return;
+
+    int folderDepth = depthBelowFocus(folderPath);
+    if ((folderDepth < 0) || (folderDepth >= maxDepth)) return;
+
+    for (QString aFolder : myModel->unlistedSubfolders(folderPath))
+    {
+        if (prefetchQueue.contains(aFolder)) continue;
+        prefetchQueue.append(aFolder);
+    }
+    startPrefetches();
+}
+
+void ListingPrefetcher::prefetchReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!activePrefetches.contains(sender())) return;
+    ActivePrefetch thePrefetch = activePrefetches.take(sender());
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+
+    //A full page is only part of a large folder, which is left to be listed when it is opened
+    if ((replyState == RequestState::GOOD) && (resultList.size() < RemoteFolderModel::listPageSize))
+    {
+        myModel->applyListing(thePrefetch.folderPath, RemoteFolderModel::parseRestListing(resultList));
+    }
+    startPrefetches();
+}
+
+int ListingPrefetcher::depthBelowFocus(QString folderPath)
+{
+    if (focusFolder.isEmpty()) return -1;
+    if (folderPath == focusFolder) return 0;
+
+    QString focusPrefix = focusFolder;
+    if (!focusPrefix.endsWith('/')) focusPrefix.append('/');
+    if (!folderPath.startsWith(focusPrefix)) return -1;
+
+    return folderPath.mid(focusPrefix.size()).split('/', QString::SkipEmptyParts).size();
+}
+
+void ListingPrefetcher::startPrefetches()
+{
+    while (!prefetchQueue.isEmpty() && (activePrefetches.size() < maxActive) && (requestsMade < requestBudget))
+    {
+        //Bulk lanes only: prefetches never wait in line ahead of listings the user asked for
+        AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+        if ((theSession == nullptr) || (theSession == ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE)))
+        {
+            prefetchQueue.clear();
+            return;
+        }
+
+        ActivePrefetch newPrefetch;
+        newPrefetch.folderPath = prefetchQueue.takeFirst();
+        newPrefetch.session = theSession;
+
+        RestTask * lsTask = theSession->newListing(newPrefetch.folderPath, 0, RemoteFolderModel::listPageSize);
+        QObject::connect(lsTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(prefetchReply(RequestState,QByteArray,qint64)));
+        newPrefetch.taskID = lsTask->getTaskID();
+        activePrefetches.insert(lsTask, newPrefetch);
+        requestsMade++;
+        theSession->submitTask(lsTask);
+    }
+}
@@ -0,0 +1,99 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef LISTINGPREFETCHER_H
+#define LISTINGPREFETCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+
+class RemoteFolderModel;
+class AgaveRestSession;
+enum class RequestState;
+
+/*! \brief The ListingPrefetcher lists folders in the file tree before the user expands them.
+ *
+ *  The prefetcher works below a focus folder, which is the folder the user is looking at. Whenever a folder under the focus is loaded, its subfolders are queued, down to maxDepth levels below the focus. Queued folders are listed on the bulk lanes, a few at a time, so that they do not hold up listings the user asked for, and the listings are handed to the RemoteFolderModel.
+ *
+ *  Each focus has a budget of listing requests. When the focus moves elsewhere, queued and running prefetches are dropped, and the budget starts over.
+ */
+
+class ListingPrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ListingPrefetcher(RemoteFolderModel * theModel, QObject *parent = nullptr);
+
+    void setMaxDepth(int newDepth);
+    void setRequestBudget(int newBudget);
+    void setMaxActive(int newMax);
+
+    /*! \brief Moves the prefetch to folderPath. Prefetches outside the new focus are cancelled.
+     */
+    void setFocusFolder(QString folderPath);
+    void cancelAll();
+
+    static const int defaultDepth = 2;
+    static const int defaultBudget = 40;
+
+private slots:
+    void folderLoaded(QString folderPath, RequestState finalState);
+    void prefetchReply(RequestState replyState, QByteArray body, qint64);
+
+private:
+    struct ActivePrefetch
+    {
+        QString folderPath;
+        AgaveRestSession * session = nullptr;
+        int taskID = -1;
+    };
+
+    int depthBelowFocus(QString folderPath);
+    void startPrefetches();
+
+    RemoteFolderModel * myModel;
+
+    int maxDepth = defaultDepth;
+    int requestBudget = defaultBudget;
+    int maxActive = 2;
+
+    QString focusFolder;
+    int requestsMade = 0;
+    QList<QString> prefetchQueue;
+    QHash<QObject *, ActivePrefetch> activePrefetches;
+};
+
+#endif // LISTINGPREFETCHER_H
@@ -0,0 +1,248 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "pathindex.h"
+
+#include <QRegExp>
+#include <QSet>
+
+#include "ae_globals.h"
+
+const int PathIndex::compactThreshold;
+
+PathIndex::PathIndex(ListingCache * theCache, QObject *parent) : QObject(parent)
+{
+    myCache = theCache;
+    QObject::connect(myCache, SIGNAL(cacheOpened()), this, SLOT(cacheOpened()));
+    QObject::connect(myCache, SIGNAL(listingStored(QString)), this, SLOT(listingStored(QString)));
+    QObject::connect(myCache, SIGNAL(listingRemoved(QString)), this, SLOT(listingRemoved(QString)));
+}
+
+void PathIndex::setFolderContents(QString folderPath, const QVector<CachedFileEntry> &entries)
+{
+    dropFolderNames(folderID(folderPath));
+    addFolderContents(folderPath, entries);
+}
+
+void PathIndex::addFolderContents(QString folderPath, const QVector<CachedFileEntry> &entries)
+{
+    int theFolder = folderID(folderPath);
+    QVector<int> &theNames = folderNames[theFolder];
+
+    for (const CachedFileEntry &anEntry : entries)
+    {
+        IndexedName newName;
+        newName.folderID = theFolder;
+        newName.name = anEntry.name;
+        newName.lowerName = anEntry.name.toLower();
+
+        int nameID = nameList.size();
+        nameList.append(newName);
+        theNames.append(nameID);
+        liveNames++;
+
+        //Each trigram is posted once per name; IDs only grow, so posting lists stay sorted
+        QSet<quint64> seenTrigrams;
+        for (int i = 0; i + 2 < newName.lowerName.size(); i++)
+        {
+            quint64 aKey = trigramKey(newName.lowerName, i);
+            if (seenTrigrams.contains(aKey)) continue;
+            seenTrigrams.insert(aKey);
+            trigramPostings[aKey].append(nameID);
+        }
+    }
+}
+
+void PathIndex::removeFolder(QString folderPath)
+{
+    while ((folderPath.size() > 1) && folderPath.endsWith('/')) folderPath.chop(1);
+    QString folderPrefix = folderPath + "/";
+
+    for (auto itr = folderIDs.cbegin(); itr != folderIDs.cend(); itr++)
+    {
+        if ((itr.key() == folderPath) || itr.key().startsWith(folderPrefix))
+        {
+            dropFolderNames(itr.value());
+        }
+    }
+    if ((deadNames > compactThreshold) && (deadNames > liveNames)) compact();
+}
+
+void PathIndex::clear()
+{
+    folderPaths.clear();
+    folderIDs.clear();
+    folderNames.clear();
+    nameList.clear();
+    trigramPostings.clear();
+    liveNames = 0;
+    deadNames = 0;
+}
+
+QStringList PathIndex::search(QString query, int maxResults)
+{
+    QStringList ret;
+    query = query.trimmed().toLower();
+    if (query.isEmpty()) return ret;
+
+    bool isGlob = query.contains('*') || query.contains('?');
+    QRegExp globMatcher(query, Qt::CaseInsensitive, QRegExp::Wildcard);
+
+    //Every trigram of the literal parts must be in a matching name
+    QVector<int> candidates;
+    bool haveCandidates = false;
+    for (QString aPart : query.split(QRegExp("[*?]"), QString::SkipEmptyParts))
+    {
+        for (int i = 0; i + 2 < aPart.size(); i++)
+        {
+            QVector<int> postings = trigramPostings.value(trigramKey(aPart, i));
+            candidates = haveCandidates ? intersect(candidates, postings) : postings;
+            haveCandidates = true;
+            if (candidates.isEmpty()) return ret;
+        }
+    }
+
+    int numToCheck = haveCandidates ? candidates.size() : nameList.size();
+    for (int i = 0; (i < numToCheck) && (ret.size() < maxResults); i++)
+    {
+        const IndexedName &aName = nameList.at(haveCandidates ? candidates.at(i) : i);
+        if (aName.folderID < 0) continue;
+
+        bool isMatch = isGlob ? globMatcher.exactMatch(aName.lowerName) : aName.lowerName.contains(query);
+        if (!isMatch) continue;
+
+        QString folderPath = folderPaths.at(aName.folderID);
+        ret.append((folderPath == "/") ? ("/" + aName.name) : (folderPath + "/" + aName.name));
+    }
+    return ret;
+}
+
+int PathIndex::pathCount()
+{
+    return liveNames;
+}
+
+void PathIndex::cacheOpened()
+{
+    clear();
+    for (QString aFolder : myCache->cachedFolders())
+    {
+        addFolderContents(aFolder, myCache->getListing(aFolder));
+    }
+    qCDebug(agaveAppLayer, "Path index holds %d names", liveNames);
+}
+
+void PathIndex::listingStored(QString folderPath)
+{
+    setFolderContents(folderPath, myCache->getListing(folderPath));
+    if ((deadNames > compactThreshold) && (deadNames > liveNames)) compact();
+}
+
+void PathIndex::listingRemoved(QString folderPath)
+{
+    removeFolder(folderPath);
+}
+
+quint64 PathIndex::trigramKey(const QString &text, int pos)
+{
+    return ((quint64) text.at(pos).unicode() << 32) | ((quint64) text.at(pos + 1).unicode() << 16) | (quint64) text.at(pos + 2).unicode();
+}
+
+QVector<int> PathIndex::intersect(const QVector<int> &left, const QVector<int> &right)
+{
+    QVector<int> ret;
+    int i = 0;
+    int j = 0;
+    while ((i < left.size()) && (j < right.size()))
+    {
+        if (left.at(i) < right.at(j)) i++;
+        else if (left.at(i) > right.at(j)) j++;
+        else
+        {
+            ret.append(left.at(i));
+            i++;
+            j++;
+        }
+    }
+    return ret;
+}
+
+int PathIndex::folderID(QString folderPath)
+{
+    while ((folderPath.size() > 1) && folderPath.endsWith('/')) folderPath.chop(1);
+    if (!folderIDs.contains(folderPath))
+    {
+        folderIDs.insert(folderPath, folderPaths.size());
+        folderPaths.append(folderPath);
+    }
+    return folderIDs.value(folderPath);
+}
+
+void PathIndex::dropFolderNames(int theFolder)
+{
+    //Names are only marked dead here; their postings are dropped at the next compaction
+    for (int nameID : folderNames.take(theFolder))
+    {
+        nameList[nameID].folderID = -1;
+        nameList[nameID].name.clear();
+        nameList[nameID].lowerName.clear();
+        liveNames--;
+        deadNames++;
+    }
+}
+
+void PathIndex::compact()
+{
+    QHash<int, QVector<int>> oldFolderNames = folderNames;
+    QVector<IndexedName> oldNames = nameList;
+
+    folderNames.clear();
+    nameList.clear();
+    trigramPostings.clear();
+    liveNames = 0;
+    deadNames = 0;
+
+    for (auto itr = oldFolderNames.cbegin(); itr != oldFolderNames.cend(); itr++)
+    {
+        QVector<CachedFileEntry> keptEntries;
+        for (int nameID : itr.value())
+        {
+            CachedFileEntry anEntry;
+            anEntry.name = oldNames.at(nameID).name;
+            keptEntries.append(anEntry);
+        }
+        addFolderContents(folderPaths.at(itr.key()), keptEntries);
+    }
+}
@@ -0,0 +1,113 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+
+#include "fileCache/listingcache.h"
+
+/*! \brief The PathIndex is an in-memory index of every remote path seen so far, for searching by file name.
+ *
+ *  File names are indexed by their trigrams, the runs of three characters in each name, lowercased. A search for a substring, or a glob pattern with * and ?, first narrows the names to those holding every trigram of the literal parts of the query, and then checks only those. Queries with no literal run of three characters fall back to checking every name.
+ *
+ *  The index follows the ListingCache, so it holds everything the tree has listed. Pages of large folders, which are not cached, are added by the RemoteFolderModel directly.
+ */
+
+class PathIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PathIndex(ListingCache * theCache, QObject *parent = nullptr);
+
+    /*! \brief Replaces the indexed contents of folderPath with the given entries.
+     */
+    void setFolderContents(QString folderPath, const QVector<CachedFileEntry> &entries);
+
+    /*! \brief Adds entries to the indexed contents of folderPath, as when a further page of a large folder arrives.
+     */
+    void addFolderContents(QString folderPath, const QVector<CachedFileEntry> &entries);
+
+    /*! \brief Drops the contents of folderPath, and of every folder under it.
+     */
+    void removeFolder(QString folderPath);
+    void clear();
+
+    /*! \brief Returns up to maxResults full paths whose file names match the query.
+     *
+     *  A query with * or ? is a glob, which must match the whole file name. Any other query matches anywhere in the file name. Case is ignored.
+     */
+    QStringList search(QString query, int maxResults = 500);
+    int pathCount();
+
+    static const int compactThreshold = 10000;
+
+private slots:
+    void cacheOpened();
+    void listingStored(QString folderPath);
+    void listingRemoved(QString folderPath);
+
+private:
+    struct IndexedName
+    {
+        int folderID = -1;
+        QString name;
+        QString lowerName;
+    };
+
+    static quint64 trigramKey(const QString &text, int pos);
+    static QVector<int> intersect(const QVector<int> &left, const QVector<int> &right);
+
+    int folderID(QString folderPath);
+    void dropFolderNames(int theFolder);
+    void compact();
+
+    ListingCache * myCache;
+
+    QVector<QString> folderPaths;
+    QHash<QString, int> folderIDs;
+    QHash<int, QVector<int>> folderNames;
+
+    QVector<IndexedName> nameList;
+    QHash<quint64, QVector<int>> trigramPostings;
+    int liveNames = 0;
+    int deadNames = 0;
+};
+
+#endif // PATHINDEX_H
@@ -0,0 +1,678 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotefoldermodel.h"
+
+#include <algorithm>
+#include <QDateTime>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "fileCache/pathindex.h"
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "ae_globals.h"
+
+const int RemoteFolderModel::listPageSize;
+
+RemoteFolderModel::RemoteFolderModel(QObject *parent) : QAbstractItemModel(parent)
+{
+    invisibleRoot = new FolderNode();
+}
+
+RemoteFolderModel::~RemoteFolderModel()
+{
+    deleteNode(invisibleRoot);
+}
+
+void RemoteFolderModel::setRootFolder(QString rootPath)
+{
+    while ((rootPath.size() > 1) && rootPath.endsWith('/')) rootPath.chop(1);
+
+    beginResetModel();
+    deleteNode(invisibleRoot);
+    invisibleRoot = new FolderNode();
+    invisibleRoot->childrenKnown = true;
+    rootFolder = rootPath;
+
+    CachedFileEntry rootEntry;
+    rootEntry.name = rootPath.mid(rootPath.lastIndexOf('/') + 1);
+    rootEntry.type = FileType::DIR;
+    invisibleRoot->rows.append(rootEntry);
+    invisibleRoot->rowNodes.append(nullptr);
+    FolderNode * rootNode = openRow(invisibleRoot, 0);
+    endResetModel();
+
+    //The cached tree is shown at once; the live listing then replaces it
+    fillFromCache(rootNode);
+    requestListing(rootNode);
+}
+
+QModelIndex RemoteFolderModel::index(int row, int column, const QModelIndex &parent) const
+{
+    FolderNode * parentNode = folderNodeOf(parent);
+    if (parentNode == nullptr) return QModelIndex();
+    if ((row < 0) || (row >= parentNode->rows.size())) return QModelIndex();
+    if ((column < 0) || (column >= columnCount())) return QModelIndex();
+
+    //Each index points to the folder holding its row, so that rows need no node of their own
+    return createIndex(row, column, parentNode);
+}
+
+QModelIndex RemoteFolderModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) return QModelIndex();
+    return indexForNode(parentNodeOf(child));
+}
+
+int RemoteFolderModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) return 0;
+    FolderNode * theNode = folderNodeOf(parent);
+    if (theNode == nullptr) return 0;
+    return theNode->rows.size();
+}
+
+int RemoteFolderModel::columnCount(const QModelIndex &) const
+{
+    return 3;
+}
+
+QVariant RemoteFolderModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    const CachedFileEntry * theEntry = entryOf(index);
+
+    if (role == Qt::ToolTipRole) return rowPath(parentNodeOf(index), index.row());
+    if (role != Qt::DisplayRole) return QVariant();
+
+    if (index.column() == 0) return theEntry->name;
+    if (index.column() == 1)
+    {
+        if (theEntry->type != FileType::FILE) return QVariant();
+        return formatSize(theEntry->size);
+    }
+    if (theEntry->lastModified <= 0) return QVariant();
+    return QDateTime::fromMSecsSinceEpoch(theEntry->lastModified).toString("yyyy-MM-dd hh:mm");
+}
+
+QVariant RemoteFolderModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+
+    if (section == 0) return "Name";
+    if (section == 1) return "Size";
+    if (section == 2) return "Modified";
+    return QVariant();
+}
+
+bool RemoteFolderModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return !invisibleRoot->rows.isEmpty();
+    if (entryOf(parent)->type != FileType::DIR) return false;
+
+    //An unlisted folder shows an expander, until a listing says it is empty
+    FolderNode * theNode = folderNodeOf(parent);
+    if ((theNode == nullptr) || !theNode->childrenKnown) return true;
+    return !theNode->rows.isEmpty();
+}
+
+bool RemoteFolderModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return false;
+    if (entryOf(parent)->type != FileType::DIR) return false;
+
+    FolderNode * theNode = folderNodeOf(parent);
+    if (theNode == nullptr) return true;
+    if (theNode->listingPending) return false;
+    if (theNode->paged) return (theNode->moreOnServer || !theNode->heldRows.isEmpty());
+    return !(theNode->listingLive || theNode->listingFailed);
+}
+
+void RemoteFolderModel::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid()) return;
+    FolderNode * theNode = openRow(parentNodeOf(parent), parent.row());
+    if ((theNode == nullptr) || theNode->listingPending) return;
+
+    if (theNode->paged)
+    {
+        if (!theNode->heldRows.isEmpty())
+        {
+            showHeldRows(theNode);
+        }
+        else if (theNode->moreOnServer)
+        {
+            requestListing(theNode, theNode->nextOffset);
+        }
+        return;
+    }
+
+    fillFromCache(theNode);
+    requestListing(theNode);
+}
+
+QModelIndex RemoteFolderModel::indexForPath(QString fullPath)
+{
+    FolderNode * parentNode = nullptr;
+    int row = 0;
+    if (!locatePath(fullPath, &parentNode, &row)) return QModelIndex();
+    return createIndex(row, 0, parentNode);
+}
+
+RemoteEntry RemoteFolderModel::entryForIndex(const QModelIndex &index)
+{
+    RemoteEntry ret;
+    if (!index.isValid()) return ret;
+
+    const CachedFileEntry * theEntry = entryOf(index);
+    ret.name = theEntry->name;
+    ret.fullPath = rowPath(parentNodeOf(index), index.row());
+    ret.type = theEntry->type;
+    ret.size = theEntry->size;
+    ret.lastModified = theEntry->lastModified;
+    ret.isRoot = (parentNodeOf(index) == invisibleRoot);
+    return ret;
+}
+
+void RemoteFolderModel::refreshFolder(QString folderPath)
+{
+    FolderNode * theNode = nodeForPath(folderPath);
+    if ((theNode == nullptr) || theNode->listingPending) return;
+
+    theNode->listingFailed = false;
+    requestListing(theNode);
+}
+
+void RemoteFolderModel::refreshParentOf(QString fullPath)
+{
+    while ((fullPath.size() > 1) && fullPath.endsWith('/')) fullPath.chop(1);
+    int lastSlash = fullPath.lastIndexOf('/');
+    if (lastSlash <= 0) return;
+    refreshFolder(fullPath.left(lastSlash));
+}
+
+void RemoteFolderModel::applyListing(QString folderPath, QVector<CachedFileEntry> newListing)
+{
+    FolderNode * theNode = nodeForPath(folderPath);
+    if ((theNode != nullptr) && !theNode->listingPending)
+    {
+        mergeListing(theNode, newListing);
+    }
+
+    ListingCache * theCache = ae_globals::get_listing_cache();
+    if (theCache != nullptr) theCache->storeListing(folderPath, newListing);
+    emit folderRefreshed(folderPath, RequestState::GOOD);
+}
+
+QStringList RemoteFolderModel::unlistedSubfolders(QString folderPath)
+{
+    QStringList ret;
+    FolderNode * theNode = nodeForPath(folderPath);
+    if (theNode == nullptr) return ret;
+
+    for (int i = 0; i < theNode->rows.size(); i++)
+    {
+        if (theNode->rows.at(i).type != FileType::DIR) continue;
+        FolderNode * aChild = theNode->rowNodes.at(i);
+        if ((aChild != nullptr) && (aChild->listingLive || aChild->listingPending)) continue;
+        ret.append(rowPath(theNode, i));
+    }
+    return ret;
+}
+
+QVector<CachedFileEntry> RemoteFolderModel::parseRestListing(const QJsonArray &resultList)
+{
+    QVector<CachedFileEntry> ret;
+    ret.reserve(resultList.size());
+
+    for (const QJsonValue &aValue : resultList)
+    {
+        QJsonObject anObject = aValue.toObject();
+        CachedFileEntry anEntry;
+        anEntry.name = anObject.value("name").toString();
+        if (anEntry.name.isEmpty() || (anEntry.name == ".") || (anEntry.name == "..")) continue;
+
+        QString typeText = anObject.value("type").toString();
+        if (typeText == "dir") anEntry.type = FileType::DIR;
+        else if (typeText == "file") anEntry.type = FileType::FILE;
+        else anEntry.type = FileType::INVALID;
+
+        anEntry.size = (qint64) anObject.value("length").toDouble();
+        QDateTime modTime = QDateTime::fromString(anObject.value("lastModified").toString(), Qt::ISODate);
+        if (modTime.isValid()) anEntry.lastModified = modTime.toMSecsSinceEpoch();
+        ret.append(anEntry);
+    }
+    return ret;
+}
+
+void RemoteFolderModel::restListingReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!pendingListings.contains(sender())) return;
+    PendingListing theListing = pendingListings.take(sender());
+
+    if (replyState != RequestState::GOOD)
+    {
+        finishListing(theListing.folderPath, replyState);
+        return;
+    }
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    QVector<CachedFileEntry> pageRows = parseRestListing(resultList);
+    bool pageFull = (resultList.size() >= listPageSize);
+
+    //A folder which fits in one page is merged and cached whole; larger ones are paged
+    if ((theListing.offset == 0) && !pageFull)
+    {
+        finishListing(theListing.folderPath, RequestState::GOOD, pageRows);
+        return;
+    }
+    receivePage(theListing.folderPath, theListing.offset, pageRows, theListing.offset + resultList.size(), pageFull);
+}
+
+void RemoteFolderModel::lsReply(RequestState replyState, QList<FileMetaData> fileList)
+{
+    if (!pendingListings.contains(sender())) return;
+    PendingListing theListing = pendingListings.take(sender());
+
+    if (replyState != RequestState::GOOD)
+    {
+        finishListing(theListing.folderPath, replyState);
+        return;
+    }
+
+    QVector<CachedFileEntry> allRows;
+    allRows.reserve(fileList.size());
+    for (FileMetaData aFile : fileList)
+    {
+        CachedFileEntry anEntry;
+        anEntry.name = aFile.getFileName();
+        if (anEntry.name.isEmpty() || (anEntry.name == ".") || (anEntry.name == "..")) continue;
+        anEntry.type = aFile.getFileType();
+        anEntry.size = aFile.getSize();
+        allRows.append(anEntry);
+    }
+
+    if (allRows.size() <= listPageSize)
+    {
+        finishListing(theListing.folderPath, RequestState::GOOD, allRows);
+        return;
+    }
+    //The handler gives the whole folder at once, so the rows past the first page are held until scrolled to
+    receivePage(theListing.folderPath, 0, allRows, allRows.size(), false);
+}
+
+RemoteFolderModel::FolderNode * RemoteFolderModel::parentNodeOf(const QModelIndex &index) const
+{
+    return static_cast<FolderNode *>(index.internalPointer());
+}
+
+RemoteFolderModel::FolderNode * RemoteFolderModel::folderNodeOf(const QModelIndex &index) const
+{
+    if (!index.isValid()) return invisibleRoot;
+    return parentNodeOf(index)->rowNodes.value(index.row(), nullptr);
+}
+
+const CachedFileEntry * RemoteFolderModel::entryOf(const QModelIndex &index) const
+{
+    return &(parentNodeOf(index)->rows.at(index.row()));
+}
+
+QModelIndex RemoteFolderModel::indexForNode(FolderNode * theNode, int column) const
+{
+    if ((theNode == nullptr) || (theNode == invisibleRoot)) return QModelIndex();
+    return createIndex(theNode->row, column, theNode->parent);
+}
+
+QString RemoteFolderModel::pathForNode(FolderNode * theNode) const
+{
+    if ((theNode == nullptr) || (theNode == invisibleRoot)) return QString();
+    return rowPath(theNode->parent, theNode->row);
+}
+
+QString RemoteFolderModel::rowPath(FolderNode * parentNode, int row) const
+{
+    if (parentNode == invisibleRoot) return rootFolder;
+    return pathForNode(parentNode) + "/" + parentNode->rows.at(row).name;
+}
+
+bool RemoteFolderModel::locatePath(QString fullPath, FolderNode ** parentNode, int * row)
+{
+    if (invisibleRoot->rows.isEmpty()) return false;
+    while ((fullPath.size() > 1) && fullPath.endsWith('/')) fullPath.chop(1);
+
+    FolderNode * searchNode = invisibleRoot;
+    int searchRow = 0;
+    if (fullPath != rootFolder)
+    {
+        if (!fullPath.startsWith(rootFolder + "/")) return false;
+
+        QStringList pathParts = fullPath.mid(rootFolder.size() + 1).split('/', QString::SkipEmptyParts);
+        for (QString aPart : pathParts)
+        {
+            //A folder with no node has never been listed, so nothing below it is known
+            FolderNode * nextNode = searchNode->rowNodes.at(searchRow);
+            if (nextNode == nullptr) return false;
+
+            searchRow = -1;
+            for (int i = 0; i < nextNode->rows.size(); i++)
+            {
+                if (nextNode->rows.at(i).name == aPart)
+                {
+                    searchRow = i;
+                    break;
+                }
+            }
+            if (searchRow < 0) return false;
+            searchNode = nextNode;
+        }
+    }
+
+    *parentNode = searchNode;
+    *row = searchRow;
+    return true;
+}
+
+RemoteFolderModel::FolderNode * RemoteFolderModel::nodeForPath(QString fullPath)
+{
+    FolderNode * parentNode = nullptr;
+    int row = 0;
+    if (!locatePath(fullPath, &parentNode, &row)) return nullptr;
+    return openRow(parentNode, row);
+}
+
+RemoteFolderModel::FolderNode * RemoteFolderModel::openRow(FolderNode * parentNode, int row)
+{
+    if ((row < 0) || (row >= parentNode->rows.size())) return nullptr;
+    if (parentNode->rows.at(row).type != FileType::DIR) return nullptr;
+
+    if (parentNode->rowNodes.at(row) == nullptr)
+    {
+        FolderNode * newNode = new FolderNode();
+        newNode->parent = parentNode;
+        newNode->row = row;
+        parentNode->rowNodes[row] = newNode;
+    }
+    return parentNode->rowNodes.at(row);
+}
+
+void RemoteFolderModel::deleteNode(FolderNode * theNode)
+{
+    if (theNode == nullptr) return;
+    for (FolderNode * aChild : theNode->rowNodes)
+    {
+        deleteNode(aChild);
+    }
+    delete theNode;
+}
+
+void RemoteFolderModel::renumberRows(FolderNode * theNode, int firstRow)
+{
+    for (int i = firstRow; i < theNode->rowNodes.size(); i++)
+    {
+        if (theNode->rowNodes.at(i) != nullptr) theNode->rowNodes.at(i)->row = i;
+    }
+}
+
+void RemoteFolderModel::spliceRows(FolderNode * theNode, int firstRow, const QVector<CachedFileEntry> &newRows)
+{
+    if (newRows.isEmpty()) return;
+
+    beginInsertRows(indexForNode(theNode), firstRow, firstRow + newRows.size() - 1);
+    if (firstRow == theNode->rows.size())
+    {
+        theNode->rows.append(newRows);
+    }
+    else
+    {
+        theNode->rows = theNode->rows.mid(0, firstRow) + newRows + theNode->rows.mid(firstRow);
+    }
+    theNode->rowNodes.insert(firstRow, newRows.size(), nullptr);
+    renumberRows(theNode, firstRow + newRows.size());
+    endInsertRows();
+}
+
+void RemoteFolderModel::dropRow(FolderNode * theNode, int row)
+{
+    beginRemoveRows(indexForNode(theNode), row, row);
+    deleteNode(theNode->rowNodes.at(row));
+    theNode->rows.remove(row);
+    theNode->rowNodes.remove(row);
+    renumberRows(theNode, row);
+    endRemoveRows();
+}
+
+void RemoteFolderModel::fillFromCache(FolderNode * theNode)
+{
+    if (theNode->childrenKnown) return;
+
+    ListingCache * theCache = ae_globals::get_listing_cache();
+    if ((theCache == nullptr) || !theCache->hasListing(pathForNode(theNode))) return;
+
+    QVector<CachedFileEntry> cachedList = theCache->getListing(pathForNode(theNode));
+    std::sort(cachedList.begin(), cachedList.end(), entryLessThan);
+    spliceRows(theNode, 0, cachedList);
+    theNode->childrenKnown = true;
+}
+
+void RemoteFolderModel::requestListing(FolderNode * theNode, int offset)
+{
+    PendingListing newListing;
+    newListing.folderPath = pathForNode(theNode);
+    newListing.offset = offset;
+    theNode->listingPending = true;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession != nullptr)
+    {
+        RestTask * lsTask = theSession->newListing(newListing.folderPath, offset, listPageSize);
+        QObject::connect(lsTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(restListingReply(RequestState,QByteArray,qint64)));
+        pendingListings.insert(lsTask, newListing);
+        theSession->submitTask(lsTask);
+        return;
+    }
+
+    //Without a direct session, the full listing comes from the handler in one reply
+    RemoteDataReply * theReply = ae_globals::get_connection()->remoteLS(newListing.folderPath);
+    if (theReply == nullptr)
+    {
+        finishListing(newListing.folderPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    QObject::connect(theReply, SIGNAL(haveLSReply(RequestState,QList<FileMetaData>)),
+                     this, SLOT(lsReply(RequestState,QList<FileMetaData>)));
+    pendingListings.insert(theReply, newListing);
+}
+
+void RemoteFolderModel::finishListing(QString folderPath, RequestState replyState, QVector<CachedFileEntry> newListing)
+{
+    FolderNode * theNode = nodeForPath(folderPath);
+    if (theNode != nullptr) theNode->listingPending = false;
+
+    if (replyState == RequestState::GOOD)
+    {
+        applyListing(folderPath, newListing);
+        return;
+    }
+
+    qCDebug(agaveAppLayer, "Listing failed for: %s", qPrintable(folderPath));
+    if (theNode != nullptr) theNode->listingFailed = !theNode->listingLive;
+    emit folderRefreshed(folderPath, replyState);
+}
+
+void RemoteFolderModel::receivePage(QString folderPath, int offset, QVector<CachedFileEntry> pageRows, int nextOffset, bool moreOnServer)
+{
+    FolderNode * theNode = nodeForPath(folderPath);
+    if (theNode == nullptr) return;
+    theNode->listingPending = false;
+
+    if (offset == 0)
+    {
+        //A paged folder is shown in server order, so the sorted cached rows make way for it
+        clearChildren(theNode);
+        theNode->paged = true;
+        ListingCache * theCache = ae_globals::get_listing_cache();
+        if (theCache != nullptr) theCache->removeListing(folderPath);
+    }
+    theNode->heldRows.append(pageRows);
+
+    //Paged folders are not cached, so the path index is given their pages here
+    PathIndex * theIndex = ae_globals::get_path_index();
+    if (theIndex != nullptr)
+    {
+        if (offset == 0) theIndex->setFolderContents(folderPath, pageRows);
+        else theIndex->addFolderContents(folderPath, pageRows);
+    }
+    theNode->nextOffset = nextOffset;
+    theNode->moreOnServer = moreOnServer;
+    theNode->childrenKnown = true;
+    theNode->listingLive = true;
+    theNode->listingFailed = false;
+
+    showHeldRows(theNode);
+    emit folderRefreshed(folderPath, RequestState::GOOD);
+}
+
+void RemoteFolderModel::showHeldRows(FolderNode * theNode)
+{
+    int numRows = qMin(listPageSize, theNode->heldRows.size());
+    QVector<CachedFileEntry> newRows = theNode->heldRows.mid(0, numRows);
+    theNode->heldRows.remove(0, numRows);
+    spliceRows(theNode, theNode->rows.size(), newRows);
+}
+
+void RemoteFolderModel::mergeListing(FolderNode * theNode, QVector<CachedFileEntry> newListing)
+{
+    std::sort(newListing.begin(), newListing.end(), entryLessThan);
+
+    //Rows of a paged folder are in server order, and cannot be merged in place
+    if (theNode->paged) clearChildren(theNode);
+
+    //An entry which changed type also changes its sorted place, so it is matched on name and type together
+    QSet<QString> newKeys;
+    for (const CachedFileEntry &anEntry : newListing)
+    {
+        newKeys.insert(mergeKey(anEntry));
+    }
+
+    ListingCache * theCache = ae_globals::get_listing_cache();
+    for (int i = theNode->rows.size() - 1; i >= 0; i--)
+    {
+        if (newKeys.contains(mergeKey(theNode->rows.at(i)))) continue;
+
+        if ((theCache != nullptr) && (theNode->rows.at(i).type == FileType::DIR)) theCache->removeListing(rowPath(theNode, i));
+        dropRow(theNode, i);
+    }
+
+    //Both lists are now in the same order, so kept rows are updated in place and runs of new rows inserted between them
+    int i = 0;
+    while (i < newListing.size())
+    {
+        const CachedFileEntry &anEntry = newListing.at(i);
+        if ((i < theNode->rows.size()) && (mergeKey(theNode->rows.at(i)) == mergeKey(anEntry)))
+        {
+            theNode->rows[i] = anEntry;
+            emit dataChanged(createIndex(i, 0, theNode), createIndex(i, columnCount() - 1, theNode));
+            i++;
+            continue;
+        }
+
+        QString nextKept;
+        if (i < theNode->rows.size()) nextKept = mergeKey(theNode->rows.at(i));
+        int runEnd = i;
+        while ((runEnd < newListing.size()) && (mergeKey(newListing.at(runEnd)) != nextKept)) runEnd++;
+
+        spliceRows(theNode, i, newListing.mid(i, runEnd - i));
+        i = runEnd;
+    }
+
+    theNode->childrenKnown = true;
+    theNode->listingLive = true;
+    theNode->listingFailed = false;
+}
+
+void RemoteFolderModel::clearChildren(FolderNode * theNode)
+{
+    if (!theNode->rows.isEmpty())
+    {
+        beginRemoveRows(indexForNode(theNode), 0, theNode->rows.size() - 1);
+        for (FolderNode * aChild : theNode->rowNodes)
+        {
+            deleteNode(aChild);
+        }
+        theNode->rows.clear();
+        theNode->rowNodes.clear();
+        endRemoveRows();
+    }
+    theNode->childrenKnown = false;
+    theNode->listingLive = false;
+    theNode->listingFailed = false;
+    theNode->paged = false;
+    theNode->moreOnServer = false;
+    theNode->nextOffset = 0;
+    theNode->heldRows.clear();
+}
+
+bool RemoteFolderModel::entryLessThan(const CachedFileEntry &left, const CachedFileEntry &right)
+{
+    //Folders are listed before files
+    bool leftIsDir = (left.type == FileType::DIR);
+    bool rightIsDir = (right.type == FileType::DIR);
+    if (leftIsDir != rightIsDir) return leftIsDir;
+
+    int nameOrder = QString::compare(left.name, right.name, Qt::CaseInsensitive);
+    if (nameOrder != 0) return (nameOrder < 0);
+    return (left.name < right.name);
+}
+
+QString RemoteFolderModel::mergeKey(const CachedFileEntry &anEntry)
+{
+    //A '/' cannot be part of a file name, so it separates the two parts
+    return QString("%1/%2").arg((int) anEntry.type).arg(anEntry.name);
+}
+
+QString RemoteFolderModel::formatSize(qint64 bytes)
+{
+    if (bytes >= 1073741824) return QString("%1 GB").arg(bytes / 1073741824.0, 0, 'f', 2);
+    if (bytes >= 1048576) return QString("%1 MB").arg(bytes / 1048576.0, 0, 'f', 1);
+    if (bytes >= 1024) return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1 B").arg(bytes);
+}
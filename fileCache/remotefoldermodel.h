@@ -0,0 +1,179 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTEFOLDERMODEL_H
+#define REMOTEFOLDERMODEL_H
+
+#include <QAbstractItemModel>
+#include <QVector>
+#include <QHash>
+#include <QJsonArray>
+
+#include "filemetadata.h"
+
+#include "fileCache/listingcache.h"
+
+enum class RequestState;
+
+struct RemoteEntry
+{
+    QString name;
+    QString fullPath;
+    FileType type = FileType::INVALID;
+    qint64 size = 0;
+    qint64 lastModified = 0;
+    bool isRoot = false;
+
+    bool isNil() const {return fullPath.isEmpty();}
+};
+
+/*! \brief The RemoteFolderModel is the tree model of the user's remote files, shown in the explorer window.
+ *
+ *  Folders are listed when the view first expands them. If the ListingCache holds a listing for the folder, it is shown at once, and a live listing is requested in the background. When the live listing arrives, it is merged into the tree by name, so that expanded folders and the selection are kept, and is stored back into the cache.
+ *
+ *  Each folder keeps its rows in a flat array of entries. A folder only gets a node of its own once it is opened, so a large folder of files costs one array entry per row. Folders with more than one page of entries are paged: the first page is shown, and further pages are fetched with offset and limit as the view scrolls down to them, through canFetchMore() and fetchMore(). Paged folders are shown in server order, and are not cached.
+ */
+
+class RemoteFolderModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    explicit RemoteFolderModel(QObject *parent = nullptr);
+    ~RemoteFolderModel();
+
+    void setRootFolder(QString rootPath);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    QModelIndex indexForPath(QString fullPath);
+    RemoteEntry entryForIndex(const QModelIndex &index);
+
+    /*! \brief Asks for a live listing of the folder, if it is in the tree and is not being listed already.
+     */
+    void refreshFolder(QString folderPath);
+    void refreshParentOf(QString fullPath);
+
+    /*! \brief Merges a complete listing of the folder, fetched elsewhere, into the tree and the cache.
+     *
+     *  This is for listings fetched by other means, such as the ListingPrefetcher. If the folder is not in the tree, or is being listed already, the listing is only stored in the cache.
+     */
+    void applyListing(QString folderPath, QVector<CachedFileEntry> newListing);
+
+    /*! \brief Returns the subfolders of folderPath which have not had a live listing yet.
+     */
+    QStringList unlistedSubfolders(QString folderPath);
+
+    static QVector<CachedFileEntry> parseRestListing(const QJsonArray &resultList);
+
+    static const int listPageSize = 500;
+
+signals:
+    void folderRefreshed(QString folderPath, RequestState finalState);
+
+private slots:
+    void restListingReply(RequestState replyState, QByteArray body, qint64);
+    void lsReply(RequestState replyState, QList<FileMetaData> fileList);
+
+private:
+    struct FolderNode
+    {
+        FolderNode * parent = nullptr;
+        int row = 0;
+
+        //Both arrays are always the same length; rowNodes is null for rows which have not been opened
+        QVector<CachedFileEntry> rows;
+        QVector<FolderNode *> rowNodes;
+
+        bool childrenKnown = false;
+        bool listingLive = false;
+        bool listingPending = false;
+        bool listingFailed = false;
+
+        bool paged = false;
+        bool moreOnServer = false;
+        int nextOffset = 0;
+        QVector<CachedFileEntry> heldRows;
+    };
+
+    FolderNode * parentNodeOf(const QModelIndex &index) const;
+    FolderNode * folderNodeOf(const QModelIndex &index) const;
+    const CachedFileEntry * entryOf(const QModelIndex &index) const;
+    QModelIndex indexForNode(FolderNode * theNode, int column = 0) const;
+    QString pathForNode(FolderNode * theNode) const;
+    QString rowPath(FolderNode * parentNode, int row) const;
+
+    bool locatePath(QString fullPath, FolderNode ** parentNode, int * row);
+    FolderNode * nodeForPath(QString fullPath);
+    FolderNode * openRow(FolderNode * parentNode, int row);
+
+    void deleteNode(FolderNode * theNode);
+    void renumberRows(FolderNode * theNode, int firstRow);
+    void spliceRows(FolderNode * theNode, int firstRow, const QVector<CachedFileEntry> &newRows);
+    void dropRow(FolderNode * theNode, int row);
+
+    void fillFromCache(FolderNode * theNode);
+    void requestListing(FolderNode * theNode, int offset = 0);
+    void finishListing(QString folderPath, RequestState replyState, QVector<CachedFileEntry> newListing = QVector<CachedFileEntry>());
+    void receivePage(QString folderPath, int offset, QVector<CachedFileEntry> pageRows, int nextOffset, bool moreOnServer);
+    void showHeldRows(FolderNode * theNode);
+    void mergeListing(FolderNode * theNode, QVector<CachedFileEntry> newListing);
+    void clearChildren(FolderNode * theNode);
+
+    static bool entryLessThan(const CachedFileEntry &left, const CachedFileEntry &right);
+    static QString mergeKey(const CachedFileEntry &anEntry);
+    static QString formatSize(qint64 bytes);
+
+    struct PendingListing
+    {
+        QString folderPath;
+        int offset = 0;
+    };
+
+    FolderNode * invisibleRoot = nullptr;
+    QString rootFolder;
+
+    QHash<QObject *, PendingListing> pendingListings;
+};
+
+#endif // REMOTEFOLDERMODEL_H
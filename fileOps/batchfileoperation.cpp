@@ -0,0 +1,255 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "batchfileoperation.h"
+
+#include "remotedatainterface.h"
+
+#include "netOps/remotelanepool.h"
+#include "ae_globals.h"
+
+BatchFileOperation::BatchFileOperation(BatchOpType opType, QStringList sourcePaths, QString newTargetText, QObject *parent) : QObject(parent)
+{
+    myOpType = opType;
+    targetText = newTargetText;
+    while ((targetText.size() > 1) && targetText.endsWith('/')) targetText.chop(1);
+
+    for (QString aPath : sourcePaths)
+    {
+        BatchItem newItem;
+        newItem.sourcePath = aPath;
+        QString itemName = aPath.mid(aPath.lastIndexOf('/') + 1);
+
+        if ((myOpType == BatchOpType::COPY) || (myOpType == BatchOpType::MOVE))
+        {
+            newItem.targetPath = targetText + "/" + itemName;
+        }
+        else if (myOpType == BatchOpType::RENAME)
+        {
+            newItem.targetPath = QString(targetText).replace("*", itemName);
+        }
+        itemList.append(newItem);
+    }
+
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        maxConcurrent = 2 * ae_globals::get_lane_pool()->bulkLaneCount();
+    }
+}
+
+void BatchFileOperation::setMaxConcurrent(int newMax)
+{
+    if (newMax < 1) newMax = 1;
+    maxConcurrent = newMax;
+}
+
+void BatchFileOperation::start()
+{
+    qCDebug(agaveAppLayer, "Starting batch %s of %d items", qPrintable(opName(myOpType)), itemList.size());
+    sendNextItems();
+}
+
+void BatchFileOperation::cancel()
+{
+    cancelled = true;
+    sendNextItems();
+}
+
+BatchOpType BatchFileOperation::getOpType()
+{
+    return myOpType;
+}
+
+int BatchFileOperation::totalCount()
+{
+    return itemList.size();
+}
+
+int BatchFileOperation::succeededCount()
+{
+    return itemsDone - itemsFailed;
+}
+
+int BatchFileOperation::failedCount()
+{
+    return itemsFailed;
+}
+
+QStringList BatchFileOperation::failedItems()
+{
+    QStringList ret;
+    for (const BatchItem &anItem : itemList)
+    {
+        if (anItem.done && !anItem.succeeded) ret.append(anItem.sourcePath);
+    }
+    return ret;
+}
+
+QStringList BatchFileOperation::affectedFolders()
+{
+    QStringList ret;
+    for (const BatchItem &anItem : itemList)
+    {
+        ret.append(parentFolder(anItem.sourcePath));
+    }
+    if ((myOpType == BatchOpType::COPY) || (myOpType == BatchOpType::MOVE))
+    {
+        ret.append(targetText);
+    }
+    ret.removeDuplicates();
+    return ret;
+}
+
+QStringList BatchFileOperation::writePaths()
+{
+    QStringList ret;
+    for (const BatchItem &anItem : itemList)
+    {
+        if (myOpType != BatchOpType::COPY) ret.append(anItem.sourcePath);
+        if (myOpType == BatchOpType::RENAME)
+        {
+            ret.append(parentFolder(anItem.sourcePath) + "/" + anItem.targetPath);
+        }
+        else if (!anItem.targetPath.isEmpty())
+        {
+            ret.append(anItem.targetPath);
+        }
+    }
+    return ret;
+}
+
+QStringList BatchFileOperation::readPaths()
+{
+    QStringList ret;
+    if (myOpType != BatchOpType::COPY) return ret;
+    for (const BatchItem &anItem : itemList)
+    {
+        ret.append(anItem.sourcePath);
+    }
+    return ret;
+}
+
+QString BatchFileOperation::opName(BatchOpType opType)
+{
+    if (opType == BatchOpType::COPY) return "Copy";
+    if (opType == BatchOpType::MOVE) return "Move";
+    if (opType == BatchOpType::RENAME) return "Rename";
+    return "Delete";
+}
+
+void BatchFileOperation::itemReply(RequestState replyState)
+{
+    if (!pendingItems.contains(sender())) return;
+    int itemNum = pendingItems.take(sender());
+
+    finishItem(itemNum, (replyState == RequestState::GOOD));
+    sendNextItems();
+}
+
+QString BatchFileOperation::parentFolder(QString fullPath)
+{
+    int lastSlash = fullPath.lastIndexOf('/');
+    if (lastSlash <= 0) return "/";
+    return fullPath.left(lastSlash);
+}
+
+void BatchFileOperation::sendNextItems()
+{
+    if (batchEnded) return;
+
+    while (!cancelled && (nextItem < itemList.size()) && (pendingItems.size() < maxConcurrent))
+    {
+        int itemNum = nextItem;
+        nextItem++;
+        const BatchItem &theItem = itemList.at(itemNum);
+
+        RemoteDataInterface * theLane = ae_globals::get_lane_pool()->getLane(LaneType::BULK);
+        RemoteDataReply * theReply = nullptr;
+        const char * replySignal = nullptr;
+
+        if (myOpType == BatchOpType::COPY)
+        {
+            theReply = theLane->copyFile(theItem.sourcePath, theItem.targetPath);
+            replySignal = SIGNAL(haveCopyReply(RequestState,FileMetaData));
+        }
+        else if (myOpType == BatchOpType::MOVE)
+        {
+            theReply = theLane->moveFile(theItem.sourcePath, theItem.targetPath);
+            replySignal = SIGNAL(haveMoveReply(RequestState,FileMetaData));
+        }
+        else if (myOpType == BatchOpType::RENAME)
+        {
+            theReply = theLane->renameFile(theItem.sourcePath, theItem.targetPath);
+            replySignal = SIGNAL(haveRenameReply(RequestState,FileMetaData,QString));
+        }
+        else
+        {
+            theReply = theLane->deleteFile(theItem.sourcePath);
+            replySignal = SIGNAL(haveDeleteReply(RequestState));
+        }
+
+        if (theReply == nullptr)
+        {
+            finishItem(itemNum, false);
+            continue;
+        }
+        ae_globals::get_lane_pool()->trackReply(theLane, theReply);
+        pendingItems.insert(theReply, itemNum);
+        QObject::connect(theReply, replySignal, this, SLOT(itemReply(RequestState)));
+    }
+
+    //Done once every sent item is back, and nothing more will be sent
+    if (!pendingItems.isEmpty()) return;
+    if (!cancelled && (nextItem < itemList.size())) return;
+
+    batchEnded = true;
+    emit batchFinished(succeededCount(), itemsFailed);
+}
+
+void BatchFileOperation::finishItem(int itemNum, bool succeeded)
+{
+    BatchItem &theItem = itemList[itemNum];
+    theItem.done = true;
+    theItem.succeeded = succeeded;
+
+    itemsDone++;
+    if (!succeeded)
+    {
+        itemsFailed++;
+        qCDebug(agaveAppLayer, "Batch %s failed for: %s", qPrintable(opName(myOpType)), qPrintable(theItem.sourcePath));
+    }
+    emit itemFinished(theItem.sourcePath, succeeded ? RequestState::GOOD : RequestState::EXPLICIT_ERROR);
+    emit batchProgress(itemsDone, itemList.size());
+}
@@ -0,0 +1,120 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef BATCHFILEOPERATION_H
+#define BATCHFILEOPERATION_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+enum class RequestState;
+
+enum class BatchOpType {COPY, MOVE, RENAME, REMOVE};
+
+/*! \brief A BatchFileOperation copies, moves, renames or deletes a list of remote files, with several requests in flight at once.
+ *
+ *  Requests are spread over the bulk lanes, with at most maxConcurrent outstanding, so that a batch of hundreds of items does not wait on each reply in turn. Every item gets its own result, and a failed item does not stop the rest.
+ *
+ *  For COPY and MOVE, the target is the folder to put the items in. For RENAME, the target is a pattern for the new name, in which * stands for the old name.
+ */
+
+class BatchFileOperation : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchFileOperation(BatchOpType opType, QStringList sourcePaths, QString targetText, QObject *parent = nullptr);
+
+    void setMaxConcurrent(int newMax);
+    void start();
+
+    /*! \brief Stops sending new requests. Requests already sent still finish, and are reported.
+     */
+    void cancel();
+
+    BatchOpType getOpType();
+    int totalCount();
+    int succeededCount();
+    int failedCount();
+    QStringList failedItems();
+
+    /*! \brief Returns the folders whose contents the batch may have changed.
+     */
+    QStringList affectedFolders();
+
+    /*! \brief Returns the paths the batch changes, and the paths it only reads, for the FileOpScheduler.
+     */
+    QStringList writePaths();
+    QStringList readPaths();
+
+    static QString opName(BatchOpType opType);
+
+signals:
+    void batchProgress(int itemsDone, int itemsTotal);
+    void itemFinished(QString sourcePath, RequestState finalState);
+    void batchFinished(int succeeded, int failed);
+
+private slots:
+    void itemReply(RequestState replyState);
+
+private:
+    struct BatchItem
+    {
+        QString sourcePath;
+        QString targetPath;
+        bool done = false;
+        bool succeeded = false;
+    };
+
+    static QString parentFolder(QString fullPath);
+
+    void sendNextItems();
+    void finishItem(int itemNum, bool succeeded);
+
+    BatchOpType myOpType;
+    QString targetText;
+    QVector<BatchItem> itemList;
+    QHash<QObject *, int> pendingItems;
+
+    int maxConcurrent = 4;
+    int nextItem = 0;
+    int itemsDone = 0;
+    int itemsFailed = 0;
+    bool cancelled = false;
+    bool batchEnded = false;
+};
+
+#endif // BATCHFILEOPERATION_H
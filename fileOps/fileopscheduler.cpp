@@ -0,0 +1,202 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "fileopscheduler.h"
+
+#include "ae_globals.h"
+
+FileOpScheduler::FileOpScheduler(QObject *parent) : QObject(parent) {}
+
+int FileOpScheduler::tryBegin(QString description, QStringList writePaths, QStringList readPaths)
+{
+    PathOp newOp;
+    newOp.description = description;
+    newOp.writePaths = normalizePaths(writePaths);
+    newOp.readPaths = normalizePaths(readPaths);
+
+    for (const PathOp &anOp : opList)
+    {
+        if (opsConflict(anOp, newOp))
+        {
+            qCDebug(agaveAppLayer, "%s refused, conflicts with: %s", qPrintable(description), qPrintable(anOp.description));
+            return -1;
+        }
+    }
+
+    newOp.started = true;
+    int newID = nextOpID++;
+    opList.insert(newID, newOp);
+    emit opsChanged(activeCount(), queuedCount());
+    return newID;
+}
+
+int FileOpScheduler::enqueue(QString description, QStringList writePaths, QStringList readPaths)
+{
+    PathOp newOp;
+    newOp.description = description;
+    newOp.writePaths = normalizePaths(writePaths);
+    newOp.readPaths = normalizePaths(readPaths);
+
+    bool canStart = true;
+    for (const PathOp &anOp : opList)
+    {
+        if (opsConflict(anOp, newOp)) canStart = false;
+    }
+
+    newOp.started = canStart;
+    int newID = nextOpID++;
+    opList.insert(newID, newOp);
+    emit opsChanged(activeCount(), queuedCount());
+    return newID;
+}
+
+bool FileOpScheduler::isStarted(int opID)
+{
+    return opList.value(opID).started;
+}
+
+void FileOpScheduler::finish(int opID)
+{
+    if (opList.remove(opID) == 0) return;
+    startReadyOps();
+    emit opsChanged(activeCount(), queuedCount());
+}
+
+QString FileOpScheduler::conflictWith(QStringList writePaths, QStringList readPaths)
+{
+    PathOp testOp;
+    testOp.writePaths = normalizePaths(writePaths);
+    testOp.readPaths = normalizePaths(readPaths);
+
+    for (const PathOp &anOp : opList)
+    {
+        if (opsConflict(anOp, testOp)) return anOp.description;
+    }
+    return QString();
+}
+
+int FileOpScheduler::activeCount()
+{
+    int ret = 0;
+    for (const PathOp &anOp : opList)
+    {
+        if (anOp.started) ret++;
+    }
+    return ret;
+}
+
+int FileOpScheduler::queuedCount()
+{
+    return opList.size() - activeCount();
+}
+
+QString FileOpScheduler::normalizePath(QString aPath)
+{
+    while ((aPath.size() > 1) && aPath.endsWith('/')) aPath.chop(1);
+    if (!aPath.startsWith('/')) aPath.prepend('/');
+    return aPath;
+}
+
+QStringList FileOpScheduler::normalizePaths(QStringList pathList)
+{
+    QStringList ret;
+    for (QString aPath : pathList)
+    {
+        if (aPath.isEmpty()) continue;
+        ret.append(normalizePath(aPath));
+    }
+    return ret;
+}
+
+bool FileOpScheduler::pathsOverlap(const QString &path1, const QString &path2)
+{
+    if ((path1 == "/") || (path2 == "/")) return true;
+    if (path1 == path2) return true;
+    if (path1.startsWith(path2) && (path1.at(path2.size()) == '/')) return true;
+    if (path2.startsWith(path1) && (path2.at(path1.size()) == '/')) return true;
+    return false;
+}
+
+bool FileOpScheduler::anyOverlap(const QStringList &list1, const QStringList &list2)
+{
+    for (const QString &path1 : list1)
+    {
+        for (const QString &path2 : list2)
+        {
+            if (pathsOverlap(path1, path2)) return true;
+        }
+    }
+    return false;
+}
+
+bool FileOpScheduler::opsConflict(const PathOp &op1, const PathOp &op2)
+{
+    //Reads never conflict with reads
+    if (anyOverlap(op1.writePaths, op2.writePaths)) return true;
+    if (anyOverlap(op1.writePaths, op2.readPaths)) return true;
+    if (anyOverlap(op1.readPaths, op2.writePaths)) return true;
+    return false;
+}
+
+void FileOpScheduler::startReadyOps()
+{
+    //Ops are checked in ID order, against every op before them, so an overlapping op never jumps the queue
+    QList<int> opIDs = opList.keys();
+    QList<int> readyOps;
+    for (int i = 0; i < opIDs.size(); i++)
+    {
+        PathOp &theOp = opList[opIDs.at(i)];
+        if (theOp.started) continue;
+
+        bool canStart = true;
+        for (int j = 0; (j < opIDs.size()) && canStart; j++)
+        {
+            if (j == i) continue;
+            const PathOp &otherOp = opList[opIDs.at(j)];
+            if (!otherOp.started && (j > i)) continue;
+            if (opsConflict(theOp, otherOp)) canStart = false;
+        }
+        if (!canStart) continue;
+
+        theOp.started = true;
+        readyOps.append(opIDs.at(i));
+    }
+
+    //Signals go out last, since a receiver may finish or queue ops in turn
+    for (int anID : readyOps)
+    {
+        emit opReady(anID);
+    }
+}
@@ -0,0 +1,102 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FILEOPSCHEDULER_H
+#define FILEOPSCHEDULER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+
+/*! \brief The FileOpScheduler keeps track of which remote paths are in use by file operations in flight.
+ *
+ *  Each operation names the paths it changes, and the paths it only reads. A path stands for its whole subtree. Two operations conflict if one changes a path which overlaps any path of the other; operations which only read, or which touch separate subtrees, run side by side.
+ *
+ *  An operation can be begun at once, which fails if it conflicts, or queued, in which case opReady() is emitted when it may start. Queued operations start in order, and a queued operation is never passed by a later one which overlaps it.
+ */
+
+class FileOpScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileOpScheduler(QObject *parent = nullptr);
+
+    /*! \brief Starts an operation, if it conflicts with no operation in flight or queued.
+     *
+     *  \return The ID of the operation, to be given to finish(), or -1 if it conflicts.
+     */
+    int tryBegin(QString description, QStringList writePaths, QStringList readPaths = QStringList());
+
+    /*! \brief Queues an operation, starting it at once if it can. Use isStarted() to tell which happened.
+     */
+    int enqueue(QString description, QStringList writePaths, QStringList readPaths = QStringList());
+
+    bool isStarted(int opID);
+    void finish(int opID);
+
+    /*! \brief Returns the description of an operation in flight or queued which would conflict with these paths, or an empty string if there is none.
+     */
+    QString conflictWith(QStringList writePaths, QStringList readPaths = QStringList());
+
+    int activeCount();
+    int queuedCount();
+
+signals:
+    void opReady(int opID);
+    void opsChanged(int activeOps, int queuedOps);
+
+private:
+    struct PathOp
+    {
+        QString description;
+        QStringList writePaths;
+        QStringList readPaths;
+        bool started = false;
+    };
+
+    static QString normalizePath(QString aPath);
+    static QStringList normalizePaths(QStringList pathList);
+    static bool pathsOverlap(const QString &path1, const QString &path2);
+    static bool anyOverlap(const QStringList &list1, const QStringList &list2);
+    static bool opsConflict(const PathOp &op1, const PathOp &op2);
+
+    void startReadyOps();
+
+    QMap<int, PathOp> opList;
+    int nextOpID = 1;
+};
+
+#endif // FILEOPSCHEDULER_H
@@ -58,6 +58,7 @@ void ExplorerDriver::startup()
 
     myDataInterface->registerAgaveAppInfo("compress", "compress-0.1u1",{"directory", "compression_type"},{},"directory");
     myDataInterface->registerAgaveAppInfo("extract", "extract-0.1u1",{"inputFile"},{},"inputFile");
+    myDataInterface->registerAgaveAppInfo("concat", "concat-0.1u1",{"directory", "outputFile"},{},"directory");
 
     myDataInterface->registerAgaveAppInfo("cwe-serial", "cwe-serial-0.2.0", {"stage"}, {"file_input", "directory"}, "directory");
     myDataInterface->registerAgaveAppInfo("cwe-parallel", "cwe-parallel-0.2.0", {"stage"}, {"file_input", "directory"}, "directory");
@@ -103,6 +104,7 @@ void ExplorerDriver::loadAppList(RequestState replyState, QVariantList appList)
     if (replyState != RequestState::GOOD)
     {
         qCDebug(agaveAppLayer, "App List not available.");
+        mainWindow->offerUploadResume();
         return;
     }
 
@@ -115,6 +117,9 @@ void ExplorerDriver::loadAppList(RequestState replyState, QVariantList appList)
             mainWindow->addAppToList(appName);
         }
     }
+
+    //Interrupted uploads are offered only now, since finishing them needs to know if the concat app exists
+    mainWindow->offerUploadResume();
 }
 
 void ExplorerDriver::loadStyleFiles()
@@ -36,16 +36,40 @@
 #include "explorerwindow.h"
 #include "ui_explorerwindow.h"
 
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QCheckBox>
+#include <QPushButton>
+
 #include "remotedatainterface.h"
 #include "filemetadata.h"
 
-#include "remoteFiles/filetreenode.h"
-#include "remoteFiles/fileoperator.h"
-#include "remoteFiles/filerecursiveoperator.h"
-
-#include "remoteJobs/joboperator.h"
-
 #include "utilFuncs/singlelinedialog.h"
+#include "transferOps/transferqueue.h"
+#include "transferOps/chunkeduploader.h"
+#include "transferOps/transferlistmodel.h"
+#include "transferOps/fileretriever.h"
+#include "transferOps/foldercrawler.h"
+#include "transferOps/compresseddownload.h"
+#include "transferOps/bundledupload.h"
+#include "transferOps/foldersync.h"
+#include "transferOps/remotefiletail.h"
+#include "utilFuncs/pagedfilereader.h"
+#include "utilFuncs/fileviewerdialog.h"
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "fileCache/listingcache.h"
+#include "fileCache/listingprefetcher.h"
+#include "fileCache/pathindex.h"
+#include "fileCache/deepindexcrawler.h"
+#include "jobOps/jobstore.h"
+#include "jobOps/jobpoller.h"
+#include "jobOps/joblistmodel.h"
+#include "jobOps/parametersweep.h"
 
 #include "explorerdriver.h"
 #include "ae_globals.h"
@@ -65,11 +89,82 @@ ExplorerWindow::ExplorerWindow(QWidget *parent) :
     }
     ui->agaveAppList->setModel(&taskListModel);
 
-    ui->remoteFileView->linkToFileOperator(ae_globals::get_file_handle());
-    ui->jobTable->setOperator(ae_globals::get_job_handle());
-
-    ui->selectedFileLabel->connectFileTreeWidget(ui->remoteFileView);
-    ui->selectedFileInfo->connectFileTreeWidget(ui->remoteFileView);
+    ui->remoteFileView->setModel(&remoteFileModel);
+    ui->remoteFileView->setUniformRowHeights(true);
+    QObject::connect(ui->remoteFileView->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)),
+                     this, SLOT(fileSelectionChanged(QModelIndex,QModelIndex)));
+    QObject::connect(ui->remoteFileView, SIGNAL(expanded(QModelIndex)), this, SLOT(fileFolderExpanded(QModelIndex)));
+
+    myPrefetcher = new ListingPrefetcher(&remoteFileModel, this);
+    myPrefetcher->setMaxDepth(ae_globals::get_Driver()->getPrefetchDepth());
+    myPrefetcher->setRequestBudget(ae_globals::get_Driver()->getPrefetchBudget());
+
+    ui->fileSearchResults->hide();
+    QObject::connect(ui->fileSearchText, SIGNAL(textChanged(QString)), this, SLOT(fileSearchChanged(QString)));
+    QObject::connect(ui->fileSearchResults, SIGNAL(itemActivated(QListWidgetItem*)), this, SLOT(fileSearchResultChosen(QListWidgetItem*)));
+    QObject::connect(&fileOpScheduler, SIGNAL(opReady(int)), this, SLOT(fileOpReady(int)));
+    QObject::connect(ui->deepIndexBox, SIGNAL(toggled(bool)), this, SLOT(deepIndexToggled(bool)));
+
+    JobStore * theJobStore = ae_globals::get_job_store();
+    jobModel = new JobListModel(theJobStore, ae_globals::get_job_poller(), this);
+    ui->jobTable->setModel(jobModel);
+    ui->jobTable->sortByColumn(3, Qt::DescendingOrder);
+    ui->jobTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    ui->jobTable->verticalHeader()->hide();
+
+    ui->jobAppFilter->addItem("All Apps");
+    ui->jobStatusFilter->addItem("All States");
+    for (QString anApp : theJobStore->knownApps()) addFilterChoice(ui->jobAppFilter, anApp);
+    for (QString aStatus : theJobStore->knownStatuses()) addFilterChoice(ui->jobStatusFilter, aStatus);
+    ui->jobDateFilter->addItem("Any Time", 0);
+    ui->jobDateFilter->addItem("Last Day", 1);
+    ui->jobDateFilter->addItem("Last Week", 7);
+    ui->jobDateFilter->addItem("Last Month", 30);
+    ui->jobDateFilter->addItem("Last Year", 365);
+    QObject::connect(ui->jobAppFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->jobStatusFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->jobDateFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    ui->jobSweepFilter->addItem("All Jobs", -1);
+    QObject::connect(ui->jobSweepFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->agaveSweepButton, SIGNAL(clicked(bool)), this, SLOT(agaveSweepInvoked()));
+    QObject::connect(theJobStore, SIGNAL(jobAdded(QString)), this, SLOT(jobStoreChanged(QString)));
+    QObject::connect(theJobStore, SIGNAL(jobChanged(QString)), this, SLOT(jobStoreChanged(QString)));
+    QObject::connect(jobModel, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(updateJobCountLabel()));
+    QObject::connect(jobModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(updateJobCountLabel()));
+    QObject::connect(jobModel, SIGNAL(modelReset()), this, SLOT(updateJobCountLabel()));
+    QObject::connect(ae_globals::get_job_poller(), SIGNAL(olderJobsRead(int,bool)), this, SLOT(updateJobCountLabel()));
+    updateJobCountLabel();
+
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    ui->transferLimitBox->setValue(theQueue->getMaxConcurrent());
+    QObject::connect(ui->transferLimitBox, SIGNAL(valueChanged(int)), this, SLOT(transferLimitChanged(int)));
+    QObject::connect(ui->clearTransfersButton, SIGNAL(clicked(bool)), this, SLOT(clearFinishedTransfers()));
+    QObject::connect(theQueue, SIGNAL(queueProgress(int,int,double)), this, SLOT(transferQueueProgress(int,int,double)));
+    QObject::connect(theQueue, SIGNAL(queueDrained()), this, SLOT(transferQueueDrained()));
+    QObject::connect(theQueue, SIGNAL(transferFinished(int,RequestState)), this, SLOT(transferItemFinished(int,RequestState)));
+
+    transferModel = new TransferListModel(theQueue, this);
+    ui->transferView->setModel(transferModel);
+    ui->transferView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    ui->transferView->verticalHeader()->hide();
+
+    RemoteLanePool * thePool = ae_globals::get_lane_pool();
+    ui->downloadLimitBox->setValue((int) (thePool->getDownloadLimit() / 1024));
+    ui->uploadLimitBox->setValue((int) (thePool->getUploadLimit() / 1024));
+    ui->transferDownloadLimitBox->setValue((int) (theQueue->getPerTransferDownloadLimit() / 1024));
+    ui->transferUploadLimitBox->setValue((int) (theQueue->getPerTransferUploadLimit() / 1024));
+    QObject::connect(ui->downloadLimitBox, SIGNAL(editingFinished()), this, SLOT(rateLimitsChanged()));
+    QObject::connect(ui->uploadLimitBox, SIGNAL(editingFinished()), this, SLOT(rateLimitsChanged()));
+    QObject::connect(ui->transferDownloadLimitBox, SIGNAL(editingFinished()), this, SLOT(rateLimitsChanged()));
+    QObject::connect(ui->transferUploadLimitBox, SIGNAL(editingFinished()), this, SLOT(rateLimitsChanged()));
+
+    ChunkedUploader * theUploader = ae_globals::get_chunked_uploader();
+    QObject::connect(theUploader, SIGNAL(uploadProgress(QString,int,int)), this, SLOT(chunkedUploadProgress(QString,int,int)));
+    QObject::connect(theUploader, SIGNAL(uploadFinished(QString,RequestState)), this, SLOT(chunkedUploadFinished(QString,RequestState)));
+
+    FileRetriever * theRetriever = ae_globals::get_file_retriever();
+    QObject::connect(theRetriever, SIGNAL(retrievalProgress(QString,qint64,qint64)), this, SLOT(retrievalProgress(QString,qint64,qint64)));
+    QObject::connect(theRetriever, SIGNAL(retrievalFinished(QString,RequestState)), this, SLOT(retrievalFinished(QString,RequestState)));
 }
 
 ExplorerWindow::~ExplorerWindow()
@@ -85,11 +180,18 @@ void ExplorerWindow::startAndShow()
     ui->agaveAppList->setModel(&taskListModel);
     QObject::connect(ui->jobTable, SIGNAL(customContextMenuRequested(QPoint)),
                      this, SLOT(jobRightClickMenu(QPoint)));
+    QObject::connect(ui->transferView, SIGNAL(customContextMenuRequested(QPoint)),
+                     this, SLOT(transferRightClickMenu(QPoint)));
 
     //Note: Adding widget to header will re-parent them
     QLabel * username = new QLabel(ae_globals::get_connection()->getUserName());
     ui->header->appendWidget(username);
 
+    //The tree is drawn from the listing cache first, then brought up to date
+    remoteFileModel.setRootFolder("/" + ae_globals::get_connection()->getUserName());
+    myPrefetcher->setFocusFolder("/" + ae_globals::get_connection()->getUserName());
+    ui->remoteFileView->expand(remoteFileModel.index(0, 0));
+
     QPushButton * logoutButton = new QPushButton("Logout");
     QObject::connect(logoutButton, SIGNAL(clicked(bool)), ae_globals::get_Driver(), SLOT(shutdown()));
     ui->header->appendWidget(logoutButton);
@@ -108,6 +210,10 @@ void ExplorerWindow::addAppToList(QString appName)
         agaveParamLists.insert("cwe-parallel", {"stage", "file_input"});
         taskListModel.appendRow(new QStandardItem("cwe-parallel"));
     }
+    else if (appName == ChunkedUploader::assemblyApp)
+    {
+        ae_globals::get_chunked_uploader()->setAssemblyAvailable(true);
+    }
 }
 
 void ExplorerWindow::agaveAppSelected(QModelIndex clickedItem)
@@ -154,24 +260,8 @@ void ExplorerWindow::agaveCommandInvoked()
     {
         return;
     }
-    QString workingDir = ui->remoteFileView->getSelectedFile().getFullPath();
-
-    QStringList inputList = agaveParamLists.value(selectedAgaveApp);
-    QMultiMap<QString, QString> allInputs;
-
-    qCDebug(agaveAppLayer, "Input List:");
-    for (auto itr = inputList.cbegin(); itr != inputList.cend(); itr++)
-    {
-        QString paramName = "debugAgave_";
-        paramName = paramName.append(*itr);
-
-        QLineEdit * theInput = ui->AgaveParamWidget->findChild<QLineEdit *>(paramName);
-        if (theInput != nullptr)
-        {
-            allInputs.insert((*itr),theInput->text());
-            qCDebug(agaveAppLayer, "%s : %s", qPrintable(*itr), qPrintable(theInput->text()));
-        }
-    }
+    QString workingDir = selectedPath;
+    QMultiMap<QString, QString> allInputs = appInputsFromPanel();
 
     RemoteDataReply * theTask = ae_globals::get_connection()->runRemoteJob(selectedAgaveApp,allInputs,workingDir);
     if (theTask == nullptr)
@@ -184,53 +274,147 @@ void ExplorerWindow::agaveCommandInvoked()
                      this, SLOT(finishedAppInvoke(RequestState,QJsonDocument)));
 }
 
-void ExplorerWindow::finishedAppInvoke(RequestState, QJsonDocument)
+void ExplorerWindow::finishedAppInvoke(RequestState finalState, QJsonDocument rawReply)
 {
     waitingOnCommand = false;
-    ae_globals::get_job_handle()->demandJobDataRefresh();
+    if (finalState != RequestState::GOOD) return;
+
+    //Only the new job is polled; the rest of the job list is left as it is
+    ae_globals::get_job_poller()->jobSubmitted(rawReply);
 }
 
-void ExplorerWindow::customFileMenu(QPoint pos)
+void ExplorerWindow::agaveSweepInvoked()
 {
-    QMenu fileMenu;
-    if (ae_globals::get_Driver()->getFileHandler()->operationIsPending())
+    QStringList inputList = agaveParamLists.value(selectedAgaveApp);
+    if (selectedAgaveApp.isEmpty() || inputList.isEmpty())
     {
-        fileMenu.addAction("File Operation In Progress . . .");
-        fileMenu.exec(QCursor::pos());
+        ae_globals::displayPopup("Please select an app with parameters to sweep.", "Parameter Sweep");
+        return;
+    }
+
+    SingleLineDialog sweepFilePopup("Please type the local path of a sweep file (.csv, or parameter ranges):", "");
+    if (sweepFilePopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    //Parameters the file does not vary take their values from the panel
+    ParameterSweep * newSweep = new ParameterSweep(selectedAgaveApp, selectedPath, this);
+    QString errorText;
+    if (!newSweep->loadSweepFile(sweepFilePopup.getInputText(), inputList, appInputsFromPanel(), errorText))
+    {
+        delete newSweep;
+        ae_globals::displayPopup(errorText, "Parameter Sweep");
+        return;
+    }
+
+    QMessageBox sweepQuery;
+    sweepQuery.setWindowTitle("Parameter Sweep");
+    sweepQuery.setText(QString("Submit %1 %2 jobs in %3?").arg(newSweep->jobCount()).arg(selectedAgaveApp, selectedPath));
+    sweepQuery.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    sweepQuery.setDefaultButton(QMessageBox::No);
+    if (sweepQuery.exec() != QMessageBox::Yes)
+    {
+        delete newSweep;
         return;
     }
 
+    sweepList.append(newSweep);
+    ui->jobSweepFilter->addItem(QString("Sweep %1: %2 x %3").arg(sweepList.size()).arg(newSweep->jobCount()).arg(selectedAgaveApp),
+                                sweepList.size() - 1);
+    QObject::connect(newSweep, SIGNAL(sweepProgress(int,int,int)), this, SLOT(sweepProgress(int,int,int)));
+    QObject::connect(newSweep, SIGNAL(sweepFinished(RequestState,QString)), this, SLOT(sweepFinished(RequestState,QString)));
+    ui->sweepStatusLabel->setText(QString("Submitting %1 %2 jobs . . .").arg(newSweep->jobCount()).arg(selectedAgaveApp));
+    newSweep->start();
+}
+
+void ExplorerWindow::sweepProgress(int submitted, int failed, int total)
+{
+    ParameterSweep * theSweep = qobject_cast<ParameterSweep *>(sender());
+    if (theSweep == nullptr) return;
+
+    ui->sweepStatusLabel->setText(QString("Sweep %1: %2 of %3 jobs submitted, %4 failed")
+                                  .arg(sweepList.indexOf(theSweep) + 1).arg(submitted).arg(total).arg(failed));
+
+    //The sweep's new jobs are added to the table if it is showing that sweep
+    if (ui->jobSweepFilter->currentData().toInt() == sweepList.indexOf(theSweep))
+    {
+        jobFilterChanged();
+    }
+}
+
+void ExplorerWindow::sweepFinished(RequestState finalState, QString message)
+{
+    ui->sweepStatusLabel->setText(message);
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(message, "Parameter Sweep");
+    }
+}
+
+void ExplorerWindow::customFileMenu(QPoint pos)
+{
+    QMenu fileMenu;
     QModelIndex targetIndex = ui->remoteFileView->indexAt(pos);
-    ui->remoteFileView->fileEntryTouched(targetIndex);
+    targetEntry = remoteFileModel.entryForIndex(targetIndex);
+
+    //A click inside a multiple selection acts on the whole selection
+    QItemSelectionModel * theSelection = ui->remoteFileView->selectionModel();
+    if (targetIndex.isValid() && theSelection->isRowSelected(targetIndex.row(), targetIndex.parent()) &&
+            (theSelection->selectedRows().size() > 1))
+    {
+        batchTargets.clear();
+        for (QModelIndex aRow : theSelection->selectedRows())
+        {
+            RemoteEntry anEntry = remoteFileModel.entryForIndex(aRow);
+            if (anEntry.isNil() || anEntry.isRoot || (anEntry.type == FileType::INVALID)) continue;
+            batchTargets.append(anEntry.fullPath);
+        }
+        if (batchTargets.isEmpty()) return;
 
-    targetNode = ui->remoteFileView->getSelectedFile();
+        fileMenu.addAction(QString("Copy %1 Items To . . .").arg(batchTargets.size()),this, SLOT(batchCopyMenuItem()));
+        fileMenu.addAction(QString("Move %1 Items To . . .").arg(batchTargets.size()),this, SLOT(batchMoveMenuItem()));
+        fileMenu.addAction(QString("Rename %1 Items . . .").arg(batchTargets.size()),this, SLOT(batchRenameMenuItem()));
+
+        fileMenu.addSeparator();
+        fileMenu.addAction(QString("Delete %1 Items").arg(batchTargets.size()),this, SLOT(batchDeleteMenuItem()));
+        fileMenu.exec(QCursor::pos());
+        return;
+    }
+    if (targetIndex.isValid()) ui->remoteFileView->setCurrentIndex(targetIndex);
 
     //If we did not click anything, we should return
-    if (targetNode.isNil()) return;
-    if (targetNode.getFileType() == FileType::INVALID) return;
+    if (targetEntry.isNil()) return;
+    if (targetEntry.type == FileType::INVALID) return;
 
     //We don't let the user fiddle with the username folder
-    if (!(targetNode.isRootNode()))
+    if (!(targetEntry.isRoot))
     {
-        fileMenu.addAction("Copy To . . .",this, SLOT(copyMenuItem()));
-        fileMenu.addAction("Move To . . .",this, SLOT(moveMenuItem()));
-        fileMenu.addAction("Rename",this, SLOT(renameMenuItem()));
+        addPathAction(fileMenu, "Copy To . . .", SLOT(copyMenuItem()), {}, {targetEntry.fullPath});
+        addPathAction(fileMenu, "Move To . . .", SLOT(moveMenuItem()), {targetEntry.fullPath});
+        addPathAction(fileMenu, "Rename", SLOT(renameMenuItem()), {targetEntry.fullPath});
 
         fileMenu.addSeparator();
-        fileMenu.addAction("Delete",this, SLOT(deleteMenuItem()));
+        addPathAction(fileMenu, "Delete", SLOT(deleteMenuItem()), {targetEntry.fullPath});
         fileMenu.addSeparator();
     }
-    if (targetNode.getFileType() == FileType::DIR)
+    if (targetEntry.type == FileType::DIR)
     {
         fileMenu.addAction("Upload File Here",this, SLOT(uploadMenuItem()));
         fileMenu.addAction("Upload Folder Here",this, SLOT(uploadFolderMenuItem()));
-        fileMenu.addAction("Download Folder",this, SLOT(downloadFolderMenuItem()));
+        addPathAction(fileMenu, "Download Folder", SLOT(downloadFolderMenuItem()), {}, {targetEntry.fullPath});
+        addPathAction(fileMenu, "Sync Folder . . .", SLOT(syncFolderMenuItem()), {targetEntry.fullPath});
         fileMenu.addAction("Create New Folder",this, SLOT(createFolderMenuItem()));
     }
-    if (targetNode.getFileType() == FileType::FILE)
+    if (targetEntry.type == FileType::FILE)
     {
-        fileMenu.addAction("Download File",this, SLOT(downloadMenuItem()));
-        if (targetNode.fileBufferLoaded())
+        addPathAction(fileMenu, "Download File", SLOT(downloadMenuItem()), {}, {targetEntry.fullPath});
+        FileRetriever * theRetriever = ae_globals::get_file_retriever();
+        if (theRetriever->isRetrieving(targetEntry.fullPath))
+        {
+            fileMenu.addAction("Retrieving File . . .")->setEnabled(false);
+        }
+        else if (theRetriever->isRetrieved(targetEntry.fullPath))
         {
             fileMenu.addAction("Read File",this, SLOT(readMenuItem()));
         }
@@ -238,9 +422,10 @@ void ExplorerWindow::customFileMenu(QPoint pos)
         {
             fileMenu.addAction("Retrive File",this, SLOT(retriveMenuItem()));
         }
+        fileMenu.addAction("Follow File . . .",this, SLOT(followMenuItem()));
     }
 
-    if ((targetNode.getFileType() == FileType::DIR) || (targetNode.getFileType() == FileType::FILE))
+    if ((targetEntry.type == FileType::DIR) || (targetEntry.type == FileType::FILE))
     {
         fileMenu.addSeparator();
         fileMenu.addAction("Refresh Data",this, SLOT(refreshMenuItem()));
@@ -250,6 +435,156 @@ void ExplorerWindow::customFileMenu(QPoint pos)
     fileMenu.exec(QCursor::pos());
 }
 
+void ExplorerWindow::fileSelectionChanged(const QModelIndex &current, const QModelIndex &)
+{
+    RemoteEntry selectedEntry = remoteFileModel.entryForIndex(current);
+    selectedPath = selectedEntry.fullPath;
+
+    //Prefetch follows the user: the folder looked at, or the folder holding the file
+    if (selectedEntry.type == FileType::DIR)
+    {
+        myPrefetcher->setFocusFolder(selectedEntry.fullPath);
+    }
+    else if (!selectedEntry.isNil())
+    {
+        myPrefetcher->setFocusFolder(QFileInfo(selectedEntry.fullPath).path());
+    }
+
+    if (selectedEntry.isNil())
+    {
+        ui->selectedFileLabel->setText("None");
+        ui->selectedFileInfo->setText("No File Selected.");
+        return;
+    }
+    ui->selectedFileLabel->setText(selectedEntry.fullPath);
+
+    QString infoText = QString("Name: %1\nPath: %2\n").arg(selectedEntry.name, selectedEntry.fullPath);
+    if (selectedEntry.type == FileType::DIR)
+    {
+        infoText.append("Type: Folder\n");
+    }
+    else
+    {
+        infoText.append(QString("Type: File\nSize: %1 bytes\n").arg(selectedEntry.size));
+    }
+    if (selectedEntry.lastModified > 0)
+    {
+        infoText.append(QString("Modified: %1\n").arg(QDateTime::fromMSecsSinceEpoch(selectedEntry.lastModified).toString()));
+    }
+    ui->selectedFileInfo->setText(infoText);
+}
+
+void ExplorerWindow::fileFolderExpanded(const QModelIndex &folderIndex)
+{
+    RemoteEntry expandedEntry = remoteFileModel.entryForIndex(folderIndex);
+    if (expandedEntry.type != FileType::DIR) return;
+    myPrefetcher->setFocusFolder(expandedEntry.fullPath);
+}
+
+void ExplorerWindow::fileSearchChanged(QString searchText)
+{
+    ui->fileSearchResults->clear();
+    if (searchText.trimmed().isEmpty())
+    {
+        ui->fileSearchResults->hide();
+        ui->searchStatusLabel->clear();
+        return;
+    }
+
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    QStringList foundPaths = ae_globals::get_path_index()->search(searchText);
+    qint64 searchTime = searchTimer.elapsed();
+
+    ui->fileSearchResults->addItems(foundPaths);
+    ui->fileSearchResults->show();
+    ui->searchStatusLabel->setText(QString("%1 found among %2 known files (%3 ms)")
+                                   .arg(foundPaths.size()).arg(ae_globals::get_path_index()->pathCount()).arg(searchTime));
+}
+
+void ExplorerWindow::fileSearchResultChosen(QListWidgetItem * chosenItem)
+{
+    QString chosenPath = chosenItem->text();
+
+    //Folders on the way are opened in turn; known paths are cached, so each opens at once
+    QStringList pathParts = chosenPath.split('/', QString::SkipEmptyParts);
+    QString openPath;
+    for (int i = 0; i + 1 < pathParts.size(); i++)
+    {
+        openPath.append("/" + pathParts.at(i));
+        QModelIndex folderIndex = remoteFileModel.indexForPath(openPath);
+        if (!folderIndex.isValid()) continue;
+        ui->remoteFileView->expand(folderIndex);
+    }
+
+    QModelIndex chosenIndex = remoteFileModel.indexForPath(chosenPath);
+    if (!chosenIndex.isValid())
+    {
+        ui->searchStatusLabel->setText(QString("%1 is not loaded in the tree yet.").arg(chosenPath));
+        return;
+    }
+    ui->remoteFileView->setCurrentIndex(chosenIndex);
+    ui->remoteFileView->scrollTo(chosenIndex);
+}
+
+void ExplorerWindow::deepIndexToggled(bool indexOn)
+{
+    if (!indexOn)
+    {
+        if (deepIndexer != nullptr) deepIndexer->cancel();
+        return;
+    }
+    if (deepIndexer != nullptr) return;
+
+    deepIndexer = new DeepIndexCrawler("/" + ae_globals::get_connection()->getUserName(), this);
+    QObject::connect(deepIndexer, SIGNAL(crawlProgress(int,int)), this, SLOT(deepIndexProgress(int,int)));
+    QObject::connect(deepIndexer, SIGNAL(crawlFinished(bool)), this, SLOT(deepIndexFinished(bool)));
+    deepIndexer->start();
+}
+
+void ExplorerWindow::deepIndexProgress(int foldersListed, int foldersFound)
+{
+    ui->searchStatusLabel->setText(QString("Indexing: %1 of %2 folders, %3 files known.")
+                                   .arg(foldersListed).arg(foldersFound).arg(ae_globals::get_path_index()->pathCount()));
+}
+
+void ExplorerWindow::deepIndexFinished(bool completed)
+{
+    if (deepIndexer == nullptr) return;
+    deepIndexer->deleteLater();
+    deepIndexer = nullptr;
+
+    if (completed)
+    {
+        ui->searchStatusLabel->setText(QString("Index complete: %1 files known.").arg(ae_globals::get_path_index()->pathCount()));
+    }
+    else
+    {
+        ui->searchStatusLabel->setText("Indexing stopped.");
+    }
+    ui->deepIndexBox->blockSignals(true);
+    ui->deepIndexBox->setChecked(false);
+    ui->deepIndexBox->blockSignals(false);
+
+    if (!ui->fileSearchText->text().trimmed().isEmpty()) fileSearchChanged(ui->fileSearchText->text());
+}
+
+void ExplorerWindow::fileOpReply(RequestState finalState)
+{
+    if (!pendingFileOps.contains(sender())) return;
+    QStringList foldersToRefresh = endFileOp(sender());
+
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup("The file operation failed. The remote files may have changed; refreshing.", "File Operation Failed");
+    }
+    foldersToRefresh.removeDuplicates();
+    for (QString aFolder : foldersToRefresh)
+    {
+        remoteFileModel.refreshFolder(aFolder);
+    }
+}
+
 void ExplorerWindow::copyMenuItem()
 {
     SingleLineDialog newNamePopup("Please type a file name to copy to:", "newname");
@@ -258,7 +593,12 @@ void ExplorerWindow::copyMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendCopyReq(targetNode, newNamePopup.getInputText());
+    QString newPath = resolveRemoteName(newNamePopup.getInputText());
+    int opID = beginFileOp(QString("Copy %1").arg(targetEntry.fullPath), {newPath}, {targetEntry.fullPath});
+    if (opID < 0) return;
+
+    RemoteDataReply * theReply = ae_globals::get_connection()->copyFile(targetEntry.fullPath, newPath);
+    trackFileOp(theReply, SIGNAL(haveCopyReply(RequestState,FileMetaData)), opID, {QFileInfo(newPath).path()});
 }
 
 void ExplorerWindow::moveMenuItem()
@@ -270,7 +610,13 @@ void ExplorerWindow::moveMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendMoveReq(targetNode,newNamePopup.getInputText());
+    QString newPath = resolveRemoteName(newNamePopup.getInputText());
+    int opID = beginFileOp(QString("Move %1").arg(targetEntry.fullPath), {targetEntry.fullPath, newPath});
+    if (opID < 0) return;
+
+    RemoteDataReply * theReply = ae_globals::get_connection()->moveFile(targetEntry.fullPath, newPath);
+    trackFileOp(theReply, SIGNAL(haveMoveReply(RequestState,FileMetaData)), opID,
+                {QFileInfo(targetEntry.fullPath).path(), QFileInfo(newPath).path()});
 }
 
 void ExplorerWindow::renameMenuItem()
@@ -282,26 +628,193 @@ void ExplorerWindow::renameMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendRenameReq(targetNode, newNamePopup.getInputText());
+    int opID = beginFileOp(QString("Rename %1").arg(targetEntry.fullPath),
+                           {targetEntry.fullPath, resolveRemoteName(newNamePopup.getInputText())});
+    if (opID < 0) return;
+
+    RemoteDataReply * theReply = ae_globals::get_connection()->renameFile(targetEntry.fullPath, newNamePopup.getInputText());
+    trackFileOp(theReply, SIGNAL(haveRenameReply(RequestState,FileMetaData,QString)), opID, {QFileInfo(targetEntry.fullPath).path()});
 }
 
 void ExplorerWindow::deleteMenuItem()
 {
-    if (ae_globals::get_Driver()->getFileHandler()->deletePopup(targetNode))
+    QMessageBox deleteQuery;
+    deleteQuery.setWindowTitle("Delete");
+    deleteQuery.setText(QString("Are you sure you wish to delete:\n\n%1").arg(targetEntry.fullPath));
+    deleteQuery.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    deleteQuery.setDefaultButton(QMessageBox::No);
+    if (deleteQuery.exec() != QMessageBox::Yes) return;
+
+    int opID = beginFileOp(QString("Delete %1").arg(targetEntry.fullPath), {targetEntry.fullPath});
+    if (opID < 0) return;
+
+    RemoteDataReply * theReply = ae_globals::get_connection()->deleteFile(targetEntry.fullPath);
+    trackFileOp(theReply, SIGNAL(haveDeleteReply(RequestState)), opID, {QFileInfo(targetEntry.fullPath).path()});
+}
+
+void ExplorerWindow::batchCopyMenuItem()
+{
+    SingleLineDialog destPopup("Please type a folder to copy the items to:", QFileInfo(targetEntry.fullPath).path());
+    if (destPopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+    startBatchOp(BatchOpType::COPY, resolveRemoteName(destPopup.getInputText()));
+}
+
+void ExplorerWindow::batchMoveMenuItem()
+{
+    SingleLineDialog destPopup("Please type a folder to move the items to:", QFileInfo(targetEntry.fullPath).path());
+    if (destPopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+    startBatchOp(BatchOpType::MOVE, resolveRemoteName(destPopup.getInputText()));
+}
+
+void ExplorerWindow::batchRenameMenuItem()
+{
+    SingleLineDialog patternPopup("Please type a pattern for the new names.\nThe * is replaced by each old name:", "*_old");
+    if (patternPopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+    if (!patternPopup.getInputText().contains('*') || patternPopup.getInputText().contains('/'))
+    {
+        ae_globals::displayPopup("The pattern must contain a * for the old name, and no / characters.");
+        return;
+    }
+    startBatchOp(BatchOpType::RENAME, patternPopup.getInputText());
+}
+
+void ExplorerWindow::batchDeleteMenuItem()
+{
+    QMessageBox deleteQuery;
+    deleteQuery.setWindowTitle("Delete");
+    deleteQuery.setText(QString("Are you sure you wish to delete these %1 items?").arg(batchTargets.size()));
+    deleteQuery.setDetailedText(batchTargets.join("\n"));
+    deleteQuery.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    deleteQuery.setDefaultButton(QMessageBox::No);
+    if (deleteQuery.exec() != QMessageBox::Yes) return;
+
+    startBatchOp(BatchOpType::REMOVE, QString());
+}
+
+void ExplorerWindow::batchOpProgress(int itemsDone, int itemsTotal)
+{
+    BatchFileOperation * theBatch = qobject_cast<BatchFileOperation *>(sender());
+    if (theBatch == nullptr) return;
+
+    ui->transferStatusLabel->setText(QString("%1: %2 of %3 items done, %4 failed.")
+                                     .arg(BatchFileOperation::opName(theBatch->getOpType())).arg(itemsDone).arg(itemsTotal).arg(theBatch->failedCount()));
+}
+
+void ExplorerWindow::batchOpFinished(int succeeded, int failed)
+{
+    BatchFileOperation * theBatch = qobject_cast<BatchFileOperation *>(sender());
+    if (theBatch == nullptr) return;
+    theBatch->deleteLater();
+
+    QStringList foldersToRefresh = endFileOp(theBatch);
+    for (QString aFolder : foldersToRefresh)
     {
-        ae_globals::get_Driver()->getFileHandler()->sendDeleteReq(targetNode);
+        remoteFileModel.refreshFolder(aFolder);
     }
+
+    QString resultText = QString("%1 finished: %2 items done, %3 failed.")
+            .arg(BatchFileOperation::opName(theBatch->getOpType())).arg(succeeded).arg(failed);
+    ui->transferStatusLabel->setText(resultText);
+    if (failed == 0) return;
+
+    QMessageBox failQuery;
+    failQuery.setWindowTitle("Batch Operation");
+    failQuery.setText(resultText);
+    failQuery.setDetailedText(theBatch->failedItems().join("\n"));
+    failQuery.exec();
+}
+
+void ExplorerWindow::fileOpReady(int opID)
+{
+    BatchFileOperation * theBatch = waitingBatches.take(opID);
+    if (theBatch == nullptr) return;
+
+    ui->transferStatusLabel->setText(QString("Starting %1 of %2 items.")
+                                     .arg(BatchFileOperation::opName(theBatch->getOpType())).arg(theBatch->totalCount()));
+    theBatch->start();
 }
 
 void ExplorerWindow::uploadMenuItem()
 {
-    SingleLineDialog uploadNamePopup("Please input full path of file to upload:", "");
+    SingleLineDialog uploadNamePopup("Please input full path of file(s) to upload.\nSeparate files with ; and use * or ? as wildcards:", "");
 
     if (uploadNamePopup.exec() != QDialog::Accepted)
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->sendUploadReq(targetNode, uploadNamePopup.getInputText());
+
+    QStringList queuedFiles;
+    QStringList chunkedFiles;
+    QStringList remoteFiles;
+    for (QString aFile : TransferQueue::expandLocalPattern(uploadNamePopup.getInputText()))
+    {
+        if (ae_globals::get_chunked_uploader()->fileShouldBeChunked(QFileInfo(aFile).size()))
+        {
+            if (chunkedUploadOps.contains(aFile)) continue;
+            chunkedFiles.append(aFile);
+        }
+        else
+        {
+            queuedFiles.append(aFile);
+        }
+        remoteFiles.append(targetEntry.fullPath + "/" + QFileInfo(aFile).fileName());
+    }
+
+    QString blockingOp = fileOpScheduler.conflictWith(remoteFiles);
+    if (!blockingOp.isEmpty())
+    {
+        ae_globals::displayPopup(QString("Another operation is using these files:\n\n%1\n\nPlease wait for it to finish.").arg(blockingOp), "Files In Use");
+        return;
+    }
+
+    //Chunked uploads finish on their own, so each holds its own path
+    int numQueued = 0;
+    for (QString aFile : chunkedFiles)
+    {
+        if (!ae_globals::get_chunked_uploader()->startUpload(aFile, targetEntry.fullPath)) continue;
+        chunkedUploadTargets.insert(aFile, targetEntry.fullPath);
+        chunkedUploadOps.insert(aFile, fileOpScheduler.tryBegin(QString("Upload %1").arg(aFile),
+                                                                {targetEntry.fullPath + "/" + QFileInfo(aFile).fileName()}));
+        numQueued++;
+    }
+
+    QList<int> queuedIDs;
+    QStringList queuedRemoteFiles;
+    for (QString aFile : queuedFiles)
+    {
+        int transferID = ae_globals::get_transfer_queue()->enqueueUpload(aFile, targetEntry.fullPath);
+        if (transferID < 0) continue;
+        queuedIDs.append(transferID);
+        queuedRemoteFiles.append(targetEntry.fullPath + "/" + QFileInfo(aFile).fileName());
+        numQueued++;
+    }
+    if (!queuedIDs.isEmpty())
+    {
+        //The files hold their paths until the last of them is done, however busy the rest of the queue is
+        int opID = fileOpScheduler.tryBegin(QString("Upload to %1").arg(targetEntry.fullPath), queuedRemoteFiles);
+        uploadOpCounts.insert(opID, queuedIDs.size());
+        for (int transferID : queuedIDs)
+        {
+            uploadOps.insert(transferID, opID);
+        }
+    }
+
+    if (numQueued == 0)
+    {
+        ae_globals::displayPopup("No readable local files match the given path.");
+        return;
+    }
+    transferQueueProgress(ae_globals::get_transfer_queue()->finishedCount() + ae_globals::get_transfer_queue()->failedCount() + ae_globals::get_transfer_queue()->cancelledCount(),
+                          ae_globals::get_transfer_queue()->totalCount(), ae_globals::get_transfer_queue()->getThroughput());
 }
 
 void ExplorerWindow::uploadFolderMenuItem()
@@ -312,7 +825,22 @@ void ExplorerWindow::uploadFolderMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveUpload(targetNode, uploadNamePopup.getInputText());
+    if (!ae_globals::isValidLocalFolder(uploadNamePopup.getInputText()))
+    {
+        ae_globals::displayPopup("Please enter a valid local folder.");
+        return;
+    }
+
+    QString newFolder = targetEntry.fullPath + "/" + QFileInfo(uploadNamePopup.getInputText()).fileName();
+    int opID = beginFileOp(QString("Upload folder to %1").arg(newFolder), {newFolder});
+    if (opID < 0) return;
+
+    //Folders of many small files go up as one archive; others file by file
+    BundledUpload * theUploader = new BundledUpload(uploadNamePopup.getInputText(), targetEntry.fullPath, this);
+    pendingFileOps.insert(theUploader, {opID, {targetEntry.fullPath}});
+    QObject::connect(theUploader, SIGNAL(folderUploadProgress(int,int,int,int)), this, SLOT(folderUploadProgress(int,int,int,int)));
+    QObject::connect(theUploader, SIGNAL(folderUploadFinished(RequestState,QString)), this, SLOT(folderUploadFinished(RequestState,QString)));
+    theUploader->start();
 }
 
 void ExplorerWindow::downloadFolderMenuItem()
@@ -323,7 +851,95 @@ void ExplorerWindow::downloadFolderMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveDownload(targetNode, downloadNamePopup.getInputText());
+    if (!ae_globals::isValidLocalFolder(downloadNamePopup.getInputText()))
+    {
+        ae_globals::displayPopup("Please enter a valid local folder.");
+        return;
+    }
+
+    QString remoteFolder = targetEntry.fullPath;
+    int opID = beginFileOp(QString("Download %1").arg(remoteFolder), {}, {remoteFolder});
+    if (opID < 0) return;
+
+    if (ae_globals::get_lane_pool()->getRestSession(LaneType::BULK) != nullptr)
+    {
+        QMessageBox modeQuery;
+        modeQuery.setWindowTitle("Download Folder");
+        modeQuery.setText("Compress the folder on the server and download it as one archive?\n\nThis is much faster for folders with many files, but waits for a compress job first.");
+        modeQuery.setStandardButtons(QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        modeQuery.setDefaultButton(QMessageBox::No);
+
+        int userChoice = modeQuery.exec();
+        if (userChoice == QMessageBox::Cancel)
+        {
+            fileOpScheduler.finish(opID);
+            return;
+        }
+        if (userChoice == QMessageBox::Yes)
+        {
+            CompressedFolderDownload * theDownload = new CompressedFolderDownload(remoteFolder, downloadNamePopup.getInputText(), this);
+            pendingFileOps.insert(theDownload, {opID, {}});
+            QObject::connect(theDownload, SIGNAL(stageChanged(QString)), this, SLOT(compressedDownloadStage(QString)));
+            QObject::connect(theDownload, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(compressedDownloadProgress(qint64,qint64)));
+            QObject::connect(theDownload, SIGNAL(downloadFinished(RequestState,QString)), this, SLOT(compressedDownloadFinished(RequestState,QString)));
+            theDownload->start();
+            return;
+        }
+    }
+
+    QString localFolder = QDir(downloadNamePopup.getInputText()).filePath(QFileInfo(remoteFolder).fileName());
+
+    FolderCrawler * theCrawler = new FolderCrawler(remoteFolder, localFolder, this);
+    pendingFileOps.insert(theCrawler, {opID, {}});
+    QObject::connect(theCrawler, SIGNAL(crawlProgress(int,int,int,int)), this, SLOT(folderCrawlProgress(int,int,int,int)));
+    QObject::connect(theCrawler, SIGNAL(crawlFinished(RequestState,QString)), this, SLOT(folderCrawlFinished(RequestState,QString)));
+    theCrawler->start();
+}
+
+void ExplorerWindow::syncFolderMenuItem()
+{
+    SingleLineDialog localNamePopup("Please input full path of the local folder to sync with:", "");
+
+    if (localNamePopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+    if (!ae_globals::isValidLocalFolder(localNamePopup.getInputText()))
+    {
+        ae_globals::displayPopup("Please enter a valid local folder.");
+        return;
+    }
+
+    QMessageBox modeQuery;
+    modeQuery.setWindowTitle("Sync Folder");
+    modeQuery.setText(QString("Copy only the files which differ between:\n\n%1\n%2\n\nWhich way should files be copied?")
+                      .arg(localNamePopup.getInputText(), targetEntry.fullPath));
+    QPushButton * bothButton = modeQuery.addButton("Both Ways", QMessageBox::AcceptRole);
+    QPushButton * uploadButton = modeQuery.addButton("Upload Only", QMessageBox::AcceptRole);
+    QPushButton * downloadButton = modeQuery.addButton("Download Only", QMessageBox::AcceptRole);
+    modeQuery.addButton(QMessageBox::Cancel);
+    modeQuery.setDefaultButton(bothButton);
+    QCheckBox * hashBox = new QCheckBox("Check contents of files whose time changed (slower)");
+    modeQuery.setCheckBox(hashBox);
+    modeQuery.exec();
+
+    SyncDirection theDirection;
+    if (modeQuery.clickedButton() == bothButton) theDirection = SyncDirection::BOTH_WAYS;
+    else if (modeQuery.clickedButton() == uploadButton) theDirection = SyncDirection::UPLOAD_ONLY;
+    else if (modeQuery.clickedButton() == downloadButton) theDirection = SyncDirection::DOWNLOAD_ONLY;
+    else return;
+
+    QString remoteFolder = targetEntry.fullPath;
+    int opID = beginFileOp(QString("Sync %1").arg(remoteFolder), {remoteFolder});
+    if (opID < 0) return;
+
+    FolderSync * theSync = new FolderSync(localNamePopup.getInputText(), remoteFolder, theDirection, this);
+    theSync->setHashCheck(hashBox->isChecked());
+    pendingFileOps.insert(theSync, {opID, {remoteFolder}});
+    QObject::connect(theSync, SIGNAL(syncStage(QString)), this, SLOT(folderSyncStage(QString)));
+    QObject::connect(theSync, SIGNAL(syncProgress(int,int)), this, SLOT(folderSyncProgress(int,int)));
+    QObject::connect(theSync, SIGNAL(syncFinished(RequestState,QString)), this, SLOT(folderSyncFinished(RequestState,QString)));
+    theSync->start();
 }
 
 void ExplorerWindow::createFolderMenuItem()
@@ -334,7 +950,12 @@ void ExplorerWindow::createFolderMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->sendCreateFolderReq(targetNode, newFolderNamePopup.getInputText());
+    int opID = beginFileOp(QString("Create %1").arg(newFolderNamePopup.getInputText()),
+                           {targetEntry.fullPath + "/" + newFolderNamePopup.getInputText()});
+    if (opID < 0) return;
+
+    RemoteDataReply * theReply = ae_globals::get_connection()->createFolder(targetEntry.fullPath, newFolderNamePopup.getInputText());
+    trackFileOp(theReply, SIGNAL(haveMkdirReply(RequestState,FileMetaData)), opID, {targetEntry.fullPath});
 }
 
 void ExplorerWindow::downloadMenuItem()
@@ -345,71 +966,676 @@ void ExplorerWindow::downloadMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->sendDownloadReq(targetNode, downloadNamePopup.getInputText());
+    int opID = beginFileOp(QString("Download %1").arg(targetEntry.fullPath), {}, {targetEntry.fullPath});
+    if (opID < 0) return;
+
+    //A file the user asked for goes ahead of folder transfers
+    int transferID = ae_globals::get_transfer_queue()->enqueueDownload(targetEntry.fullPath, downloadNamePopup.getInputText(),
+                                                                       targetEntry.size, TransferPriority::HIGH);
+    downloadOps.insert(transferID, opID);
 }
 
 void ExplorerWindow::readMenuItem()
 {
-    QMessageBox dataPopup;
-    dataPopup.setText(QString(*(targetNode.getFileBuffer())));
-    dataPopup.exec();
+    PagedFileReader * theReader = ae_globals::get_file_retriever()->openReader(targetEntry.fullPath);
+    if (theReader == nullptr)
+    {
+        ae_globals::displayPopup("The retrieved file could not be opened.");
+        return;
+    }
+
+    FileViewerDialog fileViewer(QFileInfo(targetEntry.fullPath).fileName(), theReader);
+    fileViewer.exec();
 }
 
 void ExplorerWindow::retriveMenuItem()
 {
-    ae_globals::get_Driver()->getFileHandler()->sendDownloadBuffReq(targetNode);
+    ae_globals::get_file_retriever()->retrieve(targetEntry.fullPath);
 }
 
-void ExplorerWindow::refreshMenuItem()
+void ExplorerWindow::followMenuItem()
 {
-    targetNode.enactFolderRefresh();
+    if (ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE) == nullptr)
+    {
+        ae_globals::displayPopup("Following a file needs the direct transfer connection, which is not available.");
+        return;
+    }
+
+    //Only bytes added since the last check are fetched, so a growing log is not read again from the start
+    RemoteFileTail theTail(targetEntry.fullPath);
+    FileViewerDialog fileViewer(QFileInfo(targetEntry.fullPath).fileName(), &theTail);
+    theTail.start();
+    fileViewer.exec();
 }
 
-void ExplorerWindow::jobRightClickMenu(QPoint pos)
+void ExplorerWindow::refreshMenuItem()
 {
-    if (ae_globals::get_job_handle() == nullptr)
+    if (targetEntry.type == FileType::FILE)
     {
+        ae_globals::get_file_retriever()->forget(targetEntry.fullPath);
+        remoteFileModel.refreshParentOf(targetEntry.fullPath);
         return;
     }
+    remoteFileModel.refreshFolder(targetEntry.fullPath);
+}
+
+void ExplorerWindow::jobRightClickMenu(QPoint pos)
+{
     QMenu jobMenu;
 
-    if (ae_globals::get_job_handle()->currentlyPerformingJobOperation())
+    //Polling only updates rows in place, so the menu is never locked while it runs
+    jobMenu.addAction("Refresh Job Info", this, SLOT(demandJobRefresh()));
+    if (ae_globals::get_job_poller()->hasOlderJobs())
     {
-        jobMenu.addAction("Currently Performing Job Operation . . .");
-        jobMenu.exec(QCursor::pos());
-        return;
+        jobMenu.addAction("Load Older Jobs", this, SLOT(loadOlderJobs()));
     }
-
-    if (ae_globals::get_job_handle()->currentlyRefreshingJobs())
+    if (ui->jobSweepFilter->currentIndex() > 0)
     {
-        jobMenu.addAction("Currently Refreshing Job Info . . .");
-        jobMenu.exec(QCursor::pos());
-        return;
+        jobMenu.addAction("Sweep Status . . .", this, SLOT(showSweepStatus()));
     }
 
-    jobMenu.addAction("Refresh Job Info", this, SLOT(demandJobRefresh()));
-
     QModelIndex targetIndex = ui->jobTable->indexAt(pos);
-    ui->jobTable->jobEntryTouched(targetIndex);
-
-    targetJob = ui->jobTable->getSelectedJob();
+    if (targetIndex.isValid()) ui->jobTable->selectRow(targetIndex.row());
+    targetJobID = jobModel->jobIDForIndex(targetIndex);
 
-    if (targetJob.isValidEntry())
+    if (!targetJobID.isEmpty())
     {
-        jobMenu.addAction("Delete This Job Entry", this, SLOT(deleteJobDataEntry()));
+        if (pendingJobDeletes.values().contains(targetJobID))
+        {
+            jobMenu.addAction("Deleting Job Entry . . .")->setEnabled(false);
+        }
+        else
+        {
+            jobMenu.addAction("Delete This Job Entry", this, SLOT(deleteJobDataEntry()));
+        }
     }
 
     jobMenu.exec(QCursor::pos());
 }
 
+void ExplorerWindow::transferRightClickMenu(QPoint pos)
+{
+    QModelIndex targetIndex = ui->transferView->indexAt(pos);
+    if (!targetIndex.isValid()) return;
+
+    //A click inside a multiple selection acts on the whole selection
+    QItemSelectionModel * theSelection = ui->transferView->selectionModel();
+    if (!theSelection->isRowSelected(targetIndex.row(), QModelIndex()))
+    {
+        ui->transferView->selectRow(targetIndex.row());
+    }
+    targetTransfers.clear();
+    for (QModelIndex aRow : theSelection->selectedRows())
+    {
+        targetTransfers.append(transferModel->transferIDForIndex(aRow));
+    }
+
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    bool anyPending = false;
+    bool anyRunning = false;
+    bool anyPaused = false;
+    for (int anID : targetTransfers)
+    {
+        TransferState theState = theQueue->getTransfer(anID).state;
+        if ((theState == TransferState::QUEUED) || (theState == TransferState::PAUSED)) anyPending = true;
+        if ((theState == TransferState::QUEUED) || (theState == TransferState::ACTIVE)) anyRunning = true;
+        if (theState == TransferState::PAUSED) anyPaused = true;
+        if ((theState == TransferState::ACTIVE) && theQueue->canInterrupt(anID)) anyPending = true;
+    }
+
+    QMenu transferMenu;
+    if (!anyPending && !anyRunning)
+    {
+        transferMenu.addAction("Transfer Finished")->setEnabled(false);
+        transferMenu.exec(QCursor::pos());
+        return;
+    }
+
+    transferMenu.addAction("High Priority", this, SLOT(transferPriorityHigh()));
+    transferMenu.addAction("Normal Priority", this, SLOT(transferPriorityNormal()));
+    transferMenu.addAction("Background Priority", this, SLOT(transferPriorityBackground()));
+    transferMenu.addSeparator();
+    if (anyRunning) transferMenu.addAction("Pause", this, SLOT(pauseTransferItems()));
+    if (anyPaused) transferMenu.addAction("Resume", this, SLOT(resumeTransferItems()));
+    transferMenu.addSeparator();
+    if (anyRunning || anyPaused) transferMenu.addAction("Limit Rate . . .", this, SLOT(limitTransferItems()));
+    transferMenu.addSeparator();
+    if (anyPending) transferMenu.addAction("Cancel", this, SLOT(cancelTransferItems()));
+
+    transferMenu.exec(QCursor::pos());
+}
+
+void ExplorerWindow::transferPriorityHigh()
+{
+    setTransferPriority(TransferPriority::HIGH);
+}
+
+void ExplorerWindow::transferPriorityNormal()
+{
+    setTransferPriority(TransferPriority::NORMAL);
+}
+
+void ExplorerWindow::transferPriorityBackground()
+{
+    setTransferPriority(TransferPriority::BACKGROUND);
+}
+
+void ExplorerWindow::pauseTransferItems()
+{
+    int notPaused = 0;
+    for (int anID : targetTransfers)
+    {
+        TransferState theState = ae_globals::get_transfer_queue()->getTransfer(anID).state;
+        if ((theState != TransferState::QUEUED) && (theState != TransferState::ACTIVE)) continue;
+        if (!ae_globals::get_transfer_queue()->pauseTransfer(anID)) notPaused++;
+    }
+    if (notPaused > 0)
+    {
+        ae_globals::displayPopup(QString("%1 transfer(s) were already sent through a connection which cannot be interrupted.").arg(notPaused));
+    }
+}
+
+void ExplorerWindow::resumeTransferItems()
+{
+    for (int anID : targetTransfers)
+    {
+        ae_globals::get_transfer_queue()->resumeTransfer(anID);
+    }
+}
+
+void ExplorerWindow::cancelTransferItems()
+{
+    for (int anID : targetTransfers)
+    {
+        ae_globals::get_transfer_queue()->cancelTransfer(anID);
+    }
+}
+
+void ExplorerWindow::limitTransferItems()
+{
+    SingleLineDialog limitPopup("Please type a rate limit for these transfers, in KB/s.\nUse 0 for the per transfer limit:", "0");
+    if (limitPopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    bool isNumber = false;
+    qint64 newLimit = limitPopup.getInputText().trimmed().toLongLong(&isNumber);
+    if (!isNumber || (newLimit < 0))
+    {
+        ae_globals::displayPopup("Please enter a whole number of KB/s.");
+        return;
+    }
+    for (int anID : targetTransfers)
+    {
+        ae_globals::get_transfer_queue()->setTransferRateLimit(anID, newLimit * 1024);
+    }
+}
+
+void ExplorerWindow::rateLimitsChanged()
+{
+    ae_globals::get_lane_pool()->setRateLimits(1024 * (qint64) ui->downloadLimitBox->value(),
+                                               1024 * (qint64) ui->uploadLimitBox->value());
+    ae_globals::get_transfer_queue()->setPerTransferLimits(1024 * (qint64) ui->transferDownloadLimitBox->value(),
+                                                           1024 * (qint64) ui->transferUploadLimitBox->value());
+}
+
 void ExplorerWindow::demandJobRefresh()
 {
-    if (ae_globals::get_job_handle()->currentlyRefreshingJobs()) return;
-    ae_globals::get_job_handle()->demandJobDataRefresh();
+    ae_globals::get_job_poller()->pollNow();
 }
 
 void ExplorerWindow::deleteJobDataEntry()
 {
-    if (ae_globals::get_job_handle()->currentlyPerformingJobOperation()) return;
-    ae_globals::get_job_handle()->deleteJobDataEntry(&targetJob);
+    if (targetJobID.isEmpty() || pendingJobDeletes.values().contains(targetJobID)) return;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        ae_globals::displayPopup("Unable to delete the job entry: the direct connection is not available.");
+        return;
+    }
+
+    RestTask * deleteTask = theSession->newJobDelete(targetJobID);
+    QObject::connect(deleteTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(jobDeleteReply(RequestState,QByteArray,qint64)));
+    pendingJobDeletes.insert(deleteTask, targetJobID);
+    theSession->submitTask(deleteTask);
+}
+
+void ExplorerWindow::jobDeleteReply(RequestState replyState, QByteArray, qint64)
+{
+    if (!pendingJobDeletes.contains(sender())) return;
+    QString jobID = pendingJobDeletes.take(sender());
+
+    if (replyState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(QString("Unable to delete job entry %1").arg(jobID));
+        return;
+    }
+    ae_globals::get_job_poller()->forgetJob(jobID);
+    ae_globals::get_job_store()->removeJob(jobID);
+}
+
+void ExplorerWindow::loadOlderJobs()
+{
+    ae_globals::get_job_poller()->fetchOlderJobs();
+}
+
+void ExplorerWindow::jobFilterChanged()
+{
+    JobFilter newFilter;
+    if (ui->jobAppFilter->currentIndex() > 0) newFilter.appID = ui->jobAppFilter->currentText();
+    if (ui->jobStatusFilter->currentIndex() > 0) newFilter.status = ui->jobStatusFilter->currentText();
+
+    qint64 dayCount = ui->jobDateFilter->currentData().toInt();
+    if (dayCount > 0) newFilter.createdAfter = QDateTime::currentMSecsSinceEpoch() - dayCount * 86400000;
+
+    int sweepNum = ui->jobSweepFilter->currentData().toInt();
+    if ((sweepNum >= 0) && (sweepNum < sweepList.size()))
+    {
+        newFilter.limitToJobs = true;
+        for (QString aJob : sweepList.at(sweepNum)->getJobIDs())
+        {
+            newFilter.jobIDs.insert(aJob);
+        }
+    }
+    jobModel->setFilter(newFilter);
+}
+
+void ExplorerWindow::jobStoreChanged(QString jobID)
+{
+    JobRecord theJob = ae_globals::get_job_store()->getJob(jobID);
+    addFilterChoice(ui->jobAppFilter, theJob.appID);
+    addFilterChoice(ui->jobStatusFilter, theJob.status);
+}
+
+void ExplorerWindow::updateJobCountLabel()
+{
+    QString countText = QString("%1 of %2 jobs shown").arg(jobModel->rowCount()).arg(ae_globals::get_job_store()->jobCount());
+    if (ae_globals::get_job_poller()->hasOlderJobs())
+    {
+        countText.append(", older jobs on server");
+    }
+    ui->jobCountLabel->setText(countText);
+}
+
+void ExplorerWindow::transferLimitChanged(int newLimit)
+{
+    ae_globals::get_transfer_queue()->setMaxConcurrent(newLimit);
+}
+
+void ExplorerWindow::clearFinishedTransfers()
+{
+    ae_globals::get_transfer_queue()->clearFinished();
+}
+
+void ExplorerWindow::transferQueueProgress(int finished, int total, double bytesPerSec)
+{
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    QString statusText = QString("Transfers: %1 of %2 done, %3 active, %4 failed. %5")
+            .arg(finished).arg(total).arg(theQueue->activeCount()).arg(theQueue->failedCount()).arg(formatRate(bytesPerSec));
+    ui->transferStatusLabel->setText(statusText);
+}
+
+void ExplorerWindow::transferQueueDrained()
+{
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    ui->transferStatusLabel->setText(QString("Transfers complete: %1 done, %2 failed. %3")
+                                     .arg(theQueue->finishedCount()).arg(theQueue->failedCount()).arg(formatRate(theQueue->getThroughput())));
+}
+
+void ExplorerWindow::chunkedUploadProgress(QString localFile, int chunksConfirmed, int chunksTotal)
+{
+    if (chunksConfirmed == chunksTotal)
+    {
+        ui->transferStatusLabel->setText(QString("Uploading %1: joining %2 chunks on the server.")
+                                         .arg(QFileInfo(localFile).fileName()).arg(chunksTotal));
+        return;
+    }
+    ui->transferStatusLabel->setText(QString("Uploading %1: %2 of %3 chunks confirmed.")
+                                     .arg(QFileInfo(localFile).fileName()).arg(chunksConfirmed).arg(chunksTotal));
+}
+
+void ExplorerWindow::chunkedUploadFinished(QString localFile, RequestState finalState)
+{
+    QString theTarget = chunkedUploadTargets.take(localFile);
+    if (chunkedUploadOps.contains(localFile))
+    {
+        fileOpScheduler.finish(chunkedUploadOps.take(localFile));
+    }
+
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(QString("Upload of %1 did not complete. The chunks sent so far are kept, and the upload can be resumed at next login.").arg(localFile), "Upload Interrupted");
+        return;
+    }
+
+    ui->transferStatusLabel->setText(QString("Upload of %1 complete.").arg(QFileInfo(localFile).fileName()));
+    if (!theTarget.isEmpty())
+    {
+        remoteFileModel.refreshFolder(theTarget);
+    }
+}
+
+void ExplorerWindow::transferItemFinished(int transferID, RequestState finalState)
+{
+    if (uploadOps.contains(transferID))
+    {
+        int opID = uploadOps.take(transferID);
+        uploadOpCounts[opID]--;
+        if (uploadOpCounts.value(opID) > 0) return;
+
+        uploadOpCounts.remove(opID);
+        fileOpScheduler.finish(opID);
+        remoteFileModel.refreshFolder(ae_globals::get_transfer_queue()->getTransfer(transferID).remotePath);
+        return;
+    }
+
+    if (!downloadOps.contains(transferID)) return;
+    fileOpScheduler.finish(downloadOps.take(transferID));
+
+    TransferItem theItem = ae_globals::get_transfer_queue()->getTransfer(transferID);
+    if (finalState == RequestState::GOOD)
+    {
+        ui->transferStatusLabel->setText(QString("Downloaded %1").arg(theItem.remotePath));
+        return;
+    }
+    if (theItem.state == TransferState::CANCELLED) return;
+    ae_globals::displayPopup(QString("Unable to download %1").arg(theItem.remotePath), "Download Failed");
+}
+
+void ExplorerWindow::retrievalProgress(QString remotePath, qint64 bytesDone, qint64 bytesTotal)
+{
+    if (bytesTotal <= 0) return;
+    ui->transferStatusLabel->setText(QString("Retrieving %1: %2%")
+                                     .arg(QFileInfo(remotePath).fileName()).arg((100 * bytesDone) / bytesTotal));
+}
+
+void ExplorerWindow::retrievalFinished(QString remotePath, RequestState finalState)
+{
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(QString("Unable to retrieve %1").arg(remotePath), "Retrieve Failed");
+        return;
+    }
+    ui->transferStatusLabel->setText(QString("Retrieved %1, ready to read.").arg(QFileInfo(remotePath).fileName()));
+}
+
+void ExplorerWindow::folderCrawlProgress(int foldersListed, int foldersFound, int filesDone, int filesFound)
+{
+    ui->transferStatusLabel->setText(QString("Folder download: %1 of %2 folders listed, %3 of %4 files downloaded.")
+                                     .arg(foldersListed).arg(foldersFound).arg(filesDone).arg(filesFound));
+}
+
+void ExplorerWindow::folderCrawlFinished(RequestState finalState, QString message)
+{
+    FolderCrawler * theCrawler = qobject_cast<FolderCrawler *>(sender());
+    if (theCrawler == nullptr) return;
+    theCrawler->deleteLater();
+    endFileOp(theCrawler);
+
+    ui->transferStatusLabel->setText(message);
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(message, "Folder Download Failed");
+    }
+}
+
+void ExplorerWindow::folderUploadProgress(int foldersCreated, int foldersFound, int filesDone, int filesFound)
+{
+    ui->transferStatusLabel->setText(QString("Folder upload: %1 of %2 folders created, %3 of %4 files uploaded.")
+                                     .arg(foldersCreated).arg(foldersFound).arg(filesDone).arg(filesFound));
+}
+
+void ExplorerWindow::folderUploadFinished(RequestState finalState, QString message)
+{
+    BundledUpload * theUploader = qobject_cast<BundledUpload *>(sender());
+    if (theUploader == nullptr) return;
+    theUploader->deleteLater();
+
+    //A bundle's files only appear once its extract job is done, so the folder is refreshed here
+    QStringList foldersToRefresh = endFileOp(theUploader);
+    for (QString aFolder : foldersToRefresh)
+    {
+        remoteFileModel.refreshFolder(aFolder);
+    }
+
+    ui->transferStatusLabel->setText(message);
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(message, "Folder Upload Failed");
+    }
+}
+
+void ExplorerWindow::folderSyncStage(QString message)
+{
+    ui->transferStatusLabel->setText(message);
+}
+
+void ExplorerWindow::folderSyncProgress(int filesDone, int filesToMove)
+{
+    ui->transferStatusLabel->setText(QString("Sync: %1 of %2 changed files copied.").arg(filesDone).arg(filesToMove));
+}
+
+void ExplorerWindow::folderSyncFinished(RequestState finalState, QString message)
+{
+    FolderSync * theSync = qobject_cast<FolderSync *>(sender());
+    if (theSync == nullptr) return;
+    theSync->deleteLater();
+
+    QStringList foldersToRefresh = endFileOp(theSync);
+    for (QString aFolder : foldersToRefresh)
+    {
+        remoteFileModel.refreshFolder(aFolder);
+    }
+
+    ui->transferStatusLabel->setText(message);
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(message, "Folder Sync Failed");
+    }
+}
+
+void ExplorerWindow::compressedDownloadStage(QString message)
+{
+    ui->transferStatusLabel->setText(message);
+}
+
+void ExplorerWindow::compressedDownloadProgress(qint64 bytesDone, qint64 bytesTotal)
+{
+    CompressedFolderDownload * theDownload = qobject_cast<CompressedFolderDownload *>(sender());
+    if ((theDownload == nullptr) || (bytesTotal <= 0)) return;
+
+    ui->transferStatusLabel->setText(QString("Downloading %1: %2%")
+                                     .arg(QFileInfo(theDownload->getRemoteFolder()).fileName()).arg((100 * bytesDone) / bytesTotal));
+}
+
+void ExplorerWindow::compressedDownloadFinished(RequestState finalState, QString message)
+{
+    CompressedFolderDownload * theDownload = qobject_cast<CompressedFolderDownload *>(sender());
+    if (theDownload == nullptr) return;
+    theDownload->deleteLater();
+    endFileOp(theDownload);
+
+    ui->transferStatusLabel->setText(message);
+    if (finalState != RequestState::GOOD)
+    {
+        ae_globals::displayPopup(message, "Folder Download Failed");
+    }
+    ae_globals::get_job_poller()->checkForNewJobs();
+}
+
+void ExplorerWindow::offerUploadResume()
+{
+    QStringList pendingList = ae_globals::get_chunked_uploader()->pendingUploads();
+    if (pendingList.isEmpty()) return;
+
+    QMessageBox resumeQuery;
+    resumeQuery.setWindowTitle("Resume Uploads");
+    resumeQuery.setText(QString("%1 upload(s) were interrupted in a previous session:\n\n%2\n\nResume them now?")
+                        .arg(pendingList.size()).arg(pendingList.join("\n")));
+    resumeQuery.setStandardButtons(QMessageBox::Yes | QMessageBox::No | QMessageBox::Discard);
+    resumeQuery.setDefaultButton(QMessageBox::Yes);
+
+    int userChoice = resumeQuery.exec();
+    for (QString aFile : pendingList)
+    {
+        if (userChoice == QMessageBox::Yes)
+        {
+            //A resumed upload holds its path and refreshes its folder, as one started from the menu does
+            QString remoteFolder = ae_globals::get_chunked_uploader()->pendingRemoteFolder(aFile);
+            if (remoteFolder.isEmpty() || chunkedUploadOps.contains(aFile)) continue;
+            int opID = fileOpScheduler.tryBegin(QString("Upload %1").arg(aFile), {remoteFolder + "/" + QFileInfo(aFile).fileName()});
+            if (opID < 0)
+            {
+                ae_globals::displayPopup(QString("Another operation is using the target of %1. The upload is kept, and can be resumed at next login.").arg(aFile), "Files In Use");
+                continue;
+            }
+
+            chunkedUploadTargets.insert(aFile, remoteFolder);
+            chunkedUploadOps.insert(aFile, opID);
+            if (!ae_globals::get_chunked_uploader()->resumeUpload(aFile))
+            {
+                chunkedUploadTargets.remove(aFile);
+                fileOpScheduler.finish(chunkedUploadOps.take(aFile));
+            }
+        }
+        else if (userChoice == QMessageBox::Discard)
+        {
+            ae_globals::get_chunked_uploader()->discardUpload(aFile);
+        }
+    }
+}
+
+QString ExplorerWindow::resolveRemoteName(QString newName)
+{
+    //A bare name is taken to be in the same folder as the target
+    if (newName.startsWith('/')) return newName;
+    return QFileInfo(targetEntry.fullPath).path() + "/" + newName;
+}
+
+void ExplorerWindow::addPathAction(QMenu &theMenu, QString actionText, const char * actionSlot, QStringList writePaths, QStringList readPaths)
+{
+    //Only actions which would collide with an operation in flight are held back
+    if (!fileOpScheduler.conflictWith(writePaths, readPaths).isEmpty())
+    {
+        theMenu.addAction(actionText + " (In Use)")->setEnabled(false);
+        return;
+    }
+    theMenu.addAction(actionText, this, actionSlot);
+}
+
+int ExplorerWindow::beginFileOp(QString description, QStringList writePaths, QStringList readPaths)
+{
+    int opID = fileOpScheduler.tryBegin(description, writePaths, readPaths);
+    if (opID < 0)
+    {
+        ae_globals::displayPopup(QString("Another operation is using these files:\n\n%1\n\nPlease wait for it to finish.")
+                                 .arg(fileOpScheduler.conflictWith(writePaths, readPaths)), "Files In Use");
+    }
+    return opID;
+}
+
+void ExplorerWindow::trackFileOp(RemoteDataReply * theReply, const char * replySignal, int opID, QStringList foldersToRefresh)
+{
+    if (theReply == nullptr)
+    {
+        fileOpScheduler.finish(opID);
+        ae_globals::displayPopup("Unable to contact the remote server for this operation.");
+        return;
+    }
+    pendingFileOps.insert(theReply, {opID, foldersToRefresh});
+    QObject::connect(theReply, replySignal, this, SLOT(fileOpReply(RequestState)));
+}
+
+QStringList ExplorerWindow::endFileOp(QObject * theOp)
+{
+    PendingFileOp theEntry = pendingFileOps.take(theOp);
+    fileOpScheduler.finish(theEntry.opID);
+    return theEntry.foldersToRefresh;
+}
+
+void ExplorerWindow::setTransferPriority(TransferPriority newPriority)
+{
+    for (int anID : targetTransfers)
+    {
+        ae_globals::get_transfer_queue()->setPriority(anID, newPriority);
+    }
+}
+
+void ExplorerWindow::startBatchOp(BatchOpType opType, QString targetText)
+{
+    BatchFileOperation * theBatch = new BatchFileOperation(opType, batchTargets, targetText, this);
+    QObject::connect(theBatch, SIGNAL(batchProgress(int,int)), this, SLOT(batchOpProgress(int,int)));
+    QObject::connect(theBatch, SIGNAL(batchFinished(int,int)), this, SLOT(batchOpFinished(int,int)));
+
+    //A batch which overlaps other work waits its turn rather than being refused
+    int opID = fileOpScheduler.enqueue(QString("%1 of %2 items").arg(BatchFileOperation::opName(opType)).arg(batchTargets.size()),
+                                       theBatch->writePaths(), theBatch->readPaths());
+    pendingFileOps.insert(theBatch, {opID, theBatch->affectedFolders()});
+    if (!fileOpScheduler.isStarted(opID))
+    {
+        waitingBatches.insert(opID, theBatch);
+        ui->transferStatusLabel->setText(QString("%1 of %2 items is waiting for other operations on those files.")
+                                         .arg(BatchFileOperation::opName(opType)).arg(batchTargets.size()));
+        return;
+    }
+    theBatch->start();
+}
+
+void ExplorerWindow::showSweepStatus()
+{
+    int sweepNum = ui->jobSweepFilter->currentData().toInt();
+    if ((sweepNum < 0) || (sweepNum >= sweepList.size())) return;
+    ParameterSweep * theSweep = sweepList.at(sweepNum);
+
+    QString statusText = QString("Sweep %1: %2 jobs of %3 in %4\n")
+            .arg(sweepNum + 1).arg(theSweep->jobCount()).arg(theSweep->getAppName(), theSweep->getWorkingDir());
+    QMap<QString, int> summary = theSweep->statusSummary();
+    for (auto itr = summary.cbegin(); itr != summary.cend(); itr++)
+    {
+        statusText.append(QString("\n%1: %2").arg(itr.key()).arg(itr.value()));
+    }
+    ae_globals::displayPopup(statusText, "Sweep Status");
+}
+
+QMultiMap<QString, QString> ExplorerWindow::appInputsFromPanel()
+{
+    QStringList inputList = agaveParamLists.value(selectedAgaveApp);
+    QMultiMap<QString, QString> allInputs;
+
+    qCDebug(agaveAppLayer, "Input List:");
+    for (auto itr = inputList.cbegin(); itr != inputList.cend(); itr++)
+    {
+        QString paramName = "debugAgave_";
+        paramName = paramName.append(*itr);
+
+        QLineEdit * theInput = ui->AgaveParamWidget->findChild<QLineEdit *>(paramName);
+        if (theInput != nullptr)
+        {
+            allInputs.insert((*itr),theInput->text());
+            qCDebug(agaveAppLayer, "%s : %s", qPrintable(*itr), qPrintable(theInput->text()));
+        }
+    }
+    return allInputs;
+}
+
+void ExplorerWindow::addFilterChoice(QComboBox * theBox, QString newChoice)
+{
+    if (newChoice.isEmpty() || (theBox->findText(newChoice) >= 0)) return;
+
+    //The first item is always the choice which matches everything
+    int newPlace = 1;
+    while ((newPlace < theBox->count()) && (theBox->itemText(newPlace) < newChoice)) newPlace++;
+    theBox->insertItem(newPlace, newChoice);
+}
+
+QString ExplorerWindow::formatRate(double bytesPerSec)
+{
+    if (bytesPerSec >= 1048576.0)
+    {
+        return QString("%1 MB/s").arg(bytesPerSec / 1048576.0, 0, 'f', 2);
+    }
+    return QString("%1 KB/s").arg(bytesPerSec / 1024.0, 0, 'f', 1);
 }
@@ -40,19 +40,26 @@
 #include <QStandardItemModel>
 #include <QLineEdit>
 #include <QMenu>
+#include <QListWidgetItem>
 #include <QJsonDocument>
+#include <QComboBox>
 
-#include "remoteFiles/filenoderef.h"
-#include "remotejobdata.h"
+#include "fileCache/remotefoldermodel.h"
+#include "fileOps/batchfileoperation.h"
+#include "fileOps/fileopscheduler.h"
 
-class RemoteFileTree;
 class FileMetaData;
-class FileTreeNode;
-class FileOperator;
+class RemoteDataReply;
+class ListingPrefetcher;
+class DeepIndexCrawler;
+class TransferListModel;
+class JobListModel;
+class ParameterSweep;
 
 class ExplorerDriver;
 class RemoteDataInterface;
 enum class RequestState;
+enum class TransferPriority;
 
 namespace Ui {
 class ExplorerWindow;
@@ -69,40 +76,135 @@ public:
     void startAndShow();
 
     void addAppToList(QString appName);
+    void offerUploadResume();
 
 private slots:
     void agaveAppSelected(QModelIndex clickedItem);
 
     void agaveCommandInvoked();
     void finishedAppInvoke(RequestState finalState, QJsonDocument rawReply);
+    void agaveSweepInvoked();
+    void sweepProgress(int submitted, int failed, int total);
+    void sweepFinished(RequestState finalState, QString message);
 
     void customFileMenu(QPoint pos);
+    void fileSelectionChanged(const QModelIndex &current, const QModelIndex &);
+    void fileFolderExpanded(const QModelIndex &folderIndex);
+    void fileSearchChanged(QString searchText);
+    void fileSearchResultChosen(QListWidgetItem * chosenItem);
+    void deepIndexToggled(bool indexOn);
+    void deepIndexProgress(int foldersListed, int foldersFound);
+    void deepIndexFinished(bool completed);
+    void fileOpReply(RequestState finalState);
 
     void copyMenuItem();
     void moveMenuItem();
     void renameMenuItem();
     void deleteMenuItem();
 
+    void batchCopyMenuItem();
+    void batchMoveMenuItem();
+    void batchRenameMenuItem();
+    void batchDeleteMenuItem();
+    void batchOpProgress(int itemsDone, int itemsTotal);
+    void batchOpFinished(int succeeded, int failed);
+    void fileOpReady(int opID);
+
     void uploadMenuItem();
     void uploadFolderMenuItem();
     void downloadFolderMenuItem();
+    void syncFolderMenuItem();
 
     void createFolderMenuItem();
     void downloadMenuItem();
     void readMenuItem();
     void retriveMenuItem();
+    void followMenuItem();
     void refreshMenuItem();
 
     void jobRightClickMenu(QPoint);
+    void transferRightClickMenu(QPoint pos);
+    void transferPriorityHigh();
+    void transferPriorityNormal();
+    void transferPriorityBackground();
+    void pauseTransferItems();
+    void resumeTransferItems();
+    void cancelTransferItems();
+    void limitTransferItems();
+    void rateLimitsChanged();
 
     void demandJobRefresh();
     void deleteJobDataEntry();
+    void jobDeleteReply(RequestState replyState, QByteArray, qint64);
+    void loadOlderJobs();
+    void jobFilterChanged();
+    void jobStoreChanged(QString jobID);
+    void updateJobCountLabel();
+    void showSweepStatus();
+
+    void transferLimitChanged(int newLimit);
+    void clearFinishedTransfers();
+    void transferQueueProgress(int finished, int total, double bytesPerSec);
+    void transferQueueDrained();
+    void chunkedUploadProgress(QString localFile, int chunksConfirmed, int chunksTotal);
+    void chunkedUploadFinished(QString localFile, RequestState finalState);
+    void transferItemFinished(int transferID, RequestState finalState);
+    void retrievalProgress(QString remotePath, qint64 bytesDone, qint64 bytesTotal);
+    void retrievalFinished(QString remotePath, RequestState finalState);
+    void folderCrawlProgress(int foldersListed, int foldersFound, int filesDone, int filesFound);
+    void folderCrawlFinished(RequestState finalState, QString message);
+    void compressedDownloadStage(QString message);
+    void compressedDownloadProgress(qint64 bytesDone, qint64 bytesTotal);
+    void compressedDownloadFinished(RequestState finalState, QString message);
+    void folderUploadProgress(int foldersCreated, int foldersFound, int filesDone, int filesFound);
+    void folderUploadFinished(RequestState finalState, QString message);
+    void folderSyncStage(QString message);
+    void folderSyncProgress(int filesDone, int filesToMove);
+    void folderSyncFinished(RequestState finalState, QString message);
 
 private:
+    static QString formatRate(double bytesPerSec);
+    static void addFilterChoice(QComboBox * theBox, QString newChoice);
+
+    QString resolveRemoteName(QString newName);
+    QMultiMap<QString, QString> appInputsFromPanel();
+    void addPathAction(QMenu &theMenu, QString actionText, const char * actionSlot, QStringList writePaths, QStringList readPaths = QStringList());
+    int beginFileOp(QString description, QStringList writePaths, QStringList readPaths = QStringList());
+    void trackFileOp(RemoteDataReply * theReply, const char * replySignal, int opID, QStringList foldersToRefresh);
+    QStringList endFileOp(QObject * theOp);
+    void startBatchOp(BatchOpType opType, QString targetText);
+    void setTransferPriority(TransferPriority newPriority);
+
     Ui::ExplorerWindow *ui;
 
-    FileNodeRef targetNode;
-    RemoteJobData targetJob;
+    RemoteFolderModel remoteFileModel;
+    ListingPrefetcher * myPrefetcher;
+    DeepIndexCrawler * deepIndexer = nullptr;
+    RemoteEntry targetEntry;
+    QStringList batchTargets;
+    QString selectedPath;
+    QMap<QString, QString> chunkedUploadTargets;
+    QMap<QString, int> chunkedUploadOps;
+    QHash<int, int> uploadOps;
+    QHash<int, int> uploadOpCounts;
+    QHash<int, int> downloadOps;
+
+    TransferListModel * transferModel;
+    QList<int> targetTransfers;
+
+    JobListModel * jobModel;
+    QString targetJobID;
+    QHash<QObject *, QString> pendingJobDeletes;
+    QList<ParameterSweep *> sweepList;
+
+    struct PendingFileOp
+    {
+        int opID;
+        QStringList foldersToRefresh;
+    };
+    FileOpScheduler fileOpScheduler;
+    QHash<QObject *, PendingFileOp> pendingFileOps;
+    QHash<int, BatchFileOperation *> waitingBatches;
 
     QStandardItemModel taskListModel;
     QString selectedAgaveApp;
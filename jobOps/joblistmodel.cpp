@@ -0,0 +1,266 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "joblistmodel.h"
+
+#include <QDateTime>
+#include <QVector>
+#include <algorithm>
+
+#include "jobOps/jobpoller.h"
+
+JobListModel::JobListModel(JobStore * theStore, JobPoller * thePoller, QObject *parent) : QAbstractTableModel(parent)
+{
+    myStore = theStore;
+    myPoller = thePoller;
+    rebuildRows();
+
+    QObject::connect(myStore, SIGNAL(jobAdded(QString)), this, SLOT(jobAdded(QString)));
+    QObject::connect(myStore, SIGNAL(jobChanged(QString)), this, SLOT(jobChanged(QString)));
+    QObject::connect(myStore, SIGNAL(jobRemoved(QString)), this, SLOT(jobRemoved(QString)));
+    QObject::connect(myStore, SIGNAL(storeCleared()), this, SLOT(storeCleared()));
+    QObject::connect(myStore, SIGNAL(storeOpened()), this, SLOT(storeOpened()));
+}
+
+int JobListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return rowIDs.size();
+}
+
+int JobListModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return 5;
+}
+
+QVariant JobListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= rowIDs.size())) return QVariant();
+    if (role != Qt::DisplayRole) return QVariant();
+
+    JobRecord theJob = myStore->getJob(rowIDs.at(index.row()));
+    switch (index.column())
+    {
+    case 0: return theJob.name;
+    case 1: return theJob.status;
+    case 2: return theJob.appID;
+    case 3:
+        if (theJob.created <= 0) return QVariant();
+        return QDateTime::fromMSecsSinceEpoch(theJob.created).toString("yyyy-MM-dd hh:mm");
+    case 4: return theJob.jobID;
+    }
+    return QVariant();
+}
+
+QVariant JobListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+
+    switch (section)
+    {
+    case 0: return "Task Name";
+    case 1: return "State";
+    case 2: return "Agave App";
+    case 3: return "Time Created";
+    case 4: return "Agave ID";
+    }
+    return QVariant();
+}
+
+void JobListModel::sort(int column, Qt::SortOrder order)
+{
+    if ((column < 0) || (column >= columnCount())) return;
+    if ((column == sortColumn) && (order == sortOrder)) return;
+
+    sortColumn = column;
+    sortOrder = order;
+    rebuildRows();
+}
+
+bool JobListModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid() || (myPoller == nullptr)) return false;
+    return myPoller->hasOlderJobs();
+}
+
+void JobListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || (myPoller == nullptr)) return;
+
+    //The rows come later, through the store's signals
+    myPoller->fetchOlderJobs();
+}
+
+void JobListModel::setFilter(JobFilter newFilter)
+{
+    activeFilter = newFilter;
+    rebuildRows();
+}
+
+JobFilter JobListModel::getFilter()
+{
+    return activeFilter;
+}
+
+QString JobListModel::jobIDForIndex(const QModelIndex &index) const
+{
+    if (!index.isValid() || (index.row() >= rowIDs.size())) return QString();
+    return rowIDs.at(index.row());
+}
+
+void JobListModel::jobAdded(QString jobID)
+{
+    JobRecord theJob = myStore->getJob(jobID);
+    if (!activeFilter.matches(theJob)) return;
+    insertJobRow(theJob);
+}
+
+void JobListModel::jobChanged(QString jobID)
+{
+    JobRecord theJob = myStore->getJob(jobID);
+    int theRow = rowIDs.indexOf(jobID);
+
+    if (!activeFilter.matches(theJob))
+    {
+        if (theRow >= 0) jobRemoved(jobID);
+        return;
+    }
+    if (theRow < 0)
+    {
+        insertJobRow(theJob);
+        return;
+    }
+
+    //A change of status can move a job when the table is sorted by status
+    bool inOrder = true;
+    if ((theRow > 0) && !rowBefore(myStore->getJob(rowIDs.at(theRow - 1)), theJob)) inOrder = false;
+    if ((theRow < rowIDs.size() - 1) && !rowBefore(theJob, myStore->getJob(rowIDs.at(theRow + 1)))) inOrder = false;
+    if (!inOrder)
+    {
+        jobRemoved(jobID);
+        insertJobRow(theJob);
+        return;
+    }
+    emit dataChanged(index(theRow, 0), index(theRow, columnCount() - 1));
+}
+
+void JobListModel::jobRemoved(QString jobID)
+{
+    int theRow = rowIDs.indexOf(jobID);
+    if (theRow < 0) return;
+
+    beginRemoveRows(QModelIndex(), theRow, theRow);
+    rowIDs.removeAt(theRow);
+    endRemoveRows();
+}
+
+void JobListModel::storeCleared()
+{
+    beginResetModel();
+    rowIDs.clear();
+    endResetModel();
+}
+
+void JobListModel::storeOpened()
+{
+    rebuildRows();
+}
+
+void JobListModel::rebuildRows()
+{
+    QVector<JobRecord> shownJobs;
+    for (const QString &aJob : myStore->findJobs(activeFilter))
+    {
+        shownJobs.append(myStore->getJob(aJob));
+    }
+    std::sort(shownJobs.begin(), shownJobs.end(), [this](const JobRecord &firstJob, const JobRecord &secondJob)
+    {
+        return rowBefore(firstJob, secondJob);
+    });
+
+    beginResetModel();
+    rowIDs.clear();
+    rowIDs.reserve(shownJobs.size());
+    for (const JobRecord &aJob : shownJobs)
+    {
+        rowIDs.append(aJob.jobID);
+    }
+    endResetModel();
+}
+
+bool JobListModel::rowBefore(const JobRecord &firstJob, const JobRecord &secondJob) const
+{
+    int compared = 0;
+    switch (sortColumn)
+    {
+    case 0: compared = QString::compare(firstJob.name, secondJob.name, Qt::CaseInsensitive); break;
+    case 1: compared = QString::compare(firstJob.status, secondJob.status); break;
+    case 2: compared = QString::compare(firstJob.appID, secondJob.appID); break;
+    case 4: compared = QString::compare(firstJob.jobID, secondJob.jobID); break;
+    }
+
+    //Ties are broken by creation time, then ID, so that every job has one place
+    if ((compared == 0) && (firstJob.created != secondJob.created))
+    {
+        compared = (firstJob.created < secondJob.created) ? -1 : 1;
+    }
+    if (compared == 0) compared = QString::compare(firstJob.jobID, secondJob.jobID);
+
+    if (sortOrder == Qt::AscendingOrder) return (compared < 0);
+    return (compared > 0);
+}
+
+int JobListModel::rowForJob(const JobRecord &theJob) const
+{
+    //Rows are always in sorted order, so a job's place is found by binary search
+    int lowRow = 0;
+    int highRow = rowIDs.size();
+    while (lowRow < highRow)
+    {
+        int midRow = (lowRow + highRow) / 2;
+        if (rowBefore(myStore->getJob(rowIDs.at(midRow)), theJob)) lowRow = midRow + 1;
+        else highRow = midRow;
+    }
+    return lowRow;
+}
+
+void JobListModel::insertJobRow(const JobRecord &theJob)
+{
+    int newRow = rowForJob(theJob);
+    beginInsertRows(QModelIndex(), newRow, newRow);
+    rowIDs.insert(newRow, theJob.jobID);
+    endInsertRows();
+}
@@ -0,0 +1,95 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBLISTMODEL_H
+#define JOBLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+
+#include "jobOps/jobstore.h"
+
+class JobPoller;
+
+/*! \brief The JobListModel shows the jobs in a JobStore, one row each, for the jobs tab.
+ *
+ *  Only jobs which match the model's filter are shown. Sorting and filtering are done against the store's indexes, and never ask the server again. When the view is scrolled to the end, the model asks the JobPoller for the next page of older jobs.
+ *
+ *  Rows are only added, removed or repainted as the store reports changes, so the table stays usable while jobs are polled.
+ */
+
+class JobListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit JobListModel(JobStore * theStore, JobPoller * thePoller, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void setFilter(JobFilter newFilter);
+    JobFilter getFilter();
+
+    QString jobIDForIndex(const QModelIndex &index) const;
+
+private slots:
+    void jobAdded(QString jobID);
+    void jobChanged(QString jobID);
+    void jobRemoved(QString jobID);
+    void storeCleared();
+    void storeOpened();
+
+private:
+    void rebuildRows();
+    bool rowBefore(const JobRecord &firstJob, const JobRecord &secondJob) const;
+    int rowForJob(const JobRecord &theJob) const;
+    void insertJobRow(const JobRecord &theJob);
+
+    JobStore * myStore;
+    JobPoller * myPoller;
+    JobFilter activeFilter;
+    int sortColumn = 3;
+    Qt::SortOrder sortOrder = Qt::DescendingOrder;
+
+    QStringList rowIDs;
+};
+
+#endif // JOBLISTMODEL_H
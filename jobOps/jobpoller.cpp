@@ -0,0 +1,403 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobpoller.h"
+
+#include <QJsonObject>
+
+#include "remotedatainterface.h"
+
+#include "jobOps/jobstore.h"
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "ae_globals.h"
+
+const int JobPoller::firstPollInterval;
+const int JobPoller::maxPollInterval;
+const int JobPoller::firstListInterval;
+const int JobPoller::maxListInterval;
+const int JobPoller::sessionRetryDelay;
+const int JobPoller::maxActivePolls;
+const int JobPoller::maxPollFailures;
+const int JobPoller::fullPageSize;
+const int JobPoller::headPageSize;
+
+JobPoller::JobPoller(JobStore * theStore, QObject *parent) : QObject(parent)
+{
+    myStore = theStore;
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollTimeout()));
+    pollClock.start();
+}
+
+void JobPoller::start()
+{
+    pollerRunning = true;
+    olderJobsLeft = true;
+    listInterval = firstListInterval;
+    watchList.clear();
+
+    //Stored jobs are the newest part of the job list, so older pages follow on from them
+    pagedJobCount = myStore->jobCount();
+    qint64 now = pollClock.elapsed();
+    if (pagedJobCount == 0)
+    {
+        headPolling = false;
+        pageWanted = true;
+        nextPageTry = now;
+        scheduleNext();
+        return;
+    }
+
+    pageWanted = false;
+    headPolling = true;
+    headOffset = 0;
+    nextListPoll = now;
+    for (QString aJob : myStore->activeJobIDs())
+    {
+        addWatch(aJob, now);
+    }
+    qCDebug(agaveAppLayer, "Catching up on %d stored jobs, %d still active", pagedJobCount, watchList.size());
+    scheduleNext();
+}
+
+void JobPoller::stop()
+{
+    pollerRunning = false;
+    pollTimer.stop();
+}
+
+void JobPoller::fetchOlderJobs()
+{
+    if (!olderJobsLeft || pageWanted) return;
+    pageWanted = true;
+    nextPageTry = pollClock.elapsed();
+    scheduleNext();
+}
+
+bool JobPoller::hasOlderJobs()
+{
+    return pollerRunning && olderJobsLeft;
+}
+
+void JobPoller::watchJob(QString jobID)
+{
+    if (jobID.isEmpty()) return;
+    addWatch(jobID, pollClock.elapsed());
+
+    WatchedJob &theWatch = watchList[jobID];
+    theWatch.interval = firstPollInterval;
+    theWatch.nextPoll = pollClock.elapsed();
+    scheduleNext();
+}
+
+void JobPoller::forgetJob(QString jobID)
+{
+    watchList.remove(jobID);
+}
+
+QString JobPoller::jobSubmitted(QJsonDocument rawReply)
+{
+    //The job may be at the top level, or inside the result object, depending on how much of the reply is passed on
+    QJsonObject replyObject = rawReply.object();
+    if (replyObject.contains("result")) replyObject = replyObject.value("result").toObject();
+
+    JobRecord newJob = JobStore::parseJob(replyObject);
+    if (newJob.jobID.isEmpty())
+    {
+        checkForNewJobs();
+        return QString();
+    }
+    if (!myStore->hasJob(newJob.jobID)) pagedJobCount++;
+    myStore->storeJob(newJob);
+    watchJob(newJob.jobID);
+    return newJob.jobID;
+}
+
+void JobPoller::checkForNewJobs()
+{
+    if (!headPolling || headInFlight) return;
+    listInterval = firstListInterval;
+    nextListPoll = pollClock.elapsed();
+    scheduleNext();
+}
+
+void JobPoller::pollNow()
+{
+    qint64 now = pollClock.elapsed();
+    for (auto itr = watchList.begin(); itr != watchList.end(); itr++)
+    {
+        itr->interval = firstPollInterval;
+        itr->nextPoll = now;
+    }
+    checkForNewJobs();
+    scheduleNext();
+}
+
+int JobPoller::watchedCount()
+{
+    return watchList.size();
+}
+
+void JobPoller::pollTimeout()
+{
+    if (!pollerRunning) return;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        pollTimer.start(sessionRetryDelay);
+        return;
+    }
+
+    qint64 now = pollClock.elapsed();
+    if (pageWanted && !pageInFlight && (nextPageTry <= now))
+    {
+        requestOlderPage(theSession);
+    }
+    if (headPolling && !headInFlight && (nextListPoll <= now))
+    {
+        requestHeadPage(theSession);
+    }
+
+    for (auto itr = watchList.begin(); itr != watchList.end(); itr++)
+    {
+        if (statusTasks.size() >= maxActivePolls) break;
+        if (itr->inFlight || (itr->nextPoll > now)) continue;
+
+        //Only the fields which can change are asked for
+        RestTask * statusTask = theSession->newJobStatus(itr.key(), "id,status,lastUpdated");
+        QObject::connect(statusTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(statusReply(RequestState,QByteArray,qint64)));
+        statusTasks.insert(statusTask, itr.key());
+        itr->inFlight = true;
+        theSession->submitTask(statusTask);
+    }
+    scheduleNext();
+}
+
+void JobPoller::statusReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!statusTasks.contains(sender())) return;
+    QString jobID = statusTasks.take(sender());
+
+    //The job may have been forgotten, or seen to end in a listing, while this poll was out
+    if (!watchList.contains(jobID))
+    {
+        scheduleNext();
+        return;
+    }
+    WatchedJob &theWatch = watchList[jobID];
+    theWatch.inFlight = false;
+
+    if (replyState != RequestState::GOOD)
+    {
+        theWatch.failures++;
+        if (theWatch.failures >= maxPollFailures)
+        {
+            qCDebug(agaveAppLayer, "Job %s could not be read %d times, and is no longer polled", qPrintable(jobID), theWatch.failures);
+            watchList.remove(jobID);
+            emit watchAbandoned(jobID);
+        }
+        else
+        {
+            theWatch.interval = qMin(maxPollInterval, theWatch.interval * 3 / 2);
+            theWatch.nextPoll = pollClock.elapsed() + theWatch.interval;
+        }
+        scheduleNext();
+        return;
+    }
+    theWatch.failures = 0;
+
+    JobRecord statusRecord = JobStore::parseJob(QJsonDocument::fromJson(body).object().value("result").toObject());
+    statusRecord.jobID = jobID;
+    bool jobUpdated = myStore->storeJob(statusRecord);
+
+    if (JobStore::isTerminal(myStore->getJob(jobID).status))
+    {
+        qCDebug(agaveAppLayer, "Job %s ended with status %s", qPrintable(jobID), qPrintable(myStore->getJob(jobID).status));
+        watchList.remove(jobID);
+    }
+    else
+    {
+        theWatch.interval = jobUpdated ? firstPollInterval : qMin(maxPollInterval, theWatch.interval * 3 / 2);
+        theWatch.nextPoll = pollClock.elapsed() + theWatch.interval;
+    }
+    scheduleNext();
+}
+
+void JobPoller::pageReply(RequestState replyState, QByteArray body, qint64)
+{
+    pageInFlight = false;
+    qint64 now = pollClock.elapsed();
+
+    if (replyState != RequestState::GOOD)
+    {
+        //The page is still wanted, and is asked for again shortly
+        nextPageTry = now + sessionRetryDelay;
+        scheduleNext();
+        return;
+    }
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    storeListedJobs(resultList);
+    pagedJobCount += resultList.size();
+    olderJobsLeft = (resultList.size() >= fullPageSize);
+    pageWanted = false;
+
+    if (!headPolling)
+    {
+        headPolling = true;
+        headOffset = 0;
+        nextListPoll = now + listInterval;
+    }
+    qCDebug(agaveAppLayer, "Read %d jobs; %d known, %d still active", resultList.size(), myStore->jobCount(), watchList.size());
+    emit olderJobsRead(resultList.size(), olderJobsLeft);
+    scheduleNext();
+}
+
+void JobPoller::headReply(RequestState replyState, QByteArray body, qint64)
+{
+    headInFlight = false;
+    qint64 now = pollClock.elapsed();
+
+    if (replyState != RequestState::GOOD)
+    {
+        //The walk picks up again from the same page
+        listInterval = qMin(maxListInterval, listInterval * 3 / 2);
+        nextListPoll = now + listInterval;
+        scheduleNext();
+        return;
+    }
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    int newJobs = storeListedJobs(resultList);
+
+    //New jobs push the older pages further down the list
+    pagedJobCount += newJobs;
+
+    //The next newest page is only read while every job on this one was new
+    if ((resultList.size() >= headPageSize) && (newJobs == resultList.size()))
+    {
+        headOffset += resultList.size();
+        nextListPoll = now;
+    }
+    else
+    {
+        if (newJobs > 0) listInterval = firstListInterval;
+        else listInterval = qMin(maxListInterval, listInterval * 3 / 2);
+        headOffset = 0;
+        nextListPoll = now + listInterval;
+    }
+    scheduleNext();
+}
+
+void JobPoller::requestOlderPage(AgaveRestSession * theSession)
+{
+    //Counting from the jobs read so far, rather than by page number, keeps jobs started since from shifting the pages
+    RestTask * listTask = theSession->newJobList(pagedJobCount, fullPageSize, "id,name,appId,status,created,lastUpdated");
+    QObject::connect(listTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(pageReply(RequestState,QByteArray,qint64)));
+    pageInFlight = true;
+    theSession->submitTask(listTask);
+}
+
+void JobPoller::requestHeadPage(AgaveRestSession * theSession)
+{
+    RestTask * listTask = theSession->newJobList(headOffset, headPageSize, "id,name,appId,status,created,lastUpdated");
+    QObject::connect(listTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(headReply(RequestState,QByteArray,qint64)));
+    headInFlight = true;
+    theSession->submitTask(listTask);
+}
+
+int JobPoller::storeListedJobs(QJsonArray resultList)
+{
+    int newJobs = 0;
+    qint64 now = pollClock.elapsed();
+    for (const QJsonValue &aValue : resultList)
+    {
+        JobRecord aJob = JobStore::parseJob(aValue.toObject());
+        if (aJob.jobID.isEmpty()) continue;
+        if (!myStore->hasJob(aJob.jobID)) newJobs++;
+        myStore->storeJob(aJob);
+
+        if (JobStore::isTerminal(aJob.status))
+        {
+            watchList.remove(aJob.jobID);
+        }
+        else
+        {
+            //The listing has just given this job's status, so its first poll can wait
+            addWatch(aJob.jobID, now + firstPollInterval);
+        }
+    }
+    return newJobs;
+}
+
+void JobPoller::addWatch(QString jobID, qint64 firstPoll)
+{
+    if (watchList.contains(jobID)) return;
+
+    WatchedJob newWatch;
+    newWatch.nextPoll = firstPoll;
+    watchList.insert(jobID, newWatch);
+}
+
+void JobPoller::scheduleNext()
+{
+    if (!pollerRunning) return;
+
+    qint64 nextDue = -1;
+    if (pageWanted && !pageInFlight) nextDue = nextPageTry;
+    if (headPolling && !headInFlight && ((nextDue < 0) || (nextListPoll < nextDue))) nextDue = nextListPoll;
+    if (statusTasks.size() < maxActivePolls)
+    {
+        for (const WatchedJob &aWatch : watchList)
+        {
+            if (aWatch.inFlight) continue;
+            if ((nextDue < 0) || (aWatch.nextPoll < nextDue)) nextDue = aWatch.nextPoll;
+        }
+    }
+
+    if (nextDue < 0)
+    {
+        pollTimer.stop();
+        return;
+    }
+    pollTimer.start((int) qMax((qint64) 0, nextDue - pollClock.elapsed()));
+}
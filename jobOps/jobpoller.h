@@ -0,0 +1,157 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBPOLLER_H
+#define JOBPOLLER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+class JobStore;
+class AgaveRestSession;
+enum class RequestState;
+
+/*! \brief The JobPoller keeps the JobStore up to date, asking only about jobs which can still change.
+ *
+ *  At start, if the JobStore already holds jobs from an earlier session, only the changes are asked for: the newest pages are read until a known job is seen, and each stored job which was still active is polled. Otherwise, only the newest page of the user's job list is read. Older pages are read one at a time when asked for, as the job table is scrolled down. Each job seen which is not yet in a terminal state is then polled on its own, asking only for its status. Each job has its own poll interval, which grows while the job's status stays the same, and goes back to the shortest interval when it changes. Once a job reaches a terminal state it is no longer polled, and stays in the store as it is.
+ *
+ *  Jobs started elsewhere are found by reading the newest page of the job list, on a slower interval which also grows while nothing new shows up.
+ */
+
+class JobPoller : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobPoller(JobStore * theStore, QObject *parent = nullptr);
+
+    /*! \brief Catches up with jobs changed since the store was saved, or reads the newest page of the job list if the store is empty, then begins polling. Polling waits for the direct connection to be ready.
+     */
+    void start();
+    void stop();
+
+    /*! \brief Reads the next page of older jobs, if there is one, and one is not already being read.
+     */
+    void fetchOlderJobs();
+    bool hasOlderJobs();
+
+    /*! \brief Begins polling jobID at once, at the shortest interval.
+     */
+    void watchJob(QString jobID);
+
+    /*! \brief Stops polling jobID. The job is left in the store.
+     */
+    void forgetJob(QString jobID);
+
+    /*! \brief Records a job from the reply to a job submission, and begins polling it.
+     *
+     *  \return The ID of the new job, or an empty string if the reply does not name one.
+     */
+    QString jobSubmitted(QJsonDocument rawReply);
+
+    /*! \brief Reads the newest page of the job list at once, to find jobs which were started elsewhere.
+     */
+    void checkForNewJobs();
+
+    /*! \brief Polls every watched job at once, and starts each again from the shortest interval.
+     */
+    void pollNow();
+
+    int watchedCount();
+
+    static const int firstPollInterval = 5000;
+    static const int maxPollInterval = 300000;
+    static const int firstListInterval = 30000;
+    static const int maxListInterval = 600000;
+    static const int sessionRetryDelay = 3000;
+    static const int maxActivePolls = 4;
+    static const int maxPollFailures = 5;
+    static const int fullPageSize = 100;
+    static const int headPageSize = 20;
+
+signals:
+    void olderJobsRead(int jobsRead, bool moreLeft);
+
+    /*! \brief Emitted when jobID could not be read maxPollFailures times in a row, and is no longer polled. Its state in the store is then unknown.
+     */
+    void watchAbandoned(QString jobID);
+
+private slots:
+    void pollTimeout();
+    void statusReply(RequestState replyState, QByteArray body, qint64);
+    void pageReply(RequestState replyState, QByteArray body, qint64);
+    void headReply(RequestState replyState, QByteArray body, qint64);
+
+private:
+    struct WatchedJob
+    {
+        qint64 nextPoll = 0;
+        int interval = firstPollInterval;
+        int failures = 0;
+        bool inFlight = false;
+    };
+
+    void requestOlderPage(AgaveRestSession * theSession);
+    void requestHeadPage(AgaveRestSession * theSession);
+    int storeListedJobs(QJsonArray resultList);
+    void addWatch(QString jobID, qint64 firstPoll);
+    void scheduleNext();
+
+    JobStore * myStore;
+    bool pollerRunning = false;
+
+    QTimer pollTimer;
+    QElapsedTimer pollClock;
+
+    QHash<QString, WatchedJob> watchList;
+    QHash<QObject *, QString> statusTasks;
+
+    bool pageWanted = false;
+    bool pageInFlight = false;
+    bool olderJobsLeft = true;
+    qint64 nextPageTry = 0;
+    int pagedJobCount = 0;
+
+    bool headPolling = false;
+    bool headInFlight = false;
+    int headOffset = 0;
+    int listInterval = firstListInterval;
+    qint64 nextListPoll = 0;
+};
+
+#endif // JOBPOLLER_H
@@ -0,0 +1,373 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobstore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#include "ae_globals.h"
+
+const quint32 JobStore::storeMagic;
+const quint32 JobStore::storeVersion;
+const int JobStore::saveDelay;
+
+bool JobFilter::matches(const JobRecord &aJob) const
+{
+    if (!appID.isEmpty() && (aJob.appID != appID)) return false;
+    if (!status.isEmpty() && (aJob.status != status)) return false;
+    if (aJob.created < createdAfter) return false;
+    if (limitToJobs && !jobIDs.contains(aJob.jobID)) return false;
+    return true;
+}
+
+JobStore::JobStore(QObject *parent) : QObject(parent)
+{
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDelay);
+    QObject::connect(&saveTimer, SIGNAL(timeout()), this, SLOT(saveTimeout()));
+}
+
+void JobStore::openStore(QString userName, QString storageSystem)
+{
+    if (storeDirty) saveNow();
+    jobList.clear();
+    appIndex.clear();
+    statusIndex.clear();
+    createdIndex.clear();
+
+    QByteArray storeKey = QString("%1@%2").arg(userName, storageSystem).toUtf8();
+    storePath = QDir(storeFolder()).filePath(QCryptographicHash::hash(storeKey, QCryptographicHash::Sha1).toHex() + ".jobs");
+
+    QFile storeFile(storePath);
+    if (!storeFile.open(QIODevice::ReadOnly))
+    {
+        emit storeOpened();
+        return;
+    }
+
+    QDataStream storeStream(&storeFile);
+    storeStream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    storeStream >> fileMagic >> fileVersion;
+    if ((fileMagic != storeMagic) || (fileVersion != storeVersion))
+    {
+        qCDebug(agaveAppLayer, "Ignoring job store of another format: %s", qPrintable(storePath));
+        emit storeOpened();
+        return;
+    }
+
+    quint32 jobCount = 0;
+    storeStream >> jobCount;
+    for (quint32 i = 0; (i < jobCount) && (storeStream.status() == QDataStream::Ok); i++)
+    {
+        JobRecord aJob;
+        storeStream >> aJob.jobID >> aJob.name >> aJob.appID >> aJob.status >> aJob.created >> aJob.lastUpdated;
+        jobList.insert(aJob.jobID, aJob);
+    }
+
+    //A truncated file is dropped as a whole, rather than trusted in part
+    if (storeStream.status() != QDataStream::Ok)
+    {
+        qCDebug(agaveAppLayer, "Job store is damaged, starting empty: %s", qPrintable(storePath));
+        jobList.clear();
+        emit storeOpened();
+        return;
+    }
+
+    for (const JobRecord &aJob : jobList)
+    {
+        indexJob(aJob);
+    }
+    qCDebug(agaveAppLayer, "Loaded %d stored jobs", jobList.size());
+    emit storeOpened();
+}
+
+bool JobStore::hasJob(QString jobID)
+{
+    return jobList.contains(jobID);
+}
+
+JobRecord JobStore::getJob(QString jobID)
+{
+    return jobList.value(jobID);
+}
+
+QStringList JobStore::jobIDs()
+{
+    return jobList.keys();
+}
+
+int JobStore::jobCount()
+{
+    return jobList.size();
+}
+
+QStringList JobStore::findJobs(const JobFilter &theFilter)
+{
+    //The smallest index which applies gives the candidates; only those are checked against the whole filter
+    const QSet<QString> * candidateSet = nullptr;
+    if (theFilter.limitToJobs)
+    {
+        candidateSet = &theFilter.jobIDs;
+    }
+    if (!theFilter.appID.isEmpty())
+    {
+        auto appItr = appIndex.constFind(theFilter.appID);
+        if (appItr == appIndex.constEnd()) return QStringList();
+        if ((candidateSet == nullptr) || (appItr->size() < candidateSet->size())) candidateSet = &(*appItr);
+    }
+    if (!theFilter.status.isEmpty())
+    {
+        auto statusItr = statusIndex.constFind(theFilter.status);
+        if (statusItr == statusIndex.constEnd()) return QStringList();
+        if ((candidateSet == nullptr) || (statusItr->size() < candidateSet->size())) candidateSet = &(*statusItr);
+    }
+
+    QStringList ret;
+    if (candidateSet != nullptr)
+    {
+        for (const QString &aJob : *candidateSet)
+        {
+            if (jobList.contains(aJob) && theFilter.matches(jobList.value(aJob))) ret.append(aJob);
+        }
+        return ret;
+    }
+    if (theFilter.createdAfter > 0)
+    {
+        for (auto itr = createdIndex.lowerBound(theFilter.createdAfter); itr != createdIndex.end(); itr++)
+        {
+            ret.append(itr.value());
+        }
+        return ret;
+    }
+    return jobList.keys();
+}
+
+QStringList JobStore::activeJobIDs()
+{
+    QStringList ret;
+    for (auto itr = statusIndex.cbegin(); itr != statusIndex.cend(); itr++)
+    {
+        if (isTerminal(itr.key())) continue;
+        for (const QString &aJob : itr.value())
+        {
+            ret.append(aJob);
+        }
+    }
+    return ret;
+}
+
+QStringList JobStore::knownApps()
+{
+    QStringList ret = appIndex.keys();
+    ret.removeAll(QString());
+    ret.sort();
+    return ret;
+}
+
+QStringList JobStore::knownStatuses()
+{
+    QStringList ret = statusIndex.keys();
+    ret.removeAll(QString());
+    ret.sort();
+    return ret;
+}
+
+bool JobStore::storeJob(JobRecord newRecord)
+{
+    if (newRecord.jobID.isEmpty()) return false;
+
+    if (!jobList.contains(newRecord.jobID))
+    {
+        jobList.insert(newRecord.jobID, newRecord);
+        indexJob(newRecord);
+        markDirty();
+        emit jobAdded(newRecord.jobID);
+        return true;
+    }
+
+    JobRecord &oldRecord = jobList[newRecord.jobID];
+    JobRecord indexedRecord = oldRecord;
+    bool jobUpdated = false;
+    if (!newRecord.name.isEmpty() && (newRecord.name != oldRecord.name))
+    {
+        oldRecord.name = newRecord.name;
+        jobUpdated = true;
+    }
+    if (!newRecord.appID.isEmpty() && (newRecord.appID != oldRecord.appID))
+    {
+        oldRecord.appID = newRecord.appID;
+        jobUpdated = true;
+    }
+    if (!newRecord.status.isEmpty() && (newRecord.status != oldRecord.status))
+    {
+        oldRecord.status = newRecord.status;
+        jobUpdated = true;
+    }
+    if ((newRecord.created > 0) && (newRecord.created != oldRecord.created))
+    {
+        oldRecord.created = newRecord.created;
+        jobUpdated = true;
+    }
+    if ((newRecord.lastUpdated > 0) && (newRecord.lastUpdated != oldRecord.lastUpdated))
+    {
+        oldRecord.lastUpdated = newRecord.lastUpdated;
+        jobUpdated = true;
+    }
+
+    if (!jobUpdated) return false;
+
+    unindexJob(indexedRecord);
+    indexJob(oldRecord);
+    markDirty();
+    emit jobChanged(newRecord.jobID);
+    return true;
+}
+
+void JobStore::removeJob(QString jobID)
+{
+    if (!jobList.contains(jobID)) return;
+    unindexJob(jobList.take(jobID));
+    markDirty();
+    emit jobRemoved(jobID);
+}
+
+void JobStore::clear()
+{
+    jobList.clear();
+    appIndex.clear();
+    statusIndex.clear();
+    createdIndex.clear();
+    markDirty();
+    emit storeCleared();
+}
+
+void JobStore::saveNow()
+{
+    saveTimer.stop();
+    if (storePath.isEmpty() || !storeDirty) return;
+
+    QDir().mkpath(storeFolder());
+    QSaveFile storeFile(storePath);
+    if (!storeFile.open(QIODevice::WriteOnly)) return;
+
+    QDataStream storeStream(&storeFile);
+    storeStream.setVersion(QDataStream::Qt_5_6);
+    storeStream << storeMagic << storeVersion << (quint32) jobList.size();
+
+    for (const JobRecord &aJob : jobList)
+    {
+        storeStream << aJob.jobID << aJob.name << aJob.appID << aJob.status << aJob.created << aJob.lastUpdated;
+    }
+
+    if (storeFile.commit())
+    {
+        storeDirty = false;
+    }
+}
+
+bool JobStore::isTerminal(QString status)
+{
+    return ((status == "FINISHED") || (status == "FAILED") || (status == "STOPPED") ||
+            (status == "KILLED") || (status == "ARCHIVING_FAILED"));
+}
+
+JobRecord JobStore::parseJob(QJsonObject jobObject)
+{
+    JobRecord ret;
+    ret.jobID = jobObject.value("id").toString();
+    ret.name = jobObject.value("name").toString();
+    ret.appID = jobObject.value("appId").toString();
+    ret.status = jobObject.value("status").toString();
+    ret.created = parseTime(jobObject.value("created").toString());
+    ret.lastUpdated = parseTime(jobObject.value("lastUpdated").toString());
+    return ret;
+}
+
+qint64 JobStore::parseTime(QString agaveTime)
+{
+    if (agaveTime.isEmpty()) return 0;
+    QDateTime parsedTime = QDateTime::fromString(agaveTime, Qt::ISODate);
+    if (!parsedTime.isValid()) return 0;
+    return parsedTime.toMSecsSinceEpoch();
+}
+
+void JobStore::saveTimeout()
+{
+    saveNow();
+}
+
+QString JobStore::storeFolder()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("jobStore");
+}
+
+void JobStore::markDirty()
+{
+    storeDirty = true;
+    if (!saveTimer.isActive()) saveTimer.start();
+}
+
+void JobStore::indexJob(const JobRecord &aJob)
+{
+    appIndex[aJob.appID].insert(aJob.jobID);
+    statusIndex[aJob.status].insert(aJob.jobID);
+    createdIndex.insert(aJob.created, aJob.jobID);
+}
+
+void JobStore::unindexJob(const JobRecord &aJob)
+{
+    auto appItr = appIndex.find(aJob.appID);
+    if (appItr != appIndex.end())
+    {
+        appItr->remove(aJob.jobID);
+        if (appItr->isEmpty()) appIndex.erase(appItr);
+    }
+    auto statusItr = statusIndex.find(aJob.status);
+    if (statusItr != statusIndex.end())
+    {
+        statusItr->remove(aJob.jobID);
+        if (statusItr->isEmpty()) statusIndex.erase(statusItr);
+    }
+    createdIndex.remove(aJob.created, aJob.jobID);
+}
@@ -0,0 +1,150 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBSTORE_H
+#define JOBSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMap>
+#include <QJsonObject>
+#include <QTimer>
+
+struct JobRecord
+{
+    QString jobID;
+    QString name;
+    QString appID;
+    QString status;
+    qint64 created = 0;
+    qint64 lastUpdated = 0;
+};
+
+/*! \brief A JobFilter picks jobs by app, status and creation time, and optionally from a given set of jobs. Empty fields match every job.
+ */
+
+struct JobFilter
+{
+    QString appID;
+    QString status;
+    qint64 createdAfter = 0;
+    bool limitToJobs = false;
+    QSet<QString> jobIDs;
+
+    bool matches(const JobRecord &aJob) const;
+};
+
+/*! \brief The JobStore holds every Agave job seen so far, keyed by job ID.
+ *
+ *  Jobs which have reached a terminal state never change again, so they are kept as they are and never asked for again. Only the JobPoller writes to the store; views read from it and follow its signals.
+ *
+ *  The store keeps indexes by app, status and creation time, so that views can sort and filter many thousands of jobs without asking the server again.
+ *
+ *  There is one store file for each user and storage system, kept between sessions in the same way as the ListingCache. The jobs tab is filled from it at login, and only jobs which are new, or were still active, are asked for again. The indexes are not saved, but rebuilt as the file is read.
+ */
+
+class JobStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobStore(QObject *parent = nullptr);
+
+    /*! \brief Loads the store file for this user and storage system, replacing any jobs held now.
+     */
+    void openStore(QString userName, QString storageSystem);
+
+    bool hasJob(QString jobID);
+    JobRecord getJob(QString jobID);
+    QStringList jobIDs();
+    int jobCount();
+
+    /*! \brief Returns the IDs of the jobs which match theFilter, in no set order.
+     */
+    QStringList findJobs(const JobFilter &theFilter);
+    QStringList activeJobIDs();
+    QStringList knownApps();
+    QStringList knownStatuses();
+
+    /*! \brief Adds a job, or updates a known one, and returns true if anything changed.
+     *
+     *  Status replies carry only a few fields, so fields which are empty in newRecord keep their known values.
+     */
+    bool storeJob(JobRecord newRecord);
+    void removeJob(QString jobID);
+    void clear();
+    void saveNow();
+
+    static bool isTerminal(QString status);
+
+    /*! \brief Reads a job from an Agave job object, as given in job listings and status replies.
+     */
+    static JobRecord parseJob(QJsonObject jobObject);
+
+    /*! \brief Converts an Agave time stamp to ms since the epoch, or 0 if it cannot be read.
+     */
+    static qint64 parseTime(QString agaveTime);
+
+    static const quint32 storeMagic = 0x41454a42;
+    static const quint32 storeVersion = 1;
+    static const int saveDelay = 2000;
+
+signals:
+    void storeOpened();
+    void jobAdded(QString jobID);
+    void jobChanged(QString jobID);
+    void jobRemoved(QString jobID);
+    void storeCleared();
+
+private slots:
+    void saveTimeout();
+
+private:
+    static QString storeFolder();
+    void markDirty();
+    void indexJob(const JobRecord &aJob);
+    void unindexJob(const JobRecord &aJob);
+
+    QHash<QString, JobRecord> jobList;
+    QHash<QString, QSet<QString>> appIndex;
+    QHash<QString, QSet<QString>> statusIndex;
+    QMultiMap<qint64, QString> createdIndex;
+
+    QString storePath;
+    QTimer saveTimer;
+    bool storeDirty = false;
+};
+
+#endif // JOBSTORE_H
@@ -0,0 +1,474 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "parametersweep.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QRegularExpression>
+#include <QJsonObject>
+#include <cmath>
+
+#include "remotedatainterface.h"
+
+#include "jobOps/jobstore.h"
+#include "jobOps/jobpoller.h"
+#include "ae_globals.h"
+
+const int ParameterSweep::maxSweepJobs;
+const int ParameterSweep::maxPendingSubmits;
+const int ParameterSweep::submitInterval;
+const int ParameterSweep::maxSubmitTries;
+const int ParameterSweep::retryDelay;
+const qint64 ParameterSweep::maxSweepFileSize;
+
+ParameterSweep::ParameterSweep(QString newAppName, QString newWorkingDir, QObject *parent) : QObject(parent)
+{
+    appName = newAppName;
+    workingDir = newWorkingDir;
+
+    QObject::connect(&submitTimer, SIGNAL(timeout()), this, SLOT(submitNext()));
+}
+
+bool ParameterSweep::loadSweepFile(QString localPath, QStringList appParams, QMultiMap<QString, QString> fixedInputs, QString &errorText)
+{
+    QFile sweepFile(localPath);
+    if (!sweepFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        errorText = QString("Unable to open sweep file: %1").arg(localPath);
+        return false;
+    }
+    if (sweepFile.size() > maxSweepFileSize)
+    {
+        errorText = "Sweep file is too large.";
+        return false;
+    }
+    QString sweepText = QString::fromUtf8(sweepFile.readAll());
+    sweepFile.close();
+
+    QList<QMap<QString, QString>> rowList;
+    bool readOkay;
+    if (QFileInfo(localPath).suffix().toLower() == "csv") readOkay = parseCSV(sweepText, rowList, errorText);
+    else readOkay = parseRanges(sweepText, rowList, errorText);
+    if (!readOkay) return false;
+
+    if (rowList.isEmpty())
+    {
+        errorText = "Sweep file gives no jobs.";
+        return false;
+    }
+    for (QString aParam : rowList.first().keys())
+    {
+        if (!appParams.contains(aParam))
+        {
+            errorText = QString("%1 is not a parameter of %2.").arg(aParam, appName);
+            return false;
+        }
+    }
+
+    jobList.clear();
+    for (const QMap<QString, QString> &aRow : rowList)
+    {
+        SweepJob newJob;
+        for (QString aParam : appParams)
+        {
+            newJob.inputs.insert(aParam, aRow.contains(aParam) ? aRow.value(aParam) : fixedInputs.value(aParam));
+        }
+        jobList.append(newJob);
+    }
+    return true;
+}
+
+bool ParameterSweep::parseCSV(QString csvText, QList<QMap<QString, QString>> &rowList, QString &errorText)
+{
+    QList<QStringList> cellRows;
+    QStringList currentRow;
+    QString currentCell;
+    bool inQuotes = false;
+
+    for (int i = 0; i <= csvText.size(); i++)
+    {
+        bool atEnd = (i == csvText.size());
+        QChar nextChar = atEnd ? QChar('\n') : csvText.at(i);
+
+        if (inQuotes && !atEnd)
+        {
+            if (nextChar != '"')
+            {
+                currentCell.append(nextChar);
+            }
+            else if ((i + 1 < csvText.size()) && (csvText.at(i + 1) == '"'))
+            {
+                currentCell.append('"');
+                i++;
+            }
+            else
+            {
+                inQuotes = false;
+            }
+            continue;
+        }
+
+        if (nextChar == '"')
+        {
+            inQuotes = true;
+        }
+        else if (nextChar == ',')
+        {
+            currentRow.append(currentCell.trimmed());
+            currentCell.clear();
+        }
+        else if ((nextChar == '\n') || (nextChar == '\r'))
+        {
+            currentRow.append(currentCell.trimmed());
+            currentCell.clear();
+            if (!currentRow.join("").isEmpty()) cellRows.append(currentRow);
+            currentRow.clear();
+        }
+        else
+        {
+            currentCell.append(nextChar);
+        }
+    }
+    if (inQuotes)
+    {
+        errorText = "CSV file ends inside a quoted value.";
+        return false;
+    }
+    if (cellRows.size() < 2)
+    {
+        errorText = "CSV file needs a row of parameter names and at least one row of values.";
+        return false;
+    }
+
+    QStringList paramNames = cellRows.takeFirst();
+    for (int i = 0; i < paramNames.size(); i++)
+    {
+        if (paramNames.at(i).isEmpty() || (paramNames.indexOf(paramNames.at(i)) != i))
+        {
+            errorText = "CSV parameter names must be unique, and not blank.";
+            return false;
+        }
+    }
+    if (cellRows.size() > maxSweepJobs)
+    {
+        errorText = QString("A sweep may have at most %1 jobs.").arg(maxSweepJobs);
+        return false;
+    }
+
+    for (int rowNum = 0; rowNum < cellRows.size(); rowNum++)
+    {
+        const QStringList &aRow = cellRows.at(rowNum);
+        if (aRow.size() != paramNames.size())
+        {
+            errorText = QString("CSV row %1 has %2 values, but there are %3 parameters.").arg(rowNum + 2).arg(aRow.size()).arg(paramNames.size());
+            return false;
+        }
+        QMap<QString, QString> newRow;
+        for (int i = 0; i < paramNames.size(); i++)
+        {
+            newRow.insert(paramNames.at(i), aRow.at(i));
+        }
+        rowList.append(newRow);
+    }
+    return true;
+}
+
+bool ParameterSweep::parseRanges(QString rangeText, QList<QMap<QString, QString>> &rowList, QString &errorText)
+{
+    QRegularExpression rangePattern("^(-?[0-9.]+):(-?[0-9.]+)(?::(-?[0-9.]+))?$");
+
+    QList<QMap<QString, QString>> expandedRows;
+    expandedRows.append(QMap<QString, QString>());
+    QSet<QString> paramsSeen;
+
+    QStringList lineList = rangeText.split('\n');
+    for (int lineNum = 0; lineNum < lineList.size(); lineNum++)
+    {
+        QString aLine = lineList.at(lineNum).trimmed();
+        if (aLine.isEmpty() || aLine.startsWith('#')) continue;
+
+        int splitPlace = aLine.indexOf('=');
+        QString paramName = aLine.left(splitPlace).trimmed();
+        QString valueText = aLine.mid(splitPlace + 1).trimmed();
+        if ((splitPlace < 0) || paramName.isEmpty() || valueText.isEmpty())
+        {
+            errorText = QString("Line %1 should be: parameter = values").arg(lineNum + 1);
+            return false;
+        }
+        if (paramsSeen.contains(paramName))
+        {
+            errorText = QString("Parameter %1 is given twice.").arg(paramName);
+            return false;
+        }
+        paramsSeen.insert(paramName);
+
+        QStringList valueList;
+        QRegularExpressionMatch rangeMatch = rangePattern.match(valueText);
+        if (rangeMatch.hasMatch())
+        {
+            double firstValue = rangeMatch.captured(1).toDouble();
+            double lastValue = rangeMatch.captured(2).toDouble();
+            double stepSize = rangeMatch.captured(3).isEmpty() ? 1.0 : rangeMatch.captured(3).toDouble();
+            if ((stepSize == 0.0) || ((lastValue - firstValue) / stepSize < 0))
+            {
+                errorText = QString("The range on line %1 never reaches its end.").arg(lineNum + 1);
+                return false;
+            }
+
+            //Values are worked out from the start each time, so that rounding does not build up
+            double stepCount = std::floor((lastValue - firstValue) / stepSize + 1e-9);
+            if (stepCount >= maxSweepJobs)
+            {
+                errorText = QString("A sweep may have at most %1 jobs.").arg(maxSweepJobs);
+                return false;
+            }
+            for (int i = 0; i <= (int) stepCount; i++)
+            {
+                valueList.append(QString::number(firstValue + i * stepSize, 'g', 12));
+            }
+        }
+        else
+        {
+            for (QString aValue : valueText.split(','))
+            {
+                if (!aValue.trimmed().isEmpty()) valueList.append(aValue.trimmed());
+            }
+        }
+
+        if (valueList.isEmpty())
+        {
+            errorText = QString("Line %1 gives no values.").arg(lineNum + 1);
+            return false;
+        }
+        if ((qint64) expandedRows.size() * valueList.size() > maxSweepJobs)
+        {
+            errorText = QString("A sweep may have at most %1 jobs.").arg(maxSweepJobs);
+            return false;
+        }
+
+        QList<QMap<QString, QString>> newRows;
+        for (const QMap<QString, QString> &aRow : expandedRows)
+        {
+            for (QString aValue : valueList)
+            {
+                QMap<QString, QString> newRow = aRow;
+                newRow.insert(paramName, aValue);
+                newRows.append(newRow);
+            }
+        }
+        expandedRows = newRows;
+    }
+
+    if (paramsSeen.isEmpty())
+    {
+        errorText = "Sweep file gives no parameters.";
+        return false;
+    }
+    rowList.append(expandedRows);
+    return true;
+}
+
+void ParameterSweep::start()
+{
+    qCDebug(agaveAppLayer, "Starting sweep of %d %s jobs in %s", jobList.size(), qPrintable(appName), qPrintable(workingDir));
+    sweepClock.start();
+    submitTimer.start(submitInterval);
+    submitNext();
+}
+
+void ParameterSweep::cancel()
+{
+    if (sweepEnded) return;
+    sweepCancelled = true;
+
+    //Jobs already sent are left to run; their replies are still recorded
+    for (SweepJob &aJob : jobList)
+    {
+        if (aJob.state == SweepJobState::WAITING) aJob.state = SweepJobState::FAILED;
+    }
+    finishIfDone();
+}
+
+QString ParameterSweep::getAppName()
+{
+    return appName;
+}
+
+QString ParameterSweep::getWorkingDir()
+{
+    return workingDir;
+}
+
+int ParameterSweep::jobCount()
+{
+    return jobList.size();
+}
+
+int ParameterSweep::submittedCount()
+{
+    int ret = 0;
+    for (const SweepJob &aJob : jobList)
+    {
+        if (aJob.state == SweepJobState::SUBMITTED) ret++;
+    }
+    return ret;
+}
+
+int ParameterSweep::failedCount()
+{
+    int ret = 0;
+    for (const SweepJob &aJob : jobList)
+    {
+        if (aJob.state == SweepJobState::FAILED) ret++;
+    }
+    return ret;
+}
+
+bool ParameterSweep::isFinished()
+{
+    return sweepEnded;
+}
+
+QStringList ParameterSweep::getJobIDs()
+{
+    QStringList ret;
+    for (const SweepJob &aJob : jobList)
+    {
+        if (!aJob.jobID.isEmpty()) ret.append(aJob.jobID);
+    }
+    return ret;
+}
+
+QMap<QString, int> ParameterSweep::statusSummary()
+{
+    QMap<QString, int> ret;
+    JobStore * theStore = ae_globals::get_job_store();
+    for (const SweepJob &aJob : jobList)
+    {
+        QString stateText;
+        if (aJob.state == SweepJobState::FAILED) stateText = "Not Submitted (Failed)";
+        else if (aJob.state != SweepJobState::SUBMITTED) stateText = "Not Yet Submitted";
+        else stateText = theStore->getJob(aJob.jobID).status;
+
+        if (stateText.isEmpty()) stateText = "Submitted";
+        ret[stateText]++;
+    }
+    return ret;
+}
+
+void ParameterSweep::submitNext()
+{
+    if (sweepEnded || sweepCancelled) return;
+    if (pendingSubmits.size() >= maxPendingSubmits) return;
+
+    qint64 now = sweepClock.elapsed();
+    int jobNum = -1;
+    for (int i = 0; i < jobList.size(); i++)
+    {
+        if ((jobList.at(i).state == SweepJobState::WAITING) && (jobList.at(i).nextTry <= now))
+        {
+            jobNum = i;
+            break;
+        }
+    }
+    if (jobNum < 0) return;
+
+    SweepJob &theJob = jobList[jobNum];
+    theJob.tries++;
+
+    RemoteDataReply * jobReply = ae_globals::get_connection()->runRemoteJob(appName, theJob.inputs, workingDir);
+    if (jobReply == nullptr)
+    {
+        theJob.state = (theJob.tries >= maxSubmitTries) ? SweepJobState::FAILED : SweepJobState::WAITING;
+        theJob.nextTry = now + retryDelay * theJob.tries;
+        finishIfDone();
+        return;
+    }
+    theJob.state = SweepJobState::SUBMITTING;
+    QObject::connect(jobReply, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
+                     this, SLOT(submitReply(RequestState,QJsonDocument)));
+    pendingSubmits.insert(jobReply, jobNum);
+}
+
+void ParameterSweep::submitReply(RequestState replyState, QJsonDocument rawReply)
+{
+    if (!pendingSubmits.contains(sender())) return;
+    SweepJob &theJob = jobList[pendingSubmits.take(sender())];
+
+    //The job ID may be at the top level, or inside the result object, depending on how much of the reply is passed on
+    QJsonObject replyObject = rawReply.object();
+    if (replyObject.contains("result")) replyObject = replyObject.value("result").toObject();
+    QString jobID = replyObject.value("id").toString();
+
+    if ((replyState == RequestState::GOOD) && !jobID.isEmpty())
+    {
+        theJob.state = SweepJobState::SUBMITTED;
+        theJob.jobID = jobID;
+        ae_globals::get_job_poller()->jobSubmitted(rawReply);
+    }
+    else if ((theJob.tries < maxSubmitTries) && !sweepCancelled)
+    {
+        theJob.state = SweepJobState::WAITING;
+        theJob.nextTry = sweepClock.elapsed() + retryDelay * theJob.tries;
+    }
+    else
+    {
+        theJob.state = SweepJobState::FAILED;
+    }
+
+    emit sweepProgress(submittedCount(), failedCount(), jobList.size());
+    finishIfDone();
+}
+
+void ParameterSweep::finishIfDone()
+{
+    if (sweepEnded || !pendingSubmits.isEmpty()) return;
+    for (const SweepJob &aJob : jobList)
+    {
+        if ((aJob.state == SweepJobState::WAITING) || (aJob.state == SweepJobState::SUBMITTING)) return;
+    }
+
+    sweepEnded = true;
+    submitTimer.stop();
+
+    int jobsFailed = failedCount();
+    QString message = QString("Sweep of %1 %2 jobs: %3 submitted").arg(jobList.size()).arg(appName).arg(submittedCount());
+    if (jobsFailed > 0) message.append(QString(", %1 not submitted").arg(jobsFailed));
+    if (sweepCancelled) message.append(" (cancelled)");
+    qCDebug(agaveAppLayer, "%s", qPrintable(message));
+    emit sweepFinished((jobsFailed == 0) ? RequestState::GOOD : RequestState::EXPLICIT_ERROR, message);
+}
@@ -0,0 +1,137 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+
+enum class RequestState;
+
+enum class SweepJobState {WAITING, SUBMITTING, SUBMITTED, FAILED};
+
+struct SweepJob
+{
+    QMultiMap<QString, QString> inputs;
+    SweepJobState state = SweepJobState::WAITING;
+    int tries = 0;
+    qint64 nextTry = 0;
+    QString jobID;
+};
+
+/*! \brief A ParameterSweep submits one Agave app many times, once for each set of parameter values in a sweep file.
+ *
+ *  A sweep file is either a CSV file, with parameter names in the first row and one job in each row after, or a list of parameter ranges, one parameter per line, which is expanded into every combination:
+ *
+ *  \code
+ *  stage = mesh, sim
+ *  file_input = 1:10:1
+ *  \endcode
+ *
+ *  A range is start:end or start:end:step, and includes both ends. Lines starting with # are ignored. Parameters which the file does not vary take fixed values given by the caller.
+ *
+ *  Jobs are submitted one at a time, at most one per submitInterval, with up to maxPendingSubmits waiting on a reply at once. A failed submission is tried again after a delay. Every job ID which comes back is kept, and handed to the JobPoller to be watched, so the whole sweep can be followed from the job store.
+ */
+
+class ParameterSweep : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ParameterSweep(QString appName, QString workingDir, QObject *parent = nullptr);
+
+    /*! \brief Reads a sweep file and expands it into job requests. Returns false, and sets errorText, if the file cannot be used.
+     *
+     *  Files ending in .csv are read as CSV; any other file is read as parameter ranges. Every parameter in the file must be one of appParams.
+     */
+    bool loadSweepFile(QString localPath, QStringList appParams, QMultiMap<QString, QString> fixedInputs, QString &errorText);
+
+    static bool parseCSV(QString csvText, QList<QMap<QString, QString>> &rowList, QString &errorText);
+    static bool parseRanges(QString rangeText, QList<QMap<QString, QString>> &rowList, QString &errorText);
+
+    void start();
+    void cancel();
+
+    QString getAppName();
+    QString getWorkingDir();
+    int jobCount();
+    int submittedCount();
+    int failedCount();
+    bool isFinished();
+
+    /*! \brief Returns the ID of every job of the sweep which has been submitted so far.
+     */
+    QStringList getJobIDs();
+
+    /*! \brief Counts the sweep's jobs by their current state in the job store. Jobs not yet submitted are counted apart.
+     */
+    QMap<QString, int> statusSummary();
+
+    static const int maxSweepJobs = 1000;
+    static const int maxPendingSubmits = 4;
+    static const int submitInterval = 500;
+    static const int maxSubmitTries = 3;
+    static const int retryDelay = 5000;
+    static const qint64 maxSweepFileSize = 1024 * 1024;
+
+signals:
+    void sweepProgress(int submitted, int failed, int total);
+    void sweepFinished(RequestState finalState, QString message);
+
+private slots:
+    void submitNext();
+    void submitReply(RequestState replyState, QJsonDocument rawReply);
+
+private:
+    void finishIfDone();
+
+    QString appName;
+    QString workingDir;
+
+    QVector<SweepJob> jobList;
+    QHash<QObject *, int> pendingSubmits;
+
+    QTimer submitTimer;
+    QElapsedTimer sweepClock;
+    bool sweepEnded = false;
+    bool sweepCancelled = false;
+};
+
+#endif // PARAMETERSWEEP_H
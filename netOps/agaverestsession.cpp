@@ -0,0 +1,415 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agaverestsession.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QFileInfo>
+
+#include "resttask.h"
+#include "ratelimiter.h"
+
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+const int AgaveRestSession::maxRefreshTries;
+
+AgaveRestSession::AgaveRestSession(QNetworkAccessManager * netManager, QObject *parent) : QObject(parent)
+{
+    theNetManager = netManager;
+}
+
+void AgaveRestSession::setConnectionParams(QString newTenantURL, QString newClientName, QString newStorage)
+{
+    tenantURL = newTenantURL;
+    clientName = newClientName;
+    storageSystem = newStorage;
+}
+
+void AgaveRestSession::performAuth(QString uname, QString passwd)
+{
+    QMetaObject::invokeMethod(this, "startAuth", Qt::QueuedConnection, Q_ARG(QString, uname), Q_ARG(QString, passwd));
+}
+
+bool AgaveRestSession::isReady()
+{
+    return (sessionReady.load() != 0);
+}
+
+void AgaveRestSession::setRateLimiters(QSharedPointer<RateLimiter> downloadLimit, QSharedPointer<RateLimiter> uploadLimit)
+{
+    downloadLimiter = downloadLimit;
+    uploadLimiter = uploadLimit;
+}
+
+void AgaveRestSession::submitTask(RestTask * theTask)
+{
+    activeTasks.ref();
+    theTask->moveToThread(this->thread());
+    QMetaObject::invokeMethod(this, "startTask", Qt::QueuedConnection, Q_ARG(QObject *, theTask));
+}
+
+void AgaveRestSession::cancelTask(int taskID)
+{
+    QMetaObject::invokeMethod(this, "doCancelTask", Qt::QueuedConnection, Q_ARG(int, taskID));
+}
+
+int AgaveRestSession::activeTaskCount()
+{
+    return activeTasks.load();
+}
+
+RestTask * AgaveRestSession::newMediaRead(QString remotePath, qint64 firstByte, qint64 lastByte)
+{
+    if (!remotePath.startsWith('/')) remotePath.prepend('/');
+
+    RestTask * ret = new RestTask("GET", QString("/files/v2/media/system/%1%2").arg(storageSystem, remotePath));
+    ret->setThrottled(true);
+    if (firstByte >= 0)
+    {
+        ret->setByteRange(firstByte, lastByte);
+    }
+    return ret;
+}
+
+RestTask * AgaveRestSession::newMediaUpload(QString localFile, QString remoteFolder)
+{
+    if (!remoteFolder.startsWith('/')) remoteFolder.prepend('/');
+
+    RestTask * ret = new RestTask("POST", QString("/files/v2/media/system/%1%2").arg(storageSystem, remoteFolder));
+    ret->setUploadFile(localFile, QFileInfo(localFile).fileName());
+    ret->setThrottled(true);
+    return ret;
+}
+
+RestTask * AgaveRestSession::newListing(QString remotePath, int offset, int limit)
+{
+    if (!remotePath.startsWith('/')) remotePath.prepend('/');
+
+    RestTask * ret = new RestTask("GET", QString("/files/v2/listings/system/%1%2").arg(storageSystem, remotePath));
+    QUrlQuery listQuery;
+    listQuery.addQueryItem("offset", QString::number(offset));
+    if (limit > 0)
+    {
+        listQuery.addQueryItem("limit", QString::number(limit));
+    }
+    ret->setQuery(listQuery);
+    return ret;
+}
+
+RestTask * AgaveRestSession::newJobStatus(QString jobID, QString fieldFilter)
+{
+    RestTask * ret = new RestTask("GET", QString("/jobs/v2/%1").arg(jobID));
+    if (!fieldFilter.isEmpty())
+    {
+        QUrlQuery jobQuery;
+        jobQuery.addQueryItem("filter", fieldFilter);
+        ret->setQuery(jobQuery);
+    }
+    return ret;
+}
+
+RestTask * AgaveRestSession::newJobList(int offset, int limit, QString fieldFilter)
+{
+    RestTask * ret = new RestTask("GET", "/jobs/v2");
+    QUrlQuery listQuery;
+    listQuery.addQueryItem("offset", QString::number(offset));
+    listQuery.addQueryItem("limit", QString::number(limit));
+    listQuery.addQueryItem("orderBy", "created");
+    listQuery.addQueryItem("order", "desc");
+    if (!fieldFilter.isEmpty())
+    {
+        listQuery.addQueryItem("filter", fieldFilter);
+    }
+    ret->setQuery(listQuery);
+    return ret;
+}
+
+RestTask * AgaveRestSession::newJobDelete(QString jobID)
+{
+    return new RestTask("DELETE", QString("/jobs/v2/%1").arg(jobID));
+}
+
+void AgaveRestSession::startAuth(QString uname, QString passwd)
+{
+    authUname = uname;
+    authPasswd = passwd;
+    authFailed = false;
+    refreshTries = 0;
+    sessionReady.store(0);
+
+    //The session's client is re-made at each login, as the consumer secret cannot be retrieved later
+    QNetworkRequest deleteRequest(QUrl(QString("%1/clients/v2/%2").arg(tenantURL, clientName)));
+    deleteRequest.setRawHeader("Authorization", basicAuth(authUname, authPasswd));
+
+    QNetworkReply * theReply = theNetManager->deleteResource(deleteRequest);
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(clientDeleteReply()));
+}
+
+void AgaveRestSession::startTask(QObject * theTask)
+{
+    RestTask * restTask = qobject_cast<RestTask *>(theTask);
+    if (restTask == nullptr) return;
+
+    QObject::connect(restTask, SIGNAL(finished(RequestState,QByteArray,qint64)), this, SLOT(taskDone()));
+    liveTasks.insert(restTask->getTaskID(), restTask);
+    if (restTask->isThrottled())
+    {
+        restTask->setSharedLimiter(restTask->isUpload() ? uploadLimiter : downloadLimiter);
+    }
+
+    if (authFailed)
+    {
+        restTask->emitResult(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    if (!isReady())
+    {
+        waitingTasks.append(restTask);
+        return;
+    }
+    restTask->launch(theNetManager, tenantURL, authHeader);
+}
+
+void AgaveRestSession::doCancelTask(int taskID)
+{
+    QPointer<RestTask> theTask = liveTasks.value(taskID);
+    if (theTask.isNull()) return;
+    theTask->doCancel();
+}
+
+void AgaveRestSession::taskDone()
+{
+    RestTask * theTask = qobject_cast<RestTask *>(sender());
+    if (theTask != nullptr)
+    {
+        liveTasks.remove(theTask->getTaskID());
+    }
+    activeTasks.deref();
+}
+
+void AgaveRestSession::clientDeleteReply()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    //A failed delete is expected, if the client did not exist
+    QList<QPair<QString, QString>> clientForm;
+    clientForm.append({"clientName", clientName});
+    clientForm.append({"description", "Direct transfer client for the SimCenter Agave Explorer"});
+    clientForm.append({"tier", "Unlimited"});
+
+    QNetworkRequest createRequest(QUrl(QString("%1/clients/v2").arg(tenantURL)));
+    createRequest.setRawHeader("Authorization", basicAuth(authUname, authPasswd));
+    createRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QNetworkReply * createReply = theNetManager->post(createRequest, encodeForm(clientForm));
+    QObject::connect(createReply, SIGNAL(finished()), this, SLOT(clientCreateReply()));
+}
+
+void AgaveRestSession::clientCreateReply()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    QJsonObject resultObj = QJsonDocument::fromJson(theReply->readAll()).object().value("result").toObject();
+    consumerKey = resultObj.value("consumerKey").toString();
+    consumerSecret = resultObj.value("consumerSecret").toString();
+
+    if ((theReply->error() != QNetworkReply::NoError) || consumerKey.isEmpty() || consumerSecret.isEmpty())
+    {
+        failAuth("Unable to create client");
+        return;
+    }
+
+    QList<QPair<QString, QString>> tokenForm;
+    tokenForm.append({"grant_type", "password"});
+    tokenForm.append({"username", authUname});
+    tokenForm.append({"password", authPasswd});
+    tokenForm.append({"scope", "PRODUCTION"});
+    requestToken(encodeForm(tokenForm));
+}
+
+void AgaveRestSession::tokenReply()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    QJsonObject tokenObj = QJsonDocument::fromJson(theReply->readAll()).object();
+    QString accessToken = tokenObj.value("access_token").toString();
+
+    if ((theReply->error() != QNetworkReply::NoError) || accessToken.isEmpty())
+    {
+        failAuth("Unable to get token");
+        return;
+    }
+
+    authHeader = QByteArray("Bearer ").append(accessToken.toUtf8());
+    refreshTokenText = tokenObj.value("refresh_token").toString();
+
+    //From here on, the token is kept fresh with the refresh token alone
+    authPasswd.clear();
+    refreshTries = 0;
+
+    //Refresh at 90% of the token lifetime, so that no request is sent with an expired token
+    int lifeTime = tokenObj.value("expires_in").toInt();
+    if (lifeTime <= 0) lifeTime = 3600;
+    if (refreshTimer == nullptr)
+    {
+        refreshTimer = new QTimer(this);
+        refreshTimer->setSingleShot(true);
+        QObject::connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refreshToken()));
+    }
+    refreshTimer->start(lifeTime * 900);
+
+    if (!isReady())
+    {
+        qCDebug(agaveAppLayer, "REST session %s ready", qPrintable(clientName));
+    }
+    sessionReady.store(1);
+    emit tokenChanged(authHeader);
+
+    while (!waitingTasks.isEmpty())
+    {
+        QPointer<RestTask> aTask = waitingTasks.takeFirst();
+        if (aTask.isNull()) continue;
+        aTask->launch(theNetManager, tenantURL, authHeader);
+    }
+}
+
+void AgaveRestSession::useToken(QByteArray newAuthHeader)
+{
+    authHeader = newAuthHeader;
+    authFailed = false;
+    sessionReady.store(1);
+
+    while (!waitingTasks.isEmpty())
+    {
+        QPointer<RestTask> aTask = waitingTasks.takeFirst();
+        if (aTask.isNull()) continue;
+        aTask->launch(theNetManager, tenantURL, authHeader);
+    }
+}
+
+void AgaveRestSession::dropToken()
+{
+    authFailed = true;
+    sessionReady.store(0);
+    authHeader.clear();
+
+    while (!waitingTasks.isEmpty())
+    {
+        QPointer<RestTask> aTask = waitingTasks.takeFirst();
+        if (aTask.isNull()) continue;
+        aTask->emitResult(RequestState::EXPLICIT_ERROR);
+    }
+}
+
+void AgaveRestSession::refreshToken()
+{
+    if (refreshTokenText.isEmpty())
+    {
+        failAuth("No refresh token");
+        return;
+    }
+
+    QList<QPair<QString, QString>> tokenForm;
+    tokenForm.append({"grant_type", "refresh_token"});
+    tokenForm.append({"refresh_token", refreshTokenText});
+    tokenForm.append({"scope", "PRODUCTION"});
+    requestToken(encodeForm(tokenForm));
+}
+
+void AgaveRestSession::requestToken(QByteArray formBody)
+{
+    QNetworkRequest tokenRequest(QUrl(QString("%1/token").arg(tenantURL)));
+    tokenRequest.setRawHeader("Authorization", basicAuth(consumerKey, consumerSecret));
+    tokenRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QNetworkReply * theReply = theNetManager->post(tokenRequest, formBody);
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(tokenReply()));
+}
+
+void AgaveRestSession::failAuth(QString reason)
+{
+    qCDebug(agaveAppLayer, "REST session %s: %s", qPrintable(clientName), qPrintable(reason));
+
+    if (isReady() && (refreshTimer != nullptr) && !refreshTokenText.isEmpty() && (refreshTries < maxRefreshTries))
+    {
+        //Current token may still be good for a while; try once more shortly
+        refreshTries++;
+        refreshTimer->start(60000);
+        return;
+    }
+
+    authPasswd.clear();
+    authFailed = true;
+    sessionReady.store(0);
+    emit tokenLost();
+
+    while (!waitingTasks.isEmpty())
+    {
+        QPointer<RestTask> aTask = waitingTasks.takeFirst();
+        if (aTask.isNull()) continue;
+        aTask->emitResult(RequestState::EXPLICIT_ERROR);
+    }
+}
+
+QByteArray AgaveRestSession::basicAuth(QString user, QString pass)
+{
+    return QByteArray("Basic ").append(QString("%1:%2").arg(user, pass).toUtf8().toBase64());
+}
+
+QByteArray AgaveRestSession::encodeForm(const QList<QPair<QString, QString>> &formFields)
+{
+    //Every value is percent-encoded, since QUrlQuery would leave a '+' in a password as-is
+    QByteArray ret;
+    for (const QPair<QString, QString> &aField : formFields)
+    {
+        if (!ret.isEmpty()) ret.append('&');
+        ret.append(QUrl::toPercentEncoding(aField.first));
+        ret.append('=');
+        ret.append(QUrl::toPercentEncoding(aField.second));
+    }
+    return ret;
+}
@@ -0,0 +1,162 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVERESTSESSION_H
+#define AGAVERESTSESSION_H
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QPointer>
+#include <QHash>
+#include <QAtomicInt>
+#include <QTimer>
+#include <QSharedPointer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class RestTask;
+class RateLimiter;
+
+/*! \brief The AgaveRestSession makes direct, authenticated requests to the Agave REST API from one network lane.
+ *
+ *  The AgaveHandler only offers whole-file transfers and full listings. The sessions hold an OAuth token of their own, so that RestTasks can ask for byte ranges, paged listings and other requests which the handler does not expose.
+ *
+ *  A bearer token is not tied to a connection, so only one session logs in: it makes the Agave client, gets the token and keeps it fresh with the refresh token, and announces each new token with tokenChanged(). Every other session is given the token through useToken(). The password is dropped as soon as the first token is received.
+ *
+ *  The session lives in its lane's thread and uses that lane's QNetworkAccessManager. Its public methods are safe to call from the GUI thread.
+ */
+
+class AgaveRestSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveRestSession(QNetworkAccessManager * netManager, QObject *parent = nullptr);
+
+    void setConnectionParams(QString tenantURL, QString clientName, QString storage);
+
+    /*! \brief Sets the limiters shared by every throttled task of this session. These are normally shared by every session in the lane pool.
+     */
+    void setRateLimiters(QSharedPointer<RateLimiter> downloadLimit, QSharedPointer<RateLimiter> uploadLimit);
+
+    /*! \brief Starts the login for this session, in the session's thread. The session then owns the token, and announces it with tokenChanged().
+     */
+    void performAuth(QString uname, QString passwd);
+    bool isReady();
+
+    /*! \brief Hands a task to the session. The task is moved to the session's thread, and is started once the session has a token.
+     */
+    void submitTask(RestTask * theTask);
+
+    /*! \brief Aborts the task with the given ID, if it is still running. The task then finishes with an error.
+     */
+    void cancelTask(int taskID);
+    int activeTaskCount();
+
+    /*! \brief Returns a task which reads remotePath from the storage system, optionally limited to the byte range [firstByte, lastByte].
+     */
+    RestTask * newMediaRead(QString remotePath, qint64 firstByte = -1, qint64 lastByte = -1);
+    RestTask * newMediaUpload(QString localFile, QString remoteFolder);
+    RestTask * newListing(QString remotePath, int offset = 0, int limit = -1);
+
+    /*! \brief Returns a task which reads one job. If fieldFilter is given, only those comma-separated fields of the job are sent back.
+     */
+    RestTask * newJobStatus(QString jobID, QString fieldFilter = QString());
+
+    /*! \brief Returns a task which reads one page of the user's jobs, newest first.
+     */
+    RestTask * newJobList(int offset, int limit, QString fieldFilter = QString());
+    RestTask * newJobDelete(QString jobID);
+
+    static const int maxRefreshTries = 5;
+
+signals:
+    void tokenChanged(QByteArray newAuthHeader);
+    void tokenLost();
+
+public slots:
+    /*! \brief Takes on a token obtained by the session which logged in, and starts any waiting tasks with it.
+     */
+    void useToken(QByteArray newAuthHeader);
+
+    /*! \brief Fails waiting tasks, and any later ones, after the session which logged in lost its token.
+     */
+    void dropToken();
+
+private slots:
+    void startAuth(QString uname, QString passwd);
+    void startTask(QObject * theTask);
+    void doCancelTask(int taskID);
+    void taskDone();
+
+    void clientDeleteReply();
+    void clientCreateReply();
+    void tokenReply();
+    void refreshToken();
+
+private:
+    void requestToken(QByteArray formBody);
+    void failAuth(QString reason);
+    QByteArray basicAuth(QString user, QString pass);
+
+    static QByteArray encodeForm(const QList<QPair<QString, QString>> &formFields);
+
+    QNetworkAccessManager * theNetManager;
+
+    QString tenantURL;
+    QString clientName;
+    QString storageSystem;
+
+    QString authUname;
+    QString authPasswd;
+    QString consumerKey;
+    QString consumerSecret;
+    QString refreshTokenText;
+    QByteArray authHeader;
+
+    bool authFailed = false;
+    int refreshTries = 0;
+    QAtomicInt sessionReady;
+    QAtomicInt activeTasks;
+
+    QList<QPointer<RestTask>> waitingTasks;
+    QHash<int, QPointer<RestTask>> liveTasks;
+    QTimer * refreshTimer = nullptr;
+
+    QSharedPointer<RateLimiter> downloadLimiter;
+    QSharedPointer<RateLimiter> uploadLimiter;
+};
+
+#endif // AGAVERESTSESSION_H
@@ -0,0 +1,141 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "ratelimiter.h"
+
+#include <QMutexLocker>
+
+const qint64 RateLimiter::minBurst;
+
+RateLimiter::RateLimiter(qint64 bytesPerSec)
+{
+    rate = (bytesPerSec > 0) ? bytesPerSec : 0;
+    tokens = burstSize();
+    refillClock.start();
+}
+
+void RateLimiter::setRate(qint64 bytesPerSec)
+{
+    QMutexLocker lock(&bucketLock);
+    refill();
+    rate = (bytesPerSec > 0) ? bytesPerSec : 0;
+    if (tokens > burstSize()) tokens = burstSize();
+}
+
+qint64 RateLimiter::getRate()
+{
+    QMutexLocker lock(&bucketLock);
+    return rate;
+}
+
+bool RateLimiter::isLimited()
+{
+    QMutexLocker lock(&bucketLock);
+    return (rate > 0);
+}
+
+qint64 RateLimiter::take(qint64 wanted)
+{
+    QMutexLocker lock(&bucketLock);
+    if (rate <= 0) return wanted;
+
+    refill();
+    qint64 granted = qMin(wanted, (qint64) tokens);
+    if (granted < 0) granted = 0;
+    tokens -= granted;
+    return granted;
+}
+
+void RateLimiter::giveBack(qint64 unused)
+{
+    QMutexLocker lock(&bucketLock);
+    if ((rate <= 0) || (unused <= 0)) return;
+
+    tokens += unused;
+    if (tokens > burstSize()) tokens = burstSize();
+}
+
+int RateLimiter::msecUntilAvailable()
+{
+    QMutexLocker lock(&bucketLock);
+    if (rate <= 0) return 0;
+
+    refill();
+    //Waking for less than a small burst would mean many tiny reads
+    double wantedTokens = qMin((double) minBurst, (double) burstSize()) - tokens;
+    if (wantedTokens <= 0) return 0;
+    return qMax(1, (int) ((wantedTokens * 1000.0) / rate));
+}
+
+qint64 RateLimiter::takeFromAll(const QList<QSharedPointer<RateLimiter>> &limiterList, qint64 wanted)
+{
+    qint64 granted = wanted;
+    for (int i = 0; (i < limiterList.size()) && (granted > 0); i++)
+    {
+        qint64 newGrant = limiterList.at(i)->take(granted);
+
+        //Limiters which already granted more get the difference back
+        for (int j = 0; j < i; j++)
+        {
+            limiterList.at(j)->giveBack(granted - newGrant);
+        }
+        granted = newGrant;
+    }
+    return granted;
+}
+
+int RateLimiter::msecUntilAllAvailable(const QList<QSharedPointer<RateLimiter>> &limiterList)
+{
+    int ret = 0;
+    for (const QSharedPointer<RateLimiter> &aLimiter : limiterList)
+    {
+        ret = qMax(ret, aLimiter->msecUntilAvailable());
+    }
+    return ret;
+}
+
+void RateLimiter::refill()
+{
+    qint64 elapsed = refillClock.restart();
+    if (rate <= 0) return;
+
+    tokens += (elapsed * (double) rate) / 1000.0;
+    if (tokens > burstSize()) tokens = burstSize();
+}
+
+qint64 RateLimiter::burstSize()
+{
+    return qMax(minBurst, rate / 4);
+}
@@ -0,0 +1,89 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QList>
+
+/*! \brief A RateLimiter is a token bucket, which holds a stream of bytes to a set rate.
+ *
+ *  Tokens flow into the bucket at the set rate, up to a quarter second's worth, and each byte sent or received takes one. A rate of 0 means no limit.
+ *
+ *  One limiter may be shared by transfers in several lane threads, so every method locks.
+ */
+
+class RateLimiter
+{
+public:
+    explicit RateLimiter(qint64 bytesPerSec = 0);
+
+    void setRate(qint64 bytesPerSec);
+    qint64 getRate();
+    bool isLimited();
+
+    /*! \brief Takes up to wanted bytes from the bucket, and returns the number granted, which may be 0.
+     */
+    qint64 take(qint64 wanted);
+
+    /*! \brief Returns bytes taken but not used, such as when another limiter granted less.
+     */
+    void giveBack(qint64 unused);
+
+    /*! \brief Returns the time, in milliseconds, until there will be a useful amount in the bucket.
+     */
+    int msecUntilAvailable();
+
+    /*! \brief Takes up to wanted bytes from every limiter in the list, and returns the number all of them granted.
+     */
+    static qint64 takeFromAll(const QList<QSharedPointer<RateLimiter>> &limiterList, qint64 wanted);
+    static int msecUntilAllAvailable(const QList<QSharedPointer<RateLimiter>> &limiterList);
+
+    static const qint64 minBurst = 16 * 1024;
+
+private:
+    void refill();
+    qint64 burstSize();
+
+    QMutex bucketLock;
+    qint64 rate = 0;
+    double tokens = 0.0;
+    QElapsedTimer refillClock;
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,279 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotelanepool.h"
+
+#include "agaverestsession.h"
+#include "ratelimiter.h"
+
+#include "remotedatainterface.h"
+#include "agaveInterfaces/agavehandler.h"
+
+#include "ae_globals.h"
+
+RemoteLanePool::RemoteLanePool(int bulkLanes, QObject *parent) : QObject(parent)
+{
+    if (bulkLanes < 1) bulkLanes = 1;
+
+    downloadLimiter = QSharedPointer<RateLimiter>(new RateLimiter());
+    uploadLimiter = QSharedPointer<RateLimiter>(new RateLimiter());
+
+    for (int i = 0; i < bulkLanes + 1; i++)
+    {
+        RemoteLane newLane;
+        newLane.laneThread = new QThread(this);
+        newLane.laneThread->start();
+
+        newLane.netManager = new QNetworkAccessManager();
+        newLane.netManager->moveToThread(newLane.laneThread);
+
+        newLane.handler = new AgaveHandler(newLane.netManager);
+        newLane.handler->moveToThread(newLane.laneThread);
+
+        newLane.restSession = new AgaveRestSession(newLane.netManager);
+        newLane.restSession->setRateLimiters(downloadLimiter, uploadLimiter);
+        newLane.restSession->moveToThread(newLane.laneThread);
+
+        laneList.append(newLane);
+    }
+
+    //Only the interactive lane's session logs in; the others use its token
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        QObject::connect(laneList.first().restSession, SIGNAL(tokenChanged(QByteArray)),
+                         laneList.at(i).restSession, SLOT(useToken(QByteArray)));
+        QObject::connect(laneList.first().restSession, SIGNAL(tokenLost()),
+                         laneList.at(i).restSession, SLOT(dropToken()));
+    }
+    qCDebug(agaveAppLayer, "Started network lanes: 1 interactive, %d bulk", bulkLanes);
+}
+
+RemoteLanePool::~RemoteLanePool()
+{
+    for (RemoteLane &aLane : laneList)
+    {
+        aLane.laneThread->quit();
+        aLane.laneThread->wait();
+
+        delete aLane.restSession;
+        delete aLane.handler;
+        delete aLane.netManager;
+    }
+}
+
+void RemoteLanePool::setConnectionParams(QString tenantURL, QString clientName, QString storage)
+{
+    for (int i = 0; i < laneList.size(); i++)
+    {
+        //Each lane needs its own Agave client, since logging in re-creates the client and would revoke the tokens of the other lanes
+        QString laneClient = clientName;
+        if (i != 0)
+        {
+            laneClient.append(QString("_lane%1").arg(i));
+        }
+        laneList[i].handler->setAgaveConnectionParams(tenantURL, laneClient, storage);
+        laneList[i].restSession->setConnectionParams(tenantURL, QString("%1_rest").arg(clientName), storage);
+    }
+}
+
+void RemoteLanePool::setRateLimits(qint64 downloadLimit, qint64 uploadLimit)
+{
+    downloadLimiter->setRate(downloadLimit);
+    uploadLimiter->setRate(uploadLimit);
+    qCDebug(agaveAppLayer, "Transfer limits: %lld bytes/s down, %lld bytes/s up", downloadLimit, uploadLimit);
+}
+
+qint64 RemoteLanePool::getDownloadLimit()
+{
+    return downloadLimiter->getRate();
+}
+
+qint64 RemoteLanePool::getUploadLimit()
+{
+    return uploadLimiter->getRate();
+}
+
+void RemoteLanePool::performLaneAuth(QString uname, QString passwd)
+{
+    laneList.first().restSession->performAuth(uname, passwd);
+
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        if (laneList.at(i).authenticated) continue;
+        if (laneList.at(i).handler->getInterfaceState() != RemoteDataInterfaceState::READY_TO_AUTH) continue;
+
+        RemoteDataReply * authReply = laneList.at(i).handler->performAuth(uname, passwd);
+        if (authReply == nullptr)
+        {
+            qCDebug(agaveAppLayer, "Unable to start auth for bulk lane %d", i);
+            continue;
+        }
+        pendingAuths.insert(authReply, i);
+        QObject::connect(authReply, SIGNAL(haveAuthReply(RequestState)), this, SLOT(bulkAuthReply(RequestState)));
+    }
+}
+
+void RemoteLanePool::closeBulkConnections()
+{
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        if (!laneList.at(i).authenticated) continue;
+        laneList[i].authenticated = false;
+
+        RemoteDataReply * closeReply = laneList.at(i).handler->closeAllConnections();
+        if (closeReply != nullptr)
+        {
+            closeReply->setAsUnconnectedReply();
+        }
+    }
+}
+
+AgaveHandler * RemoteLanePool::getInteractiveLane()
+{
+    return laneList.first().handler;
+}
+
+RemoteDataInterface * RemoteLanePool::getLane(LaneType laneType)
+{
+    if (laneType == LaneType::INTERACTIVE)
+    {
+        return getInteractiveLane();
+    }
+
+    int bestLane = 0;
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        if (!laneList.at(i).authenticated) continue;
+        if ((bestLane == 0) || (laneList.at(i).outstanding < laneList.at(bestLane).outstanding))
+        {
+            bestLane = i;
+        }
+    }
+    return laneList.at(bestLane).handler;
+}
+
+void RemoteLanePool::trackReply(RemoteDataInterface * lane, RemoteDataReply * theReply)
+{
+    if (theReply == nullptr) return;
+
+    int laneNum = findLane(lane);
+    if (laneNum < 0) return;
+
+    laneList[laneNum].outstanding++;
+    trackedReplies.insert(theReply, laneNum);
+    QObject::connect(theReply, SIGNAL(destroyed(QObject*)), this, SLOT(trackedReplyDestroyed(QObject*)));
+}
+
+AgaveRestSession * RemoteLanePool::getRestSession(LaneType laneType)
+{
+    AgaveRestSession * ret = nullptr;
+    if (laneList.first().restSession->isReady())
+    {
+        ret = laneList.first().restSession;
+    }
+    if (laneType == LaneType::INTERACTIVE) return ret;
+
+    AgaveRestSession * bestSession = nullptr;
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        AgaveRestSession * aSession = laneList.at(i).restSession;
+        if (!aSession->isReady()) continue;
+        if ((bestSession == nullptr) || (aSession->activeTaskCount() < bestSession->activeTaskCount()))
+        {
+            bestSession = aSession;
+        }
+    }
+    if (bestSession != nullptr) return bestSession;
+    return ret;
+}
+
+int RemoteLanePool::bulkLaneCount()
+{
+    return laneList.size() - 1;
+}
+
+int RemoteLanePool::readyBulkLaneCount()
+{
+    int ret = 0;
+    for (int i = 1; i < laneList.size(); i++)
+    {
+        if (laneList.at(i).authenticated) ret++;
+    }
+    return ret;
+}
+
+int RemoteLanePool::defaultBulkLaneCount()
+{
+    //One core is left for the GUI and the interactive lane
+    int ret = QThread::idealThreadCount() - 1;
+    if (ret < 1) ret = 1;
+    if (ret > 4) ret = 4;
+    return ret;
+}
+
+void RemoteLanePool::bulkAuthReply(RequestState authReply)
+{
+    int laneNum = pendingAuths.take(sender());
+    if (laneNum <= 0) return;
+
+    if (authReply == RequestState::GOOD)
+    {
+        laneList[laneNum].authenticated = true;
+        qCDebug(agaveAppLayer, "Bulk lane %d ready", laneNum);
+    }
+    else
+    {
+        qCDebug(agaveAppLayer, "Bulk lane %d failed to authenticate, transfers will share the interactive lane", laneNum);
+    }
+}
+
+void RemoteLanePool::trackedReplyDestroyed(QObject * theReply)
+{
+    if (!trackedReplies.contains(theReply)) return;
+    int laneNum = trackedReplies.take(theReply);
+    if (laneList.at(laneNum).outstanding > 0)
+    {
+        laneList[laneNum].outstanding--;
+    }
+}
+
+int RemoteLanePool::findLane(QObject * laneHandler)
+{
+    for (int i = 0; i < laneList.size(); i++)
+    {
+        if (laneList.at(i).handler == laneHandler) return i;
+    }
+    return -1;
+}
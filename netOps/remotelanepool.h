@@ -0,0 +1,135 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTELANEPOOL_H
+#define REMOTELANEPOOL_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QThread>
+#include <QNetworkAccessManager>
+#include <QSharedPointer>
+
+class AgaveHandler;
+class RemoteDataInterface;
+class RemoteDataReply;
+class AgaveRestSession;
+class RateLimiter;
+enum class RequestState;
+
+enum class LaneType {INTERACTIVE, BULK};
+
+/*! \brief The RemoteLanePool owns the worker threads through which all traffic to Agave passes.
+ *
+ *  Each lane is a QThread with its own QNetworkAccessManager and AgaveHandler. Lane 0 is the interactive lane: it is the program's main data connection, and carries listings, job calls and other small requests. The remaining lanes are bulk lanes, which carry file transfers, so that a multi-GB transfer never sits in front of a listing.
+ *
+ *  The pool also holds the global upload and download RateLimiters, which every lane's REST session draws file data from. Listings and job calls are not limited.
+ *
+ *  Bulk lanes authenticate with their own Agave client, once the interactive lane has logged in. Until then, or if they fail, requests for a bulk lane are given the interactive lane instead. The REST sessions share one client and token: the interactive lane's session logs in, and hands each new token to the others.
+ */
+
+class RemoteLanePool : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Creates and starts the lane threads.
+     *
+     *  \param bulkLanes The number of lanes reserved for file transfers. At least one is always created.
+     */
+    explicit RemoteLanePool(int bulkLanes, QObject *parent = nullptr);
+    ~RemoteLanePool();
+
+    void setConnectionParams(QString tenantURL, QString clientName, QString storage);
+
+    /*! \brief Logs in the bulk lanes and the shared REST session, using the credentials which were accepted by the interactive lane.
+     */
+    void performLaneAuth(QString uname, QString passwd);
+    void closeBulkConnections();
+
+    AgaveHandler * getInteractiveLane();
+
+    /*! \brief Returns the connection which should carry the next request of the given type.
+     *
+     *  For BULK, this is the authenticated bulk lane with the fewest outstanding requests tracked by trackReply().
+     */
+    RemoteDataInterface * getLane(LaneType laneType);
+
+    /*! \brief Counts theReply against the lane which issued it, until the reply object is destroyed.
+     */
+    void trackReply(RemoteDataInterface * lane, RemoteDataReply * theReply);
+
+    /*! \brief Returns the REST session which should carry the next direct request of the given type, or nullptr if no session has logged in.
+     *
+     *  For BULK, this is the ready bulk session with the fewest active tasks.
+     */
+    AgaveRestSession * getRestSession(LaneType laneType);
+
+    /*! \brief Sets the global transfer rate limits, in bytes per second, with 0 for no limit.
+     */
+    void setRateLimits(qint64 downloadLimit, qint64 uploadLimit);
+    qint64 getDownloadLimit();
+    qint64 getUploadLimit();
+
+    int bulkLaneCount();
+    int readyBulkLaneCount();
+
+    static int defaultBulkLaneCount();
+
+private slots:
+    void bulkAuthReply(RequestState authReply);
+    void trackedReplyDestroyed(QObject * theReply);
+
+private:
+    struct RemoteLane
+    {
+        QThread * laneThread = nullptr;
+        QNetworkAccessManager * netManager = nullptr;
+        AgaveHandler * handler = nullptr;
+        AgaveRestSession * restSession = nullptr;
+        int outstanding = 0;
+        bool authenticated = false;
+    };
+
+    int findLane(QObject * laneHandler);
+
+    QVector<RemoteLane> laneList;
+    QSharedPointer<RateLimiter> downloadLimiter;
+    QSharedPointer<RateLimiter> uploadLimiter;
+    QHash<QObject *, int> trackedReplies;
+    QHash<QObject *, int> pendingAuths;
+};
+
+#endif // REMOTELANEPOOL_H
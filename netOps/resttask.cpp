@@ -0,0 +1,341 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "resttask.h"
+
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QTimer>
+
+#include "remotedatainterface.h"
+#include "netOps/ratelimiter.h"
+#include "netOps/throttledfiledevice.h"
+#include "ae_globals.h"
+
+QAtomicInt RestTask::nextTaskID(1);
+
+RestTask::RestTask(QByteArray verb, QString urlPath, QObject *parent) : QObject(parent)
+{
+    taskID = nextTaskID.fetchAndAddRelaxed(1);
+    requestVerb = verb;
+    requestPath = urlPath;
+}
+
+void RestTask::setQuery(QUrlQuery newQuery)
+{
+    requestQuery = newQuery;
+}
+
+void RestTask::setByteRange(qint64 firstByte, qint64 lastByte)
+{
+    rangeStart = firstByte;
+    rangeEnd = lastByte;
+}
+
+void RestTask::setOutputFile(QString localPath, qint64 fileOffset)
+{
+    outputPath = localPath;
+    outputOffset = fileOffset;
+}
+
+void RestTask::setBody(QByteArray bodyData, QByteArray contentType)
+{
+    requestBody = bodyData;
+    requestContentType = contentType;
+}
+
+void RestTask::setUploadFile(QString localPath, QString newUploadName)
+{
+    uploadPath = localPath;
+    uploadName = newUploadName;
+}
+
+void RestTask::setUploadRange(qint64 firstByte, qint64 length)
+{
+    uploadStart = firstByte;
+    uploadLength = length;
+}
+
+void RestTask::setThrottled(bool isThrottled)
+{
+    throttled = isThrottled;
+}
+
+bool RestTask::isThrottled()
+{
+    return throttled;
+}
+
+bool RestTask::isUpload()
+{
+    return !uploadPath.isEmpty();
+}
+
+void RestTask::setTransferLimiter(QSharedPointer<RateLimiter> newLimiter)
+{
+    transferLimiter = newLimiter;
+}
+
+void RestTask::setSharedLimiter(QSharedPointer<RateLimiter> newLimiter)
+{
+    sharedLimiter = newLimiter;
+}
+
+QString RestTask::getUrlPath()
+{
+    return requestPath;
+}
+
+int RestTask::getTaskID()
+{
+    return taskID;
+}
+
+void RestTask::launch(QNetworkAccessManager * netManager, QString tenantURL, QByteArray authHeader)
+{
+    if (taskDone) return;
+
+    if (throttled)
+    {
+        if (!sharedLimiter.isNull()) activeLimiters.append(sharedLimiter);
+        if (!transferLimiter.isNull()) activeLimiters.append(transferLimiter);
+    }
+
+    if (!outputPath.isEmpty())
+    {
+        outputFile = new QFile(outputPath, this);
+        //ReadWrite, so that a file preallocated by the caller is not truncated
+        if (!outputFile->open(QIODevice::ReadWrite) || !outputFile->seek(outputOffset))
+        {
+            qCDebug(agaveAppLayer, "Unable to open output file: %s", qPrintable(outputPath));
+            emitResult(RequestState::EXPLICIT_ERROR);
+            return;
+        }
+    }
+
+    QUrl requestURL(tenantURL + requestPath);
+    if (!requestQuery.isEmpty())
+    {
+        requestURL.setQuery(requestQuery);
+    }
+
+    QNetworkRequest theRequest(requestURL);
+    theRequest.setRawHeader("Authorization", authHeader);
+    if (rangeStart >= 0)
+    {
+        QByteArray rangeText = "bytes=" + QByteArray::number(rangeStart) + "-";
+        if (rangeEnd >= 0) rangeText.append(QByteArray::number(rangeEnd));
+        theRequest.setRawHeader("Range", rangeText);
+    }
+    if (!requestBody.isEmpty())
+    {
+        theRequest.setHeader(QNetworkRequest::ContentTypeHeader, requestContentType);
+    }
+
+    if (!uploadPath.isEmpty())
+    {
+        //The device is the whole body, as a QHttpMultiPart spins on a part device which has nothing to give yet
+        ThrottledFileDevice * uploadFile = new ThrottledFileDevice(uploadPath, activeLimiters);
+        QByteArray formType = uploadFile->setFormPart("fileToUpload", uploadName);
+        if (uploadLength >= 0) uploadFile->setFileRange(uploadStart, uploadLength);
+        if (!uploadFile->open(QIODevice::ReadOnly))
+        {
+            delete uploadFile;
+            qCDebug(agaveAppLayer, "Unable to open upload file: %s", qPrintable(uploadPath));
+            emitResult(RequestState::EXPLICIT_ERROR);
+            return;
+        }
+
+        theRequest.setHeader(QNetworkRequest::ContentTypeHeader, formType);
+        theRequest.setHeader(QNetworkRequest::ContentLengthHeader, uploadFile->size());
+
+        uploadDevice = uploadFile;
+        theReply = netManager->post(theRequest, uploadFile);
+        uploadFile->setParent(theReply);
+        QObject::connect(theReply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(replyProgress(qint64,qint64)));
+    }
+    else
+    {
+        theReply = netManager->sendCustomRequest(theRequest, requestVerb, requestBody);
+        QObject::connect(theReply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(replyProgress(qint64,qint64)));
+
+        if (!activeLimiters.isEmpty())
+        {
+            //A small buffer makes the server slow down while we are not reading
+            theReply->setReadBufferSize(RateLimiter::minBurst * 4);
+            throttleTimer = new QTimer(this);
+            throttleTimer->setSingleShot(true);
+            QObject::connect(throttleTimer, SIGNAL(timeout()), this, SLOT(replyReadyRead()));
+        }
+    }
+    QObject::connect(theReply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(replyFinished()));
+}
+
+void RestTask::replyReadyRead()
+{
+    if (taskDone) return;
+
+    if (!statusChecked)
+    {
+        statusChecked = true;
+        int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if ((rangeStart >= 0) && (httpStatus == 200))
+        {
+            //Server ignored the Range header, and is sending the whole file
+            if (rangeStart != 0)
+            {
+                qCDebug(agaveAppLayer, "Byte range not honored for: %s", qPrintable(requestPath));
+                theReply->abort();
+                return;
+            }
+            rangeEnd = -1;
+            emit rangeNotSupported(theReply->header(QNetworkRequest::ContentLengthHeader).toLongLong());
+        }
+    }
+
+    QByteArray newData;
+    if (throttleTimer == nullptr)
+    {
+        newData = theReply->readAll();
+    }
+    else
+    {
+        qint64 granted = RateLimiter::takeFromAll(activeLimiters, theReply->bytesAvailable());
+        newData = theReply->read(granted);
+        if ((theReply->bytesAvailable() > 0) && !throttleTimer->isActive())
+        {
+            throttleTimer->start(RateLimiter::msecUntilAllAvailable(activeLimiters));
+        }
+    }
+
+    if (outputFile == nullptr)
+    {
+        collectedBody.append(newData);
+    }
+    else if (outputFile->write(newData) != newData.size())
+    {
+        qCDebug(agaveAppLayer, "Write failed for: %s", qPrintable(outputPath));
+        theReply->abort();
+        return;
+    }
+    else
+    {
+        bytesWritten += newData.size();
+        writtenCrc.update(newData);
+    }
+
+    if (finishWaiting && (theReply->bytesAvailable() == 0))
+    {
+        replyFinished();
+    }
+}
+
+void RestTask::replyProgress(qint64 bytesDone, qint64 bytesTotal)
+{
+    emit progress(bytesDone, bytesTotal);
+}
+
+void RestTask::replyFinished()
+{
+    if (taskDone) return;
+
+    //Anything left in the buffer is processed before the result, which may wait on the limiters
+    if (theReply->bytesAvailable() > 0)
+    {
+        finishWaiting = false;
+        replyReadyRead();
+        if (taskDone) return;
+        if (theReply->bytesAvailable() > 0)
+        {
+            finishWaiting = true;
+            return;
+        }
+    }
+
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if ((theReply->error() != QNetworkReply::NoError) || (httpStatus < 200) || (httpStatus >= 300))
+    {
+        qCDebug(agaveAppLayer, "REST request failed (%d): %s", httpStatus, qPrintable(requestPath));
+        emitResult(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    emitResult(RequestState::GOOD);
+}
+
+void RestTask::doCancel()
+{
+    if (taskDone) return;
+    if (theReply != nullptr)
+    {
+        //abort() emits finished(), which reports the failure
+        theReply->abort();
+        return;
+    }
+    emitResult(RequestState::EXPLICIT_ERROR);
+}
+
+void RestTask::emitResult(RequestState finalState)
+{
+    if (taskDone) return;
+    taskDone = true;
+
+    if (throttleTimer != nullptr)
+    {
+        throttleTimer->stop();
+    }
+    if (outputFile != nullptr)
+    {
+        outputFile->close();
+    }
+
+    if (outputFile != nullptr)
+    {
+        emit checksumReady(writtenCrc.value(), writtenCrc.length());
+    }
+    else if ((finalState == RequestState::GOOD) && (uploadDevice != nullptr) && uploadDevice->hasChecksum())
+    {
+        emit checksumReady(uploadDevice->getChecksum(), uploadDevice->fileSize());
+    }
+
+    if (theReply != nullptr)
+    {
+        theReply->deleteLater();
+    }
+
+    emit finished(finalState, collectedBody, bytesWritten);
+    this->deleteLater();
+}
@@ -0,0 +1,172 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef RESTTASK_H
+#define RESTTASK_H
+
+#include <QObject>
+#include <QUrlQuery>
+#include <QByteArray>
+#include <QNetworkReply>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QList>
+
+#include "utilFuncs/crc32c.h"
+
+class QFile;
+class QTimer;
+class ThrottledFileDevice;
+class RateLimiter;
+class QNetworkAccessManager;
+enum class RequestState;
+
+/*! \brief A RestTask is one direct HTTP request to the Agave REST API, made through an AgaveRestSession.
+ *
+ *  RestTasks are for the requests which the AgaveHandler does not offer, such as byte ranges of a file, or paged listings. A task is built in the calling thread, its signals connected, and then handed to AgaveRestSession::submitTask(), which moves it into the session's lane thread. The task deletes itself after emitting finished().
+ *
+ *  Tasks which carry file data are throttled: their bytes are drawn from the session's shared RateLimiter for their direction, and from the task's own limiter if one is set. Listings and job calls are not throttled, so they stay quick while transfers are held back.
+ *
+ *  If an output file is set, the body is written straight to that file, starting at the given offset, from the lane thread. Otherwise, the body is collected and given in finished(). For uploads, progress() counts the bytes sent rather than received.
+ *
+ *  Bytes written to an output file, or read for an upload, are checksummed with CRC-32C as they pass, so a transfer can be verified without reading the file again.
+ */
+
+class RestTask : public QObject
+{
+    Q_OBJECT
+
+    friend class AgaveRestSession;
+
+public:
+    explicit RestTask(QByteArray verb, QString urlPath, QObject *parent = nullptr);
+
+    void setQuery(QUrlQuery newQuery);
+    void setByteRange(qint64 firstByte, qint64 lastByte = -1);
+    void setOutputFile(QString localPath, qint64 fileOffset);
+    void setBody(QByteArray bodyData, QByteArray contentType = "application/x-www-form-urlencoded");
+
+    /*! \brief Sends localPath as a multipart form upload, read from disk as it is sent, under the given file name.
+     */
+    void setUploadFile(QString localPath, QString uploadName);
+
+    /*! \brief Sends only length bytes of the upload file, starting at firstByte, as if they were the whole file.
+     */
+    void setUploadRange(qint64 firstByte, qint64 length);
+
+    void setThrottled(bool isThrottled);
+    bool isThrottled();
+    bool isUpload();
+
+    /*! \brief Sets a limiter of this transfer's own, in addition to the session's. One limiter may be shared by the tasks of one transfer.
+     */
+    void setTransferLimiter(QSharedPointer<RateLimiter> newLimiter);
+
+    QString getUrlPath();
+
+    /*! \brief Returns the ID used to cancel this task with AgaveRestSession::cancelTask().
+     *
+     *  Once submitted, a task may be deleted at any time by its session, so callers keep the ID rather than the pointer.
+     */
+    int getTaskID();
+
+signals:
+    void progress(qint64 bytesDone, qint64 bytesTotal);
+
+    /*! \brief Emitted if a byte range was asked for at offset 0, and the server sent the whole file instead.
+     */
+    void rangeNotSupported(qint64 fullSize);
+
+    /*! \brief Emitted just before finished(), with the CRC-32C of the bytes moved.
+     *
+     *  For a download to an output file, this covers the bytes written, even if the task failed or was cancelled, since those bytes stay on disk. For an upload, it is only emitted if the whole file was sent.
+     */
+    void checksumReady(quint32 crc32c, qint64 length);
+
+    /*! \brief Emitted once, when the request is done.
+     *
+     *  \param body The response body, or empty if the body was written to an output file.
+     *  \param bytesWritten The number of bytes written to the output file.
+     */
+    void finished(RequestState finalState, QByteArray body, qint64 bytesWritten);
+
+private slots:
+    void replyReadyRead();
+    void replyProgress(qint64 bytesDone, qint64 bytesTotal);
+    void replyFinished();
+    void doCancel();
+
+private:
+    void launch(QNetworkAccessManager * netManager, QString tenantURL, QByteArray authHeader);
+    void setSharedLimiter(QSharedPointer<RateLimiter> newLimiter);
+    void emitResult(RequestState finalState);
+
+    QByteArray requestVerb;
+    QString requestPath;
+    QUrlQuery requestQuery;
+    QByteArray requestBody;
+    QByteArray requestContentType;
+    QString uploadPath;
+    QString uploadName;
+    qint64 uploadStart = 0;
+    qint64 uploadLength = -1;
+
+    qint64 rangeStart = -1;
+    qint64 rangeEnd = -1;
+    bool statusChecked = false;
+
+    QString outputPath;
+    qint64 outputOffset = 0;
+    QFile * outputFile = nullptr;
+    qint64 bytesWritten = 0;
+    Crc32c writtenCrc;
+    ThrottledFileDevice * uploadDevice = nullptr;
+
+    bool throttled = false;
+    QSharedPointer<RateLimiter> sharedLimiter;
+    QSharedPointer<RateLimiter> transferLimiter;
+    QList<QSharedPointer<RateLimiter>> activeLimiters;
+    QTimer * throttleTimer = nullptr;
+    bool finishWaiting = false;
+
+    QByteArray collectedBody;
+    QNetworkReply * theReply = nullptr;
+    bool taskDone = false;
+    int taskID;
+
+    static QAtomicInt nextTaskID;
+};
+
+#endif // RESTTASK_H
@@ -0,0 +1,179 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "throttledfiledevice.h"
+
+#include <QTimer>
+#include <QUuid>
+#include <cstring>
+
+#include "netOps/ratelimiter.h"
+
+ThrottledFileDevice::ThrottledFileDevice(QString filePath, QList<QSharedPointer<RateLimiter>> limiterList, QObject *parent) :
+    QIODevice(parent), theFile(filePath)
+{
+    myLimiters = limiterList;
+
+    waitTimer = new QTimer(this);
+    waitTimer->setSingleShot(true);
+    QObject::connect(waitTimer, SIGNAL(timeout()), this, SIGNAL(readyRead()));
+}
+
+QByteArray ThrottledFileDevice::setFormPart(QString fieldName, QString fileName)
+{
+    QByteArray boundary = "AgaveUpload" + QUuid::createUuid().toRfc4122().toHex();
+
+    formHead = "--" + boundary + "\r\n";
+    formHead.append(QString("Content-Disposition: form-data; name=\"%1\"; filename=\"%2\"\r\n").arg(fieldName, fileName).toUtf8());
+    formHead.append("Content-Type: application/octet-stream\r\n\r\n");
+    formTail = "\r\n--" + boundary + "--\r\n";
+
+    return "multipart/form-data; boundary=" + boundary;
+}
+
+void ThrottledFileDevice::setFileRange(qint64 firstByte, qint64 length)
+{
+    rangeStart = firstByte;
+    rangeLength = length;
+}
+
+bool ThrottledFileDevice::open(OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) return false;
+    if (!theFile.open(QIODevice::ReadOnly)) return false;
+    if (!theFile.seek(rangeStart))
+    {
+        theFile.close();
+        return false;
+    }
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void ThrottledFileDevice::close()
+{
+    waitTimer->stop();
+    theFile.close();
+    QIODevice::close();
+}
+
+qint64 ThrottledFileDevice::size() const
+{
+    return formHead.size() + fileSize() + formTail.size();
+}
+
+bool ThrottledFileDevice::seek(qint64 pos)
+{
+    qint64 filePos = qBound((qint64) 0, pos - formHead.size(), fileSize());
+    if (!theFile.seek(rangeStart + filePos)) return false;
+
+    //A reset before a resend starts the checksum over; any other jump leaves it incomplete
+    if (filePos == 0)
+    {
+        streamCrc.reset();
+        crcInOrder = true;
+    }
+    else if (filePos != streamCrc.length())
+    {
+        crcInOrder = false;
+    }
+    return QIODevice::seek(pos);
+}
+
+bool ThrottledFileDevice::hasChecksum() const
+{
+    return crcInOrder && (streamCrc.length() == fileSize());
+}
+
+quint32 ThrottledFileDevice::getChecksum() const
+{
+    return streamCrc.value();
+}
+
+qint64 ThrottledFileDevice::fileSize() const
+{
+    //A range which runs past the end of the file is cut short, so the device never waits on bytes which cannot come
+    qint64 bytesAfterStart = qMax((qint64) 0, theFile.size() - rangeStart);
+    if (rangeLength < 0) return bytesAfterStart;
+    return qMin(rangeLength, bytesAfterStart);
+}
+
+qint64 ThrottledFileDevice::readData(char *data, qint64 maxlen)
+{
+    //The framing around the file is never held back
+    qint64 readFrom = pos();
+    if (readFrom < formHead.size())
+    {
+        qint64 headBytes = qMin(maxlen, formHead.size() - readFrom);
+        memcpy(data, formHead.constData() + readFrom, headBytes);
+        return headBytes;
+    }
+    qint64 filePos = theFile.pos() - rangeStart;
+    qint64 fileLeft = fileSize() - filePos;
+    if (fileLeft <= 0)
+    {
+        qint64 tailFrom = readFrom - formHead.size() - fileSize();
+        if ((tailFrom < 0) || (tailFrom >= formTail.size())) return 0;
+        qint64 tailBytes = qMin(maxlen, formTail.size() - tailFrom);
+        memcpy(data, formTail.constData() + tailFrom, tailBytes);
+        return tailBytes;
+    }
+
+    qint64 granted = RateLimiter::takeFromAll(myLimiters, qMin(maxlen, fileLeft));
+    if (granted <= 0)
+    {
+        if (!waitTimer->isActive()) waitTimer->start(RateLimiter::msecUntilAllAvailable(myLimiters));
+        return 0;
+    }
+
+    qint64 bytesRead = theFile.read(data, granted);
+    if (bytesRead > 0)
+    {
+        if (filePos == streamCrc.length()) streamCrc.update(data, bytesRead);
+        else crcInOrder = false;
+    }
+    if (bytesRead < granted)
+    {
+        for (const QSharedPointer<RateLimiter> &aLimiter : myLimiters)
+        {
+            aLimiter->giveBack(granted - qMax((qint64) 0, bytesRead));
+        }
+    }
+    return bytesRead;
+}
+
+qint64 ThrottledFileDevice::writeData(const char *, qint64)
+{
+    return -1;
+}
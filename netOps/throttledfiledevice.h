@@ -0,0 +1,106 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef THROTTLEDFILEDEVICE_H
+#define THROTTLEDFILEDEVICE_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+
+#include "utilFuncs/crc32c.h"
+
+class QTimer;
+class RateLimiter;
+
+/*! \brief A ThrottledFileDevice reads a local file for upload, no faster than its RateLimiters allow.
+ *
+ *  When the limiters have nothing to give, a read returns no bytes, and readyRead() is emitted once they do. The device is read only, and must be used in one thread.
+ *
+ *  The device must be given to the QNetworkAccessManager as the whole request body, which waits for readyRead() after an empty read. It must not be the body of a QHttpPart, since a QHttpMultiPart reads its parts in a loop until it has all it asked for. To send the file as a form upload, setFormPart() wraps it in the multipart framing itself.
+ *
+ *  The device also takes the CRC-32C of the bytes as they are read. If the file is read again from the start, the checksum starts over.
+ */
+
+class ThrottledFileDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit ThrottledFileDevice(QString filePath, QList<QSharedPointer<RateLimiter>> limiterList, QObject *parent = nullptr);
+
+    /*! \brief Wraps the file in one multipart/form-data part, and returns the Content-Type to send the device with. Only the file's own bytes are throttled and checksummed.
+     *
+     *  Must be called before open().
+     */
+    QByteArray setFormPart(QString fieldName, QString fileName);
+
+    /*! \brief Limits the device to length bytes of the file, starting at firstByte, as if they were the whole file. Must be called before open().
+     */
+    void setFileRange(qint64 firstByte, qint64 length);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    qint64 size() const override;
+    bool seek(qint64 pos) override;
+
+    /*! \brief Returns true if the checksum covers the whole file, read once in order from the start.
+     */
+    bool hasChecksum() const;
+    quint32 getChecksum() const;
+
+    /*! \brief Returns the size of the file, or of its range, without any form framing.
+     */
+    qint64 fileSize() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override;
+
+private:
+    QFile theFile;
+    QList<QSharedPointer<RateLimiter>> myLimiters;
+    QTimer * waitTimer = nullptr;
+
+    QByteArray formHead;
+    QByteArray formTail;
+    qint64 rangeStart = 0;
+    qint64 rangeLength = -1;
+
+    Crc32c streamCrc;
+    bool crcInOrder = true;
+};
+
+#endif // THROTTLEDFILEDEVICE_H
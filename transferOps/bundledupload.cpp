@@ -0,0 +1,332 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "bundledupload.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <algorithm>
+
+#include "remotedatainterface.h"
+
+#include "jobOps/jobpoller.h"
+#include "jobOps/jobstore.h"
+
+#include "transferOps/transferqueue.h"
+#include "transferOps/folderuploader.h"
+#include "utilFuncs/tarwriter.h"
+#include "ae_globals.h"
+
+const int BundledUpload::minBundleFiles;
+const qint64 BundledUpload::smallFileLimit;
+const qint64 BundledUpload::maxBundleSize;
+const QString BundledUpload::extractApp = "extract";
+
+BundleBuilder::BundleBuilder(QString rootFolder, QString newArchivePath) : QObject(nullptr)
+{
+    rootPath = rootFolder;
+    archivePath = newArchivePath;
+}
+
+void BundleBuilder::cancel()
+{
+    cancelled.store(1);
+}
+
+void BundleBuilder::startBuild()
+{
+    QDir rootDir(rootPath);
+    if (!rootDir.exists())
+    {
+        emit bundleFailed(QString("Unable to read local folder: %1").arg(rootPath));
+        return;
+    }
+
+    //The whole tree is scanned first, as the choice depends on every file's size
+    QStringList folderList;
+    QStringList fileList;
+    QList<qint64> sizeList;
+
+    QStringList scanQueue("");
+    while (!scanQueue.isEmpty() && (cancelled.load() == 0))
+    {
+        QString relativeFolder = scanQueue.takeFirst();
+        QDir currentDir(rootDir.filePath(relativeFolder));
+        QString prefix = relativeFolder.isEmpty() ? QString() : relativeFolder + "/";
+
+        for (const QFileInfo &anEntry : currentDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Hidden, QDir::Name))
+        {
+            folderList.append(prefix + anEntry.fileName());
+            scanQueue.append(prefix + anEntry.fileName());
+        }
+        for (const QFileInfo &anEntry : currentDir.entryInfoList(QDir::Files | QDir::Readable | QDir::Hidden, QDir::Name))
+        {
+            fileList.append(prefix + anEntry.fileName());
+            sizeList.append(anEntry.size());
+        }
+    }
+    if (cancelled.load() != 0) return;
+
+    if (!BundledUpload::shouldBundle(sizeList))
+    {
+        emit bundleSkipped(QString("%1 files, not enough small files to bundle").arg(fileList.size()));
+        return;
+    }
+
+    //Every path in the archive starts with the root folder's name, so extract recreates it
+    QString rootName = rootDir.dirName();
+    TarWriter theArchive(archivePath);
+    if (!theArchive.open() || !theArchive.addFolder(rootName))
+    {
+        emit bundleFailed(theArchive.errorString());
+        return;
+    }
+    for (QString aFolder : folderList)
+    {
+        if (!theArchive.addFolder(rootName + "/" + aFolder))
+        {
+            emit bundleFailed(theArchive.errorString());
+            return;
+        }
+    }
+    for (int i = 0; i < fileList.size(); i++)
+    {
+        if (cancelled.load() != 0) return;
+        if (!theArchive.addFile(rootDir.filePath(fileList.at(i)), rootName + "/" + fileList.at(i)))
+        {
+            emit bundleFailed(theArchive.errorString());
+            return;
+        }
+        if ((i % 100) == 99) emit bundleProgress(i + 1, fileList.size());
+    }
+    if (!theArchive.finish())
+    {
+        emit bundleFailed(theArchive.errorString());
+        return;
+    }
+
+    emit bundleReady(fileList.size(), QFileInfo(archivePath).size());
+}
+
+BundledUpload::BundledUpload(QString localFolder, QString newRemoteParent, QObject *parent) : QObject(parent)
+{
+    localRoot = QDir::cleanPath(QDir(localFolder).absolutePath());
+    remoteParent = newRemoteParent;
+    archiveName = QString("%1.bundle.tar").arg(QDir(localRoot).dirName());
+}
+
+BundledUpload::~BundledUpload()
+{
+    if (theBuilder != nullptr) theBuilder->cancel();
+    buildThread.quit();
+    buildThread.wait();
+}
+
+void BundledUpload::start()
+{
+    if (!archiveFolder.isValid())
+    {
+        bundleSkipped("No temporary folder for the archive");
+        return;
+    }
+
+    theBuilder = new BundleBuilder(localRoot, archiveFolder.filePath(archiveName));
+    theBuilder->moveToThread(&buildThread);
+    QObject::connect(&buildThread, SIGNAL(finished()), theBuilder, SLOT(deleteLater()));
+    QObject::connect(theBuilder, SIGNAL(bundleProgress(int,int)), this, SLOT(bundleProgress(int,int)));
+    QObject::connect(theBuilder, SIGNAL(bundleReady(int,qint64)), this, SLOT(bundleReady(int,qint64)));
+    QObject::connect(theBuilder, SIGNAL(bundleSkipped(QString)), this, SLOT(bundleSkipped(QString)));
+    QObject::connect(theBuilder, SIGNAL(bundleFailed(QString)), this, SLOT(bundleFailed(QString)));
+    buildThread.start();
+    QMetaObject::invokeMethod(theBuilder, "startBuild", Qt::QueuedConnection);
+}
+
+bool BundledUpload::shouldBundle(QList<qint64> fileSizes)
+{
+    if (fileSizes.size() < minBundleFiles) return false;
+
+    qint64 totalSize = 0;
+    int smallFiles = 0;
+    for (qint64 aSize : fileSizes)
+    {
+        totalSize += aSize;
+        if (aSize <= smallFileLimit) smallFiles++;
+    }
+
+    if (totalSize > maxBundleSize) return false;
+    return (2 * smallFiles >= fileSizes.size());
+}
+
+void BundledUpload::bundleProgress(int filesBundled, int filesFound)
+{
+    emit folderUploadProgress(0, 0, filesBundled, filesFound);
+}
+
+void BundledUpload::bundleReady(int fileCount, qint64 archiveSize)
+{
+    buildThread.quit();
+    theBuilder = nullptr;
+    bundledFiles = fileCount;
+
+    qCDebug(agaveAppLayer, "Bundled %d files of %s into %lld bytes", fileCount, qPrintable(localRoot), archiveSize);
+
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    QObject::connect(theQueue, SIGNAL(transferFinished(int,RequestState)), this, SLOT(archiveUploaded(int,RequestState)));
+    archiveTransferID = theQueue->enqueueUpload(archiveFolder.filePath(archiveName), remoteParent, archiveSize, TransferPriority::BACKGROUND);
+    if (archiveTransferID < 0)
+    {
+        QObject::disconnect(theQueue, SIGNAL(transferFinished(int,RequestState)), this, SLOT(archiveUploaded(int,RequestState)));
+        QFile::remove(archiveFolder.filePath(archiveName));
+        finishUpload(RequestState::EXPLICIT_ERROR, QString("Unable to queue the upload of the bundle of %1").arg(localRoot));
+    }
+}
+
+void BundledUpload::bundleSkipped(QString reason)
+{
+    buildThread.quit();
+    theBuilder = nullptr;
+
+    qCDebug(agaveAppLayer, "Uploading %s file by file: %s", qPrintable(localRoot), qPrintable(reason));
+
+    //The per-file uploader reports through this object's signals
+    FolderUploader * fileUploader = new FolderUploader(localRoot, remoteParent, this);
+    QObject::connect(fileUploader, SIGNAL(folderUploadProgress(int,int,int,int)), this, SIGNAL(folderUploadProgress(int,int,int,int)));
+    QObject::connect(fileUploader, SIGNAL(folderUploadFinished(RequestState,QString)), this, SIGNAL(folderUploadFinished(RequestState,QString)));
+    fileUploader->start();
+}
+
+void BundledUpload::bundleFailed(QString reason)
+{
+    buildThread.quit();
+    theBuilder = nullptr;
+    finishUpload(RequestState::EXPLICIT_ERROR, QString("Unable to bundle folder: %1").arg(reason));
+}
+
+void BundledUpload::archiveUploaded(int transferID, RequestState finalState)
+{
+    if (transferID != archiveTransferID) return;
+    QObject::disconnect(ae_globals::get_transfer_queue(), SIGNAL(transferFinished(int,RequestState)), this, SLOT(archiveUploaded(int,RequestState)));
+    QFile::remove(archiveFolder.filePath(archiveName));
+
+    if (finalState != RequestState::GOOD)
+    {
+        finishUpload(RequestState::EXPLICIT_ERROR, QString("Unable to upload bundle of %1").arg(localRoot));
+        return;
+    }
+
+    RemoteDataReply * jobReply = ae_globals::get_connection()->runRemoteJob(extractApp, QMultiMap<QString, QString>(), remoteParent + "/" + archiveName);
+    if (jobReply == nullptr)
+    {
+        finishUpload(RequestState::EXPLICIT_ERROR, "Unable to start remote extraction of the bundle.");
+        return;
+    }
+    QObject::connect(jobReply, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
+                     this, SLOT(extractReply(RequestState,QJsonDocument)));
+}
+
+void BundledUpload::extractReply(RequestState replyState, QJsonDocument rawReply)
+{
+    if (replyState != RequestState::GOOD)
+    {
+        finishUpload(RequestState::EXPLICIT_ERROR, QString("Bundle of %1 uploaded, but the extract job could not be started.").arg(localRoot));
+        return;
+    }
+    extractJobID = ae_globals::get_job_poller()->jobSubmitted(rawReply);
+    if (extractJobID.isEmpty())
+    {
+        finishUpload(RequestState::EXPLICIT_ERROR, QString("Bundle of %1 uploaded, but the extract job could not be followed.").arg(localRoot));
+        return;
+    }
+    QObject::connect(ae_globals::get_job_store(), SIGNAL(jobChanged(QString)), this, SLOT(extractJobChanged(QString)));
+    QObject::connect(ae_globals::get_job_poller(), SIGNAL(watchAbandoned(QString)), this, SLOT(extractJobAbandoned(QString)));
+    extractJobChanged(extractJobID);
+}
+
+void BundledUpload::extractJobChanged(QString jobID)
+{
+    if (uploadEnded || (jobID != extractJobID)) return;
+    QString jobStatus = ae_globals::get_job_store()->getJob(jobID).status;
+    if (!JobStore::isTerminal(jobStatus)) return;
+
+    QObject::disconnect(ae_globals::get_job_store(), SIGNAL(jobChanged(QString)), this, SLOT(extractJobChanged(QString)));
+    QObject::disconnect(ae_globals::get_job_poller(), SIGNAL(watchAbandoned(QString)), this, SLOT(extractJobAbandoned(QString)));
+
+    QString remoteArchive = remoteParent + "/" + archiveName;
+    if (jobStatus != "FINISHED")
+    {
+        finishUpload(RequestState::EXPLICIT_ERROR, QString("The extract job for %1 ended with status %2. The bundle is left at %3.")
+                     .arg(localRoot, jobStatus, remoteArchive));
+        return;
+    }
+
+    //The files are in place; only the bundle is left to remove
+    RemoteDataReply * deleteReply = ae_globals::get_connection()->deleteFile(remoteArchive);
+    if (deleteReply == nullptr)
+    {
+        bundleDeleteReply(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    QObject::connect(deleteReply, SIGNAL(haveDeleteReply(RequestState)), this, SLOT(bundleDeleteReply(RequestState)));
+}
+
+void BundledUpload::extractJobAbandoned(QString jobID)
+{
+    if (uploadEnded || (jobID != extractJobID)) return;
+    finishUpload(RequestState::EXPLICIT_ERROR, QString("Bundle of %1 uploaded, but the extract job could no longer be read.").arg(localRoot));
+}
+
+void BundledUpload::bundleDeleteReply(RequestState replyState)
+{
+    if (replyState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Unable to remove uploaded bundle: %s/%s", qPrintable(remoteParent), qPrintable(archiveName));
+        finishUpload(RequestState::GOOD, QString("Uploaded %1 files as one bundle. The bundle %2 could not be removed.").arg(bundledFiles).arg(archiveName));
+        return;
+    }
+    finishUpload(RequestState::GOOD, QString("Uploaded %1 files as one bundle.").arg(bundledFiles));
+}
+
+void BundledUpload::finishUpload(RequestState finalState, QString message)
+{
+    if (uploadEnded) return;
+    uploadEnded = true;
+
+    if (finalState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Bundled upload of %s failed: %s", qPrintable(localRoot), qPrintable(message));
+    }
+    emit folderUploadFinished(finalState, message);
+}
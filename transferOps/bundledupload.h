@@ -0,0 +1,135 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef BUNDLEDUPLOAD_H
+#define BUNDLEDUPLOAD_H
+
+#include <QObject>
+#include <QThread>
+#include <QAtomicInt>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+
+class FolderUploader;
+enum class RequestState;
+
+/*! \brief The BundleBuilder scans a local folder tree in its own thread, decides whether to bundle it, and if so writes the tar archive.
+ */
+
+class BundleBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    BundleBuilder(QString rootFolder, QString archivePath);
+
+    void cancel();
+
+signals:
+    void bundleProgress(int filesBundled, int filesFound);
+    void bundleReady(int fileCount, qint64 archiveSize);
+    void bundleSkipped(QString reason);
+    void bundleFailed(QString reason);
+
+public slots:
+    void startBuild();
+
+private:
+    QString rootPath;
+    QString archivePath;
+    QAtomicInt cancelled;
+};
+
+/*! \brief The BundledUpload uploads a local folder either as one tar archive, expanded remotely with the extract app, or file by file.
+ *
+ *  Uploading thousands of tiny files costs one round trip each. When a folder is mostly small files, it is cheaper to pack them locally, upload the one archive, and run extract on the remote side. The choice is made by shouldBundle(), from the file count and size distribution found by a scan. Otherwise, the upload is handed to a FolderUploader.
+ *
+ *  A bundled upload is only finished once the extract job is FINISHED, which the JobPoller follows. The uploaded archive is then deleted from the server. If the job ends any other way, the upload fails, and the archive is left in place.
+ *
+ *  Either way, progress and the result are given with the same signals as the FolderUploader.
+ */
+
+class BundledUpload : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BundledUpload(QString localFolder, QString remoteParent, QObject *parent = nullptr);
+    ~BundledUpload();
+
+    void start();
+
+    /*! \brief Decides whether a folder with these file sizes should be bundled.
+     *
+     *  Bundling is chosen when there are at least minBundleFiles files, at least half of them are no larger than smallFileLimit, and the total fits in maxBundleSize.
+     */
+    static bool shouldBundle(QList<qint64> fileSizes);
+
+    static const int minBundleFiles = 64;
+    static const qint64 smallFileLimit = 256 * 1024;
+    static const qint64 maxBundleSize = 1024 * 1024 * 1024;
+    static const QString extractApp;
+
+signals:
+    void folderUploadProgress(int foldersCreated, int foldersFound, int filesDone, int filesFound);
+    void folderUploadFinished(RequestState finalState, QString message);
+
+private slots:
+    void bundleProgress(int filesBundled, int filesFound);
+    void bundleReady(int fileCount, qint64 archiveSize);
+    void bundleSkipped(QString reason);
+    void bundleFailed(QString reason);
+    void archiveUploaded(int transferID, RequestState finalState);
+    void extractReply(RequestState replyState, QJsonDocument rawReply);
+    void extractJobChanged(QString jobID);
+    void extractJobAbandoned(QString jobID);
+    void bundleDeleteReply(RequestState replyState);
+
+private:
+    void finishUpload(RequestState finalState, QString message);
+
+    QString localRoot;
+    QString remoteParent;
+    QString archiveName;
+
+    QTemporaryDir archiveFolder;
+    QThread buildThread;
+    BundleBuilder * theBuilder = nullptr;
+
+    int bundledFiles = 0;
+    int archiveTransferID = -1;
+    QString extractJobID;
+    bool uploadEnded = false;
+};
+
+#endif // BUNDLEDUPLOAD_H
@@ -0,0 +1,630 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "chunkeduploader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPointer>
+
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "jobOps/jobstore.h"
+#include "jobOps/jobpoller.h"
+#include "ae_globals.h"
+
+const qint64 ChunkedUploader::chunkSize;
+const qint64 ChunkedUploader::chunkThreshold;
+const int ChunkedUploader::maxBufferedChunks;
+const QString ChunkedUploader::assemblyApp = "concat";
+
+class ChunkedUploader::ChunkReadTask : public QRunnable
+{
+public:
+    ChunkReadTask(ChunkedUploader * newUploader, QString newLocalPath, int newChunkNum, qint64 newChunkLength)
+    {
+        theUploader = newUploader;
+        localPath = newLocalPath;
+        chunkNum = newChunkNum;
+        chunkLength = newChunkLength;
+    }
+
+    void run()
+    {
+        QByteArray chunkData;
+        QFile localFile(localPath);
+        bool readOkay = localFile.open(QIODevice::ReadOnly) && localFile.seek(chunkNum * chunkSize);
+        if (readOkay)
+        {
+            chunkData = localFile.read(chunkLength);
+            readOkay = (chunkData.size() == chunkLength);
+        }
+
+        QMetaObject::invokeMethod(theUploader, "chunkRead", Qt::QueuedConnection, Q_ARG(QString, localPath),
+                                  Q_ARG(int, chunkNum), Q_ARG(QByteArray, chunkData), Q_ARG(bool, readOkay));
+    }
+
+private:
+    QPointer<ChunkedUploader> theUploader;
+    QString localPath;
+    int chunkNum;
+    qint64 chunkLength;
+};
+
+ChunkedUploader::ChunkedUploader(QObject *parent) : QObject(parent)
+{
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        maxChunksInFlight = 2 * ae_globals::get_lane_pool()->bulkLaneCount();
+    }
+}
+
+void ChunkedUploader::openManifests(QString userName, QString storageSystem)
+{
+    QByteArray accountKey = QString("%1@%2").arg(userName, storageSystem).toUtf8();
+    manifestFolder = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/chunkedUploads/"
+            + QCryptographicHash::hash(accountKey, QCryptographicHash::Sha1).toHex();
+}
+
+bool ChunkedUploader::startUpload(QString localFile, QString remoteFolder)
+{
+    QFileInfo localInfo(localFile);
+    if (!localInfo.isFile() || !localInfo.isReadable()) return false;
+
+    QString localPath = localInfo.absoluteFilePath();
+    for (const ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath == localPath) return true;
+    }
+
+    ChunkedUploadJob newJob = loadManifest(localPath);
+    if ((newJob.remoteFolder != remoteFolder) || (newJob.fileSize != localInfo.size()) ||
+            (newJob.localModified != localInfo.lastModified().toMSecsSinceEpoch()))
+    {
+        //No manifest, or the file changed since it was written: start from the first chunk
+        newJob = ChunkedUploadJob();
+        newJob.localPath = localPath;
+        newJob.remoteFolder = remoteFolder;
+        newJob.fileName = localInfo.fileName();
+        newJob.fileSize = localInfo.size();
+        newJob.localModified = localInfo.lastModified().toMSecsSinceEpoch();
+    }
+    newJob.chunkCount = (int)((newJob.fileSize + chunkSize - 1) / chunkSize);
+    if (newJob.chunkCount == 0) newJob.chunkCount = 1;
+
+    jobList.append(newJob);
+    saveManifest(newJob);
+
+    suspended = false;
+    verifyStagingFolder(&jobList.last());
+    return true;
+}
+
+QStringList ChunkedUploader::pendingUploads()
+{
+    QStringList ret;
+    if (manifestFolder.isEmpty()) return ret;
+
+    QDir manifestDir(manifestFolder);
+    for (QFileInfo aManifest : manifestDir.entryInfoList(QStringList("*.json"), QDir::Files))
+    {
+        QFile manifestFile(aManifest.absoluteFilePath());
+        if (!manifestFile.open(QIODevice::ReadOnly)) continue;
+        QString localPath = QJsonDocument::fromJson(manifestFile.readAll()).object().value("localPath").toString();
+        if (localPath.isEmpty()) continue;
+
+        bool isRunning = false;
+        for (const ChunkedUploadJob &aJob : jobList)
+        {
+            if (aJob.localPath == localPath) isRunning = true;
+        }
+        if (!isRunning) ret.append(localPath);
+    }
+
+    return ret;
+}
+
+QString ChunkedUploader::pendingRemoteFolder(QString localFile)
+{
+    return loadManifest(localFile).remoteFolder;
+}
+
+bool ChunkedUploader::resumeUpload(QString localFile)
+{
+    ChunkedUploadJob savedJob = loadManifest(localFile);
+    if (savedJob.localPath.isEmpty()) return false;
+
+    if (!startUpload(savedJob.localPath, savedJob.remoteFolder))
+    {
+        qCDebug(agaveAppLayer, "Local file for interrupted upload is gone: %s", qPrintable(localFile));
+        removeManifest(localFile);
+        return false;
+    }
+    return true;
+}
+
+void ChunkedUploader::discardUpload(QString localFile)
+{
+    //Note: The remote staging folder is left in place, and can be deleted from the file tree
+    removeManifest(localFile);
+}
+
+void ChunkedUploader::suspendAll()
+{
+    suspended = true;
+    for (const ChunkedUploadJob &aJob : jobList)
+    {
+        saveManifest(aJob);
+    }
+}
+
+void ChunkedUploader::setAssemblyAvailable(bool isAvailable)
+{
+    assemblerKnown = isAvailable;
+}
+
+bool ChunkedUploader::assemblyAvailable()
+{
+    return assemblerKnown;
+}
+
+bool ChunkedUploader::fileShouldBeChunked(qint64 fileSize)
+{
+    return (assemblerKnown && (fileSize >= chunkThreshold));
+}
+
+void ChunkedUploader::stagingListReply(RequestState replyState, QList<FileMetaData> partList)
+{
+    QString localPath = pendingRequests.take(sender());
+    ChunkedUploadJob * theJob = nullptr;
+    for (ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath == localPath) theJob = &aJob;
+    }
+    if (theJob == nullptr) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        //No staging folder yet, so nothing can have been confirmed
+        theJob->confirmedChunks.clear();
+        RemoteDataReply * mkdirReply = ae_globals::get_connection()->createFolder(theJob->remoteFolder, QString(".%1.chunks").arg(theJob->fileName));
+        if (mkdirReply == nullptr)
+        {
+            finishJob(localPath, RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        pendingRequests.insert(mkdirReply, localPath);
+        QObject::connect(mkdirReply, SIGNAL(haveMkdirReply(RequestState,FileMetaData)),
+                         this, SLOT(stagingFolderReply(RequestState,FileMetaData)));
+        return;
+    }
+
+    //Only chunks which the manifest confirmed, and which are still on the remote side at full size, are kept
+    QSet<int> stillPresent;
+    for (const FileMetaData &aPart : partList)
+    {
+        for (int chunkNum : theJob->confirmedChunks)
+        {
+            if (aPart.getFileName() != partName(chunkNum)) continue;
+            qint64 expectedSize = qMin(chunkSize, theJob->fileSize - chunkNum * chunkSize);
+            if (aPart.getSize() == expectedSize) stillPresent.insert(chunkNum);
+        }
+    }
+    theJob->confirmedChunks = stillPresent;
+    theJob->running = true;
+    saveManifest(*theJob);
+
+    qCDebug(agaveAppLayer, "Resuming %s at %d of %d chunks", qPrintable(theJob->fileName), stillPresent.size(), theJob->chunkCount);
+    emit uploadProgress(localPath, theJob->confirmedChunks.size(), theJob->chunkCount);
+
+    if (theJob->confirmedChunks.size() == theJob->chunkCount)
+    {
+        startAssembly(theJob);
+        return;
+    }
+    sendNextChunks();
+}
+
+void ChunkedUploader::stagingFolderReply(RequestState replyState, FileMetaData)
+{
+    QString localPath = pendingRequests.take(sender());
+    for (ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath != localPath) continue;
+
+        if (replyState != RequestState::GOOD)
+        {
+            finishJob(localPath, replyState);
+            return;
+        }
+        aJob.running = true;
+        sendNextChunks();
+        return;
+    }
+}
+
+void ChunkedUploader::chunkReply(RequestState replyState, FileMetaData)
+{
+    if (!pendingChunks.contains(sender())) return;
+    chunkDone(pendingChunks.take(sender()), replyState);
+}
+
+void ChunkedUploader::chunkTaskReply(RequestState replyState, QByteArray, qint64)
+{
+    if (!pendingChunks.contains(sender())) return;
+    chunkDone(pendingChunks.take(sender()), replyState);
+}
+
+void ChunkedUploader::chunkRead(QString localPath, int chunkNum, QByteArray chunkData, bool readOkay)
+{
+    ChunkRef theChunk;
+    theChunk.localPath = localPath;
+    theChunk.chunkNum = chunkNum;
+
+    ChunkedUploadJob * theJob = nullptr;
+    for (ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath == localPath) theJob = &aJob;
+    }
+    if (!readOkay || (theJob == nullptr) || theJob->failed)
+    {
+        chunkDone(theChunk, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+    RemoteDataReply * partReply = theLane->uploadBuffer(stagingFolder(*theJob), chunkData, partName(chunkNum));
+    if (partReply == nullptr)
+    {
+        chunkDone(theChunk, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    ae_globals::get_lane_pool()->trackReply(theLane, partReply);
+    pendingChunks.insert(partReply, theChunk);
+    QObject::connect(partReply, SIGNAL(haveUploadReply(RequestState,FileMetaData)),
+                     this, SLOT(chunkReply(RequestState,FileMetaData)));
+}
+
+void ChunkedUploader::chunkDone(ChunkRef theChunk, RequestState replyState)
+{
+    chunksInFlight--;
+
+    ChunkedUploadJob * theJob = nullptr;
+    for (ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath == theChunk.localPath) theJob = &aJob;
+    }
+    if (theJob == nullptr)
+    {
+        sendNextChunks();
+        return;
+    }
+    theJob->activeChunks.remove(theChunk.chunkNum);
+
+    if (replyState != RequestState::GOOD)
+    {
+        //The manifest keeps every chunk confirmed so far, so the upload can be resumed later
+        failJob(theJob);
+        sendNextChunks();
+        return;
+    }
+
+    theJob->confirmedChunks.insert(theChunk.chunkNum);
+    saveManifest(*theJob);
+    emit uploadProgress(theJob->localPath, theJob->confirmedChunks.size(), theJob->chunkCount);
+
+    if (theJob->failed)
+    {
+        if (theJob->activeChunks.isEmpty()) finishJob(theJob->localPath, RequestState::EXPLICIT_ERROR);
+    }
+    else if (theJob->confirmedChunks.size() == theJob->chunkCount)
+    {
+        startAssembly(theJob);
+    }
+    sendNextChunks();
+}
+
+void ChunkedUploader::assemblyReply(RequestState replyState, QJsonDocument rawReply)
+{
+    QString localPath = pendingRequests.take(sender());
+    if (replyState != RequestState::GOOD)
+    {
+        finishJob(localPath, replyState);
+        return;
+    }
+
+    //The submission only means the job was accepted; the parts are joined when it runs
+    QString jobID = ae_globals::get_job_poller()->jobSubmitted(rawReply);
+    if (jobID.isEmpty())
+    {
+        qCDebug(agaveAppLayer, "Assembly job for %s could not be followed, chunks left staged", qPrintable(localPath));
+        finishJob(localPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    assemblyJobs.insert(jobID, localPath);
+    QObject::connect(ae_globals::get_job_store(), SIGNAL(jobChanged(QString)),
+                     this, SLOT(assemblyJobChanged(QString)), Qt::UniqueConnection);
+    QObject::connect(ae_globals::get_job_poller(), SIGNAL(watchAbandoned(QString)),
+                     this, SLOT(assemblyJobAbandoned(QString)), Qt::UniqueConnection);
+    assemblyJobChanged(jobID);
+}
+
+void ChunkedUploader::assemblyJobChanged(QString jobID)
+{
+    if (!assemblyJobs.contains(jobID)) return;
+    QString jobStatus = ae_globals::get_job_store()->getJob(jobID).status;
+    if (!JobStore::isTerminal(jobStatus)) return;
+
+    QString localPath = assemblyJobs.take(jobID);
+    if (jobStatus != "FINISHED")
+    {
+        qCDebug(agaveAppLayer, "Assembly job %s ended with status %s, chunks left staged", qPrintable(jobID), qPrintable(jobStatus));
+        finishJob(localPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    for (const ChunkedUploadJob &aJob : jobList)
+    {
+        if (aJob.localPath != localPath) continue;
+
+        RemoteDataReply * deleteReply = ae_globals::get_connection()->deleteFile(stagingFolder(aJob));
+        if (deleteReply != nullptr)
+        {
+            pendingRequests.insert(deleteReply, stagingFolder(aJob));
+            QObject::connect(deleteReply, SIGNAL(haveDeleteReply(RequestState)),
+                             this, SLOT(stagingDeleteReply(RequestState)));
+        }
+        break;
+    }
+
+    for (int i = 0; i < jobList.size(); i++)
+    {
+        if (jobList.at(i).localPath != localPath) continue;
+        jobList.removeAt(i);
+        break;
+    }
+    removeManifest(localPath);
+    emit uploadFinished(localPath, RequestState::GOOD);
+}
+
+void ChunkedUploader::assemblyJobAbandoned(QString jobID)
+{
+    if (!assemblyJobs.contains(jobID)) return;
+    finishJob(assemblyJobs.take(jobID), RequestState::EXPLICIT_ERROR);
+}
+
+void ChunkedUploader::stagingDeleteReply(RequestState replyState)
+{
+    QString stagingPath = pendingRequests.take(sender());
+    if (replyState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Unable to remove staging folder: %s", qPrintable(stagingPath));
+    }
+}
+
+void ChunkedUploader::verifyStagingFolder(ChunkedUploadJob * theJob)
+{
+    RemoteDataReply * lsReply = ae_globals::get_connection()->remoteLS(stagingFolder(*theJob));
+    if (lsReply == nullptr)
+    {
+        finishJob(theJob->localPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    pendingRequests.insert(lsReply, theJob->localPath);
+    QObject::connect(lsReply, SIGNAL(haveLSReply(RequestState,QList<FileMetaData>)),
+                     this, SLOT(stagingListReply(RequestState,QList<FileMetaData>)));
+}
+
+void ChunkedUploader::sendNextChunks()
+{
+    if (suspended) return;
+
+    //Chunks for the bulk connection are held in memory whole, so fewer of them are sent at once
+    AgaveRestSession * theSession = nullptr;
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    }
+    int chunkLimit = (theSession != nullptr) ? maxChunksInFlight : qMin(maxChunksInFlight, maxBufferedChunks);
+
+    for (ChunkedUploadJob &aJob : jobList)
+    {
+        if (!aJob.running) continue;
+
+        for (int chunkNum = 0; chunkNum < aJob.chunkCount; chunkNum++)
+        {
+            if (chunksInFlight >= chunkLimit) return;
+            if (aJob.confirmedChunks.contains(chunkNum) || aJob.activeChunks.contains(chunkNum)) continue;
+
+            ChunkRef newRef;
+            newRef.localPath = aJob.localPath;
+            newRef.chunkNum = chunkNum;
+            aJob.activeChunks.insert(chunkNum);
+            chunksInFlight++;
+
+            qint64 chunkStart = chunkNum * chunkSize;
+            qint64 chunkLength = qMin(chunkSize, aJob.fileSize - chunkStart);
+            if (theSession == nullptr)
+            {
+                //The GUI thread does not wait on the disk; the chunk is sent from chunkRead()
+                QThreadPool::globalInstance()->start(new ChunkReadTask(this, aJob.localPath, chunkNum, chunkLength));
+                continue;
+            }
+
+            RestTask * partTask = theSession->newMediaUpload(aJob.localPath, stagingFolder(aJob));
+            partTask->setUploadFile(aJob.localPath, partName(chunkNum));
+            partTask->setUploadRange(chunkStart, chunkLength);
+            pendingChunks.insert(partTask, newRef);
+            QObject::connect(partTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                             this, SLOT(chunkTaskReply(RequestState,QByteArray,qint64)));
+            theSession->submitTask(partTask);
+        }
+    }
+}
+
+void ChunkedUploader::startAssembly(ChunkedUploadJob * theJob)
+{
+    theJob->running = false;
+
+    if (!assemblerKnown)
+    {
+        //All chunks are staged; the manifest stays, and assembly is retried when the upload is resumed
+        qCDebug(agaveAppLayer, "The %s app is not available, chunks left staged for: %s", qPrintable(assemblyApp), qPrintable(theJob->fileName));
+        finishJob(theJob->localPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    QMultiMap<QString, QString> assemblyInputs;
+    assemblyInputs.insert("outputFile", QString("%1/%2").arg(theJob->remoteFolder, theJob->fileName));
+
+    RemoteDataReply * jobReply = ae_globals::get_connection()->runRemoteJob(assemblyApp, assemblyInputs, stagingFolder(*theJob));
+    if (jobReply == nullptr)
+    {
+        finishJob(theJob->localPath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    pendingRequests.insert(jobReply, theJob->localPath);
+    QObject::connect(jobReply, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
+                     this, SLOT(assemblyReply(RequestState,QJsonDocument)));
+}
+
+void ChunkedUploader::failJob(ChunkedUploadJob * theJob)
+{
+    theJob->running = false;
+    theJob->failed = true;
+
+    //Outstanding chunk replies still refer to this job, so it is only removed once they return
+    if (theJob->activeChunks.isEmpty())
+    {
+        finishJob(theJob->localPath, RequestState::EXPLICIT_ERROR);
+    }
+}
+
+void ChunkedUploader::finishJob(QString localPath, RequestState finalState)
+{
+    for (int i = 0; i < jobList.size(); i++)
+    {
+        if (jobList.at(i).localPath != localPath) continue;
+
+        saveManifest(jobList.at(i));
+        jobList.removeAt(i);
+        break;
+    }
+    emit uploadFinished(localPath, finalState);
+}
+
+ChunkedUploader::ChunkedUploadJob ChunkedUploader::loadManifest(QString localPath)
+{
+    ChunkedUploadJob ret;
+
+    QFile manifestFile(manifestPath(localPath));
+    if (!manifestFile.open(QIODevice::ReadOnly)) return ret;
+
+    QJsonObject manifestObj = QJsonDocument::fromJson(manifestFile.readAll()).object();
+    if ((qint64)manifestObj.value("chunkSize").toDouble() != chunkSize) return ret;
+
+    ret.localPath = manifestObj.value("localPath").toString();
+    ret.remoteFolder = manifestObj.value("remoteFolder").toString();
+    ret.fileName = manifestObj.value("fileName").toString();
+    ret.fileSize = (qint64)manifestObj.value("fileSize").toDouble();
+    ret.localModified = (qint64)manifestObj.value("localModified").toDouble();
+    for (QJsonValue aChunk : manifestObj.value("confirmed").toArray())
+    {
+        ret.confirmedChunks.insert(aChunk.toInt());
+    }
+    return ret;
+}
+
+void ChunkedUploader::saveManifest(const ChunkedUploadJob &theJob)
+{
+    if (manifestFolder.isEmpty()) return;
+    QDir().mkpath(manifestFolder);
+
+    QJsonArray confirmedList;
+    for (int chunkNum : theJob.confirmedChunks)
+    {
+        confirmedList.append(chunkNum);
+    }
+
+    QJsonObject manifestObj;
+    manifestObj.insert("localPath", theJob.localPath);
+    manifestObj.insert("remoteFolder", theJob.remoteFolder);
+    manifestObj.insert("fileName", theJob.fileName);
+    manifestObj.insert("fileSize", (double)theJob.fileSize);
+    manifestObj.insert("localModified", (double)theJob.localModified);
+    manifestObj.insert("chunkSize", (double)chunkSize);
+    manifestObj.insert("confirmed", confirmedList);
+
+    //QSaveFile, so that a crash mid-write cannot lose the chunks confirmed earlier
+    QSaveFile manifestFile(manifestPath(theJob.localPath));
+    if (!manifestFile.open(QIODevice::WriteOnly)) return;
+    manifestFile.write(QJsonDocument(manifestObj).toJson(QJsonDocument::Compact));
+    manifestFile.commit();
+}
+
+void ChunkedUploader::removeManifest(QString localPath)
+{
+    QFile::remove(manifestPath(localPath));
+}
+
+QString ChunkedUploader::manifestPath(QString localPath)
+{
+    if (manifestFolder.isEmpty()) return QString();
+    QString pathHash = QCryptographicHash::hash(QFileInfo(localPath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QString("%1/%2.json").arg(manifestFolder, pathHash);
+}
+
+QString ChunkedUploader::stagingFolder(const ChunkedUploadJob &theJob)
+{
+    return QString("%1/.%2.chunks").arg(theJob.remoteFolder, theJob.fileName);
+}
+
+QString ChunkedUploader::partName(int chunkNum)
+{
+    return QString("part.%1").arg(chunkNum, 5, 10, QChar('0'));
+}
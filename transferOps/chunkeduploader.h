@@ -0,0 +1,167 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CHUNKEDUPLOADER_H
+#define CHUNKEDUPLOADER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QJsonDocument>
+
+class FileMetaData;
+enum class RequestState;
+
+/*! \brief The ChunkedUploader sends large files to the remote storage as a series of fixed-size chunks, which can be resumed after an interruption.
+ *
+ *  Agave has no ranged or appending upload, so each chunk is uploaded as a separate part file into a hidden staging folder next to the destination, .<fileName>.chunks. Once every part is confirmed, the concat app is run on the staging folder to join the parts into the final file. The concat job is followed through the JobPoller: the upload only finishes, and the manifest and staging folder are only removed, once the job is FINISHED. If the job fails, the upload fails with the staged chunks kept, so that resuming it runs the assembly again.
+ *
+ *  With the direct transfer sessions up, each chunk is streamed from the file by a RestTask in a lane thread, and is never held in memory whole. Without them, each chunk is read on a QThreadPool thread and handed to the bulk connection as a buffer, and only maxBufferedChunks are sent at once.
+ *
+ *  Progress is recorded in an on-disk manifest after each confirmed chunk, kept in a folder for each user and storage system. On the next startup, pendingUploads() lists the unfinished manifests, and resumeUpload() continues from the parts which are still present on the remote side.
+ */
+
+class ChunkedUploader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChunkedUploader(QObject *parent = nullptr);
+
+    /*! \brief Selects the manifest folder for this user and storage system. Until this is called, there are no pending uploads, and no progress is saved.
+     */
+    void openManifests(QString userName, QString storageSystem);
+
+    /*! \brief Starts (or resumes, if a manifest for it exists) the chunked upload of localFile into remoteFolder.
+     *
+     *  \return false if the local file cannot be read.
+     */
+    bool startUpload(QString localFile, QString remoteFolder);
+
+    /*! \brief Returns the local file paths of uploads which were interrupted in this or a previous session.
+     */
+    QStringList pendingUploads();
+
+    /*! \brief Returns the remote folder an interrupted upload was going to, or an empty string if it has no manifest.
+     */
+    QString pendingRemoteFolder(QString localFile);
+
+    /*! \brief Resumes an interrupted upload.
+     *
+     *  \return false, and the manifest is dropped, if the local file cannot be read.
+     */
+    bool resumeUpload(QString localFile);
+    void discardUpload(QString localFile);
+
+    /*! \brief Stops issuing chunks and saves the manifests. Used by the driver as part of shutdown.
+     */
+    void suspendAll();
+
+    void setAssemblyAvailable(bool isAvailable);
+    bool assemblyAvailable();
+
+    bool fileShouldBeChunked(qint64 fileSize);
+
+    static const qint64 chunkSize = 32 * 1024 * 1024;
+    static const qint64 chunkThreshold = 256 * 1024 * 1024;
+    static const int maxBufferedChunks = 2;
+    static const QString assemblyApp;
+
+signals:
+    void uploadProgress(QString localFile, int chunksConfirmed, int chunksTotal);
+    void uploadFinished(QString localFile, RequestState finalState);
+
+private slots:
+    void stagingListReply(RequestState replyState, QList<FileMetaData> partList);
+    void stagingFolderReply(RequestState replyState, FileMetaData newFolder);
+    void chunkReply(RequestState replyState, FileMetaData newPart);
+    void chunkTaskReply(RequestState replyState, QByteArray, qint64);
+    void chunkRead(QString localPath, int chunkNum, QByteArray chunkData, bool readOkay);
+    void assemblyReply(RequestState replyState, QJsonDocument rawReply);
+    void assemblyJobChanged(QString jobID);
+    void assemblyJobAbandoned(QString jobID);
+    void stagingDeleteReply(RequestState replyState);
+
+private:
+    struct ChunkedUploadJob
+    {
+        QString localPath;
+        QString remoteFolder;
+        QString fileName;
+        qint64 fileSize = 0;
+        qint64 localModified = 0;
+        int chunkCount = 0;
+        QSet<int> confirmedChunks;
+        QSet<int> activeChunks;
+        bool running = false;
+        bool failed = false;
+    };
+
+    struct ChunkRef
+    {
+        QString localPath;
+        int chunkNum;
+    };
+
+    class ChunkReadTask;
+
+    void verifyStagingFolder(ChunkedUploadJob * theJob);
+    void sendNextChunks();
+    void chunkDone(ChunkRef theChunk, RequestState replyState);
+    void startAssembly(ChunkedUploadJob * theJob);
+    void failJob(ChunkedUploadJob * theJob);
+    void finishJob(QString localPath, RequestState finalState);
+
+    ChunkedUploadJob loadManifest(QString localPath);
+    void saveManifest(const ChunkedUploadJob &theJob);
+    void removeManifest(QString localPath);
+
+    QString manifestPath(QString localPath);
+    static QString stagingFolder(const ChunkedUploadJob &theJob);
+    static QString partName(int chunkNum);
+
+    QList<ChunkedUploadJob> jobList;
+    QHash<QObject *, QString> pendingRequests;
+    QHash<QObject *, ChunkRef> pendingChunks;
+    QHash<QString, QString> assemblyJobs;
+    QString manifestFolder;
+
+    int chunksInFlight = 0;
+    int maxChunksInFlight = 4;
+    bool suspended = false;
+    bool assemblerKnown = false;
+};
+
+#endif // CHUNKEDUPLOADER_H
@@ -0,0 +1,304 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "compresseddownload.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "transferOps/segmenteddownload.h"
+#include "jobOps/jobstore.h"
+#include "jobOps/jobpoller.h"
+#include "ae_globals.h"
+
+const QString CompressedFolderDownload::compressApp = "compress";
+
+CompressedFolderDownload::CompressedFolderDownload(QString newRemoteFolder, QString newLocalParent, QObject *parent) : QObject(parent)
+{
+    remoteFolder = newRemoteFolder;
+    while (remoteFolder.endsWith('/')) remoteFolder.chop(1);
+    remoteParent = remoteFolder.section('/', 0, -2);
+    localParent = newLocalParent;
+
+    QObject::connect(&extractProcess, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(extractDone(int,QProcess::ExitStatus)));
+    QObject::connect(&extractProcess, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(extractError(QProcess::ProcessError)));
+}
+
+void CompressedFolderDownload::start()
+{
+    if (ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE) == nullptr)
+    {
+        failDownload("Direct transfer connection is not available.");
+        return;
+    }
+    if (!QDir().mkpath(localParent))
+    {
+        failDownload(QString("Unable to create local folder: %1").arg(localParent));
+        return;
+    }
+    archiveFolder.reset(new QTemporaryDir(QDir(localParent).filePath(".archive-XXXXXX")));
+    if (!archiveFolder->isValid())
+    {
+        failDownload(QString("Unable to make a temporary folder in: %1").arg(localParent));
+        return;
+    }
+
+    QMultiMap<QString, QString> compressInputs;
+    compressInputs.insert("compression_type", "tgz");
+
+    RemoteDataReply * jobReply = ae_globals::get_connection()->runRemoteJob(compressApp, compressInputs, remoteFolder);
+    if (jobReply == nullptr)
+    {
+        failDownload("Unable to start the compress job.");
+        return;
+    }
+    QObject::connect(jobReply, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
+                     this, SLOT(compressReply(RequestState,QJsonDocument)));
+    emit stageChanged(QString("Compressing %1 on the server . . .").arg(remoteFolder));
+}
+
+QString CompressedFolderDownload::getRemoteFolder()
+{
+    return remoteFolder;
+}
+
+void CompressedFolderDownload::compressReply(RequestState replyState, QJsonDocument rawReply)
+{
+    if (downloadEnded) return;
+    if (replyState != RequestState::GOOD)
+    {
+        failDownload("Unable to start the compress job.");
+        return;
+    }
+
+    //The local clock is only a fallback, for a job whose creation time the server has not given
+    qint64 submitTime = QDateTime::currentMSecsSinceEpoch();
+    jobID = ae_globals::get_job_poller()->jobSubmitted(rawReply);
+    if (jobID.isEmpty())
+    {
+        failDownload("The compress job was started, but could not be followed.");
+        return;
+    }
+    jobCreated = ae_globals::get_job_store()->getJob(jobID).created;
+    if (jobCreated == 0) jobCreated = submitTime;
+
+    qCDebug(agaveAppLayer, "Compress job %s submitted for %s", qPrintable(jobID), qPrintable(remoteFolder));
+    QObject::connect(ae_globals::get_job_store(), SIGNAL(jobChanged(QString)), this, SLOT(compressJobChanged(QString)));
+    QObject::connect(ae_globals::get_job_poller(), SIGNAL(watchAbandoned(QString)), this, SLOT(compressJobAbandoned(QString)));
+    compressJobChanged(jobID);
+}
+
+void CompressedFolderDownload::compressJobChanged(QString changedJobID)
+{
+    if (downloadEnded || (changedJobID != jobID)) return;
+
+    JobRecord theJob = ae_globals::get_job_store()->getJob(jobID);
+    if (!JobStore::isTerminal(theJob.status))
+    {
+        emit stageChanged(QString("Compressing %1 on the server: %2").arg(remoteFolder, theJob.status));
+        return;
+    }
+
+    stopFollowingJob();
+    if (theJob.status != "FINISHED")
+    {
+        failDownload(QString("The compress job ended with status %1.").arg(theJob.status));
+        return;
+    }
+
+    //The server's own creation time is compared against the archive's
+    if (theJob.created > 0) jobCreated = theJob.created;
+
+    //The compress app writes its archive next to the folder, named after it
+    QString folderName = remoteFolder.section('/', -1);
+    archiveNames = QStringList({folderName + ".tgz", folderName + ".tar.gz", folderName + ".tar"});
+    checkNextArchiveName();
+}
+
+void CompressedFolderDownload::checkNextArchiveName()
+{
+    if (archiveNames.isEmpty())
+    {
+        failDownload("The compress job finished, but its archive was not found.");
+        return;
+    }
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        failDownload("Direct transfer connection was lost.");
+        return;
+    }
+
+    //Each name is listed on its own, so a large parent folder is never paged through
+    RestTask * listTask = theSession->newListing(remoteParent + "/" + archiveNames.first());
+    QObject::connect(listTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(archiveListReply(RequestState,QByteArray,qint64)));
+    theSession->submitTask(listTask);
+}
+
+void CompressedFolderDownload::archiveListReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (downloadEnded) return;
+
+    QString archiveName = archiveNames.takeFirst();
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState != RequestState::GOOD) || (resultList.size() != 1) ||
+            (resultList.first().toObject().value("type").toString() != "file"))
+    {
+        checkNextArchiveName();
+        return;
+    }
+
+    //A file of this name from before the job is not the job's output, and must not be taken or deleted
+    qint64 archiveModified = JobStore::parseTime(resultList.first().toObject().value("lastModified").toString());
+    if (archiveModified < jobCreated)
+    {
+        qCDebug(agaveAppLayer, "Skipping %s/%s, which is older than compress job %s", qPrintable(remoteParent), qPrintable(archiveName), qPrintable(jobID));
+        checkNextArchiveName();
+        return;
+    }
+    remoteArchive = remoteParent + "/" + archiveName;
+
+    localArchive = archiveFolder->filePath(archiveName);
+    archiveDownload = new SegmentedDownload(remoteArchive, localArchive, this);
+    QObject::connect(archiveDownload, SIGNAL(downloadProgress(qint64,qint64)), this, SIGNAL(downloadProgress(qint64,qint64)));
+    QObject::connect(archiveDownload, SIGNAL(downloadFinished(RequestState,QString)), this, SLOT(archiveDownloaded(RequestState,QString)));
+    archiveDownload->start();
+    emit stageChanged(QString("Downloading %1 . . .").arg(remoteArchive));
+}
+
+void CompressedFolderDownload::archiveDownloaded(RequestState finalState, QString message)
+{
+    if (downloadEnded) return;
+    if (finalState != RequestState::GOOD)
+    {
+        failDownload(message);
+        return;
+    }
+
+    //The remote archive was made by this download's job, so it can go
+    RemoteDataReply * deleteReply = ae_globals::get_connection()->deleteFile(remoteArchive);
+    if (deleteReply != nullptr)
+    {
+        deletePending = true;
+        QObject::connect(deleteReply, SIGNAL(haveDeleteReply(RequestState)), this, SLOT(archiveDeleteReply(RequestState)));
+    }
+
+    //Unpacking runs in its own process, so the GUI thread does not wait on it
+    QStringList tarArgs;
+    tarArgs << (localArchive.endsWith(".tar") ? "-xf" : "-xzf") << localArchive << "-C" << localParent;
+    extractProcess.start("tar", tarArgs);
+    emit stageChanged(QString("Unpacking %1 . . .").arg(QFileInfo(localArchive).fileName()));
+}
+
+void CompressedFolderDownload::extractDone(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (downloadEnded) return;
+    QFile::remove(localArchive);
+
+    if ((exitStatus != QProcess::NormalExit) || (exitCode != 0))
+    {
+        failDownload(QString("Unable to unpack the archive: %1").arg(QString::fromLocal8Bit(extractProcess.readAllStandardError()).trimmed()));
+        return;
+    }
+
+    unpackDone = true;
+    finishIfDone();
+}
+
+void CompressedFolderDownload::archiveDeleteReply(RequestState replyState)
+{
+    deletePending = false;
+    archiveDeleted = (replyState == RequestState::GOOD);
+    if (!archiveDeleted)
+    {
+        qCDebug(agaveAppLayer, "Unable to remove remote archive: %s", qPrintable(remoteArchive));
+    }
+    finishIfDone();
+}
+
+void CompressedFolderDownload::finishIfDone()
+{
+    if (downloadEnded || !unpackDone || deletePending) return;
+
+    downloadEnded = true;
+    if (!archiveDeleted)
+    {
+        emit downloadFinished(RequestState::GOOD, QString("Downloaded %1 as one archive. The archive %2 could not be removed from the server.").arg(remoteFolder, remoteArchive));
+        return;
+    }
+    emit downloadFinished(RequestState::GOOD, QString("Downloaded %1 as one archive.").arg(remoteFolder));
+}
+
+void CompressedFolderDownload::extractError(QProcess::ProcessError theError)
+{
+    if (theError != QProcess::FailedToStart) return;
+    QFile::remove(localArchive);
+    failDownload("Unable to run tar to unpack the archive.");
+}
+
+void CompressedFolderDownload::compressJobAbandoned(QString abandonedJobID)
+{
+    if (downloadEnded || (abandonedJobID != jobID)) return;
+    failDownload("The compress job's status could no longer be read.");
+}
+
+void CompressedFolderDownload::stopFollowingJob()
+{
+    QObject::disconnect(ae_globals::get_job_store(), SIGNAL(jobChanged(QString)), this, SLOT(compressJobChanged(QString)));
+    QObject::disconnect(ae_globals::get_job_poller(), SIGNAL(watchAbandoned(QString)), this, SLOT(compressJobAbandoned(QString)));
+}
+
+void CompressedFolderDownload::failDownload(QString message)
+{
+    if (downloadEnded) return;
+    downloadEnded = true;
+
+    stopFollowingJob();
+    if (archiveDownload != nullptr) archiveDownload->cancel();
+
+    qCDebug(agaveAppLayer, "Compressed download of %s failed: %s", qPrintable(remoteFolder), qPrintable(message));
+    emit downloadFinished(RequestState::EXPLICIT_ERROR, message);
+}
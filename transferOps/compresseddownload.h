@@ -0,0 +1,115 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef COMPRESSEDDOWNLOAD_H
+#define COMPRESSEDDOWNLOAD_H
+
+#include <QObject>
+#include <QStringList>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QScopedPointer>
+#include <QJsonDocument>
+
+class SegmentedDownload;
+enum class RequestState;
+
+/*! \brief The CompressedFolderDownload fetches a remote folder as one archive, made on the remote side by the compress app.
+ *
+ *  The steps are: submit compress on the folder, follow the job through the JobPoller until it finishes, find the archive next to the folder, fetch it with a SegmentedDownload, and unpack it into the local folder with the system tar in a separate process. The remote and local copies of the archive are removed afterwards.
+ *
+ *  The archive is fetched into a temporary folder inside localParent, so it is on the same disk as the unpacked files, and never takes the place of a local file which shares its name.
+ *
+ *  A file next to the folder with an archive's name is only taken as the job's output if it was last modified after the job was created, so that an older archive which happens to share the name is neither downloaded nor deleted.
+ *
+ *  This needs the direct transfer sessions, to find the archive and for the segmented download.
+ */
+
+class CompressedFolderDownload : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Makes a download of remoteFolder, which will be unpacked inside localParent.
+     */
+    explicit CompressedFolderDownload(QString remoteFolder, QString localParent, QObject *parent = nullptr);
+
+    void start();
+
+    QString getRemoteFolder();
+
+    static const QString compressApp;
+
+signals:
+    void stageChanged(QString message);
+    void downloadProgress(qint64 bytesDone, qint64 bytesTotal);
+    void downloadFinished(RequestState finalState, QString message);
+
+private slots:
+    void compressReply(RequestState replyState, QJsonDocument rawReply);
+    void compressJobChanged(QString jobID);
+    void compressJobAbandoned(QString jobID);
+    void archiveListReply(RequestState replyState, QByteArray body, qint64);
+    void archiveDownloaded(RequestState finalState, QString message);
+    void archiveDeleteReply(RequestState replyState);
+    void extractDone(int exitCode, QProcess::ExitStatus exitStatus);
+    void extractError(QProcess::ProcessError theError);
+
+private:
+    void checkNextArchiveName();
+    void finishIfDone();
+    void stopFollowingJob();
+    void failDownload(QString message);
+
+    QString remoteFolder;
+    QString remoteParent;
+    QString localParent;
+
+    QString jobID;
+    qint64 jobCreated = 0;
+
+    QStringList archiveNames;
+    QString remoteArchive;
+    QScopedPointer<QTemporaryDir> archiveFolder;
+    QString localArchive;
+    SegmentedDownload * archiveDownload = nullptr;
+    QProcess extractProcess;
+
+    bool deletePending = false;
+    bool archiveDeleted = false;
+    bool unpackDone = false;
+    bool downloadEnded = false;
+};
+
+#endif // COMPRESSEDDOWNLOAD_H
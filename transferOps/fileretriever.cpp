@@ -0,0 +1,255 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "fileretriever.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "utilFuncs/pagedfilereader.h"
+#include "ae_globals.h"
+
+const qint64 FileRetriever::spillThreshold;
+
+FileRetriever::FileRetriever(QObject *parent) : QObject(parent) {}
+
+bool FileRetriever::retrieve(QString remotePath)
+{
+    if (isRetrieving(remotePath)) return false;
+    forget(remotePath);
+
+    RetrievedFile newFile;
+    newFile.remotePath = remotePath;
+    fileList.insert(remotePath, newFile);
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession != nullptr)
+    {
+        //The size decides whether the file is kept in memory or spilled to disk
+        RestTask * sizeTask = theSession->newListing(remotePath);
+        QObject::connect(sizeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(sizeReply(RequestState,QByteArray,qint64)));
+        pendingRequests.insert(sizeTask, remotePath);
+        theSession->submitTask(sizeTask);
+        return true;
+    }
+
+    RetrievedFile &theFile = fileList[remotePath];
+    theFile.spillPath = newSpillPath();
+    RemoteDataReply * theReply = ae_globals::get_bulk_connection()->downloadFile(theFile.spillPath, remotePath);
+    if (theReply == nullptr)
+    {
+        finishRetrieval(remotePath, RequestState::EXPLICIT_ERROR);
+        return true;
+    }
+    QObject::connect(theReply, SIGNAL(haveDownloadReply(RequestState)), this, SLOT(downloadReply(RequestState)));
+    pendingRequests.insert(theReply, remotePath);
+    return true;
+}
+
+bool FileRetriever::isRetrieving(QString remotePath)
+{
+    if (!fileList.contains(remotePath)) return false;
+    return !fileList.value(remotePath).done;
+}
+
+bool FileRetriever::isRetrieved(QString remotePath)
+{
+    if (!fileList.contains(remotePath)) return false;
+    return fileList.value(remotePath).done;
+}
+
+PagedFileReader * FileRetriever::openReader(QString remotePath)
+{
+    if (!isRetrieved(remotePath)) return nullptr;
+    const RetrievedFile &theFile = fileList[remotePath];
+
+    PagedFileReader * ret;
+    if (theFile.spillPath.isEmpty())
+    {
+        ret = new PagedFileReader(theFile.buffer);
+    }
+    else
+    {
+        ret = new PagedFileReader(theFile.spillPath);
+    }
+
+    if (!ret->isOpen())
+    {
+        delete ret;
+        return nullptr;
+    }
+    return ret;
+}
+
+qint64 FileRetriever::retrievedSize(QString remotePath)
+{
+    if (!isRetrieved(remotePath)) return -1;
+    return fileList.value(remotePath).fileSize;
+}
+
+void FileRetriever::forget(QString remotePath)
+{
+    if (isRetrieving(remotePath)) return;
+
+    RetrievedFile oldFile = fileList.take(remotePath);
+    if (!oldFile.spillPath.isEmpty())
+    {
+        QFile::remove(oldFile.spillPath);
+    }
+}
+
+void FileRetriever::sizeReply(RequestState replyState, QByteArray body, qint64)
+{
+    QString remotePath = pendingRequests.take(sender());
+    if (!fileList.contains(remotePath)) return;
+    RetrievedFile &theFile = fileList[remotePath];
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState != RequestState::GOOD) || (resultList.size() != 1) ||
+            (resultList.first().toObject().value("type").toString() != "file"))
+    {
+        finishRetrieval(remotePath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    theFile.fileSize = (qint64) resultList.first().toObject().value("length").toDouble();
+
+    startContentRead(theFile);
+}
+
+void FileRetriever::contentProgress(qint64 bytesDone, qint64 bytesTotal)
+{
+    if (!pendingRequests.contains(sender())) return;
+    emit retrievalProgress(pendingRequests.value(sender()), bytesDone, bytesTotal);
+}
+
+void FileRetriever::contentReply(RequestState replyState, QByteArray body, qint64 bytesWritten)
+{
+    QString remotePath = pendingRequests.take(sender());
+    if (!fileList.contains(remotePath)) return;
+    RetrievedFile &theFile = fileList[remotePath];
+
+    if (replyState != RequestState::GOOD)
+    {
+        finishRetrieval(remotePath, RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    if (theFile.spillPath.isEmpty())
+    {
+        theFile.buffer = body;
+        theFile.fileSize = body.size();
+    }
+    else
+    {
+        theFile.fileSize = bytesWritten;
+    }
+    finishRetrieval(remotePath, RequestState::GOOD);
+}
+
+void FileRetriever::downloadReply(RequestState replyState)
+{
+    QString remotePath = pendingRequests.take(sender());
+    if (!fileList.contains(remotePath)) return;
+    RetrievedFile &theFile = fileList[remotePath];
+
+    theFile.fileSize = QFile(theFile.spillPath).size();
+    finishRetrieval(remotePath, replyState);
+}
+
+void FileRetriever::startContentRead(RetrievedFile &theFile)
+{
+    AgaveRestSession * theSession;
+    RestTask * readTask;
+
+    if (theFile.fileSize <= spillThreshold)
+    {
+        theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+        if (theSession == nullptr)
+        {
+            finishRetrieval(theFile.remotePath, RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        readTask = theSession->newMediaRead(theFile.remotePath);
+    }
+    else
+    {
+        theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+        if (theSession == nullptr)
+        {
+            finishRetrieval(theFile.remotePath, RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        theFile.spillPath = newSpillPath();
+        readTask = theSession->newMediaRead(theFile.remotePath);
+        readTask->setOutputFile(theFile.spillPath, 0);
+        qCDebug(agaveAppLayer, "Retrieving %s to disk: %lld bytes", qPrintable(theFile.remotePath), theFile.fileSize);
+    }
+
+    QObject::connect(readTask, SIGNAL(progress(qint64,qint64)), this, SLOT(contentProgress(qint64,qint64)));
+    QObject::connect(readTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(contentReply(RequestState,QByteArray,qint64)));
+    pendingRequests.insert(readTask, theFile.remotePath);
+    theSession->submitTask(readTask);
+}
+
+void FileRetriever::finishRetrieval(QString remotePath, RequestState finalState)
+{
+    if (finalState == RequestState::GOOD)
+    {
+        fileList[remotePath].done = true;
+    }
+    else
+    {
+        RetrievedFile oldFile = fileList.take(remotePath);
+        if (!oldFile.spillPath.isEmpty())
+        {
+            QFile::remove(oldFile.spillPath);
+        }
+    }
+    emit retrievalFinished(remotePath, finalState);
+}
+
+QString FileRetriever::newSpillPath()
+{
+    return spillFolder.filePath(QString("retrieved_%1").arg(nextSpillNum++));
+}
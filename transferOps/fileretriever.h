@@ -0,0 +1,110 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FILERETRIEVER_H
+#define FILERETRIEVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTemporaryDir>
+
+class PagedFileReader;
+enum class RequestState;
+
+/*! \brief The FileRetriever fetches remote files for reading inside the program, without holding large files in memory.
+ *
+ *  Files up to spillThreshold are kept in memory. Larger files are streamed straight to a temporary file as they arrive, which is removed when the file is forgotten or the program exits. Either way, the content is read back through a PagedFileReader from openReader().
+ *
+ *  When the direct transfer sessions are not logged in, the size of a file is not known ahead of time, and every file is retrieved to a temporary file.
+ */
+
+class FileRetriever : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileRetriever(QObject *parent = nullptr);
+
+    /*! \brief Starts retrieving remotePath. A finished retrieval of the same file is replaced.
+     *
+     *  \return false if that file is already being retrieved.
+     */
+    bool retrieve(QString remotePath);
+
+    bool isRetrieving(QString remotePath);
+    bool isRetrieved(QString remotePath);
+
+    /*! \brief Returns a new reader on the retrieved content of remotePath, or nullptr if it has not been retrieved. The caller owns the reader.
+     */
+    PagedFileReader * openReader(QString remotePath);
+    qint64 retrievedSize(QString remotePath);
+
+    /*! \brief Drops the retrieved content of remotePath, and removes its temporary file.
+     */
+    void forget(QString remotePath);
+
+    static const qint64 spillThreshold = 4 * 1024 * 1024;
+
+signals:
+    void retrievalProgress(QString remotePath, qint64 bytesDone, qint64 bytesTotal);
+    void retrievalFinished(QString remotePath, RequestState finalState);
+
+private slots:
+    void sizeReply(RequestState replyState, QByteArray body, qint64);
+    void contentProgress(qint64 bytesDone, qint64 bytesTotal);
+    void contentReply(RequestState replyState, QByteArray body, qint64 bytesWritten);
+    void downloadReply(RequestState replyState);
+
+private:
+    struct RetrievedFile
+    {
+        QString remotePath;
+        qint64 fileSize = -1;
+        QByteArray buffer;
+        QString spillPath;
+        bool done = false;
+    };
+
+    void startContentRead(RetrievedFile &theFile);
+    void finishRetrieval(QString remotePath, RequestState finalState);
+    QString newSpillPath();
+
+    QHash<QString, RetrievedFile> fileList;
+    QHash<QObject *, QString> pendingRequests;
+
+    QTemporaryDir spillFolder;
+    int nextSpillNum = 1;
+};
+
+#endif // FILERETRIEVER_H
@@ -0,0 +1,208 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "foldercrawler.h"
+
+#include <QDir>
+
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "netOps/remotelanepool.h"
+#include "transferOps/transferqueue.h"
+#include "ae_globals.h"
+
+const int FolderCrawler::maxListTries;
+
+FolderCrawler::FolderCrawler(QString remoteFolder, QString localFolder, QObject *parent) : QObject(parent)
+{
+    remoteRoot = remoteFolder;
+    localRoot = localFolder;
+
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        maxListings = ae_globals::get_lane_pool()->bulkLaneCount() + 1;
+    }
+}
+
+void FolderCrawler::setMaxListings(int newMax)
+{
+    if (newMax < 1) newMax = 1;
+    maxListings = newMax;
+    startNextListings();
+}
+
+void FolderCrawler::start()
+{
+    QObject::connect(ae_globals::get_transfer_queue(), SIGNAL(transferFinished(int,RequestState)),
+                     this, SLOT(transferFinished(int,RequestState)));
+
+    PendingFolder rootFolder;
+    rootFolder.remotePath = remoteRoot;
+    rootFolder.localPath = localRoot;
+    folderQueue.append(rootFolder);
+    foldersFound = 1;
+
+    startNextListings();
+}
+
+void FolderCrawler::cancel()
+{
+    failCrawl("Folder download cancelled.");
+}
+
+QString FolderCrawler::getRemoteFolder()
+{
+    return remoteRoot;
+}
+
+QString FolderCrawler::getLocalFolder()
+{
+    return localRoot;
+}
+
+void FolderCrawler::listReply(RequestState replyState, QList<FileMetaData> fileList)
+{
+    if (!activeListings.contains(sender())) return;
+    PendingFolder theFolder = activeListings.take(sender());
+    if (crawlEnded) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        if (theFolder.tries >= maxListTries)
+        {
+            failCrawl(QString("Unable to list remote folder: %1").arg(theFolder.remotePath));
+            return;
+        }
+        //Retried at the front, so it is not stuck behind the whole remaining tree
+        folderQueue.prepend(theFolder);
+        startNextListings();
+        return;
+    }
+
+    if (!QDir().mkpath(theFolder.localPath))
+    {
+        failCrawl(QString("Unable to create local folder: %1").arg(theFolder.localPath));
+        return;
+    }
+
+    for (const FileMetaData &anEntry : fileList)
+    {
+        QString entryName = anEntry.getFileName();
+        if (entryName.isEmpty() || (entryName == ".") || (entryName == "..")) continue;
+
+        QString entryRemotePath = theFolder.remotePath + "/" + entryName;
+        QString entryLocalPath = QDir(theFolder.localPath).filePath(entryName);
+
+        if (anEntry.getFileType() == FileType::DIR)
+        {
+            PendingFolder newFolder;
+            newFolder.remotePath = entryRemotePath;
+            newFolder.localPath = entryLocalPath;
+            folderQueue.append(newFolder);
+            foldersFound++;
+        }
+        else if (anEntry.getFileType() == FileType::FILE)
+        {
+            int transferID = ae_globals::get_transfer_queue()->enqueueDownload(entryRemotePath, entryLocalPath, anEntry.getSize(), TransferPriority::BACKGROUND);
+            activeTransfers.insert(transferID);
+            filesFound++;
+        }
+    }
+    foldersListed++;
+
+    emit crawlProgress(foldersListed, foldersFound, filesDone, filesFound);
+    startNextListings();
+    checkIfDone();
+}
+
+void FolderCrawler::transferFinished(int transferID, RequestState finalState)
+{
+    if (!activeTransfers.remove(transferID)) return;
+
+    filesDone++;
+    if (finalState != RequestState::GOOD) filesFailed++;
+
+    emit crawlProgress(foldersListed, foldersFound, filesDone, filesFound);
+    checkIfDone();
+}
+
+void FolderCrawler::startNextListings()
+{
+    while (!crawlEnded && (activeListings.size() < maxListings) && !folderQueue.isEmpty())
+    {
+        PendingFolder nextFolder = folderQueue.takeFirst();
+        nextFolder.tries++;
+
+        RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+        RemoteDataReply * lsReply = theLane->remoteLS(nextFolder.remotePath);
+        if (lsReply == nullptr)
+        {
+            failCrawl(QString("Unable to list remote folder: %1").arg(nextFolder.remotePath));
+            return;
+        }
+        ae_globals::get_lane_pool()->trackReply(theLane, lsReply);
+
+        activeListings.insert(lsReply, nextFolder);
+        QObject::connect(lsReply, SIGNAL(haveLSReply(RequestState,QList<FileMetaData>)),
+                         this, SLOT(listReply(RequestState,QList<FileMetaData>)));
+    }
+}
+
+void FolderCrawler::checkIfDone()
+{
+    if (crawlEnded) return;
+    if (!activeListings.isEmpty() || !folderQueue.isEmpty() || !activeTransfers.isEmpty()) return;
+
+    crawlEnded = true;
+    if (filesFailed > 0)
+    {
+        emit crawlFinished(RequestState::EXPLICIT_ERROR, QString("Folder download finished, but %1 of %2 files failed.").arg(filesFailed).arg(filesFound));
+        return;
+    }
+    emit crawlFinished(RequestState::GOOD, QString("Downloaded %1 files in %2 folders.").arg(filesFound).arg(foldersListed));
+}
+
+void FolderCrawler::failCrawl(QString message)
+{
+    if (crawlEnded) return;
+    crawlEnded = true;
+
+    //Downloads already queued are left to finish; only the listing stops
+    folderQueue.clear();
+    activeListings.clear();
+    qCDebug(agaveAppLayer, "Folder download of %s stopped: %s", qPrintable(remoteRoot), qPrintable(message));
+    emit crawlFinished(RequestState::EXPLICIT_ERROR, message);
+}
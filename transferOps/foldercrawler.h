@@ -0,0 +1,105 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FOLDERCRAWLER_H
+#define FOLDERCRAWLER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+
+class FileMetaData;
+enum class RequestState;
+
+/*! \brief The FolderCrawler downloads a remote folder tree, listing its subfolders concurrently while the files found so far are already downloading.
+ *
+ *  Folders waiting to be listed are kept in one shared list. Whenever a listing finishes, the freed slot takes the next folder from the list, so no slot sits idle while there is work left. The number of listings in flight is bounded separately from the downloads. Files are handed to the TransferQueue as soon as they are found, and the queue keeps its own fixed number of downloads in flight.
+ */
+
+class FolderCrawler : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Makes a crawler which downloads remoteFolder, and everything under it, into localFolder.
+     */
+    explicit FolderCrawler(QString remoteFolder, QString localFolder, QObject *parent = nullptr);
+
+    void setMaxListings(int newMax);
+    void start();
+    void cancel();
+
+    QString getRemoteFolder();
+    QString getLocalFolder();
+
+    static const int maxListTries = 2;
+
+signals:
+    void crawlProgress(int foldersListed, int foldersFound, int filesDone, int filesFound);
+    void crawlFinished(RequestState finalState, QString message);
+
+private slots:
+    void listReply(RequestState replyState, QList<FileMetaData> fileList);
+    void transferFinished(int transferID, RequestState finalState);
+
+private:
+    struct PendingFolder
+    {
+        QString remotePath;
+        QString localPath;
+        int tries = 0;
+    };
+
+    void startNextListings();
+    void checkIfDone();
+    void failCrawl(QString message);
+
+    QString remoteRoot;
+    QString localRoot;
+
+    QList<PendingFolder> folderQueue;
+    QHash<QObject *, PendingFolder> activeListings;
+    QSet<int> activeTransfers;
+
+    int maxListings = 4;
+    int foldersFound = 0;
+    int foldersListed = 0;
+    int filesFound = 0;
+    int filesDone = 0;
+    int filesFailed = 0;
+    bool crawlEnded = false;
+};
+
+#endif // FOLDERCRAWLER_H
@@ -0,0 +1,676 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "foldersync.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "transferOps/transferqueue.h"
+#include "transferOps/transfermanifest.h"
+#include "transferOps/folderuploader.h"
+#include "fileCache/remotefoldermodel.h"
+#include "utilFuncs/crc32c.h"
+#include "ae_globals.h"
+
+const qint64 LocalHashWorker::readSize;
+const int FolderSync::maxListings;
+const int FolderSync::maxListTries;
+const int FolderSync::maxMkdirs;
+const int FolderSync::maxNamedConflicts;
+
+LocalHashWorker::LocalHashWorker(QStringList filePaths) : QObject(nullptr)
+{
+    hashList = filePaths;
+}
+
+void LocalHashWorker::cancel()
+{
+    cancelled.store(1);
+}
+
+void LocalHashWorker::startHashing()
+{
+    QByteArray readBuffer(readSize, '\0');
+
+    for (QString aPath : hashList)
+    {
+        QFile theFile(aPath);
+        if (!theFile.open(QIODevice::ReadOnly))
+        {
+            emit fileHashed(aPath, 0, -1);
+            continue;
+        }
+
+        Crc32c fileCrc;
+        qint64 bytesRead;
+        while ((bytesRead = theFile.read(readBuffer.data(), readSize)) > 0)
+        {
+            if (cancelled.load() != 0) return;
+            fileCrc.update(readBuffer.constData(), bytesRead);
+        }
+        emit fileHashed(aPath, fileCrc.value(), (bytesRead < 0) ? -1 : fileCrc.length());
+    }
+    emit hashingFinished();
+}
+
+FolderSync::FolderSync(QString localFolder, QString remoteFolder, SyncDirection direction, QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<QList<qint64>>("QList<qint64>");
+
+    localRoot = QDir::cleanPath(QDir(localFolder).absolutePath());
+    remoteRoot = remoteFolder;
+    while ((remoteRoot.size() > 1) && remoteRoot.endsWith('/')) remoteRoot.chop(1);
+    syncDirection = direction;
+}
+
+FolderSync::~FolderSync()
+{
+    if (scanWorker != nullptr) scanWorker->cancel();
+    if (hashWorker != nullptr) hashWorker->cancel();
+    workThread.quit();
+    workThread.wait();
+}
+
+void FolderSync::setHashCheck(bool useHashes)
+{
+    hashCheck = useHashes;
+}
+
+void FolderSync::start()
+{
+    QObject::connect(ae_globals::get_transfer_queue(), SIGNAL(transferFinished(int,RequestState)),
+                     this, SLOT(transferFinished(int,RequestState)));
+    emit syncStage(QString("Comparing %1 with %2 . . .").arg(localRoot, remoteRoot));
+
+    //Both trees are walked at once: the local one in the work thread, the remote one on the bulk lanes
+    scanWorker = new LocalScanWorker(localRoot);
+    scanWorker->moveToThread(&workThread);
+    QObject::connect(&workThread, SIGNAL(finished()), scanWorker, SLOT(deleteLater()));
+    QObject::connect(scanWorker, SIGNAL(foldersFound(QStringList)), this, SLOT(localFoldersFound(QStringList)));
+    QObject::connect(scanWorker, SIGNAL(filesFound(QStringList,QList<qint64>,QList<qint64>)),
+                     this, SLOT(localFilesFound(QStringList,QList<qint64>,QList<qint64>)));
+    QObject::connect(scanWorker, SIGNAL(scanFinished(bool)), this, SLOT(scanFinished(bool)));
+    workThread.start();
+    QMetaObject::invokeMethod(scanWorker, "startScan", Qt::QueuedConnection);
+
+    ActiveListing rootListing;
+    rootListing.relativeFolder = "";
+    folderQueue.append(rootListing);
+    startListings();
+}
+
+void FolderSync::cancel()
+{
+    failSync("Folder sync cancelled.");
+}
+
+QString FolderSync::getLocalFolder()
+{
+    return localRoot;
+}
+
+QString FolderSync::getRemoteFolder()
+{
+    return remoteRoot;
+}
+
+void FolderSync::localFilesFound(QStringList relativeFiles, QList<qint64> fileSizes, QList<qint64> modifiedTimes)
+{
+    if (syncEnded) return;
+
+    for (int i = 0; i < relativeFiles.size(); i++)
+    {
+        SyncFile &theFile = fileTable[relativeFiles.at(i)];
+        theFile.localSize = fileSizes.value(i);
+        theFile.localModified = modifiedTimes.value(i);
+    }
+}
+
+void FolderSync::localFoldersFound(QStringList relativeFolders)
+{
+    if (syncEnded) return;
+
+    for (QString aFolder : relativeFolders)
+    {
+        localFolders.insert(aFolder);
+    }
+}
+
+void FolderSync::scanFinished(bool scanOkay)
+{
+    scanDone = true;
+    scanWorker = nullptr;
+
+    if (!scanOkay)
+    {
+        failSync(QString("Unable to read local folder: %1").arg(localRoot));
+        return;
+    }
+    compareIfReady();
+}
+
+void FolderSync::restListingReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!activeListings.contains(sender())) return;
+    ActiveListing theListing = activeListings.take(sender());
+    if (syncEnded) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        remoteFolderFailed(theListing);
+        return;
+    }
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    partialListings[theListing.relativeFolder].append(RemoteFolderModel::parseRestListing(resultList));
+
+    if (resultList.size() >= RemoteFolderModel::listPageSize)
+    {
+        listFolder(theListing.relativeFolder, theListing.offset + resultList.size(), 1);
+        return;
+    }
+    remoteFolderDone(theListing.relativeFolder, partialListings.take(theListing.relativeFolder), (theListing.offset == 0));
+}
+
+void FolderSync::lsReply(RequestState replyState, QList<FileMetaData> fileList)
+{
+    if (!activeListings.contains(sender())) return;
+    ActiveListing theListing = activeListings.take(sender());
+    if (syncEnded) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        remoteFolderFailed(theListing);
+        return;
+    }
+
+    QVector<CachedFileEntry> allEntries;
+    for (FileMetaData aFile : fileList)
+    {
+        CachedFileEntry anEntry;
+        anEntry.name = aFile.getFileName();
+        if (anEntry.name.isEmpty() || (anEntry.name == ".") || (anEntry.name == "..")) continue;
+        anEntry.type = aFile.getFileType();
+        anEntry.size = aFile.getSize();
+        allEntries.append(anEntry);
+    }
+    remoteFolderDone(theListing.relativeFolder, allEntries, (allEntries.size() <= RemoteFolderModel::listPageSize));
+}
+
+void FolderSync::fileHashed(QString filePath, quint32 crc32c, qint64 length)
+{
+    if (syncEnded) return;
+
+    QString relativePath = QDir(localRoot).relativeFilePath(filePath);
+    if (!fileTable.contains(relativePath)) return;
+
+    ManifestEntry theEntry = ae_globals::get_transfer_manifest()->getEntry(remotePathOf(relativePath));
+    bool hashMatched = (length >= 0) && (length == theEntry.size) && (crc32c == theEntry.crc32c);
+
+    SyncAction theAction = compareFile(relativePath, fileTable[relativePath], hashMatched);
+    if (theAction == SyncAction::UPLOAD) uploadList.append(relativePath);
+    else if (theAction == SyncAction::DOWNLOAD) downloadList.append(relativePath);
+}
+
+void FolderSync::hashingFinished()
+{
+    hashWorker = nullptr;
+    if (syncEnded) return;
+    startTransfers();
+}
+
+void FolderSync::mkdirReply(RequestState replyState, FileMetaData)
+{
+    if (!activeMkdirs.contains(sender())) return;
+    QString relativeFolder = activeMkdirs.take(sender());
+    if (syncEnded) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        //Every file waiting on this folder, or on any folder under it, fails
+        QStringList failedFolders(relativeFolder);
+        while (!failedFolders.isEmpty())
+        {
+            QString aFolder = failedFolders.takeFirst();
+            int lostFiles = waitingUploads.take(aFolder).size();
+            filesDone += lostFiles;
+            filesFailed += lostFiles;
+            failedFolders.append(mkdirsByParent.take(aFolder));
+        }
+        qCDebug(agaveAppLayer, "Sync could not create remote folder: %s", qPrintable(remotePathOf(relativeFolder)));
+        emit syncProgress(filesDone, filesToMove);
+        startNextMkdirs();
+        checkIfDone();
+        return;
+    }
+
+    remoteFolders.insert(relativeFolder);
+    readyMkdirs.append(mkdirsByParent.take(relativeFolder));
+    for (QString aFile : waitingUploads.take(relativeFolder))
+    {
+        queueUpload(aFile);
+    }
+    startNextMkdirs();
+    checkIfDone();
+}
+
+void FolderSync::transferFinished(int transferID, RequestState finalState)
+{
+    if (!activeTransfers.remove(transferID)) return;
+
+    filesDone++;
+    if (finalState != RequestState::GOOD) filesFailed++;
+
+    emit syncProgress(filesDone, filesToMove);
+    checkIfDone();
+}
+
+void FolderSync::startListings()
+{
+    while (!syncEnded && !folderQueue.isEmpty() && (activeListings.size() < maxListings))
+    {
+        ActiveListing nextListing = folderQueue.takeFirst();
+        listFolder(nextListing.relativeFolder, nextListing.offset, nextListing.tries);
+    }
+
+    if (!syncEnded && folderQueue.isEmpty() && activeListings.isEmpty())
+    {
+        remoteDone = true;
+        compareIfReady();
+    }
+}
+
+void FolderSync::listFolder(QString relativeFolder, int offset, int tries)
+{
+    ActiveListing newListing;
+    newListing.relativeFolder = relativeFolder;
+    newListing.offset = offset;
+    newListing.tries = tries;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    if (theSession != nullptr)
+    {
+        RestTask * lsTask = theSession->newListing(remotePathOf(relativeFolder), offset, RemoteFolderModel::listPageSize);
+        QObject::connect(lsTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(restListingReply(RequestState,QByteArray,qint64)));
+        newListing.session = theSession;
+        newListing.taskID = lsTask->getTaskID();
+        activeListings.insert(lsTask, newListing);
+        theSession->submitTask(lsTask);
+        return;
+    }
+
+    RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+    RemoteDataReply * theReply = theLane->remoteLS(remotePathOf(relativeFolder));
+    if (theReply == nullptr)
+    {
+        failSync(QString("Unable to list remote folder: %1").arg(remotePathOf(relativeFolder)));
+        return;
+    }
+    ae_globals::get_lane_pool()->trackReply(theLane, theReply);
+    QObject::connect(theReply, SIGNAL(haveLSReply(RequestState,QList<FileMetaData>)),
+                     this, SLOT(lsReply(RequestState,QList<FileMetaData>)));
+    activeListings.insert(theReply, newListing);
+}
+
+void FolderSync::remoteFolderDone(QString relativeFolder, const QVector<CachedFileEntry> &entries, bool fitsOnePage)
+{
+    remoteFolders.insert(relativeFolder);
+
+    //Folders which fit in one page are cached, as the tree would cache them
+    if (fitsOnePage && (ae_globals::get_listing_cache() != nullptr))
+    {
+        ae_globals::get_listing_cache()->storeListing(remotePathOf(relativeFolder), entries);
+    }
+
+    QString prefix = relativeFolder.isEmpty() ? QString() : relativeFolder + "/";
+    for (const CachedFileEntry &anEntry : entries)
+    {
+        if (anEntry.type == FileType::DIR)
+        {
+            ActiveListing newListing;
+            newListing.relativeFolder = prefix + anEntry.name;
+            folderQueue.append(newListing);
+        }
+        else if (anEntry.type == FileType::FILE)
+        {
+            SyncFile &theFile = fileTable[prefix + anEntry.name];
+            theFile.remoteSize = anEntry.size;
+            theFile.remoteModified = anEntry.lastModified;
+        }
+    }
+    emit syncStage(QString("Comparing: %1 remote folders listed.").arg(remoteFolders.size()));
+    startListings();
+}
+
+void FolderSync::remoteFolderFailed(ActiveListing theListing)
+{
+    //A folder which cannot be listed would look empty, and be copied over, so the sync stops instead
+    if (theListing.tries >= maxListTries)
+    {
+        failSync(QString("Unable to list remote folder: %1").arg(remotePathOf(theListing.relativeFolder)));
+        return;
+    }
+    theListing.tries++;
+    theListing.session = nullptr;
+    theListing.taskID = -1;
+    folderQueue.prepend(theListing);
+    startListings();
+}
+
+void FolderSync::compareIfReady()
+{
+    if (syncEnded || comparing || !scanDone || !remoteDone) return;
+    comparing = true;
+
+    QStringList hashList;
+    for (auto itr = fileTable.begin(); itr != fileTable.end(); itr++)
+    {
+        //A file on one side which is a folder on the other is left alone
+        if (((itr.value().localSize >= 0) && remoteFolders.contains(itr.key())) ||
+                ((itr.value().remoteSize >= 0) && localFolders.contains(itr.key())))
+        {
+            typeClashes.insert(itr.key());
+            continue;
+        }
+
+        SyncAction theAction = compareFile(itr.key(), itr.value());
+        if (theAction == SyncAction::UPLOAD) uploadList.append(itr.key());
+        else if (theAction == SyncAction::DOWNLOAD) downloadList.append(itr.key());
+        else if (theAction == SyncAction::HASH)
+        {
+            itr.value().needsHash = true;
+            hashList.append(localPathOf(itr.key()));
+        }
+    }
+
+    if (hashList.isEmpty())
+    {
+        startTransfers();
+        return;
+    }
+
+    emit syncStage(QString("Checking the contents of %1 local files . . .").arg(hashList.size()));
+    hashWorker = new LocalHashWorker(hashList);
+    hashWorker->moveToThread(&workThread);
+    QObject::connect(&workThread, SIGNAL(finished()), hashWorker, SLOT(deleteLater()));
+    QObject::connect(hashWorker, SIGNAL(fileHashed(QString,quint32,qint64)), this, SLOT(fileHashed(QString,quint32,qint64)));
+    QObject::connect(hashWorker, SIGNAL(hashingFinished()), this, SLOT(hashingFinished()));
+    QMetaObject::invokeMethod(hashWorker, "startHashing", Qt::QueuedConnection);
+}
+
+FolderSync::SyncAction FolderSync::compareFile(QString relativePath, SyncFile &theFile, bool hashMatched)
+{
+    bool isLocal = (theFile.localSize >= 0);
+    bool isRemote = (theFile.remoteSize >= 0);
+    if (isLocal && !isRemote) return (syncDirection == SyncDirection::DOWNLOAD_ONLY) ? SyncAction::NONE : SyncAction::UPLOAD;
+    if (!isLocal && isRemote) return (syncDirection == SyncDirection::UPLOAD_ONLY) ? SyncAction::NONE : SyncAction::DOWNLOAD;
+
+    TransferManifest * theManifest = ae_globals::get_transfer_manifest();
+    ManifestEntry theEntry;
+    if (theManifest != nullptr) theEntry = theManifest->getEntry(remotePathOf(relativePath));
+    bool haveEntry = !theEntry.remotePath.isEmpty() && (theEntry.localPath == localPathOf(relativePath));
+
+    bool localChanged = !haveEntry || (theEntry.size != theFile.localSize) || (theEntry.localModified != theFile.localModified);
+    bool remoteChanged = !haveEntry || (theEntry.size != theFile.remoteSize) ||
+            ((theEntry.remoteModified != 0) && (theFile.remoteModified != 0) && (theEntry.remoteModified != theFile.remoteModified));
+
+    if (hashMatched)
+    {
+        localChanged = false;
+    }
+    else if (localChanged && haveEntry && hashCheck && !theFile.needsHash &&
+             theEntry.hasChecksum && (theFile.localSize == theEntry.size))
+    {
+        //Only the time changed, so reading the file tells whether it really did
+        return SyncAction::HASH;
+    }
+
+    //Without an entry or remote times, two copies of the same size cannot be told apart
+    if (!haveEntry && (theFile.remoteModified == 0) && (theFile.localSize == theFile.remoteSize))
+    {
+        localChanged = false;
+        remoteChanged = false;
+    }
+
+    if (!localChanged && !remoteChanged)
+    {
+        filesUnchanged++;
+
+        //The entry learns the times it was missing, so the next sync needs no hash or guess
+        if (haveEntry && (hashMatched || ((theEntry.remoteModified == 0) && (theFile.remoteModified != 0))))
+        {
+            theEntry.localModified = theFile.localModified;
+            if (theEntry.remoteModified == 0) theEntry.remoteModified = theFile.remoteModified;
+            theManifest->recordFile(theEntry);
+        }
+        return SyncAction::NONE;
+    }
+
+    if (syncDirection == SyncDirection::UPLOAD_ONLY) return SyncAction::UPLOAD;
+    if (syncDirection == SyncDirection::DOWNLOAD_ONLY) return SyncAction::DOWNLOAD;
+    if (!localChanged) return SyncAction::DOWNLOAD;
+
+    //A remote copy with no known time may have changed at the same size, so only a known time shows it did not
+    bool remoteTimeKnown = haveEntry && (theEntry.remoteModified != 0) && (theFile.remoteModified != 0);
+    if (!remoteChanged && remoteTimeKnown) return SyncAction::UPLOAD;
+
+    //Either copy may hold edits the other lacks, so neither is overwritten
+    conflictList.append(relativePath);
+    qCDebug(agaveAppLayer, "Sync: both copies may have changed, skipping: %s", qPrintable(relativePath));
+    return SyncAction::NONE;
+}
+
+void FolderSync::startTransfers()
+{
+    if (syncEnded) return;
+    workThread.quit();
+
+    filesToMove = uploadList.size() + downloadList.size();
+    if (filesToMove == 0)
+    {
+        checkIfDone();
+        return;
+    }
+    emit syncStage(QString("Sync: moving %1 changed files, %2 unchanged.").arg(filesToMove).arg(filesUnchanged));
+    emit syncProgress(0, filesToMove);
+
+    TransferQueue * theQueue = ae_globals::get_transfer_queue();
+    for (QString aFile : downloadList)
+    {
+        if (!QDir().mkpath(QFileInfo(localPathOf(aFile)).path()))
+        {
+            filesDone++;
+            filesFailed++;
+            continue;
+        }
+        trackTransfer(theQueue->enqueueDownload(remotePathOf(aFile), localPathOf(aFile), fileTable.value(aFile).remoteSize, TransferPriority::BACKGROUND));
+    }
+
+    for (QString aFile : uploadList)
+    {
+        queueUpload(aFile);
+    }
+    startNextMkdirs();
+    checkIfDone();
+}
+
+void FolderSync::queueUpload(QString relativePath)
+{
+    QString parentFolder = parentOf(relativePath);
+    if (remoteFolders.contains(parentFolder))
+    {
+        trackTransfer(ae_globals::get_transfer_queue()->enqueueUpload(localPathOf(relativePath), remotePathOf(parentFolder),
+                                                                      fileTable.value(relativePath).localSize, TransferPriority::BACKGROUND));
+        return;
+    }
+
+    waitingUploads[parentFolder].append(relativePath);
+    planMkdir(parentFolder);
+}
+
+void FolderSync::planMkdir(QString relativeFolder)
+{
+    //The root was listed, so this always stops there at the latest
+    if (remoteFolders.contains(relativeFolder) || plannedMkdirs.contains(relativeFolder)) return;
+    plannedMkdirs.insert(relativeFolder);
+
+    QString parentFolder = parentOf(relativeFolder);
+    if (remoteFolders.contains(parentFolder))
+    {
+        readyMkdirs.append(relativeFolder);
+        return;
+    }
+    mkdirsByParent[parentFolder].append(relativeFolder);
+    planMkdir(parentFolder);
+}
+
+void FolderSync::trackTransfer(int transferID)
+{
+    //A file which could not be queued at all counts as failed; any other ends through transferFinished
+    if (transferID < 0)
+    {
+        filesDone++;
+        filesFailed++;
+        emit syncProgress(filesDone, filesToMove);
+        return;
+    }
+    activeTransfers.insert(transferID);
+}
+
+void FolderSync::startNextMkdirs()
+{
+    while (!syncEnded && (activeMkdirs.size() < maxMkdirs) && !readyMkdirs.isEmpty())
+    {
+        QString nextFolder = readyMkdirs.takeFirst();
+
+        RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+        RemoteDataReply * theReply = theLane->createFolder(remotePathOf(parentOf(nextFolder)), nextFolder.section('/', -1));
+        if (theReply == nullptr)
+        {
+            failSync(QString("Unable to create remote folder: %1").arg(remotePathOf(nextFolder)));
+            return;
+        }
+        ae_globals::get_lane_pool()->trackReply(theLane, theReply);
+        activeMkdirs.insert(theReply, nextFolder);
+        QObject::connect(theReply, SIGNAL(haveMkdirReply(RequestState,FileMetaData)),
+                         this, SLOT(mkdirReply(RequestState,FileMetaData)));
+    }
+}
+
+void FolderSync::checkIfDone()
+{
+    if (syncEnded || !comparing) return;
+    if ((hashWorker != nullptr) || !activeMkdirs.isEmpty() || !readyMkdirs.isEmpty()) return;
+    if (!activeTransfers.isEmpty() || !waitingUploads.isEmpty()) return;
+
+    syncEnded = true;
+    QString resultText = QString("Sync finished: %1 uploaded, %2 downloaded, %3 unchanged.")
+            .arg(uploadList.size()).arg(downloadList.size()).arg(filesUnchanged);
+    if (!conflictList.isEmpty())
+    {
+        QStringList namedConflicts = conflictList.mid(0, maxNamedConflicts);
+        if (conflictList.size() > maxNamedConflicts) namedConflicts.append("...");
+        resultText.append(QString(" %1 skipped, as both copies may have changed: %2").arg(conflictList.size()).arg(namedConflicts.join(", ")));
+    }
+    if (!typeClashes.isEmpty())
+    {
+        resultText.append(QString(" %1 skipped, as they are a file on one side and a folder on the other.").arg(typeClashes.size()));
+    }
+
+    if (filesFailed > 0)
+    {
+        emit syncFinished(RequestState::EXPLICIT_ERROR, QString("%1 of %2 files failed to copy. %3").arg(filesFailed).arg(filesToMove).arg(resultText));
+        return;
+    }
+    emit syncFinished(RequestState::GOOD, resultText);
+}
+
+void FolderSync::failSync(QString message)
+{
+    if (syncEnded) return;
+    syncEnded = true;
+
+    if (scanWorker != nullptr) scanWorker->cancel();
+    if (hashWorker != nullptr) hashWorker->cancel();
+
+    //Transfers already queued are left to finish; listings and folders not yet made are dropped
+    QList<ActiveListing> cancelList = activeListings.values();
+    activeListings.clear();
+    for (const ActiveListing &aListing : cancelList)
+    {
+        if (aListing.session != nullptr) aListing.session->cancelTask(aListing.taskID);
+    }
+    folderQueue.clear();
+    partialListings.clear();
+    readyMkdirs.clear();
+    mkdirsByParent.clear();
+    plannedMkdirs.clear();
+    waitingUploads.clear();
+    activeMkdirs.clear();
+
+    qCDebug(agaveAppLayer, "Sync of %s stopped: %s", qPrintable(localRoot), qPrintable(message));
+    emit syncFinished(RequestState::EXPLICIT_ERROR, message);
+}
+
+QString FolderSync::parentOf(QString relativePath)
+{
+    int lastSlash = relativePath.lastIndexOf('/');
+    if (lastSlash < 0) return QString("");
+    return relativePath.left(lastSlash);
+}
+
+QString FolderSync::remotePathOf(QString relativePath)
+{
+    if (relativePath.isEmpty()) return remoteRoot;
+    return remoteRoot + "/" + relativePath;
+}
+
+QString FolderSync::localPathOf(QString relativePath)
+{
+    if (relativePath.isEmpty()) return localRoot;
+    return localRoot + "/" + relativePath;
+}
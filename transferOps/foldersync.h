@@ -0,0 +1,212 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FOLDERSYNC_H
+#define FOLDERSYNC_H
+
+#include <QObject>
+#include <QThread>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "fileCache/listingcache.h"
+
+class FileMetaData;
+class LocalScanWorker;
+class AgaveRestSession;
+enum class RequestState;
+
+enum class SyncDirection {BOTH_WAYS, UPLOAD_ONLY, DOWNLOAD_ONLY};
+
+/*! \brief The LocalHashWorker takes the CRC-32C of a list of local files in its own thread.
+ *
+ *  A file which cannot be read is reported with a length of -1.
+ */
+
+class LocalHashWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalHashWorker(QStringList filePaths);
+
+    void cancel();
+
+    static const qint64 readSize = 1024 * 1024;
+
+signals:
+    void fileHashed(QString filePath, quint32 crc32c, qint64 length);
+    void hashingFinished();
+
+public slots:
+    void startHashing();
+
+private:
+    QStringList hashList;
+    QAtomicInt cancelled;
+};
+
+/*! \brief The FolderSync brings a local folder and a remote folder into step, moving only the files which differ.
+ *
+ *  The local tree is walked by a LocalScanWorker, while the remote tree is listed on the bulk lanes. Listings which fit in one page are also stored in the ListingCache. Each file found on both sides is then compared with its entry in the TransferManifest, which holds the size and times of both copies when they were last known to match:
+ *
+ *  - A file whose size and times still match the entry is unchanged, and is skipped.
+ *  - With hash checking on, a local file whose time changed but whose size did not is read, and is unchanged if its CRC-32C still matches the entry.
+ *  - If only one side changed, that side is copied over the other.
+ *  - If both changed, or there is no entry, neither copy is overwritten. The file is skipped and named as a conflict when the sync finishes, for the user to settle.
+ *  - A remote copy with no known time, as from the bulk connection, may have changed without its size changing. So a changed local copy is never copied over it, and the file is a conflict.
+ *  - With no entry and no remote times, two copies of the same size are taken to match.
+ *
+ *  Files found on one side only are copied to the other. In the one way modes, files only go in that direction, and the source side wins whenever the two differ. Nothing is deleted on either side.
+ *
+ *  The copies run in the TransferQueue at background priority, and record new manifest entries as they finish, so the next sync of the same folders finds them unchanged.
+ */
+
+class FolderSync : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FolderSync(QString localFolder, QString remoteFolder, SyncDirection direction, QObject *parent = nullptr);
+    ~FolderSync();
+
+    void setHashCheck(bool useHashes);
+    void start();
+    void cancel();
+
+    QString getLocalFolder();
+    QString getRemoteFolder();
+
+    static const int maxListings = 4;
+    static const int maxListTries = 2;
+    static const int maxMkdirs = 4;
+    static const int maxNamedConflicts = 5;
+
+signals:
+    void syncStage(QString message);
+    void syncProgress(int filesDone, int filesToMove);
+    void syncFinished(RequestState finalState, QString message);
+
+private slots:
+    void localFilesFound(QStringList relativeFiles, QList<qint64> fileSizes, QList<qint64> modifiedTimes);
+    void localFoldersFound(QStringList relativeFolders);
+    void scanFinished(bool scanOkay);
+    void restListingReply(RequestState replyState, QByteArray body, qint64);
+    void lsReply(RequestState replyState, QList<FileMetaData> fileList);
+    void fileHashed(QString filePath, quint32 crc32c, qint64 length);
+    void hashingFinished();
+    void mkdirReply(RequestState replyState, FileMetaData);
+    void transferFinished(int transferID, RequestState finalState);
+
+private:
+    struct SyncFile
+    {
+        qint64 localSize = -1;
+        qint64 localModified = 0;
+        qint64 remoteSize = -1;
+        qint64 remoteModified = 0;
+        bool needsHash = false;
+    };
+
+    struct ActiveListing
+    {
+        QString relativeFolder;
+        int offset = 0;
+        int tries = 1;
+        AgaveRestSession * session = nullptr;
+        int taskID = -1;
+    };
+
+    enum class SyncAction {NONE, UPLOAD, DOWNLOAD, HASH};
+
+    void startListings();
+    void listFolder(QString relativeFolder, int offset, int tries);
+    void remoteFolderDone(QString relativeFolder, const QVector<CachedFileEntry> &entries, bool fitsOnePage);
+    void remoteFolderFailed(ActiveListing theListing);
+    void compareIfReady();
+    SyncAction compareFile(QString relativePath, SyncFile &theFile, bool hashMatched = false);
+    void startTransfers();
+    void queueUpload(QString relativePath);
+    void planMkdir(QString relativeFolder);
+    void trackTransfer(int transferID);
+    void startNextMkdirs();
+    void checkIfDone();
+    void failSync(QString message);
+
+    static QString parentOf(QString relativePath);
+    QString remotePathOf(QString relativePath);
+    QString localPathOf(QString relativePath);
+
+    QString localRoot;
+    QString remoteRoot;
+    SyncDirection syncDirection;
+    bool hashCheck = false;
+
+    QThread workThread;
+    LocalScanWorker * scanWorker = nullptr;
+    LocalHashWorker * hashWorker = nullptr;
+    bool scanDone = false;
+
+    QList<ActiveListing> folderQueue;
+    QHash<QObject *, ActiveListing> activeListings;
+    QHash<QString, QVector<CachedFileEntry>> partialListings;
+    bool remoteDone = false;
+
+    QHash<QString, SyncFile> fileTable;
+    QSet<QString> localFolders;
+    QSet<QString> remoteFolders;
+    QSet<QString> typeClashes;
+    QStringList conflictList;
+
+    QStringList uploadList;
+    QStringList downloadList;
+    QHash<QString, QStringList> waitingUploads;
+    QStringList readyMkdirs;
+    QHash<QString, QStringList> mkdirsByParent;
+    QSet<QString> plannedMkdirs;
+    QHash<QObject *, QString> activeMkdirs;
+    QSet<int> activeTransfers;
+
+    int filesUnchanged = 0;
+    int filesToMove = 0;
+    int filesDone = 0;
+    int filesFailed = 0;
+    bool comparing = false;
+    bool syncEnded = false;
+};
+
+#endif // FOLDERSYNC_H
@@ -0,0 +1,349 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "folderuploader.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "netOps/remotelanepool.h"
+#include "transferOps/transferqueue.h"
+#include "ae_globals.h"
+
+const int LocalScanWorker::batchSize;
+const int FolderUploader::maxMkdirs;
+
+LocalScanWorker::LocalScanWorker(QString rootFolder) : QObject(nullptr)
+{
+    rootPath = rootFolder;
+}
+
+void LocalScanWorker::cancel()
+{
+    cancelled.store(1);
+}
+
+void LocalScanWorker::startScan()
+{
+    QDir rootDir(rootPath);
+    if (!rootDir.exists())
+    {
+        emit scanFinished(false);
+        return;
+    }
+
+    QStringList folderBatch;
+    QStringList fileBatch;
+    QList<qint64> sizeBatch;
+    QList<qint64> timeBatch;
+
+    //Breadth first, so that the top of the remote skeleton can be made while the walk goes deeper
+    QStringList scanQueue("");
+    while (!scanQueue.isEmpty() && (cancelled.load() == 0))
+    {
+        QString relativeFolder = scanQueue.takeFirst();
+        QDir currentDir(rootDir.filePath(relativeFolder));
+        QString prefix = relativeFolder.isEmpty() ? QString() : relativeFolder + "/";
+
+        //Links to folders are not followed, as they can loop
+        for (const QFileInfo &anEntry : currentDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Hidden, QDir::Name))
+        {
+            folderBatch.append(prefix + anEntry.fileName());
+            scanQueue.append(prefix + anEntry.fileName());
+        }
+        for (const QFileInfo &anEntry : currentDir.entryInfoList(QDir::Files | QDir::Readable | QDir::Hidden, QDir::Name))
+        {
+            fileBatch.append(prefix + anEntry.fileName());
+            sizeBatch.append(anEntry.size());
+            timeBatch.append(anEntry.lastModified().toMSecsSinceEpoch());
+        }
+
+        if (!folderBatch.isEmpty())
+        {
+            emit foldersFound(folderBatch);
+            folderBatch.clear();
+        }
+        if (fileBatch.size() >= batchSize)
+        {
+            emit filesFound(fileBatch, sizeBatch, timeBatch);
+            fileBatch.clear();
+            sizeBatch.clear();
+            timeBatch.clear();
+        }
+    }
+
+    if (!fileBatch.isEmpty())
+    {
+        emit filesFound(fileBatch, sizeBatch, timeBatch);
+    }
+    emit scanFinished(cancelled.load() == 0);
+}
+
+FolderUploader::FolderUploader(QString localFolder, QString newRemoteParent, QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<QList<qint64>>("QList<qint64>");
+
+    localRoot = QDir::cleanPath(QDir(localFolder).absolutePath());
+    remoteParent = newRemoteParent;
+    remoteRoot = remoteParent + "/" + QDir(localRoot).dirName();
+}
+
+FolderUploader::~FolderUploader()
+{
+    if (scanWorker != nullptr) scanWorker->cancel();
+    scanThread.quit();
+    scanThread.wait();
+}
+
+void FolderUploader::start()
+{
+    QObject::connect(ae_globals::get_transfer_queue(), SIGNAL(transferFinished(int,RequestState)),
+                     this, SLOT(transferFinished(int,RequestState)));
+
+    scanWorker = new LocalScanWorker(localRoot);
+    scanWorker->moveToThread(&scanThread);
+    QObject::connect(&scanThread, SIGNAL(finished()), scanWorker, SLOT(deleteLater()));
+    QObject::connect(scanWorker, SIGNAL(foldersFound(QStringList)), this, SLOT(foldersFound(QStringList)));
+    QObject::connect(scanWorker, SIGNAL(filesFound(QStringList,QList<qint64>,QList<qint64>)), this, SLOT(filesFound(QStringList,QList<qint64>)));
+    QObject::connect(scanWorker, SIGNAL(scanFinished(bool)), this, SLOT(scanFinished(bool)));
+    scanThread.start();
+    QMetaObject::invokeMethod(scanWorker, "startScan", Qt::QueuedConnection);
+
+    //The root folder is the first of the skeleton, and has no parent to wait for
+    readyFolders.append("");
+    foldersFound = 1;
+    startNextMkdirs();
+}
+
+void FolderUploader::cancel()
+{
+    failUpload("Folder upload cancelled.");
+}
+
+QString FolderUploader::getLocalFolder()
+{
+    return localRoot;
+}
+
+QString FolderUploader::getRemoteFolder()
+{
+    return remoteRoot;
+}
+
+void FolderUploader::foldersFound(QStringList relativeFolders)
+{
+    if (uploadEnded) return;
+
+    for (QString aFolder : relativeFolders)
+    {
+        QString parentFolder = parentOf(aFolder);
+        if (createdFolders.contains(parentFolder))
+        {
+            readyFolders.append(aFolder);
+        }
+        else
+        {
+            foldersByParent[parentFolder].append(aFolder);
+        }
+    }
+    foldersFound += relativeFolders.size();
+
+    startNextMkdirs();
+    emit folderUploadProgress(createdFolders.size(), foldersFound, filesDone, filesFound);
+}
+
+void FolderUploader::filesFound(QStringList relativeFiles, QList<qint64> fileSizes)
+{
+    if (uploadEnded) return;
+
+    QSet<QString> touchedFolders;
+    for (int i = 0; i < relativeFiles.size(); i++)
+    {
+        ScannedFile newFile;
+        newFile.relativePath = relativeFiles.at(i);
+        newFile.fileSize = fileSizes.value(i);
+        QString parentFolder = parentOf(newFile.relativePath);
+        waitingFiles[parentFolder].append(newFile);
+        touchedFolders.insert(parentFolder);
+    }
+    filesFound += relativeFiles.size();
+
+    //Files found in folders which already exist go straight to the queue
+    for (QString aFolder : touchedFolders)
+    {
+        if (createdFolders.contains(aFolder)) queueFolderFiles(aFolder);
+    }
+    emit folderUploadProgress(createdFolders.size(), foldersFound, filesDone, filesFound);
+}
+
+void FolderUploader::scanFinished(bool scanOkay)
+{
+    scanDone = true;
+    scanThread.quit();
+    scanWorker = nullptr;
+
+    if (!scanOkay)
+    {
+        failUpload(QString("Unable to read local folder: %1").arg(localRoot));
+        return;
+    }
+    checkIfDone();
+}
+
+void FolderUploader::mkdirReply(RequestState replyState, FileMetaData)
+{
+    if (!activeMkdirs.contains(sender())) return;
+    QString relativeFolder = activeMkdirs.take(sender());
+    if (uploadEnded) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        failUpload(QString("Unable to create remote folder: %1").arg(remotePathOf(relativeFolder)));
+        return;
+    }
+
+    createdFolders.insert(relativeFolder);
+    readyFolders.append(foldersByParent.take(relativeFolder));
+    queueFolderFiles(relativeFolder);
+    startNextMkdirs();
+
+    emit folderUploadProgress(createdFolders.size(), foldersFound, filesDone, filesFound);
+    checkIfDone();
+}
+
+void FolderUploader::transferFinished(int transferID, RequestState finalState)
+{
+    if (!activeTransfers.remove(transferID)) return;
+
+    filesDone++;
+    if (finalState != RequestState::GOOD) filesFailed++;
+
+    emit folderUploadProgress(createdFolders.size(), foldersFound, filesDone, filesFound);
+    checkIfDone();
+}
+
+void FolderUploader::startNextMkdirs()
+{
+    while (!uploadEnded && (activeMkdirs.size() < maxMkdirs) && !readyFolders.isEmpty())
+    {
+        QString nextFolder = readyFolders.takeFirst();
+
+        RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+        RemoteDataReply * theReply;
+        if (nextFolder.isEmpty())
+        {
+            theReply = theLane->createFolder(remoteParent, QDir(localRoot).dirName());
+        }
+        else
+        {
+            theReply = theLane->createFolder(remotePathOf(parentOf(nextFolder)), nextFolder.section('/', -1));
+        }
+
+        if (theReply == nullptr)
+        {
+            failUpload(QString("Unable to create remote folder: %1").arg(remotePathOf(nextFolder)));
+            return;
+        }
+        ae_globals::get_lane_pool()->trackReply(theLane, theReply);
+        activeMkdirs.insert(theReply, nextFolder);
+        QObject::connect(theReply, SIGNAL(haveMkdirReply(RequestState,FileMetaData)),
+                         this, SLOT(mkdirReply(RequestState,FileMetaData)));
+    }
+}
+
+void FolderUploader::queueFolderFiles(QString relativeFolder)
+{
+    QString remoteFolder = remotePathOf(relativeFolder);
+    for (const ScannedFile &aFile : waitingFiles.take(relativeFolder))
+    {
+        //A failure to send is posted by the queue, so the ID is always recorded before it ends
+        int transferID = ae_globals::get_transfer_queue()->enqueueUpload(QDir(localRoot).filePath(aFile.relativePath), remoteFolder, aFile.fileSize, TransferPriority::BACKGROUND);
+        if (transferID < 0)
+        {
+            filesDone++;
+            filesFailed++;
+            continue;
+        }
+        activeTransfers.insert(transferID);
+    }
+}
+
+void FolderUploader::checkIfDone()
+{
+    if (uploadEnded || !scanDone) return;
+    if (!activeMkdirs.isEmpty() || !readyFolders.isEmpty() || !waitingFiles.isEmpty() || !activeTransfers.isEmpty()) return;
+
+    uploadEnded = true;
+    if (filesFailed > 0)
+    {
+        emit folderUploadFinished(RequestState::EXPLICIT_ERROR, QString("Folder upload finished, but %1 of %2 files failed.").arg(filesFailed).arg(filesFound));
+        return;
+    }
+    emit folderUploadFinished(RequestState::GOOD, QString("Uploaded %1 files in %2 folders.").arg(filesFound).arg(createdFolders.size()));
+}
+
+void FolderUploader::failUpload(QString message)
+{
+    if (uploadEnded) return;
+    uploadEnded = true;
+
+    if (scanWorker != nullptr) scanWorker->cancel();
+
+    //Uploads already queued are left to finish; folders and files not yet started are dropped
+    readyFolders.clear();
+    foldersByParent.clear();
+    waitingFiles.clear();
+    activeMkdirs.clear();
+
+    qCDebug(agaveAppLayer, "Folder upload of %s stopped: %s", qPrintable(localRoot), qPrintable(message));
+    emit folderUploadFinished(RequestState::EXPLICIT_ERROR, message);
+}
+
+QString FolderUploader::parentOf(QString relativePath)
+{
+    int lastSlash = relativePath.lastIndexOf('/');
+    if (lastSlash < 0) return QString("");
+    return relativePath.left(lastSlash);
+}
+
+QString FolderUploader::remotePathOf(QString relativePath)
+{
+    if (relativePath.isEmpty()) return remoteRoot;
+    return remoteRoot + "/" + relativePath;
+}
@@ -0,0 +1,150 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FOLDERUPLOADER_H
+#define FOLDERUPLOADER_H
+
+#include <QObject>
+#include <QThread>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+
+class FileMetaData;
+enum class RequestState;
+
+/*! \brief The LocalScanWorker walks a local folder tree in its own thread, and reports what it finds in batches.
+ *
+ *  Folders are always reported before the files inside them. Paths are relative to the root folder, with '/' separators, and the root folder itself is "". Modification times are in ms since the epoch.
+ */
+
+class LocalScanWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalScanWorker(QString rootFolder);
+
+    void cancel();
+
+    static const int batchSize = 500;
+
+signals:
+    void foldersFound(QStringList relativeFolders);
+    void filesFound(QStringList relativeFiles, QList<qint64> fileSizes, QList<qint64> modifiedTimes);
+    void scanFinished(bool scanOkay);
+
+public slots:
+    void startScan();
+
+private:
+    QString rootPath;
+    QAtomicInt cancelled;
+};
+
+/*! \brief The FolderUploader uploads a local folder tree as a three stage pipeline.
+ *
+ *  Stage one is the local walk, run by a LocalScanWorker on a worker thread, so the GUI thread never waits on the local disk. Stage two creates the remote folder skeleton. Every folder whose parent already exists is created at once, up to maxMkdirs in flight. Stage three queues each file's upload in the TransferQueue as soon as its remote folder exists.
+ *
+ *  All three stages overlap: uploads into the first folders start while the walk is still going.
+ */
+
+class FolderUploader : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Makes an uploader which copies localFolder, and everything under it, into a new folder of the same name inside remoteParent.
+     */
+    explicit FolderUploader(QString localFolder, QString remoteParent, QObject *parent = nullptr);
+    ~FolderUploader();
+
+    void start();
+    void cancel();
+
+    QString getLocalFolder();
+    QString getRemoteFolder();
+
+    static const int maxMkdirs = 4;
+
+signals:
+    void folderUploadProgress(int foldersCreated, int foldersFound, int filesDone, int filesFound);
+    void folderUploadFinished(RequestState finalState, QString message);
+
+private slots:
+    void foldersFound(QStringList relativeFolders);
+    void filesFound(QStringList relativeFiles, QList<qint64> fileSizes);
+    void scanFinished(bool scanOkay);
+    void mkdirReply(RequestState replyState, FileMetaData newFolder);
+    void transferFinished(int transferID, RequestState finalState);
+
+private:
+    struct ScannedFile
+    {
+        QString relativePath;
+        qint64 fileSize;
+    };
+
+    void startNextMkdirs();
+    void queueFolderFiles(QString relativeFolder);
+    void checkIfDone();
+    void failUpload(QString message);
+
+    static QString parentOf(QString relativePath);
+    QString remotePathOf(QString relativePath);
+
+    QString localRoot;
+    QString remoteParent;
+    QString remoteRoot;
+
+    QThread scanThread;
+    LocalScanWorker * scanWorker = nullptr;
+    bool scanDone = false;
+
+    QSet<QString> createdFolders;
+    QList<QString> readyFolders;
+    QHash<QString, QStringList> foldersByParent;
+    QHash<QObject *, QString> activeMkdirs;
+    QHash<QString, QList<ScannedFile>> waitingFiles;
+    QSet<int> activeTransfers;
+
+    int foldersFound = 0;
+    int filesFound = 0;
+    int filesDone = 0;
+    int filesFailed = 0;
+    bool uploadEnded = false;
+};
+
+#endif // FOLDERUPLOADER_H
@@ -0,0 +1,256 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotefiletail.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "ae_globals.h"
+
+const int RemoteFileTail::firstPollInterval;
+const int RemoteFileTail::maxPollInterval;
+const int RemoteFileTail::maxTailFailures;
+const qint64 RemoteFileTail::maxReadLength;
+
+RemoteFileTail::RemoteFileTail(QString newRemotePath, QObject *parent) : QObject(parent)
+{
+    remotePath = newRemotePath;
+    localPath = tailFolder.filePath("tail");
+
+    //The viewer opens the local copy at once, before any bytes arrive
+    QFile localFile(localPath);
+    localFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    localFile.close();
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollTimeout()));
+}
+
+RemoteFileTail::~RemoteFileTail()
+{
+    stop();
+}
+
+void RemoteFileTail::start()
+{
+    if (running) return;
+    running = true;
+    failures = 0;
+    pollInterval = firstPollInterval;
+    pollTimeout();
+}
+
+void RemoteFileTail::stop()
+{
+    running = false;
+    pollTimer.stop();
+
+    if (pendingSession != nullptr)
+    {
+        pendingSession->cancelTask(pendingTaskID);
+    }
+    pendingTask = nullptr;
+    pendingSession = nullptr;
+    pendingTaskID = -1;
+}
+
+bool RemoteFileTail::isRunning()
+{
+    return running;
+}
+
+QString RemoteFileTail::getRemotePath()
+{
+    return remotePath;
+}
+
+QString RemoteFileTail::getLocalPath()
+{
+    return localPath;
+}
+
+qint64 RemoteFileTail::getLocalSize()
+{
+    return localSize;
+}
+
+void RemoteFileTail::pollTimeout()
+{
+    if (!running || (pendingTask != nullptr)) return;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        checkFailed("Direct transfer connection is not available.");
+        return;
+    }
+
+    //The listing of one file is a small reply, whether or not the file has grown
+    RestTask * sizeTask = theSession->newListing(remotePath);
+    QObject::connect(sizeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(sizeReply(RequestState,QByteArray,qint64)));
+    pendingTask = sizeTask;
+    pendingSession = theSession;
+    pendingTaskID = sizeTask->getTaskID();
+    theSession->submitTask(sizeTask);
+}
+
+void RemoteFileTail::sizeReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (sender() != pendingTask) return;
+    pendingTask = nullptr;
+    pendingSession = nullptr;
+    pendingTaskID = -1;
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState != RequestState::GOOD) || (resultList.size() != 1) ||
+            (resultList.first().toObject().value("type").toString() != "file"))
+    {
+        checkFailed("Unable to read remote file information.");
+        return;
+    }
+    failures = 0;
+    remoteSize = (qint64) resultList.first().toObject().value("length").toDouble();
+
+    if (remoteSize < localSize)
+    {
+        qCDebug(agaveAppLayer, "Remote file shrank, restarting tail: %s", qPrintable(remotePath));
+        if (!resizeLocalFile(0))
+        {
+            stop();
+            emit tailStopped("Unable to write local copy.");
+            return;
+        }
+        localSize = 0;
+        pollInterval = firstPollInterval;
+        emit tailRestarted();
+    }
+
+    if (remoteSize > localSize)
+    {
+        startRangeRead();
+        return;
+    }
+
+    pollInterval = qMin(maxPollInterval, pollInterval * 3 / 2);
+    scheduleNext(pollInterval);
+    emit tailChecked(pollInterval);
+}
+
+void RemoteFileTail::rangeReply(RequestState replyState, QByteArray, qint64 bytesWritten)
+{
+    if (sender() != pendingTask) return;
+    pendingTask = nullptr;
+    pendingSession = nullptr;
+    pendingTaskID = -1;
+
+    if ((replyState != RequestState::GOOD) || (bytesWritten <= 0))
+    {
+        //A range cut off part way leaves stray bytes past the end of the local copy
+        resizeLocalFile(localSize);
+        checkFailed("Unable to read new bytes of remote file.");
+        return;
+    }
+    failures = 0;
+    localSize += bytesWritten;
+    pollInterval = firstPollInterval;
+    emit tailGrew(localSize);
+
+    if (localSize < remoteSize)
+    {
+        startRangeRead();
+        return;
+    }
+    scheduleNext(pollInterval);
+}
+
+void RemoteFileTail::startRangeRead()
+{
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        checkFailed("Direct transfer connection is not available.");
+        return;
+    }
+
+    qint64 lastByte = qMin(remoteSize, localSize + maxReadLength) - 1;
+    RestTask * rangeTask = theSession->newMediaRead(remotePath, localSize, lastByte);
+    rangeTask->setOutputFile(localPath, localSize);
+    QObject::connect(rangeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(rangeReply(RequestState,QByteArray,qint64)));
+    pendingTask = rangeTask;
+    pendingSession = theSession;
+    pendingTaskID = rangeTask->getTaskID();
+    theSession->submitTask(rangeTask);
+}
+
+void RemoteFileTail::checkFailed(QString message)
+{
+    failures++;
+    qCDebug(agaveAppLayer, "Tail check failed (%d) for %s: %s", failures, qPrintable(remotePath), qPrintable(message));
+
+    if (failures >= maxTailFailures)
+    {
+        stop();
+        emit tailStopped(message);
+        return;
+    }
+    pollInterval = qMin(maxPollInterval, pollInterval * 3 / 2);
+    scheduleNext(pollInterval);
+    emit tailChecked(pollInterval);
+}
+
+void RemoteFileTail::scheduleNext(int waitMsec)
+{
+    if (!running) return;
+    pollTimer.start(waitMsec);
+}
+
+bool RemoteFileTail::resizeLocalFile(qint64 newSize)
+{
+    QFile localFile(localPath);
+    if (!localFile.open(QIODevice::ReadWrite)) return false;
+    bool ret = localFile.resize(newSize);
+    localFile.close();
+    return ret;
+}
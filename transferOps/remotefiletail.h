@@ -0,0 +1,117 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTEFILETAIL_H
+#define REMOTEFILETAIL_H
+
+#include <QObject>
+#include <QTimer>
+#include <QTemporaryDir>
+
+class AgaveRestSession;
+enum class RequestState;
+
+/*! \brief A RemoteFileTail follows a remote file which is still being written, such as the log of a running job, by fetching only the bytes added since the last check.
+ *
+ *  Each check reads the length of the remote file. If it has grown, the new bytes are read with a byte range starting at the end of the local copy, and appended to it. Large gains are read in pieces of up to maxReadLength, one after another.
+ *
+ *  Checks start every firstPollInterval. Each check which finds no new bytes waits half again as long as the one before, up to maxPollInterval, and new bytes bring the wait back down. If the remote file gets shorter, it is taken to have been rewritten, and the local copy starts over.
+ *
+ *  The local copy is a temporary file, removed when the tail is deleted.
+ */
+
+class RemoteFileTail : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RemoteFileTail(QString remotePath, QObject *parent = nullptr);
+    ~RemoteFileTail();
+
+    void start();
+    void stop();
+    bool isRunning();
+
+    QString getRemotePath();
+    QString getLocalPath();
+    qint64 getLocalSize();
+
+    static const int firstPollInterval = 2000;
+    static const int maxPollInterval = 60000;
+    static const int maxTailFailures = 5;
+    static const qint64 maxReadLength = 4 * 1024 * 1024;
+
+signals:
+    /*! \brief Emitted when new bytes have been appended to the local copy.
+     */
+    void tailGrew(qint64 localSize);
+
+    /*! \brief Emitted when the remote file got shorter, and the local copy was emptied to start over.
+     */
+    void tailRestarted();
+
+    /*! \brief Emitted after each check which found no new bytes, with the wait until the next one.
+     */
+    void tailChecked(int nextCheckMsec);
+    void tailStopped(QString message);
+
+private slots:
+    void pollTimeout();
+    void sizeReply(RequestState replyState, QByteArray body, qint64);
+    void rangeReply(RequestState replyState, QByteArray, qint64 bytesWritten);
+
+private:
+    void startRangeRead();
+    void checkFailed(QString message);
+    void scheduleNext(int waitMsec);
+    bool resizeLocalFile(qint64 newSize);
+
+    QString remotePath;
+    QString localPath;
+    QTemporaryDir tailFolder;
+
+    qint64 localSize = 0;
+    qint64 remoteSize = -1;
+
+    bool running = false;
+    int pollInterval = firstPollInterval;
+    int failures = 0;
+    QTimer pollTimer;
+
+    QObject * pendingTask = nullptr;
+    AgaveRestSession * pendingSession = nullptr;
+    int pendingTaskID = -1;
+};
+
+#endif // REMOTEFILETAIL_H
@@ -0,0 +1,357 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "segmenteddownload.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "remotedatainterface.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "utilFuncs/crc32c.h"
+#include "ae_globals.h"
+
+const qint64 SegmentedDownload::minSegmentSize;
+const int SegmentedDownload::maxSegmentTries;
+
+SegmentedDownload::SegmentedDownload(QString newRemotePath, QString newLocalPath, QObject *parent) : QObject(parent)
+{
+    remotePath = newRemotePath;
+    localPath = newLocalPath;
+
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        maxSegments = 2 * ae_globals::get_lane_pool()->bulkLaneCount();
+    }
+}
+
+void SegmentedDownload::setMaxSegments(int newMax)
+{
+    if (newMax < 1) newMax = 1;
+    maxSegments = newMax;
+}
+
+void SegmentedDownload::setTransferLimiter(QSharedPointer<RateLimiter> newLimiter)
+{
+    transferLimiter = newLimiter;
+}
+
+void SegmentedDownload::start()
+{
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        failDownload("Direct transfer connection is not available.");
+        return;
+    }
+
+    //The listing of a file gives its length, which fixes the segment layout
+    RestTask * sizeTask = theSession->newListing(remotePath);
+    QObject::connect(sizeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(sizeReply(RequestState,QByteArray,qint64)));
+    theSession->submitTask(sizeTask);
+}
+
+void SegmentedDownload::cancel()
+{
+    failDownload("Download cancelled.");
+}
+
+QString SegmentedDownload::getRemotePath()
+{
+    return remotePath;
+}
+
+QString SegmentedDownload::getLocalPath()
+{
+    return localPath;
+}
+
+qint64 SegmentedDownload::getTotalSize()
+{
+    return totalSize;
+}
+
+bool SegmentedDownload::hasChecksum()
+{
+    return checksumKnown;
+}
+
+quint32 SegmentedDownload::getChecksum()
+{
+    return fileChecksum;
+}
+
+void SegmentedDownload::sizeReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (downloadEnded) return;
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState != RequestState::GOOD) || (resultList.size() != 1) ||
+            (resultList.first().toObject().value("type").toString() != "file"))
+    {
+        failDownload("Unable to read remote file information.");
+        return;
+    }
+    totalSize = (qint64) resultList.first().toObject().value("length").toDouble();
+    remoteModified = resultList.first().toObject().value("lastModified").toString();
+
+    //Preallocate, so that every segment can write into its own place in the file
+    QFile localFile(localPath);
+    if (!localFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || !localFile.resize(totalSize))
+    {
+        failDownload("Unable to create local file.");
+        return;
+    }
+    localFile.close();
+
+    int numSegments = (int) qMin((qint64) maxSegments, (totalSize + minSegmentSize - 1) / minSegmentSize);
+    if (numSegments < 1) numSegments = 1;
+    qint64 segmentLength = (totalSize + numSegments - 1) / numSegments;
+
+    for (int i = 0; i < numSegments; i++)
+    {
+        FileSegment newSegment;
+        newSegment.firstByte = i * segmentLength;
+        newSegment.length = qMin(segmentLength, totalSize - newSegment.firstByte);
+        segmentList.append(newSegment);
+    }
+    qCDebug(agaveAppLayer, "Downloading %s in %d segments", qPrintable(remotePath), numSegments);
+
+    if (totalSize == 0)
+    {
+        segmentList.first().done = true;
+        segmentList.first().crcLength = 0;
+        verifyAndFinish();
+        return;
+    }
+    for (int i = 0; i < segmentList.size(); i++)
+    {
+        startSegment(i);
+    }
+}
+
+void SegmentedDownload::segmentProgress(qint64 bytesDone, qint64)
+{
+    if (!taskSegments.contains(sender())) return;
+    segmentList[taskSegments.value(sender())].bytesDone = bytesDone;
+
+    qint64 allDone = 0;
+    for (const FileSegment &aSegment : segmentList)
+    {
+        allDone += aSegment.bytesDone;
+    }
+    emit downloadProgress(allDone, totalSize);
+}
+
+void SegmentedDownload::segmentChecksum(quint32 crc32c, qint64 length)
+{
+    //Comes just before the segment's reply, from the same task
+    if (!taskSegments.contains(sender())) return;
+    FileSegment &theSegment = segmentList[taskSegments.value(sender())];
+    theSegment.crc32c = crc32c;
+    theSegment.crcLength = length;
+}
+
+void SegmentedDownload::segmentReply(RequestState replyState, QByteArray, qint64 bytesWritten)
+{
+    if (!taskSegments.contains(sender())) return;
+    int segmentNum = taskSegments.take(sender());
+    FileSegment &theSegment = segmentList[segmentNum];
+    theSegment.activeSession = nullptr;
+    theSegment.activeTaskID = -1;
+
+    if (downloadEnded) return;
+
+    if ((replyState == RequestState::GOOD) && (bytesWritten == theSegment.length))
+    {
+        theSegment.done = true;
+        theSegment.bytesDone = theSegment.length;
+        verifyAndFinish();
+        return;
+    }
+
+    if (theSegment.tries >= maxSegmentTries)
+    {
+        failDownload(QString("Segment at byte %1 failed after %2 tries.").arg(theSegment.firstByte).arg(theSegment.tries));
+        return;
+    }
+    qCDebug(agaveAppLayer, "Retrying segment %d of %s", segmentNum, qPrintable(remotePath));
+    startSegment(segmentNum);
+}
+
+void SegmentedDownload::rangeNotSupported(qint64)
+{
+    if (!taskSegments.contains(sender())) return;
+
+    //Segment 0 is now receiving the whole file, so the others are dropped
+    FileSegment &firstSegment = segmentList.first();
+    firstSegment.length = totalSize;
+    for (int i = 1; i < segmentList.size(); i++)
+    {
+        if (segmentList.at(i).activeSession != nullptr)
+        {
+            segmentList.at(i).activeSession->cancelTask(segmentList.at(i).activeTaskID);
+        }
+    }
+    segmentList.resize(1);
+
+    for (auto itr = taskSegments.begin(); itr != taskSegments.end();)
+    {
+        if (itr.value() != 0) itr = taskSegments.erase(itr);
+        else itr++;
+    }
+}
+
+void SegmentedDownload::startSegment(int segmentNum)
+{
+    FileSegment &theSegment = segmentList[segmentNum];
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    if (theSession == nullptr)
+    {
+        failDownload("Direct transfer connection is not available.");
+        return;
+    }
+
+    theSegment.tries++;
+    theSegment.bytesDone = 0;
+    theSegment.crcLength = -1;
+
+    RestTask * rangeTask = theSession->newMediaRead(remotePath, theSegment.firstByte, theSegment.firstByte + theSegment.length - 1);
+    rangeTask->setOutputFile(localPath, theSegment.firstByte);
+    if (!transferLimiter.isNull()) rangeTask->setTransferLimiter(transferLimiter);
+    QObject::connect(rangeTask, SIGNAL(progress(qint64,qint64)), this, SLOT(segmentProgress(qint64,qint64)));
+    QObject::connect(rangeTask, SIGNAL(checksumReady(quint32,qint64)), this, SLOT(segmentChecksum(quint32,qint64)));
+    QObject::connect(rangeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(segmentReply(RequestState,QByteArray,qint64)));
+    if (segmentNum == 0)
+    {
+        QObject::connect(rangeTask, SIGNAL(rangeNotSupported(qint64)), this, SLOT(rangeNotSupported(qint64)));
+    }
+
+    taskSegments.insert(rangeTask, segmentNum);
+    theSegment.activeSession = theSession;
+    theSegment.activeTaskID = rangeTask->getTaskID();
+    theSession->submitTask(rangeTask);
+}
+
+void SegmentedDownload::verifyAndFinish()
+{
+    for (const FileSegment &aSegment : segmentList)
+    {
+        if (!aSegment.done) return;
+    }
+
+    //Every segment delivered exactly its length; the remote file must also be the one listed at the start
+    if (recheckStarted) return;
+    recheckStarted = true;
+
+    AgaveRestSession * theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::INTERACTIVE);
+    if (theSession == nullptr)
+    {
+        failDownload("Direct transfer connection is not available.");
+        return;
+    }
+    RestTask * recheckTask = theSession->newListing(remotePath);
+    QObject::connect(recheckTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(recheckReply(RequestState,QByteArray,qint64)));
+    theSession->submitTask(recheckTask);
+}
+
+void SegmentedDownload::recheckReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (downloadEnded) return;
+
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState != RequestState::GOOD) || (resultList.size() != 1))
+    {
+        failDownload("Unable to confirm that the remote file was unchanged.");
+        return;
+    }
+    QJsonObject fileObject = resultList.first().toObject();
+    if (((qint64) fileObject.value("length").toDouble() != totalSize) ||
+            (fileObject.value("lastModified").toString() != remoteModified))
+    {
+        failDownload("The remote file changed during the download.");
+        return;
+    }
+    finishDownload();
+}
+
+void SegmentedDownload::finishDownload()
+{
+    //Joining the segment checksums in order gives the checksum of the file, with no second pass over it
+    checksumKnown = true;
+    fileChecksum = 0;
+    for (const FileSegment &aSegment : segmentList)
+    {
+        if (aSegment.crcLength != aSegment.length)
+        {
+            checksumKnown = false;
+            break;
+        }
+        fileChecksum = Crc32c::combine(fileChecksum, aSegment.crc32c, aSegment.length);
+    }
+
+    downloadEnded = true;
+    emit downloadProgress(totalSize, totalSize);
+    emit downloadFinished(RequestState::GOOD, QString("Downloaded %1").arg(remotePath));
+}
+
+void SegmentedDownload::failDownload(QString message)
+{
+    if (downloadEnded) return;
+    downloadEnded = true;
+
+    for (const FileSegment &aSegment : segmentList)
+    {
+        if (aSegment.activeSession == nullptr) continue;
+        aSegment.activeSession->cancelTask(aSegment.activeTaskID);
+    }
+
+    //A partial file is not left behind looking like a finished one
+    if (totalSize >= 0)
+    {
+        QFile::remove(localPath);
+    }
+    qCDebug(agaveAppLayer, "Download of %s failed: %s", qPrintable(remotePath), qPrintable(message));
+    emit downloadFinished(RequestState::EXPLICIT_ERROR, message);
+}
@@ -0,0 +1,132 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef SEGMENTEDDOWNLOAD_H
+#define SEGMENTEDDOWNLOAD_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+class AgaveRestSession;
+class RateLimiter;
+enum class RequestState;
+
+/*! \brief A SegmentedDownload fetches one remote file as several byte ranges at once, spread over the bulk network lanes.
+ *
+ *  The local file is preallocated at its full size, and each range is written straight into its place in the file from the lane thread which receives it. When every range is in, the download is verified: each range must have delivered exactly its length, and the remote file is listed again, and must still have the length and modification time it had when the download started. Otherwise, ranges read at different times could come from different versions of the file.
+ *
+ *  Each range is checksummed as it is written, and the checksums are joined in file order once every range is in, giving the CRC-32C of the whole file.
+ *
+ *  If the server does not honor byte ranges, the download falls back to a single stream.
+ */
+
+class SegmentedDownload : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SegmentedDownload(QString remotePath, QString localPath, QObject *parent = nullptr);
+
+    void setMaxSegments(int newMax);
+
+    /*! \brief Sets a limiter shared by all of this download's segments, so the limit holds for the download as a whole.
+     */
+    void setTransferLimiter(QSharedPointer<RateLimiter> newLimiter);
+    void cancel();
+
+    QString getRemotePath();
+    QString getLocalPath();
+    qint64 getTotalSize();
+
+    /*! \brief Returns true once the download has finished, with a checksum of the whole file.
+     */
+    bool hasChecksum();
+    quint32 getChecksum();
+
+    static const qint64 minSegmentSize = 8 * 1024 * 1024;
+    static const int maxSegmentTries = 3;
+
+public slots:
+    void start();
+
+signals:
+    void downloadProgress(qint64 bytesDone, qint64 bytesTotal);
+    void downloadFinished(RequestState finalState, QString message);
+
+private slots:
+    void sizeReply(RequestState replyState, QByteArray body, qint64);
+    void recheckReply(RequestState replyState, QByteArray body, qint64);
+    void segmentProgress(qint64 bytesDone, qint64);
+    void segmentChecksum(quint32 crc32c, qint64 length);
+    void segmentReply(RequestState replyState, QByteArray, qint64 bytesWritten);
+    void rangeNotSupported(qint64 fullSize);
+
+private:
+    struct FileSegment
+    {
+        qint64 firstByte = 0;
+        qint64 length = 0;
+        qint64 bytesDone = 0;
+        int tries = 0;
+        bool done = false;
+        quint32 crc32c = 0;
+        qint64 crcLength = -1;
+        AgaveRestSession * activeSession = nullptr;
+        int activeTaskID = -1;
+    };
+
+    void startSegment(int segmentNum);
+    void verifyAndFinish();
+    void finishDownload();
+    void failDownload(QString message);
+
+    QString remotePath;
+    QString localPath;
+    qint64 totalSize = -1;
+    QString remoteModified;
+
+    int maxSegments = 8;
+    QSharedPointer<RateLimiter> transferLimiter;
+    QVector<FileSegment> segmentList;
+    QHash<QObject *, int> taskSegments;
+
+    bool downloadEnded = false;
+    bool recheckStarted = false;
+    bool checksumKnown = false;
+    quint32 fileChecksum = 0;
+};
+
+#endif // SEGMENTEDDOWNLOAD_H
@@ -0,0 +1,182 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "transferlistmodel.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+
+#include "transferOps/transferqueue.h"
+#include "utilFuncs/crc32c.h"
+
+TransferListModel::TransferListModel(TransferQueue * theQueue, QObject *parent) : QAbstractTableModel(parent)
+{
+    myQueue = theQueue;
+    rowIDs = myQueue->transferIDs();
+
+    QObject::connect(myQueue, SIGNAL(transferAdded(int)), this, SLOT(transferAdded(int)));
+    QObject::connect(myQueue, SIGNAL(transferChanged(int)), this, SLOT(transferChanged(int)));
+    QObject::connect(myQueue, SIGNAL(transferRemoved(int)), this, SLOT(transferRemoved(int)));
+}
+
+int TransferListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return rowIDs.size();
+}
+
+int TransferListModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return 6;
+}
+
+QVariant TransferListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    TransferItem theItem = myQueue->getTransfer(transferIDForIndex(index));
+
+    if (role == Qt::ToolTipRole)
+    {
+        QString tipText = QString("%1\n%2").arg(theItem.localPath, theItem.remotePath);
+        if ((theItem.state == TransferState::DONE) && (theItem.crcLength >= 0))
+        {
+            tipText.append(QString("\nCRC-32C: %1").arg(Crc32c::toHex(theItem.crc32c)));
+        }
+        return tipText;
+    }
+    if (role == Qt::TextAlignmentRole)
+    {
+        if (index.column() >= 4) return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+
+    switch (index.column())
+    {
+    case 0:
+        return (theItem.direction == TransferDirection::UPLOAD) ? "Upload" : "Download";
+    case 1:
+        if (theItem.direction == TransferDirection::UPLOAD) return QFileInfo(theItem.localPath).fileName();
+        return QFileInfo(theItem.remotePath).fileName();
+    case 2:
+        return TransferQueue::priorityName(theItem.priority);
+    case 3:
+        if (theItem.checksumMismatch) return "Failed (Checksum)";
+        if (theItem.checksumVerified) return "Done (Verified)";
+        return TransferQueue::stateName(theItem.state);
+    case 4:
+        if (theItem.fileSize <= 0) return formatBytes(theItem.bytesDone);
+        return QString("%1 of %2 (%3%)").arg(formatBytes(theItem.bytesDone), formatBytes(theItem.fileSize))
+                .arg((100 * theItem.bytesDone) / theItem.fileSize);
+    case 5:
+    {
+        QString rateText;
+        if (theItem.state == TransferState::ACTIVE) rateText = formatBytes((qint64) theItem.bytesPerSec) + "/s";
+        if (theItem.rateLimit > 0)
+        {
+            if (!rateText.isEmpty()) rateText.append(" ");
+            rateText.append(QString("(max %1/s)").arg(formatBytes(theItem.rateLimit)));
+        }
+        return rateText;
+    }
+    }
+    return QVariant();
+}
+
+QVariant TransferListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+
+    switch (section)
+    {
+    case 0: return "Transfer";
+    case 1: return "File";
+    case 2: return "Priority";
+    case 3: return "Status";
+    case 4: return "Progress";
+    case 5: return "Rate";
+    }
+    return QVariant();
+}
+
+int TransferListModel::transferIDForIndex(const QModelIndex &index) const
+{
+    if (!index.isValid() || (index.row() >= rowIDs.size())) return -1;
+    return rowIDs.at(index.row());
+}
+
+QString TransferListModel::formatBytes(qint64 byteCount)
+{
+    if (byteCount >= 1073741824) return QString("%1 GB").arg(byteCount / 1073741824.0, 0, 'f', 2);
+    if (byteCount >= 1048576) return QString("%1 MB").arg(byteCount / 1048576.0, 0, 'f', 1);
+    if (byteCount >= 1024) return QString("%1 KB").arg(byteCount / 1024.0, 0, 'f', 1);
+    return QString("%1 B").arg(byteCount);
+}
+
+void TransferListModel::transferAdded(int transferID)
+{
+    if (!rowIDs.isEmpty() && (transferID <= rowIDs.last())) return;
+
+    beginInsertRows(QModelIndex(), rowIDs.size(), rowIDs.size());
+    rowIDs.append(transferID);
+    endInsertRows();
+}
+
+void TransferListModel::transferChanged(int transferID)
+{
+    int theRow = rowForTransfer(transferID);
+    if (theRow < 0) return;
+    emit dataChanged(index(theRow, 0), index(theRow, columnCount() - 1));
+}
+
+void TransferListModel::transferRemoved(int transferID)
+{
+    int theRow = rowForTransfer(transferID);
+    if (theRow < 0) return;
+
+    beginRemoveRows(QModelIndex(), theRow, theRow);
+    rowIDs.removeAt(theRow);
+    endRemoveRows();
+}
+
+int TransferListModel::rowForTransfer(int transferID) const
+{
+    //Rows are added in ID order, so the IDs stay sorted as rows are removed
+    auto rowItr = std::lower_bound(rowIDs.cbegin(), rowIDs.cend(), transferID);
+    if ((rowItr == rowIDs.cend()) || (*rowItr != transferID)) return -1;
+    return rowItr - rowIDs.cbegin();
+}
@@ -0,0 +1,192 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "transfermanifest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#include "ae_globals.h"
+
+const quint32 TransferManifest::manifestMagic;
+const quint32 TransferManifest::manifestVersion;
+const int TransferManifest::saveDelay;
+
+TransferManifest::TransferManifest(QObject *parent) : QObject(parent)
+{
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDelay);
+    QObject::connect(&saveTimer, SIGNAL(timeout()), this, SLOT(saveTimeout()));
+}
+
+void TransferManifest::openManifest(QString userName, QString storageSystem)
+{
+    if (manifestDirty) saveNow();
+    entryList.clear();
+    localIndex.clear();
+
+    QByteArray manifestKey = QString("%1@%2").arg(userName, storageSystem).toUtf8();
+    manifestPath = QDir(manifestFolder()).filePath(QCryptographicHash::hash(manifestKey, QCryptographicHash::Sha1).toHex() + ".manifest");
+
+    QFile manifestFile(manifestPath);
+    if (!manifestFile.open(QIODevice::ReadOnly)) return;
+
+    QDataStream manifestStream(&manifestFile);
+    manifestStream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    manifestStream >> fileMagic >> fileVersion;
+    if ((fileMagic != manifestMagic) || (fileVersion != manifestVersion))
+    {
+        qCDebug(agaveAppLayer, "Ignoring transfer manifest of another format: %s", qPrintable(manifestPath));
+        return;
+    }
+
+    quint32 entryCount = 0;
+    manifestStream >> entryCount;
+    for (quint32 i = 0; (i < entryCount) && (manifestStream.status() == QDataStream::Ok); i++)
+    {
+        ManifestEntry anEntry;
+        manifestStream >> anEntry.remotePath >> anEntry.localPath >> anEntry.size >> anEntry.localModified
+                >> anEntry.remoteModified >> anEntry.hasChecksum >> anEntry.crc32c >> anEntry.recordedTime;
+        entryList.insert(anEntry.remotePath, anEntry);
+        localIndex.insert(anEntry.localPath, anEntry.remotePath);
+    }
+
+    if (manifestStream.status() != QDataStream::Ok)
+    {
+        qCDebug(agaveAppLayer, "Transfer manifest is damaged, starting empty: %s", qPrintable(manifestPath));
+        entryList.clear();
+        localIndex.clear();
+        return;
+    }
+    qCDebug(agaveAppLayer, "Loaded %d transfer manifest entries", entryList.size());
+}
+
+void TransferManifest::recordFile(ManifestEntry newEntry)
+{
+    newEntry.remotePath = normalizePath(newEntry.remotePath);
+    newEntry.localPath = QFileInfo(newEntry.localPath).absoluteFilePath();
+    if (newEntry.recordedTime == 0) newEntry.recordedTime = QDateTime::currentMSecsSinceEpoch();
+
+    entryList.insert(newEntry.remotePath, newEntry);
+    localIndex.insert(newEntry.localPath, newEntry.remotePath);
+
+    manifestDirty = true;
+    if (!saveTimer.isActive()) saveTimer.start();
+}
+
+bool TransferManifest::hasEntry(QString remotePath)
+{
+    return entryList.contains(normalizePath(remotePath));
+}
+
+ManifestEntry TransferManifest::getEntry(QString remotePath)
+{
+    return entryList.value(normalizePath(remotePath));
+}
+
+ManifestEntry TransferManifest::entryForLocal(QString localPath)
+{
+    QString remotePath = localIndex.value(QFileInfo(localPath).absoluteFilePath());
+    if (remotePath.isEmpty()) return ManifestEntry();
+
+    //The remote path may since have been recorded with another local file
+    ManifestEntry ret = entryList.value(remotePath);
+    if (ret.localPath != QFileInfo(localPath).absoluteFilePath()) return ManifestEntry();
+    return ret;
+}
+
+void TransferManifest::removeEntry(QString remotePath)
+{
+    if (entryList.remove(normalizePath(remotePath)) == 0) return;
+
+    manifestDirty = true;
+    if (!saveTimer.isActive()) saveTimer.start();
+}
+
+int TransferManifest::entryCount()
+{
+    return entryList.size();
+}
+
+void TransferManifest::saveNow()
+{
+    saveTimer.stop();
+    if (manifestPath.isEmpty() || !manifestDirty) return;
+
+    QDir().mkpath(manifestFolder());
+    QSaveFile manifestFile(manifestPath);
+    if (!manifestFile.open(QIODevice::WriteOnly)) return;
+
+    QDataStream manifestStream(&manifestFile);
+    manifestStream.setVersion(QDataStream::Qt_5_6);
+    manifestStream << manifestMagic << manifestVersion << (quint32) entryList.size();
+
+    for (const ManifestEntry &anEntry : entryList)
+    {
+        manifestStream << anEntry.remotePath << anEntry.localPath << anEntry.size << anEntry.localModified
+                       << anEntry.remoteModified << anEntry.hasChecksum << anEntry.crc32c << anEntry.recordedTime;
+    }
+
+    if (manifestFile.commit())
+    {
+        manifestDirty = false;
+    }
+}
+
+void TransferManifest::saveTimeout()
+{
+    saveNow();
+}
+
+QString TransferManifest::manifestFolder()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("transferManifest");
+}
+
+QString TransferManifest::normalizePath(QString remotePath)
+{
+    while ((remotePath.size() > 1) && remotePath.endsWith('/')) remotePath.chop(1);
+    if (!remotePath.startsWith('/')) remotePath.prepend('/');
+    return remotePath;
+}
@@ -0,0 +1,101 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TRANSFERMANIFEST_H
+#define TRANSFERMANIFEST_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+
+struct ManifestEntry
+{
+    QString remotePath;
+    QString localPath;
+    qint64 size = 0;
+    qint64 localModified = 0;
+    qint64 remoteModified = 0;
+    bool hasChecksum = false;
+    quint32 crc32c = 0;
+    qint64 recordedTime = 0;
+};
+
+/*! \brief The TransferManifest records every file transfer which finished, with the CRC-32C of the bytes which were moved.
+ *
+ *  Agave does not give checksums of remote files, so the manifest stands in for the remote side: a file downloaded again, unchanged on the server, must give the checksum recorded when it was last uploaded or downloaded.
+ *
+ *  Entries are keyed by remote path. There is one manifest file for each user and storage system, kept like the ListingCache.
+ */
+
+class TransferManifest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransferManifest(QObject *parent = nullptr);
+
+    void openManifest(QString userName, QString storageSystem);
+
+    void recordFile(ManifestEntry newEntry);
+    bool hasEntry(QString remotePath);
+    ManifestEntry getEntry(QString remotePath);
+
+    /*! \brief Returns the most recent entry for the given local file, or an entry with an empty remotePath if there is none.
+     */
+    ManifestEntry entryForLocal(QString localPath);
+
+    void removeEntry(QString remotePath);
+    int entryCount();
+
+    void saveNow();
+
+    static const quint32 manifestMagic = 0x41454d46;
+    static const quint32 manifestVersion = 1;
+    static const int saveDelay = 2000;
+
+private slots:
+    void saveTimeout();
+
+private:
+    static QString manifestFolder();
+    static QString normalizePath(QString remotePath);
+
+    QString manifestPath;
+    QHash<QString, ManifestEntry> entryList;
+    QHash<QString, QString> localIndex;
+    QTimer saveTimer;
+    bool manifestDirty = false;
+};
+
+#endif // TRANSFERMANIFEST_H
@@ -0,0 +1,925 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "transferqueue.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <algorithm>
+
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "netOps/remotelanepool.h"
+#include "netOps/agaverestsession.h"
+#include "netOps/resttask.h"
+#include "netOps/ratelimiter.h"
+#include "transferOps/segmenteddownload.h"
+#include "transferOps/transfermanifest.h"
+#include "utilFuncs/crc32c.h"
+#include "ae_globals.h"
+
+const int TransferQueue::progressInterval;
+const int TransferQueue::retainedEnded;
+
+TransferQueue::TransferQueue(QObject *parent) : QObject(parent)
+{
+    waitingLists.resize(3);
+
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        maxConcurrent = 2 * ae_globals::get_lane_pool()->bulkLaneCount();
+    }
+}
+
+int TransferQueue::enqueueUpload(QString localFile, QString remoteFolder, qint64 knownSize, TransferPriority priority)
+{
+    if (knownSize >= 0)
+    {
+        TransferItem newItem;
+        newItem.direction = TransferDirection::UPLOAD;
+        newItem.priority = priority;
+        newItem.localPath = localFile;
+        newItem.remotePath = remoteFolder;
+        newItem.fileSize = knownSize;
+        return addItem(newItem);
+    }
+
+    QFileInfo localInfo(localFile);
+    if (!localInfo.isFile() || !localInfo.isReadable())
+    {
+        qCDebug(agaveAppLayer, "Cannot queue upload of unreadable file: %s", qPrintable(localFile));
+        return -1;
+    }
+
+    TransferItem newItem;
+    newItem.direction = TransferDirection::UPLOAD;
+    newItem.priority = priority;
+    newItem.localPath = localInfo.absoluteFilePath();
+    newItem.remotePath = remoteFolder;
+    newItem.fileSize = localInfo.size();
+    return addItem(newItem);
+}
+
+int TransferQueue::enqueueDownload(QString remoteFile, QString localFile, qint64 fileSize, TransferPriority priority)
+{
+    TransferItem newItem;
+    newItem.direction = TransferDirection::DOWNLOAD;
+    newItem.priority = priority;
+    newItem.localPath = localFile;
+    newItem.remotePath = remoteFile;
+    newItem.fileSize = fileSize;
+    return addItem(newItem);
+}
+
+int TransferQueue::enqueueUploadPattern(QString localPattern, QString remoteFolder)
+{
+    int ret = 0;
+    for (QString aFile : expandLocalPattern(localPattern))
+    {
+        if (enqueueUpload(aFile, remoteFolder) >= 0) ret++;
+    }
+    return ret;
+}
+
+QStringList TransferQueue::expandLocalPattern(QString localPattern)
+{
+    QStringList ret;
+
+    for (QString aPath : localPattern.split(';', QString::SkipEmptyParts))
+    {
+        aPath = aPath.trimmed();
+        QFileInfo pathInfo(aPath);
+
+        if (!pathInfo.fileName().contains('*') && !pathInfo.fileName().contains('?'))
+        {
+            if (pathInfo.isFile()) ret.append(pathInfo.absoluteFilePath());
+            continue;
+        }
+
+        QDir searchDir = pathInfo.absoluteDir();
+        QFileInfoList matchList = searchDir.entryInfoList(QStringList(pathInfo.fileName()), QDir::Files, QDir::Name);
+        for (QFileInfo aMatch : matchList)
+        {
+            ret.append(aMatch.absoluteFilePath());
+        }
+    }
+
+    return ret;
+}
+
+bool TransferQueue::setPriority(int transferID, TransferPriority newPriority)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+    if ((theItem->state == TransferState::DONE) || (theItem->state == TransferState::FAILED) ||
+            (theItem->state == TransferState::CANCELLED)) return false;
+    if (theItem->priority == newPriority) return true;
+
+    if (theItem->state == TransferState::QUEUED)
+    {
+        removeWaiting(transferID);
+        theItem->priority = newPriority;
+        addWaiting(transferID);
+    }
+    else
+    {
+        theItem->priority = newPriority;
+    }
+    emit transferChanged(transferID);
+
+    startNextTransfers();
+    return true;
+}
+
+bool TransferQueue::pauseTransfer(int transferID)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+
+    if (theItem->state == TransferState::QUEUED)
+    {
+        removeWaiting(transferID);
+    }
+    else if (theItem->state == TransferState::ACTIVE)
+    {
+        if (!canInterrupt(transferID)) return false;
+        stopTransfer(*theItem);
+    }
+    else return false;
+
+    theItem->state = TransferState::PAUSED;
+    theItem->bytesPerSec = 0.0;
+    emit transferChanged(transferID);
+
+    startNextTransfers();
+    return true;
+}
+
+bool TransferQueue::resumeTransfer(int transferID)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+    if (theItem->state != TransferState::PAUSED) return false;
+
+    if (!queueBusy)
+    {
+        queueBusy = true;
+        busyTimer.start();
+        bytesFinished = 0;
+    }
+    theItem->state = TransferState::QUEUED;
+    addWaiting(transferID);
+    emit transferChanged(transferID);
+
+    startNextTransfers();
+    return true;
+}
+
+bool TransferQueue::cancelTransfer(int transferID)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+
+    if ((theItem->state == TransferState::QUEUED) || (theItem->state == TransferState::PAUSED))
+    {
+        removeWaiting(transferID);
+    }
+    else if (theItem->state == TransferState::ACTIVE)
+    {
+        if (!canInterrupt(transferID)) return false;
+        stopTransfer(*theItem);
+    }
+    else return false;
+
+    //A partial download is not left behind looking like a finished one
+    if ((theItem->direction == TransferDirection::DOWNLOAD) && (theItem->bytesDone > 0))
+    {
+        QFile::remove(theItem->localPath);
+    }
+
+    theItem->state = TransferState::CANCELLED;
+    theItem->bytesPerSec = 0.0;
+    numCancelled++;
+    endedIDs.append(transferID);
+    qCDebug(agaveAppLayer, "Transfer cancelled: %s", qPrintable(theItem->remotePath));
+
+    emit transferChanged(transferID);
+    emit transferFinished(transferID, RequestState::EXPLICIT_ERROR);
+    emit queueProgress(numFinished + numFailed + numCancelled, totalCount(), getThroughput());
+
+    startNextTransfers();
+    return true;
+}
+
+bool TransferQueue::canInterrupt(int transferID)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+    if (theItem->state != TransferState::ACTIVE) return true;
+
+    //Transfers through the bulk connection cannot be stopped once sent, nor can one whose bytes have all moved
+    const ActiveTransfer &theWork = activeList[transferID];
+    if (theWork.readingRemoteTime) return false;
+    return (theWork.segmented || (theWork.restSession != nullptr));
+}
+
+bool TransferQueue::setTransferRateLimit(int transferID, qint64 bytesPerSec)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return false;
+
+    theItem->rateLimit = (bytesPerSec > 0) ? bytesPerSec : 0;
+    if (activeList.contains(transferID) && !activeList.value(transferID).limiter.isNull())
+    {
+        activeList.value(transferID).limiter->setRate(effectiveLimit(*theItem));
+    }
+    emit transferChanged(transferID);
+    return true;
+}
+
+void TransferQueue::setPerTransferLimits(qint64 downloadLimit, qint64 uploadLimit)
+{
+    perTransferDownloadLimit = (downloadLimit > 0) ? downloadLimit : 0;
+    perTransferUploadLimit = (uploadLimit > 0) ? uploadLimit : 0;
+
+    for (auto itr = activeList.cbegin(); itr != activeList.cend(); itr++)
+    {
+        if (itr.value().limiter.isNull()) continue;
+        itr.value().limiter->setRate(effectiveLimit(*getItem(itr.key())));
+    }
+}
+
+qint64 TransferQueue::getPerTransferDownloadLimit()
+{
+    return perTransferDownloadLimit;
+}
+
+qint64 TransferQueue::getPerTransferUploadLimit()
+{
+    return perTransferUploadLimit;
+}
+
+TransferItem TransferQueue::getTransfer(int transferID)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return TransferItem();
+    return *theItem;
+}
+
+QList<int> TransferQueue::transferIDs()
+{
+    QList<int> ret;
+    for (const TransferItem &anItem : itemList)
+    {
+        ret.append(anItem.transferID);
+    }
+    return ret;
+}
+
+void TransferQueue::clearFinished()
+{
+    for (int anID : endedIDs)
+    {
+        removeItem(anID);
+    }
+    endedIDs.clear();
+}
+
+QString TransferQueue::stateName(TransferState theState)
+{
+    if (theState == TransferState::QUEUED) return "Queued";
+    if (theState == TransferState::ACTIVE) return "Active";
+    if (theState == TransferState::PAUSED) return "Paused";
+    if (theState == TransferState::DONE) return "Done";
+    if (theState == TransferState::FAILED) return "Failed";
+    return "Cancelled";
+}
+
+QString TransferQueue::priorityName(TransferPriority thePriority)
+{
+    if (thePriority == TransferPriority::HIGH) return "High";
+    if (thePriority == TransferPriority::NORMAL) return "Normal";
+    return "Background";
+}
+
+void TransferQueue::setMaxConcurrent(int newMax)
+{
+    if (newMax < 1) newMax = 1;
+    maxConcurrent = newMax;
+    startNextTransfers();
+}
+
+int TransferQueue::getMaxConcurrent()
+{
+    return maxConcurrent;
+}
+
+int TransferQueue::queuedCount()
+{
+    int ret = 0;
+    for (const QList<int> &aList : waitingLists)
+    {
+        ret += aList.size();
+    }
+    return ret;
+}
+
+int TransferQueue::activeCount()
+{
+    return numActive;
+}
+
+int TransferQueue::finishedCount()
+{
+    return numFinished;
+}
+
+int TransferQueue::failedCount()
+{
+    return numFailed;
+}
+
+int TransferQueue::cancelledCount()
+{
+    return numCancelled;
+}
+
+int TransferQueue::totalCount()
+{
+    return nextID - 1;
+}
+
+double TransferQueue::getThroughput()
+{
+    if (!busyTimer.isValid()) return 0.0;
+    qint64 elapsed = busyTimer.elapsed();
+    if (elapsed <= 0) return 0.0;
+    return (bytesFinished * 1000.0) / elapsed;
+}
+
+void TransferQueue::uploadReply(RequestState replyState, FileMetaData)
+{
+    if (!activeReplies.contains(sender())) return;
+    finishTransfer(activeReplies.take(sender()), replyState);
+}
+
+void TransferQueue::downloadReply(RequestState replyState)
+{
+    if (!activeReplies.contains(sender())) return;
+    finishTransfer(activeReplies.take(sender()), replyState);
+}
+
+void TransferQueue::taskProgress(qint64 bytesDone, qint64 bytesTotal)
+{
+    if (!activeReplies.contains(sender())) return;
+    noteProgress(activeReplies.value(sender()), bytesDone, bytesTotal);
+}
+
+void TransferQueue::taskChecksum(quint32 crc32c, qint64 length)
+{
+    if (!checksumTasks.contains(sender())) return;
+    int transferID = checksumTasks.value(sender());
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return;
+
+    if (!activeReplies.contains(sender()))
+    {
+        //A stopped task reports the bytes it left on disk, which a resumed download builds on
+        if ((theItem->state == TransferState::PAUSED) || (theItem->state == TransferState::QUEUED))
+        {
+            theItem->crc32c = crc32c;
+            theItem->crcLength = length;
+        }
+        return;
+    }
+
+    const ActiveTransfer &theWork = activeList[transferID];
+    if (theWork.startBytes == 0)
+    {
+        theItem->crc32c = crc32c;
+        theItem->crcLength = length;
+    }
+    else if (theWork.startCrcKnown)
+    {
+        theItem->crc32c = Crc32c::combine(theWork.startCrc, crc32c, length);
+        theItem->crcLength = theWork.startBytes + length;
+    }
+    else
+    {
+        theItem->crcLength = -1;
+    }
+}
+
+void TransferQueue::taskReply(RequestState replyState, QByteArray, qint64)
+{
+    checksumTasks.remove(sender());
+    if (!activeReplies.contains(sender())) return;
+    int transferID = activeReplies.take(sender());
+
+    TransferItem * theItem = getItem(transferID);
+    qint64 startBytes = activeList.value(transferID).startBytes;
+    if ((replyState != RequestState::GOOD) && (theItem != nullptr) && (startBytes > 0))
+    {
+        //The server may not take a range; the download starts over once from the beginning
+        qCDebug(agaveAppLayer, "Resume failed, restarting download: %s", qPrintable(theItem->remotePath));
+        activeList.remove(transferID);
+        numActive--;
+        theItem->state = TransferState::QUEUED;
+        theItem->bytesDone = 0;
+        addWaiting(transferID, true);
+        startNextTransfers();
+        return;
+    }
+    finishTransfer(transferID, replyState);
+}
+
+void TransferQueue::segmentedProgress(qint64 bytesDone, qint64 bytesTotal)
+{
+    if (!activeReplies.contains(sender())) return;
+    noteProgress(activeReplies.value(sender()), bytesDone, bytesTotal);
+}
+
+void TransferQueue::segmentedReply(RequestState replyState, QString)
+{
+    sender()->deleteLater();
+    if (!activeReplies.contains(sender())) return;
+
+    SegmentedDownload * theDownload = qobject_cast<SegmentedDownload *>(sender());
+    TransferItem * theItem = getItem(activeReplies.value(sender()));
+    if ((theItem != nullptr) && theDownload->hasChecksum())
+    {
+        theItem->crc32c = theDownload->getChecksum();
+        theItem->crcLength = theDownload->getTotalSize();
+    }
+    finishTransfer(activeReplies.take(sender()), replyState);
+}
+
+void TransferQueue::remoteTimeReply(RequestState replyState, QByteArray body, qint64)
+{
+    if (!activeReplies.contains(sender())) return;
+    int transferID = activeReplies.take(sender());
+
+    qint64 remoteModified = 0;
+    QJsonArray resultList = QJsonDocument::fromJson(body).object().value("result").toArray();
+    if ((replyState == RequestState::GOOD) && (resultList.size() == 1))
+    {
+        QDateTime modTime = QDateTime::fromString(resultList.first().toObject().value("lastModified").toString(), Qt::ISODate);
+        if (modTime.isValid()) remoteModified = modTime.toMSecsSinceEpoch();
+    }
+    completeTransfer(transferID, RequestState::GOOD, remoteModified);
+}
+
+void TransferQueue::startFailed(int transferID)
+{
+    emit transferChanged(transferID);
+    emit transferFinished(transferID, RequestState::EXPLICIT_ERROR);
+    emit queueProgress(numFinished + numFailed + numCancelled, totalCount(), getThroughput());
+}
+
+int TransferQueue::addItem(TransferItem newItem)
+{
+    if (!queueBusy)
+    {
+        //Queue was idle, so throughput is measured from now
+        queueBusy = true;
+        busyTimer.start();
+        bytesFinished = 0;
+    }
+
+    while (endedIDs.size() > retainedEnded)
+    {
+        removeItem(endedIDs.takeFirst());
+    }
+
+    newItem.transferID = nextID++;
+    itemList.append(newItem);
+    addWaiting(newItem.transferID);
+    emit transferAdded(newItem.transferID);
+
+    startNextTransfers();
+    return newItem.transferID;
+}
+
+void TransferQueue::startNextTransfers()
+{
+    while (numActive < maxConcurrent)
+    {
+        int transferID = takeNextWaiting();
+        if (transferID < 0) break;
+        startTransfer(*getItem(transferID));
+    }
+
+    //High priority transfers do not wait behind background ones
+    while (!waitingLists.at((int) TransferPriority::HIGH).isEmpty())
+    {
+        int preemptID = findPreemptable();
+        if (preemptID < 0) break;
+
+        TransferItem * preemptItem = getItem(preemptID);
+        qCDebug(agaveAppLayer, "Pausing background transfer for high priority: %s", qPrintable(preemptItem->remotePath));
+        stopTransfer(*preemptItem);
+        preemptItem->state = TransferState::QUEUED;
+        preemptItem->bytesPerSec = 0.0;
+        addWaiting(preemptID, true);
+        emit transferChanged(preemptID);
+
+        startTransfer(*getItem(takeNextWaiting()));
+    }
+
+    if (queueBusy && (numActive == 0) && (queuedCount() == 0))
+    {
+        queueBusy = false;
+        emit queueDrained();
+    }
+}
+
+void TransferQueue::startTransfer(TransferItem &theItem)
+{
+    ActiveTransfer newWork;
+    newWork.runTimer.start();
+    theItem.checksumVerified = false;
+    theItem.checksumMismatch = false;
+
+    AgaveRestSession * theSession = nullptr;
+    if (ae_globals::get_lane_pool() != nullptr)
+    {
+        theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    }
+
+    if (theSession == nullptr)
+    {
+        RemoteDataInterface * theLane = ae_globals::get_bulk_connection();
+        RemoteDataReply * theReply;
+        if (theItem.direction == TransferDirection::UPLOAD)
+        {
+            theReply = theLane->uploadFile(theItem.remotePath, theItem.localPath);
+        }
+        else
+        {
+            theReply = theLane->downloadFile(theItem.localPath, theItem.remotePath);
+        }
+        if (theReply == nullptr)
+        {
+            //Posted, since this may be inside the enqueue call, before the caller has the ID
+            theItem.state = TransferState::FAILED;
+            numFailed++;
+            endedIDs.append(theItem.transferID);
+            QMetaObject::invokeMethod(this, "startFailed", Qt::QueuedConnection, Q_ARG(int, theItem.transferID));
+            return;
+        }
+        ae_globals::get_lane_pool()->trackReply(theLane, theReply);
+
+        if (theItem.direction == TransferDirection::UPLOAD)
+        {
+            QObject::connect(theReply, SIGNAL(haveUploadReply(RequestState,FileMetaData)),
+                             this, SLOT(uploadReply(RequestState,FileMetaData)));
+        }
+        else
+        {
+            QObject::connect(theReply, SIGNAL(haveDownloadReply(RequestState)),
+                             this, SLOT(downloadReply(RequestState)));
+        }
+        newWork.workObject = theReply;
+    }
+    else if ((theItem.direction == TransferDirection::DOWNLOAD) && (theItem.fileSize >= 2 * SegmentedDownload::minSegmentSize))
+    {
+        theItem.bytesDone = 0;
+        theItem.crcLength = -1;
+        SegmentedDownload * theDownload = new SegmentedDownload(theItem.remotePath, theItem.localPath, this);
+        newWork.limiter = QSharedPointer<RateLimiter>(new RateLimiter(effectiveLimit(theItem)));
+        theDownload->setTransferLimiter(newWork.limiter);
+        QObject::connect(theDownload, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(segmentedProgress(qint64,qint64)));
+        QObject::connect(theDownload, SIGNAL(downloadFinished(RequestState,QString)), this, SLOT(segmentedReply(RequestState,QString)));
+        newWork.workObject = theDownload;
+        newWork.segmented = true;
+    }
+    else
+    {
+        RestTask * theTask;
+        if (theItem.direction == TransferDirection::UPLOAD)
+        {
+            theItem.bytesDone = 0;
+            theItem.crcLength = -1;
+            theTask = theSession->newMediaUpload(theItem.localPath, theItem.remotePath);
+        }
+        else
+        {
+            //A paused download picks up after the bytes already on disk, trimmed to those covered by its checksum
+            QFile localFile(theItem.localPath);
+            qint64 resumeAt = (theItem.bytesDone > 0) ? QFileInfo(theItem.localPath).size() : 0;
+            if ((theItem.crcLength >= 0) && (theItem.crcLength < resumeAt)) resumeAt = theItem.crcLength;
+            if (!localFile.open(QIODevice::ReadWrite) || !localFile.resize(resumeAt))
+            {
+                resumeAt = 0;
+            }
+            localFile.close();
+
+            newWork.startCrcKnown = (theItem.crcLength == resumeAt);
+            newWork.startCrc = theItem.crc32c;
+            theItem.crcLength = -1;
+
+            theTask = theSession->newMediaRead(theItem.remotePath, (resumeAt > 0) ? resumeAt : -1);
+            theTask->setOutputFile(theItem.localPath, resumeAt);
+            theItem.bytesDone = resumeAt;
+            newWork.startBytes = resumeAt;
+        }
+        newWork.limiter = QSharedPointer<RateLimiter>(new RateLimiter(effectiveLimit(theItem)));
+        theTask->setTransferLimiter(newWork.limiter);
+        QObject::connect(theTask, SIGNAL(progress(qint64,qint64)), this, SLOT(taskProgress(qint64,qint64)));
+        QObject::connect(theTask, SIGNAL(checksumReady(quint32,qint64)), this, SLOT(taskChecksum(quint32,qint64)));
+        checksumTasks.insert(theTask, theItem.transferID);
+        QObject::connect(theTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                         this, SLOT(taskReply(RequestState,QByteArray,qint64)));
+        newWork.workObject = theTask;
+        newWork.restSession = theSession;
+        newWork.taskID = theTask->getTaskID();
+    }
+
+    theItem.state = TransferState::ACTIVE;
+    numActive++;
+    activeReplies.insert(newWork.workObject, theItem.transferID);
+    activeList.insert(theItem.transferID, newWork);
+    emit transferChanged(theItem.transferID);
+
+    if (newWork.segmented)
+    {
+        //Queued, as a download which cannot start fails at once
+        QMetaObject::invokeMethod(newWork.workObject, "start", Qt::QueuedConnection);
+    }
+    else if (newWork.restSession != nullptr)
+    {
+        newWork.restSession->submitTask(qobject_cast<RestTask *>(newWork.workObject));
+    }
+}
+
+void TransferQueue::stopTransfer(TransferItem &theItem)
+{
+    ActiveTransfer theWork = activeList.take(theItem.transferID);
+    activeReplies.remove(theWork.workObject);
+    numActive--;
+
+    //The work's own finished signal is no longer mapped, so it is ignored when it comes
+    if (theWork.segmented)
+    {
+        SegmentedDownload * theDownload = qobject_cast<SegmentedDownload *>(theWork.workObject);
+        theDownload->cancel();
+        theItem.bytesDone = 0;
+    }
+    else if (theWork.restSession != nullptr)
+    {
+        theWork.restSession->cancelTask(theWork.taskID);
+        if (theItem.direction == TransferDirection::UPLOAD) theItem.bytesDone = 0;
+    }
+}
+
+void TransferQueue::noteProgress(int transferID, qint64 bytesDone, qint64 bytesTotal)
+{
+    TransferItem * theItem = getItem(transferID);
+    if ((theItem == nullptr) || !activeList.contains(transferID)) return;
+    ActiveTransfer &theWork = activeList[transferID];
+
+    theItem->bytesDone = theWork.startBytes + bytesDone;
+    if ((theItem->fileSize <= 0) && (bytesTotal > 0))
+    {
+        theItem->fileSize = theWork.startBytes + bytesTotal;
+    }
+
+    qint64 elapsed = theWork.runTimer.elapsed();
+    if (elapsed - theWork.lastReport < progressInterval) return;
+    theWork.lastReport = elapsed;
+    if (elapsed > 0)
+    {
+        theItem->bytesPerSec = ((theItem->bytesDone - theWork.startBytes) * 1000.0) / elapsed;
+    }
+    emit transferChanged(transferID);
+}
+
+void TransferQueue::finishTransfer(int transferID, RequestState finalState)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return;
+
+    AgaveRestSession * theSession = nullptr;
+    if ((finalState == RequestState::GOOD) && (theItem->crcLength >= 0) && (ae_globals::get_lane_pool() != nullptr))
+    {
+        theSession = ae_globals::get_lane_pool()->getRestSession(LaneType::BULK);
+    }
+    if (theSession == nullptr)
+    {
+        completeTransfer(transferID, finalState, 0);
+        return;
+    }
+
+    //The transfer stays active while the remote file is listed, so its checksum is recorded against the file's current time
+    RestTask * timeTask = theSession->newListing(remoteFileOf(*theItem));
+    ActiveTransfer &theWork = activeList[transferID];
+    theWork.workObject = timeTask;
+    theWork.restSession = nullptr;
+    theWork.segmented = false;
+    theWork.readingRemoteTime = true;
+    activeReplies.insert(timeTask, transferID);
+    QObject::connect(timeTask, SIGNAL(finished(RequestState,QByteArray,qint64)),
+                     this, SLOT(remoteTimeReply(RequestState,QByteArray,qint64)));
+    theSession->submitTask(timeTask);
+}
+
+void TransferQueue::completeTransfer(int transferID, RequestState finalState, qint64 remoteModified)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return;
+
+    activeList.remove(transferID);
+    numActive--;
+    theItem->bytesPerSec = 0.0;
+    if ((finalState == RequestState::GOOD) && !checkAndRecord(*theItem, remoteModified))
+    {
+        //A corrupt download is not left behind looking like a finished one
+        QFile::remove(theItem->localPath);
+        theItem->checksumMismatch = true;
+        finalState = RequestState::EXPLICIT_ERROR;
+    }
+
+    if (finalState == RequestState::GOOD)
+    {
+        theItem->state = TransferState::DONE;
+        theItem->bytesDone = theItem->fileSize;
+        numFinished++;
+        bytesFinished += theItem->fileSize;
+    }
+    else
+    {
+        theItem->state = TransferState::FAILED;
+        numFailed++;
+        qCDebug(agaveAppLayer, "Transfer failed: %s <-> %s", qPrintable(theItem->localPath), qPrintable(theItem->remotePath));
+    }
+    endedIDs.append(transferID);
+
+    emit transferChanged(transferID);
+    emit transferFinished(transferID, finalState);
+    emit queueProgress(numFinished + numFailed + numCancelled, totalCount(), getThroughput());
+
+    startNextTransfers();
+}
+
+qint64 TransferQueue::effectiveLimit(const TransferItem &theItem)
+{
+    if (theItem.rateLimit > 0) return theItem.rateLimit;
+    if (theItem.direction == TransferDirection::UPLOAD) return perTransferUploadLimit;
+    return perTransferDownloadLimit;
+}
+
+bool TransferQueue::checkAndRecord(TransferItem &theItem, qint64 remoteModified)
+{
+    TransferManifest * theManifest = ae_globals::get_transfer_manifest();
+    if (theManifest == nullptr) return true;
+
+    QFileInfo localInfo(theItem.localPath);
+    ManifestEntry newEntry;
+    newEntry.localPath = theItem.localPath;
+    newEntry.size = localInfo.size();
+    newEntry.localModified = localInfo.lastModified().toMSecsSinceEpoch();
+    newEntry.hasChecksum = (theItem.crcLength == newEntry.size);
+    newEntry.crc32c = theItem.crc32c;
+    newEntry.remotePath = remoteFileOf(theItem);
+    newEntry.remoteModified = remoteModified;
+
+    if (theItem.direction == TransferDirection::UPLOAD)
+    {
+        theManifest->recordFile(newEntry);
+        return true;
+    }
+
+    if (newEntry.hasChecksum && theManifest->hasEntry(newEntry.remotePath))
+    {
+        //Only an earlier record of the same remote file, unchanged since, can be checked against. An unknown time proves nothing.
+        ManifestEntry oldEntry = theManifest->getEntry(newEntry.remotePath);
+        bool sameRemote = oldEntry.hasChecksum && (oldEntry.size == newEntry.size) &&
+                (oldEntry.remoteModified != 0) && (oldEntry.remoteModified == newEntry.remoteModified);
+        if (sameRemote && (oldEntry.crc32c != newEntry.crc32c))
+        {
+            //The record is dropped, so a retry records the file afresh if it was changed in place on the server
+            qCDebug(agaveAppLayer, "Checksum mismatch for %s: expected %s, got %s", qPrintable(newEntry.remotePath),
+                    qPrintable(Crc32c::toHex(oldEntry.crc32c)), qPrintable(Crc32c::toHex(newEntry.crc32c)));
+            theManifest->removeEntry(newEntry.remotePath);
+            return false;
+        }
+        theItem.checksumVerified = sameRemote;
+    }
+
+    theManifest->recordFile(newEntry);
+    return true;
+}
+
+QString TransferQueue::remoteFileOf(const TransferItem &theItem)
+{
+    //An upload names the folder it goes to
+    if (theItem.direction == TransferDirection::DOWNLOAD) return theItem.remotePath;
+
+    QString remoteFolder = theItem.remotePath;
+    if (!remoteFolder.endsWith('/')) remoteFolder.append('/');
+    return remoteFolder + QFileInfo(theItem.localPath).fileName();
+}
+
+int TransferQueue::takeNextWaiting()
+{
+    for (QList<int> &aList : waitingLists)
+    {
+        if (!aList.isEmpty()) return aList.takeFirst();
+    }
+    return -1;
+}
+
+void TransferQueue::addWaiting(int transferID, bool atFront)
+{
+    TransferItem * theItem = getItem(transferID);
+    if (theItem == nullptr) return;
+
+    QList<int> &theList = waitingLists[(int) theItem->priority];
+    if (atFront) theList.prepend(transferID);
+    else theList.append(transferID);
+}
+
+void TransferQueue::removeWaiting(int transferID)
+{
+    for (QList<int> &aList : waitingLists)
+    {
+        aList.removeOne(transferID);
+    }
+}
+
+int TransferQueue::findPreemptable()
+{
+    //The most recently started background transfer has the least to lose
+    int ret = -1;
+    for (auto itr = activeList.cbegin(); itr != activeList.cend(); itr++)
+    {
+        TransferItem * theItem = getItem(itr.key());
+        if (theItem->priority != TransferPriority::BACKGROUND) continue;
+        if (!canInterrupt(itr.key())) continue;
+        if (itr.key() > ret) ret = itr.key();
+    }
+    return ret;
+}
+
+TransferItem * TransferQueue::getItem(int transferID)
+{
+    int itemIndex = findItemIndex(transferID);
+    if (itemIndex < 0) return nullptr;
+    return &itemList[itemIndex];
+}
+
+int TransferQueue::findItemIndex(int transferID)
+{
+    //IDs are handed out in order, and removing items keeps that order
+    auto itemItr = std::lower_bound(itemList.begin(), itemList.end(), transferID,
+                                    [](const TransferItem &anItem, int anID) { return anItem.transferID < anID; });
+    if ((itemItr == itemList.end()) || (itemItr->transferID != transferID)) return -1;
+    return itemItr - itemList.begin();
+}
+
+void TransferQueue::removeItem(int transferID)
+{
+    int itemIndex = findItemIndex(transferID);
+    if (itemIndex < 0) return;
+    itemList.removeAt(itemIndex);
+    emit transferRemoved(transferID);
+}
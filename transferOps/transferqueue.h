@@ -0,0 +1,260 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TRANSFERQUEUE_H
+#define TRANSFERQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+
+class RemoteDataInterface;
+class RemoteDataReply;
+class FileMetaData;
+class AgaveRestSession;
+class RateLimiter;
+enum class RequestState;
+
+enum class TransferState {QUEUED, ACTIVE, PAUSED, DONE, FAILED, CANCELLED};
+enum class TransferDirection {UPLOAD, DOWNLOAD};
+enum class TransferPriority {HIGH, NORMAL, BACKGROUND};
+
+struct TransferItem
+{
+    int transferID = 0;
+    TransferDirection direction = TransferDirection::UPLOAD;
+    TransferPriority priority = TransferPriority::NORMAL;
+    QString localPath;
+    QString remotePath;
+    qint64 fileSize = 0;
+    qint64 bytesDone = 0;
+    double bytesPerSec = 0.0;
+    qint64 rateLimit = 0;
+    TransferState state = TransferState::QUEUED;
+    quint32 crc32c = 0;
+    qint64 crcLength = -1;
+    bool checksumVerified = false;
+    bool checksumMismatch = false;
+};
+
+/*! \brief The TransferQueue runs file transfers on the bulk network lanes, with a bounded number in flight at once.
+ *
+ *  Transfers are started by priority, and in the order they were queued within a priority. A HIGH priority transfer which finds every slot taken pauses a BACKGROUND transfer to make room, so that a file the user asked for does not wait behind a folder download.
+ *
+ *  Transfers run as RestTasks when the direct connection is up, which lets them report progress, and be paused or cancelled part way. A paused download resumes from the bytes already on disk. Large downloads run as SegmentedDownloads. If the direct connection is not up, transfers go through the bulk connection, and can then only be paused or cancelled before they start.
+ *
+ *  Transfers run as RestTasks or SegmentedDownloads take a CRC-32C of their bytes as they move. Each finished transfer is recorded in the TransferManifest. A download is checked against the manifest's entry for its remote file, if the file is unchanged since, and fails if the checksums differ. The file counts as unchanged only if the recorded and current remote modification times are both known and equal. A checksummed transfer lists its remote file as it finishes, to learn the current time, since cached listings may be stale.
+ *
+ *  Each transfer run as a RestTask may be held to a rate limit of its own, on top of the global limits in the RemoteLanePool. A transfer's limit is its own, if set, or else the queue's per transfer limit for its direction.
+ *
+ *  Finished, failed and cancelled transfers stay listed until clearFinished() is called, or until more than retainedEnded of them are held, when the oldest to end are dropped as the next transfer is queued. Dropping only happens on those calls, so a transfer can always be read in the handlers of its own signals.
+ *
+ *  Queued transfers do not hold any file operation lock, so the user can keep browsing and operating on files while the queue runs.
+ *
+ *  transferFinished() is never emitted from inside an enqueue call, even for a transfer which fails as it starts, so callers can record the returned ID before they hear that it ended.
+ */
+
+class TransferQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransferQueue(QObject *parent = nullptr);
+
+    /*! \brief Queues the upload of one local file into the given remote folder.
+     *
+     *  \param knownSize If the caller has already read the file's size, it is given here, and the file is not checked again in this thread.
+     *  \return The ID of the new transfer, or -1 if the local file cannot be read.
+     */
+    int enqueueUpload(QString localFile, QString remoteFolder, qint64 knownSize = -1, TransferPriority priority = TransferPriority::NORMAL);
+
+    /*! \brief Queues the upload of every file matching localPattern, and returns the number queued.
+     *
+     *  See expandLocalPattern() for the pattern format.
+     */
+    int enqueueUploadPattern(QString localPattern, QString remoteFolder);
+
+    /*! \brief Queues the download of one remote file to the given local file path. The local folder must already exist.
+     *
+     *  \param fileSize The size from the remote listing, used for progress, and to pick a segmented download for large files.
+     *  \return The ID of the new transfer.
+     */
+    int enqueueDownload(QString remoteFile, QString localFile, qint64 fileSize = 0, TransferPriority priority = TransferPriority::NORMAL);
+
+    /*! \brief Turns a list of local paths, separated by ';', into a list of existing files.
+     *
+     *  The file name part of each path may contain wildcards, such as C:/case/constant/*.dat
+     */
+    static QStringList expandLocalPattern(QString localPattern);
+
+    /*! \brief These return false if the transfer is not in a state where the change applies, or cannot be interrupted.
+     *
+     *  Cancelling a transfer reports it through transferFinished(), as a failure. Pausing does not.
+     */
+    bool setPriority(int transferID, TransferPriority newPriority);
+    bool pauseTransfer(int transferID);
+    bool resumeTransfer(int transferID);
+    bool cancelTransfer(int transferID);
+    bool canInterrupt(int transferID);
+
+    /*! \brief Sets the rate limit, in bytes per second, of one transfer. 0 means the transfer uses the per transfer limit. This applies at once to a running transfer.
+     */
+    bool setTransferRateLimit(int transferID, qint64 bytesPerSec);
+
+    /*! \brief Sets the default limits, in bytes per second, for each single transfer, with 0 for no limit.
+     */
+    void setPerTransferLimits(qint64 downloadLimit, qint64 uploadLimit);
+    qint64 getPerTransferDownloadLimit();
+    qint64 getPerTransferUploadLimit();
+
+    TransferItem getTransfer(int transferID);
+
+    /*! \brief Returns the IDs of the transfers still held, in the order they were queued.
+     */
+    QList<int> transferIDs();
+
+    /*! \brief Drops every finished, failed or cancelled transfer from the queue.
+     */
+    void clearFinished();
+
+    static QString stateName(TransferState theState);
+    static QString priorityName(TransferPriority thePriority);
+
+    void setMaxConcurrent(int newMax);
+    int getMaxConcurrent();
+
+    int queuedCount();
+    int activeCount();
+    int finishedCount();
+    int failedCount();
+    int cancelledCount();
+
+    /*! \brief Returns the number of transfers queued in this session, including those since dropped.
+     */
+    int totalCount();
+
+    /*! \brief Returns the aggregate rate, in bytes per second, of all transfers finished since the queue last became busy.
+     */
+    double getThroughput();
+
+    static const int progressInterval = 250;
+    static const int retainedEnded = 500;
+
+signals:
+    void transferAdded(int transferID);
+    void transferRemoved(int transferID);
+    void transferChanged(int transferID);
+    void transferFinished(int transferID, RequestState finalState);
+    void queueProgress(int finished, int total, double bytesPerSec);
+    void queueDrained();
+
+private slots:
+    void uploadReply(RequestState replyState, FileMetaData newFileData);
+    void downloadReply(RequestState replyState);
+    void taskProgress(qint64 bytesDone, qint64 bytesTotal);
+    void taskChecksum(quint32 crc32c, qint64 length);
+    void taskReply(RequestState replyState, QByteArray, qint64);
+    void segmentedProgress(qint64 bytesDone, qint64 bytesTotal);
+    void segmentedReply(RequestState replyState, QString message);
+    void remoteTimeReply(RequestState replyState, QByteArray body, qint64);
+    void startFailed(int transferID);
+
+private:
+    struct ActiveTransfer
+    {
+        QObject * workObject = nullptr;
+        AgaveRestSession * restSession = nullptr;
+        int taskID = -1;
+        bool segmented = false;
+        bool readingRemoteTime = false;
+        qint64 startBytes = 0;
+        quint32 startCrc = 0;
+        bool startCrcKnown = false;
+        qint64 lastReport = 0;
+        QElapsedTimer runTimer;
+        QSharedPointer<RateLimiter> limiter;
+    };
+
+    int addItem(TransferItem newItem);
+    void startNextTransfers();
+    void startTransfer(TransferItem &theItem);
+    void stopTransfer(TransferItem &theItem);
+    void noteProgress(int transferID, qint64 bytesDone, qint64 bytesTotal);
+    void finishTransfer(int transferID, RequestState finalState);
+    void completeTransfer(int transferID, RequestState finalState, qint64 remoteModified);
+    void removeItem(int transferID);
+
+    qint64 effectiveLimit(const TransferItem &theItem);
+
+    /*! \brief Records a finished transfer in the manifest, and returns false if a download does not match its earlier record.
+     *
+     *  \param remoteModified The remote file's modification time, as just listed, or 0 if it is not known.
+     */
+    bool checkAndRecord(TransferItem &theItem, qint64 remoteModified);
+    static QString remoteFileOf(const TransferItem &theItem);
+
+    int takeNextWaiting();
+    void addWaiting(int transferID, bool atFront = false);
+    void removeWaiting(int transferID);
+    int findPreemptable();
+
+    TransferItem * getItem(int transferID);
+    int findItemIndex(int transferID);
+
+    QList<TransferItem> itemList;
+    QList<int> endedIDs;
+    QVector<QList<int>> waitingLists;
+    QHash<int, ActiveTransfer> activeList;
+    QHash<QObject *, int> activeReplies;
+    QHash<QObject *, int> checksumTasks;
+
+    int nextID = 1;
+    bool queueBusy = false;
+    int maxConcurrent = 4;
+    qint64 perTransferDownloadLimit = 0;
+    qint64 perTransferUploadLimit = 0;
+    int numActive = 0;
+    int numFinished = 0;
+    int numFailed = 0;
+    int numCancelled = 0;
+
+    qint64 bytesFinished = 0;
+    QElapsedTimer busyTimer;
+};
+
+#endif // TRANSFERQUEUE_H
@@ -35,10 +35,22 @@
 
 #include "agavesetupdriver.h"
 
+#include <limits>
+
 #include "ae_globals.h"
 #include "utilFuncs/authform.h"
 #include "remoteFiles/fileoperator.h"
 #include "remoteJobs/joboperator.h"
+#include "netOps/remotelanepool.h"
+#include "transferOps/transferqueue.h"
+#include "transferOps/chunkeduploader.h"
+#include "transferOps/fileretriever.h"
+#include "transferOps/transfermanifest.h"
+#include "fileCache/listingcache.h"
+#include "fileCache/listingprefetcher.h"
+#include "fileCache/pathindex.h"
+#include "jobOps/jobstore.h"
+#include "jobOps/jobpoller.h"
 
 #include "agaveInterfaces/agavehandler.h"
 
@@ -64,8 +76,104 @@ AgaveSetupDriver::AgaveSetupDriver(int argc, char *argv[], QObject *parent) : QO
 
     debugLoggingEnabled = false;
     offlineMode = false;
+    bulkLaneCount = RemoteLanePool::defaultBulkLaneCount();
+    prefetchDepth = ListingPrefetcher::defaultDepth;
+    prefetchBudget = ListingPrefetcher::defaultBudget;
+    QStringList rejectedArgs;
     for (int i = 0; i < argc; i++)
     {
+        if (strncmp(argv[i],"networkLanes=",13) == 0)
+        {
+            bool isNumber = false;
+            int laneArg = QString(argv[i] + 13).toInt(&isNumber);
+            if (isNumber && (laneArg > 0))
+            {
+                bulkLaneCount = laneArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the lane count must be a positive whole number").arg(argv[i]));
+            }
+        }
+        if (strncmp(argv[i],"prefetchDepth=",14) == 0)
+        {
+            bool isNumber = false;
+            int depthArg = QString(argv[i] + 14).toInt(&isNumber);
+            if (isNumber && (depthArg >= 0))
+            {
+                prefetchDepth = depthArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the prefetch depth must be a whole number, 0 or more").arg(argv[i]));
+            }
+        }
+        if (strncmp(argv[i],"prefetchBudget=",15) == 0)
+        {
+            bool isNumber = false;
+            int budgetArg = QString(argv[i] + 15).toInt(&isNumber);
+            if (isNumber && (budgetArg >= 0))
+            {
+                prefetchBudget = budgetArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the prefetch budget must be a whole number, 0 or more").arg(argv[i]));
+            }
+        }
+        //Transfer rate limits are given in KB/s
+        if (strncmp(argv[i],"downloadLimit=",14) == 0)
+        {
+            bool isNumber = false;
+            qint64 limitArg = QString(argv[i] + 14).toLongLong(&isNumber);
+            if (isNumber && (limitArg >= 0) && (limitArg <= std::numeric_limits<qint64>::max() / 1024))
+            {
+                downloadLimit = 1024 * limitArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the download limit must be a whole number of KB/s, 0 or more").arg(argv[i]));
+            }
+        }
+        if (strncmp(argv[i],"uploadLimit=",12) == 0)
+        {
+            bool isNumber = false;
+            qint64 limitArg = QString(argv[i] + 12).toLongLong(&isNumber);
+            if (isNumber && (limitArg >= 0) && (limitArg <= std::numeric_limits<qint64>::max() / 1024))
+            {
+                uploadLimit = 1024 * limitArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the upload limit must be a whole number of KB/s, 0 or more").arg(argv[i]));
+            }
+        }
+        if (strncmp(argv[i],"transferDownloadLimit=",22) == 0)
+        {
+            bool isNumber = false;
+            qint64 limitArg = QString(argv[i] + 22).toLongLong(&isNumber);
+            if (isNumber && (limitArg >= 0) && (limitArg <= std::numeric_limits<qint64>::max() / 1024))
+            {
+                transferDownloadLimit = 1024 * limitArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the per transfer download limit must be a whole number of KB/s, 0 or more").arg(argv[i]));
+            }
+        }
+        if (strncmp(argv[i],"transferUploadLimit=",20) == 0)
+        {
+            bool isNumber = false;
+            qint64 limitArg = QString(argv[i] + 20).toLongLong(&isNumber);
+            if (isNumber && (limitArg >= 0) && (limitArg <= std::numeric_limits<qint64>::max() / 1024))
+            {
+                transferUploadLimit = 1024 * limitArg;
+            }
+            else
+            {
+                rejectedArgs.append(QString("%1: the per transfer upload limit must be a whole number of KB/s, 0 or more").arg(argv[i]));
+            }
+        }
         if ((strcmp(argv[i],"enableDebugLogging") == 0) || (strcmp(argv[i],"offlineMode") == 0))
         {
             debugLoggingEnabled = true;
@@ -85,39 +193,41 @@ AgaveSetupDriver::AgaveSetupDriver(int argc, char *argv[], QObject *parent) : QO
     }
     setDebugLogging(debugLoggingEnabled);
     if (debugLoggingEnabled) qCDebug(agaveAppLayer, "NOTE: Debugging text output is enabled.");
+    for (QString aReason : rejectedArgs)
+    {
+        qCDebug(agaveAppLayer, "Ignoring %s.", qPrintable(aReason));
+    }
 }
 
 AgaveSetupDriver::~AgaveSetupDriver()
 {
     if (authWindow != nullptr) delete authWindow;
 
-    if (theNetManager != nullptr) delete theNetManager;
-    if (myDataInterface != nullptr) delete myDataInterface;
-
-    if (remoteInterfacesThread != nullptr)
-    {
-        remoteInterfacesThread->quit();
-        remoteInterfacesThread->wait();
-    }
+    //Note: The lane pool owns the data interfaces, and deletes them after stopping their threads
+    if (myLanePool != nullptr) delete myLanePool;
 }
 
 void AgaveSetupDriver::createAndStartAgaveThread()
 {
-    remoteInterfacesThread = new QThread(this);
-
-    remoteInterfacesThread->start();
-
-    theNetManager = new QNetworkAccessManager();
-    theNetManager->moveToThread(remoteInterfacesThread);
+    myLanePool = new RemoteLanePool(bulkLaneCount);
+    myLanePool->setConnectionParams("https://agave.designsafe-ci.org", "SimCenter_CWE_GUI", storageSystem);
+    myLanePool->setRateLimits(downloadLimit, uploadLimit);
 
-    myDataInterface = new AgaveHandler(theNetManager);
-    myDataInterface->moveToThread(remoteInterfacesThread);
-    myDataInterface->setAgaveConnectionParams("https://agave.designsafe-ci.org", "SimCenter_CWE_GUI", "designsafe.storage.default");
+    myDataInterface = myLanePool->getInteractiveLane();
     QObject::connect(myDataInterface, SIGNAL(connectionStateChanged(RemoteDataInterfaceState)),
                      this, SLOT(newConnectionState(RemoteDataInterfaceState)));
 
     myJobHandle = new JobOperator(myDataInterface, this);
     myFileHandle = new FileOperator(myDataInterface, this);
+    myTransferQueue = new TransferQueue(this);
+    myTransferQueue->setPerTransferLimits(transferDownloadLimit, transferUploadLimit);
+    myChunkedUploader = new ChunkedUploader(this);
+    myFileRetriever = new FileRetriever(this);
+    myListingCache = new ListingCache(this);
+    myPathIndex = new PathIndex(myListingCache, this);
+    myTransferManifest = new TransferManifest(this);
+    myJobStore = new JobStore(this);
+    myJobPoller = new JobPoller(myJobStore, this);
 }
 
 void AgaveSetupDriver::setDebugLogging(bool loggingEnabled)
@@ -169,11 +279,71 @@ FileOperator * AgaveSetupDriver::getFileHandler()
     return myFileHandle;
 }
 
+RemoteLanePool * AgaveSetupDriver::getLanePool()
+{
+    return myLanePool;
+}
+
+TransferQueue * AgaveSetupDriver::getTransferQueue()
+{
+    return myTransferQueue;
+}
+
+ChunkedUploader * AgaveSetupDriver::getChunkedUploader()
+{
+    return myChunkedUploader;
+}
+
+FileRetriever * AgaveSetupDriver::getFileRetriever()
+{
+    return myFileRetriever;
+}
+
+ListingCache * AgaveSetupDriver::getListingCache()
+{
+    return myListingCache;
+}
+
+PathIndex * AgaveSetupDriver::getPathIndex()
+{
+    return myPathIndex;
+}
+
+TransferManifest * AgaveSetupDriver::getTransferManifest()
+{
+    return myTransferManifest;
+}
+
+JobStore * AgaveSetupDriver::getJobStore()
+{
+    return myJobStore;
+}
+
+JobPoller * AgaveSetupDriver::getJobPoller()
+{
+    return myJobPoller;
+}
+
+int AgaveSetupDriver::getPrefetchDepth()
+{
+    return prefetchDepth;
+}
+
+int AgaveSetupDriver::getPrefetchBudget()
+{
+    return prefetchBudget;
+}
+
 void AgaveSetupDriver::getAuthReply(RequestState authReply)
 {
     if ((authReply == RequestState::GOOD) && (authWindow != nullptr) && (authWindow->isVisible()))
     {
-
+        //The cache is per user, so it can only be opened once the login is known
+        myListingCache->openCache(myDataInterface->getUserName(), storageSystem);
+        myTransferManifest->openManifest(myDataInterface->getUserName(), storageSystem);
+        myJobStore->openStore(myDataInterface->getUserName(), storageSystem);
+        myChunkedUploader->openManifests(myDataInterface->getUserName(), storageSystem);
+        myJobPoller->start();
         closeAuthScreen();
     }
 }
@@ -201,6 +371,13 @@ void AgaveSetupDriver::shutdown()
     if (shutdownStarted) return;
     shutdownStarted = true;
 
+    //Chunk manifests are saved first, so that interrupted uploads can resume on the next login
+    if (myChunkedUploader != nullptr) myChunkedUploader->suspendAll();
+    if (myListingCache != nullptr) myListingCache->saveNow();
+    if (myTransferManifest != nullptr) myTransferManifest->saveNow();
+    if (myJobPoller != nullptr) myJobPoller->stop();
+    if (myJobStore != nullptr) myJobStore->saveNow();
+
     if ((myDataInterface == nullptr) || (myDataInterface->getInterfaceState() == RemoteDataInterfaceState::INIT) ||
             (myDataInterface->getInterfaceState() == RemoteDataInterfaceState::READY_TO_AUTH) ||
             (myDataInterface->getInterfaceState() == RemoteDataInterfaceState::DISCONNECTED))
@@ -210,6 +387,7 @@ void AgaveSetupDriver::shutdown()
     }
 
     qCDebug(agaveAppLayer, "Beginning graceful shutdown.");
+    myLanePool->closeBulkConnections();
     RemoteDataReply * shutdownInvoke = myDataInterface->closeAllConnections();
     shutdownInvoke->setAsUnconnectedReply();
 
@@ -49,6 +49,15 @@ class AgaveHandler;
 class AuthForm;
 class JobOperator;
 class FileOperator;
+class RemoteLanePool;
+class TransferQueue;
+class ChunkedUploader;
+class FileRetriever;
+class ListingCache;
+class PathIndex;
+class TransferManifest;
+class JobStore;
+class JobPoller;
 
 class AgaveSetupDriver : public QObject
 {
@@ -66,6 +75,17 @@ public:
     RemoteDataInterface *getDataConnection();
     JobOperator * getJobHandler();
     FileOperator * getFileHandler();
+    RemoteLanePool * getLanePool();
+    TransferQueue * getTransferQueue();
+    ChunkedUploader * getChunkedUploader();
+    FileRetriever * getFileRetriever();
+    ListingCache * getListingCache();
+    PathIndex * getPathIndex();
+    TransferManifest * getTransferManifest();
+    JobStore * getJobStore();
+    JobPoller * getJobPoller();
+    int getPrefetchDepth();
+    int getPrefetchBudget();
 
     virtual QString getBanner() = 0;
     virtual QString getVersion() = 0;
@@ -85,14 +105,30 @@ public slots:
     void shutdown();
 
 protected:
-    QNetworkAccessManager * theNetManager = nullptr;
-    QThread * remoteInterfacesThread = nullptr;
+    RemoteLanePool * myLanePool = nullptr;
+    int bulkLaneCount = 0;
+    int prefetchDepth = 0;
+    int prefetchBudget = 0;
+    qint64 downloadLimit = 0;
+    qint64 uploadLimit = 0;
+    qint64 transferDownloadLimit = 0;
+    qint64 transferUploadLimit = 0;
 
     AuthForm * authWindow = nullptr;
 
     AgaveHandler * myDataInterface = nullptr;
     JobOperator * myJobHandle = nullptr;
     FileOperator * myFileHandle = nullptr;
+    TransferQueue * myTransferQueue = nullptr;
+    ChunkedUploader * myChunkedUploader = nullptr;
+    FileRetriever * myFileRetriever = nullptr;
+    ListingCache * myListingCache = nullptr;
+    PathIndex * myPathIndex = nullptr;
+    TransferManifest * myTransferManifest = nullptr;
+    JobStore * myJobStore = nullptr;
+    JobPoller * myJobPoller = nullptr;
+
+    QString storageSystem = "designsafe.storage.default";
 
     static QStringList enabledDebugs;
     bool shutdownStarted = false;
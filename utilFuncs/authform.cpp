@@ -40,6 +40,7 @@
 #include "copyrightdialog.h"
 
 #include "agavesetupdriver.h"
+#include "netOps/remotelanepool.h"
 #include "ae_globals.h"
 
 AuthForm::AuthForm(QWidget *parent) :
@@ -93,6 +94,8 @@ void AuthForm::performAuth()
     {
         ae_globals::displayFatalPopup("Unable to connect to DesignSafe. Please check internet connection.");
     }
+    pendingUname = unameText;
+    pendingPasswd = passText;
     this->setCursor(QCursor(Qt::WaitCursor));
 
     ui->instructText->setText("Connecting to DesignSafe");
@@ -106,6 +109,7 @@ void AuthForm::getAuthReply(RequestState authReply)
     if (authReply == RequestState::GOOD)
     {
         ui->instructText->setText("Loading . . .");
+        ae_globals::get_lane_pool()->performLaneAuth(pendingUname, pendingPasswd);
     }
     else if (authReply == RequestState::EXPLICIT_ERROR)
     {
@@ -117,5 +121,6 @@ void AuthForm::getAuthReply(RequestState authReply)
         ui->instructText->setText("Unable to contact DesignSafe, verify your connection and try again.");
         ui->loginButton->setEnabled(true);
     }
+    pendingPasswd.clear();
     this->unsetCursor();
 }
@@ -62,6 +62,9 @@ private slots:
 
 private:
     Ui::AuthForm *ui;
+
+    QString pendingUname;
+    QString pendingPasswd;
 };
 
 #endif // AUTHFORM_H
@@ -0,0 +1,279 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "crc32c.h"
+
+#include <cstring>
+#include <QtEndian>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AE_CRC32C_X86
+#define AE_CRC32C_TARGET __attribute__((target("sse4.2")))
+#include <nmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define AE_CRC32C_X86
+#define AE_CRC32C_TARGET
+#include <nmmintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+const quint32 castagnoliPoly = 0x82F63B78;
+
+struct Crc32cTables
+{
+    quint32 table[8][256];
+
+    Crc32cTables()
+    {
+        for (quint32 i = 0; i < 256; i++)
+        {
+            quint32 crc = i;
+            for (int j = 0; j < 8; j++)
+            {
+                crc = (crc & 1) ? ((crc >> 1) ^ castagnoliPoly) : (crc >> 1);
+            }
+            table[0][i] = crc;
+        }
+        for (quint32 i = 0; i < 256; i++)
+        {
+            for (int k = 1; k < 8; k++)
+            {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+const Crc32cTables &crcTables()
+{
+    static const Crc32cTables theTables;
+    return theTables;
+}
+
+bool detectHardware()
+{
+#if defined(AE_CRC32C_X86) && defined(_MSC_VER)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+    return ((cpuInfo[2] >> 20) & 1) != 0;
+#elif defined(AE_CRC32C_X86)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+quint32 gf2Times(const quint32 * matrix, quint32 vec)
+{
+    quint32 sum = 0;
+    while (vec)
+    {
+        if (vec & 1) sum ^= *matrix;
+        vec >>= 1;
+        matrix++;
+    }
+    return sum;
+}
+
+void gf2Square(quint32 * square, const quint32 * matrix)
+{
+    for (int n = 0; n < 32; n++)
+    {
+        square[n] = gf2Times(matrix, matrix[n]);
+    }
+}
+
+}
+
+Crc32c::Crc32c()
+{
+    reset();
+}
+
+void Crc32c::reset()
+{
+    crcState = 0xFFFFFFFF;
+    byteCount = 0;
+}
+
+void Crc32c::update(const char * data, qint64 length)
+{
+    if (length <= 0) return;
+    crcState = updateAny(crcState, reinterpret_cast<const uchar *>(data), length);
+    byteCount += length;
+}
+
+void Crc32c::update(const QByteArray &data)
+{
+    update(data.constData(), data.size());
+}
+
+quint32 Crc32c::value() const
+{
+    return ~crcState;
+}
+
+qint64 Crc32c::length() const
+{
+    return byteCount;
+}
+
+quint32 Crc32c::compute(const QByteArray &data)
+{
+    Crc32c theCrc;
+    theCrc.update(data);
+    return theCrc.value();
+}
+
+quint32 Crc32c::combine(quint32 crcA, quint32 crcB, qint64 lengthB)
+{
+    if (lengthB <= 0) return crcA;
+
+    //Appending lengthB zero bytes to A is a linear map, applied by repeated squaring, as in zlib's crc32_combine
+    quint32 evenOp[32];
+    quint32 oddOp[32];
+
+    oddOp[0] = castagnoliPoly;
+    quint32 row = 1;
+    for (int n = 1; n < 32; n++)
+    {
+        oddOp[n] = row;
+        row <<= 1;
+    }
+    gf2Square(evenOp, oddOp);
+    gf2Square(oddOp, evenOp);
+
+    do
+    {
+        gf2Square(evenOp, oddOp);
+        if (lengthB & 1) crcA = gf2Times(evenOp, crcA);
+        lengthB >>= 1;
+        if (lengthB == 0) break;
+
+        gf2Square(oddOp, evenOp);
+        if (lengthB & 1) crcA = gf2Times(oddOp, crcA);
+        lengthB >>= 1;
+    } while (lengthB != 0);
+
+    return crcA ^ crcB;
+}
+
+bool Crc32c::hardwareAccelerated()
+{
+    static const bool hasHardware = detectHardware();
+    return hasHardware;
+}
+
+QString Crc32c::toHex(quint32 crc)
+{
+    return QString("%1").arg(crc, 8, 16, QChar('0'));
+}
+
+quint32 Crc32c::updateSoftware(quint32 crc, const uchar * data, qint64 length)
+{
+    const Crc32cTables &theTables = crcTables();
+
+    //Slicing by 8: eight bytes per step, through eight tables
+    while (length >= 8)
+    {
+        quint32 low;
+        quint32 high;
+        memcpy(&low, data, 4);
+        memcpy(&high, data + 4, 4);
+        low = qFromLittleEndian(low) ^ crc;
+        high = qFromLittleEndian(high);
+
+        crc = theTables.table[7][low & 0xff] ^ theTables.table[6][(low >> 8) & 0xff] ^
+                theTables.table[5][(low >> 16) & 0xff] ^ theTables.table[4][low >> 24] ^
+                theTables.table[3][high & 0xff] ^ theTables.table[2][(high >> 8) & 0xff] ^
+                theTables.table[1][(high >> 16) & 0xff] ^ theTables.table[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length > 0)
+    {
+        crc = (crc >> 8) ^ theTables.table[0][(crc ^ *data) & 0xff];
+        data++;
+        length--;
+    }
+    return crc;
+}
+
+#ifdef AE_CRC32C_X86
+AE_CRC32C_TARGET quint32 Crc32c::updateHardware(quint32 crc, const uchar * data, qint64 length)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    quint64 wideCrc = crc;
+    while (length >= 8)
+    {
+        quint64 word;
+        memcpy(&word, data, 8);
+        wideCrc = _mm_crc32_u64(wideCrc, word);
+        data += 8;
+        length -= 8;
+    }
+    crc = (quint32) wideCrc;
+#endif
+    while (length >= 4)
+    {
+        quint32 word;
+        memcpy(&word, data, 4);
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        length -= 4;
+    }
+    while (length > 0)
+    {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        length--;
+    }
+    return crc;
+}
+#else
+quint32 Crc32c::updateHardware(quint32 crc, const uchar * data, qint64 length)
+{
+    return updateSoftware(crc, data, length);
+}
+#endif
+
+quint32 Crc32c::updateAny(quint32 crc, const uchar * data, qint64 length)
+{
+    if (hardwareAccelerated()) return updateHardware(crc, data, length);
+    return updateSoftware(crc, data, length);
+}
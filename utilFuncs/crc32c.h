@@ -0,0 +1,80 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+
+/*! \brief Crc32c computes the CRC-32C (Castagnoli) checksum of a stream of bytes, as the bytes go by.
+ *
+ *  On x86 processors with SSE 4.2, the checksum uses the processor's CRC32 instruction, and runs at several GB/s. Otherwise, a table driven version is used, which gives the same result.
+ *
+ *  Checksums of pieces of a file can be joined with combine(), so that a file fetched in segments can be checked without reading it again.
+ */
+
+class Crc32c
+{
+public:
+    Crc32c();
+
+    void reset();
+    void update(const char * data, qint64 length);
+    void update(const QByteArray &data);
+
+    quint32 value() const;
+    qint64 length() const;
+
+    static quint32 compute(const QByteArray &data);
+
+    /*! \brief Returns the checksum of A followed by B, from the checksums of A and B, and the length of B.
+     */
+    static quint32 combine(quint32 crcA, quint32 crcB, qint64 lengthB);
+
+    static bool hardwareAccelerated();
+    static QString toHex(quint32 crc);
+
+private:
+    static quint32 updateSoftware(quint32 crc, const uchar * data, qint64 length);
+    static quint32 updateHardware(quint32 crc, const uchar * data, qint64 length);
+    static quint32 updateAny(quint32 crc, const uchar * data, qint64 length);
+
+    quint32 crcState;
+    qint64 byteCount = 0;
+};
+
+#endif // CRC32C_H
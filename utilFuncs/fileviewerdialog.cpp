@@ -0,0 +1,165 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "fileviewerdialog.h"
+#include "ui_fileviewerdialog.h"
+
+#include "utilFuncs/pagedfilereader.h"
+#include "transferOps/remotefiletail.h"
+
+FileViewerDialog::FileViewerDialog(QString fileName, PagedFileReader * theReader, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FileViewerDialog)
+{
+    ui->setupUi(this);
+    this->setWindowTitle(QString("File Viewer - %1").arg(fileName));
+    connectControls();
+
+    ui->fileViewer->setReader(theReader);
+}
+
+FileViewerDialog::FileViewerDialog(QString fileName, RemoteFileTail * theTail, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FileViewerDialog)
+{
+    ui->setupUi(this);
+    this->setWindowTitle(QString("File Viewer - %1 (following)").arg(fileName));
+    connectControls();
+
+    followedTail = theTail;
+    tailText = "waiting for file";
+    QObject::connect(followedTail, SIGNAL(tailGrew(qint64)), this, SLOT(tailGrew(qint64)));
+    QObject::connect(followedTail, SIGNAL(tailRestarted()), this, SLOT(tailRestarted()));
+    QObject::connect(followedTail, SIGNAL(tailChecked(int)), this, SLOT(tailChecked(int)));
+    QObject::connect(followedTail, SIGNAL(tailStopped(QString)), this, SLOT(tailStopped(QString)));
+
+    ui->fileViewer->setReader(new PagedFileReader(followedTail->getLocalPath()));
+}
+
+FileViewerDialog::~FileViewerDialog()
+{
+    delete ui;
+}
+
+void FileViewerDialog::connectControls()
+{
+    QObject::connect(ui->findButton, SIGNAL(clicked()), this, SLOT(findClicked()));
+    QObject::connect(ui->searchText, SIGNAL(returnPressed()), this, SLOT(findClicked()));
+    QObject::connect(ui->gotoButton, SIGNAL(clicked()), this, SLOT(gotoClicked()));
+    QObject::connect(ui->gotoText, SIGNAL(returnPressed()), this, SLOT(gotoClicked()));
+    QObject::connect(ui->fileViewer, SIGNAL(indexProgress(qint64,bool)), this, SLOT(indexProgress(qint64,bool)));
+    QObject::connect(ui->fileViewer, SIGNAL(searchFinished(bool,qint64)), this, SLOT(searchFinished(bool,qint64)));
+}
+
+void FileViewerDialog::showLineCount()
+{
+    if (followedTail == nullptr)
+    {
+        ui->statusLabel->setText(QString("%1 lines").arg(ui->fileViewer->lineCount()));
+        return;
+    }
+    ui->statusLabel->setText(QString("%1 lines, %2 bytes - %3").arg(ui->fileViewer->lineCount())
+                             .arg(followedTail->getLocalSize()).arg(tailText));
+}
+
+void FileViewerDialog::findClicked()
+{
+    if (ui->searchText->text().isEmpty()) return;
+
+    searchRunning = true;
+    ui->statusLabel->setText(QString("Searching for \"%1\" . . .").arg(ui->searchText->text()));
+    ui->fileViewer->findNext(ui->searchText->text());
+}
+
+void FileViewerDialog::gotoClicked()
+{
+    bool isNumber = false;
+    qint64 lineNum = ui->gotoText->text().toLongLong(&isNumber);
+    if (!isNumber || (lineNum < 1))
+    {
+        ui->statusLabel->setText("Please enter a line number, starting from 1.");
+        return;
+    }
+    ui->fileViewer->goToLine(lineNum - 1);
+}
+
+void FileViewerDialog::indexProgress(qint64 linesIndexed, bool done)
+{
+    if (searchRunning) return;
+
+    //A followed file is indexed again each time it grows, so its count is shown as it goes
+    if (done || (followedTail != nullptr))
+    {
+        showLineCount();
+        return;
+    }
+    ui->statusLabel->setText(QString("Indexing . . . %1 lines so far").arg(linesIndexed));
+}
+
+void FileViewerDialog::searchFinished(bool found, qint64 lineNum)
+{
+    searchRunning = false;
+
+    if (!found)
+    {
+        ui->statusLabel->setText(QString("\"%1\" not found.").arg(ui->searchText->text()));
+        return;
+    }
+    ui->statusLabel->setText(QString("Found on line %1.").arg(lineNum + 1));
+}
+
+void FileViewerDialog::tailGrew(qint64)
+{
+    tailText = "receiving";
+    ui->fileViewer->fileGrew();
+}
+
+void FileViewerDialog::tailRestarted()
+{
+    //The old lines are gone from the local copy, so the index starts over
+    ui->fileViewer->setReader(new PagedFileReader(followedTail->getLocalPath()));
+}
+
+void FileViewerDialog::tailChecked(int nextCheckMsec)
+{
+    tailText = QString("next check in %1 s").arg((nextCheckMsec + 999) / 1000);
+    if (!searchRunning) showLineCount();
+}
+
+void FileViewerDialog::tailStopped(QString message)
+{
+    tailText = QString("stopped following: %1").arg(message);
+    if (!searchRunning) showLineCount();
+}
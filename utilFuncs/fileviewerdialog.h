@@ -0,0 +1,95 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FILEVIEWERDIALOG_H
+#define FILEVIEWERDIALOG_H
+
+#include <QDialog>
+
+class PagedFileReader;
+class RemoteFileTail;
+
+namespace Ui {
+class FileViewerDialog;
+}
+
+/*! \brief The FileViewerDialog is a popup window for reading a retrieved file, with search and jump-to-line.
+ *
+ *  The file is shown with a PagedFileViewer, so files of any size can be opened. Line numbers shown to the user count from 1.
+ */
+
+class FileViewerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /*! \brief Makes a viewer for the content of theReader.
+     *
+     *  \param fileName Shown in the title of the window.
+     *  \param theReader The content to show. The dialog takes ownership of the reader.
+     *  \param parent As a window, this object usually will not have a parent.
+     */
+    explicit FileViewerDialog(QString fileName, PagedFileReader * theReader, QWidget *parent = nullptr);
+
+    /*! \brief Makes a viewer which follows the local copy of theTail, showing new lines as they arrive.
+     *
+     *  \param theTail The tail to follow, which is not owned by the dialog, and must outlive it. The caller starts the tail.
+     */
+    explicit FileViewerDialog(QString fileName, RemoteFileTail * theTail, QWidget *parent = nullptr);
+    ~FileViewerDialog();
+
+private slots:
+    void findClicked();
+    void gotoClicked();
+    void indexProgress(qint64 linesIndexed, bool done);
+    void searchFinished(bool found, qint64 lineNum);
+
+    void tailGrew(qint64);
+    void tailRestarted();
+    void tailChecked(int nextCheckMsec);
+    void tailStopped(QString message);
+
+private:
+    void connectControls();
+    void showLineCount();
+
+    Ui::FileViewerDialog *ui;
+
+    bool searchRunning = false;
+    RemoteFileTail * followedTail = nullptr;
+    QString tailText;
+};
+
+#endif // FILEVIEWERDIALOG_H
@@ -0,0 +1,182 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "pagedfilereader.h"
+
+const qint64 PagedFileReader::pageSize;
+const int PagedFileReader::maxMappedPages;
+
+PagedFileReader::PagedFileReader(QString localPath) : backingFile(localPath)
+{
+    readerOpen = backingFile.open(QIODevice::ReadOnly);
+    if (readerOpen)
+    {
+        totalSize = backingFile.size();
+    }
+}
+
+PagedFileReader::PagedFileReader(QByteArray buffer)
+{
+    backingBuffer = buffer;
+    useBuffer = true;
+    readerOpen = true;
+    totalSize = backingBuffer.size();
+}
+
+PagedFileReader::~PagedFileReader()
+{
+    for (FilePage &aPage : loadedPages)
+    {
+        releasePage(aPage);
+    }
+}
+
+bool PagedFileReader::isOpen()
+{
+    return readerOpen;
+}
+
+qint64 PagedFileReader::size()
+{
+    return totalSize;
+}
+
+qint64 PagedFileReader::refreshSize()
+{
+    if (!readerOpen || useBuffer) return totalSize;
+
+    qint64 newSize = backingFile.size();
+    if (newSize == totalSize) return totalSize;
+    bool fileShrank = (newSize < totalSize);
+    totalSize = newSize;
+
+    //A page mapped short, at the old end of the file, would hide the new bytes
+    for (int i = loadedPages.size() - 1; i >= 0; i--)
+    {
+        if (!fileShrank && (loadedPages.at(i).length == pageSize)) continue;
+        releasePage(loadedPages[i]);
+        loadedPages.removeAt(i);
+    }
+    return totalSize;
+}
+
+QByteArray PagedFileReader::read(qint64 offset, qint64 maxLength)
+{
+    QByteArray ret;
+    if ((offset < 0) || (maxLength <= 0)) return ret;
+    ret.reserve((int) qMin(maxLength, qMax((qint64) 0, totalSize - offset)));
+
+    while ((ret.size() < maxLength) && (offset < totalSize))
+    {
+        qint64 bytesAvailable = 0;
+        const char * pageData = dataAt(offset, &bytesAvailable);
+        if (pageData == nullptr) break;
+
+        qint64 toCopy = qMin(bytesAvailable, maxLength - ret.size());
+        ret.append(pageData, (int) toCopy);
+        offset += toCopy;
+    }
+    return ret;
+}
+
+PagedFileReader * PagedFileReader::duplicate()
+{
+    if (useBuffer) return new PagedFileReader(backingBuffer);
+    return new PagedFileReader(backingFile.fileName());
+}
+
+const char * PagedFileReader::dataAt(qint64 offset, qint64 * bytesAvailable)
+{
+    *bytesAvailable = 0;
+    if (!readerOpen || (offset < 0) || (offset >= totalSize)) return nullptr;
+
+    if (useBuffer)
+    {
+        *bytesAvailable = totalSize - offset;
+        return backingBuffer.constData() + offset;
+    }
+
+    const FilePage &thePage = getPage(offset / pageSize);
+    if (thePage.data == nullptr) return nullptr;
+
+    qint64 pageOffset = offset % pageSize;
+    *bytesAvailable = thePage.length - pageOffset;
+    return thePage.data + pageOffset;
+}
+
+const PagedFileReader::FilePage &PagedFileReader::getPage(qint64 pageNum)
+{
+    for (int i = 0; i < loadedPages.size(); i++)
+    {
+        if (loadedPages.at(i).pageNum != pageNum) continue;
+        if (i != 0) loadedPages.move(i, 0);
+        return loadedPages.first();
+    }
+
+    while (loadedPages.size() >= maxMappedPages)
+    {
+        releasePage(loadedPages.last());
+        loadedPages.removeLast();
+    }
+
+    FilePage newPage;
+    newPage.pageNum = pageNum;
+    newPage.length = qMin(pageSize, totalSize - pageNum * pageSize);
+    newPage.mapping = backingFile.map(pageNum * pageSize, newPage.length);
+
+    if (newPage.mapping != nullptr)
+    {
+        newPage.data = (const char *) newPage.mapping;
+    }
+    else if (backingFile.seek(pageNum * pageSize))
+    {
+        newPage.fallback = backingFile.read(newPage.length);
+        newPage.length = newPage.fallback.size();
+        if (newPage.length > 0) newPage.data = newPage.fallback.constData();
+    }
+
+    loadedPages.prepend(newPage);
+    return loadedPages.first();
+}
+
+void PagedFileReader::releasePage(FilePage &thePage)
+{
+    if (thePage.mapping != nullptr)
+    {
+        backingFile.unmap(thePage.mapping);
+        thePage.mapping = nullptr;
+    }
+    thePage.data = nullptr;
+}
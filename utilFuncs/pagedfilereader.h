@@ -0,0 +1,106 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PAGEDFILEREADER_H
+#define PAGEDFILEREADER_H
+
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+
+/*! \brief The PagedFileReader gives random access to a local file, or an in-memory buffer, without loading all of it.
+ *
+ *  A file is memory-mapped one page at a time, and only the few most recently used pages stay mapped. This keeps memory use flat no matter how large the file is. If a page cannot be mapped, it is read into a buffer instead.
+ *
+ *  A reader is not thread-safe. Code in another thread should open its own reader on the same file.
+ */
+
+class PagedFileReader
+{
+public:
+    explicit PagedFileReader(QString localPath);
+    explicit PagedFileReader(QByteArray buffer);
+    ~PagedFileReader();
+
+    bool isOpen();
+    qint64 size();
+
+    /*! \brief Rereads the size of the file, to pick up bytes appended since it was opened, and returns the new size. Has no effect on a buffer.
+     */
+    qint64 refreshSize();
+
+    /*! \brief Returns a new, independent reader on the same file or buffer, for use in another thread. The caller owns the new reader.
+     */
+    PagedFileReader * duplicate();
+
+    /*! \brief Returns up to maxLength bytes starting at offset. The result may cross page boundaries.
+     */
+    QByteArray read(qint64 offset, qint64 maxLength);
+
+    /*! \brief Returns a pointer to the data at offset, valid until the next call on this reader.
+     *
+     *  \param bytesAvailable Set to the number of bytes which can be read from the pointer, which ends at the end of the page.
+     */
+    const char * dataAt(qint64 offset, qint64 * bytesAvailable);
+
+    static const qint64 pageSize = 4 * 1024 * 1024;
+    static const int maxMappedPages = 8;
+
+private:
+    Q_DISABLE_COPY(PagedFileReader)
+
+    struct FilePage
+    {
+        qint64 pageNum = -1;
+        const char * data = nullptr;
+        qint64 length = 0;
+        uchar * mapping = nullptr;
+        QByteArray fallback;
+    };
+
+    const FilePage &getPage(qint64 pageNum);
+    void releasePage(FilePage &thePage);
+
+    QFile backingFile;
+    QByteArray backingBuffer;
+    bool useBuffer = false;
+    bool readerOpen = false;
+    qint64 totalSize = 0;
+
+    //Most recently used first
+    QList<FilePage> loadedPages;
+};
+
+#endif // PAGEDFILEREADER_H
@@ -0,0 +1,544 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "pagedfileviewer.h"
+
+#include <QPainter>
+#include <QScrollBar>
+#include <QFontDatabase>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QByteArrayMatcher>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "utilFuncs/pagedfilereader.h"
+
+const int PagedFileViewer::linesPerCheckpoint;
+const int PagedFileViewer::maxLineDisplay;
+
+class PagedFileViewer::LineIndexTask : public QRunnable
+{
+public:
+    LineIndexTask(PagedFileReader * newReader, QSharedPointer<LineIndexState> newState, qint64 newEndOffset)
+    {
+        theReader = newReader;
+        theState = newState;
+        endOffset = newEndOffset;
+    }
+
+    ~LineIndexTask()
+    {
+        delete theReader;
+    }
+
+    void run()
+    {
+        qint64 fileSize = qMin(theReader->size(), endOffset);
+        qint64 offset;
+        qint64 linesStarted;
+        QVector<qint64> newCheckpoints;
+        {
+            //An index of a file which has grown carries on from where it stopped
+            QMutexLocker stateLock(&(theState->indexLock));
+            offset = theState->bytesScanned;
+            linesStarted = theState->linesKnown;
+        }
+
+        if (offset < fileSize)
+        {
+            if (offset == 0)
+            {
+                linesStarted = 1;
+            }
+            else if (theReader->read(offset - 1, 1) == "\n")
+            {
+                if (linesStarted % linesPerCheckpoint == 0)
+                {
+                    newCheckpoints.append(offset);
+                }
+                linesStarted++;
+            }
+        }
+
+        while ((offset < fileSize) && (theState->cancelled.load() == 0))
+        {
+            qint64 bytesAvailable = 0;
+            const char * pageData = theReader->dataAt(offset, &bytesAvailable);
+            if (pageData == nullptr) break;
+
+            const char * searchPos = pageData;
+            const char * pageEnd = pageData + bytesAvailable;
+            while ((searchPos = (const char *) memchr(searchPos, '\n', pageEnd - searchPos)) != nullptr)
+            {
+                searchPos++;
+                qint64 newLineStart = offset + (searchPos - pageData);
+                if (newLineStart >= fileSize) break;
+
+                if (linesStarted % linesPerCheckpoint == 0)
+                {
+                    newCheckpoints.append(newLineStart);
+                }
+                linesStarted++;
+            }
+            offset += bytesAvailable;
+
+            //Published once per page, so the viewer can scroll through what is indexed so far
+            QMutexLocker stateLock(&(theState->indexLock));
+            theState->checkpoints += newCheckpoints;
+            theState->linesKnown = linesStarted;
+            theState->bytesScanned = offset;
+            newCheckpoints.clear();
+        }
+
+        theState->done.storeRelease(1);
+    }
+
+private:
+    PagedFileReader * theReader;
+    QSharedPointer<LineIndexState> theState;
+    qint64 endOffset;
+};
+
+class PagedFileViewer::TextSearchTask : public QRunnable
+{
+public:
+    TextSearchTask(PagedFileReader * newReader, QSharedPointer<SearchState> newState)
+    {
+        theReader = newReader;
+        theState = newState;
+    }
+
+    ~TextSearchTask()
+    {
+        delete theReader;
+    }
+
+    void run()
+    {
+        qint64 foundOffset = searchRange(theState->startOffset, theReader->size());
+        if (foundOffset < 0)
+        {
+            foundOffset = searchRange(0, theState->startOffset);
+        }
+        theState->foundOffset = foundOffset;
+        theState->done.storeRelease(1);
+    }
+
+private:
+    //Returns the first match which starts in [fromOffset, toOffset)
+    qint64 searchRange(qint64 fromOffset, qint64 toOffset)
+    {
+        QByteArrayMatcher theMatcher(theState->pattern);
+        qint64 blockStart = fromOffset;
+
+        while ((blockStart < toOffset) && (theState->cancelled.load() == 0))
+        {
+            //Blocks overlap by one pattern length, so matches across block edges are found
+            QByteArray block = theReader->read(blockStart, PagedFileReader::pageSize + theState->pattern.size() - 1);
+            int matchIndex = theMatcher.indexIn(block);
+            if (matchIndex >= 0)
+            {
+                if (blockStart + matchIndex < toOffset) return blockStart + matchIndex;
+                return -1;
+            }
+            blockStart += PagedFileReader::pageSize;
+        }
+        return -1;
+    }
+
+    PagedFileReader * theReader;
+    QSharedPointer<SearchState> theState;
+};
+
+PagedFileViewer::PagedFileViewer(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    pollTimer.setInterval(100);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(checkBackgroundWork()));
+}
+
+PagedFileViewer::~PagedFileViewer()
+{
+    cancelBackgroundWork();
+    if (theReader != nullptr) delete theReader;
+}
+
+void PagedFileViewer::setReader(PagedFileReader * newReader)
+{
+    cancelBackgroundWork();
+    if (theReader != nullptr) delete theReader;
+    theReader = newReader;
+
+    pendingGotoLine = -1;
+    matchOffset = -1;
+    matchLine = -1;
+    indexStale = false;
+    followEnd = false;
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+
+    if (theReader != nullptr)
+    {
+        indexState = QSharedPointer<LineIndexState>(new LineIndexState());
+        indexState->checkpoints.append(0);
+        QThreadPool::globalInstance()->start(new LineIndexTask(theReader->duplicate(), indexState, theReader->size()));
+        pollTimer.start();
+    }
+
+    updateScrollRange();
+    viewport()->update();
+}
+
+void PagedFileViewer::fileGrew()
+{
+    if (theReader == nullptr) return;
+    qint64 oldSize = theReader->size();
+    if (theReader->refreshSize() <= oldSize) return;
+
+    //A view left at the bottom stays at the bottom as lines arrive
+    if (verticalScrollBar()->value() >= verticalScrollBar()->maximum())
+    {
+        followEnd = true;
+    }
+    indexStale = true;
+    pollTimer.start();
+    if (indexComplete()) continueIndex();
+}
+
+qint64 PagedFileViewer::lineCount()
+{
+    if (indexState.isNull()) return 0;
+    QMutexLocker stateLock(&(indexState->indexLock));
+    return indexState->linesKnown;
+}
+
+bool PagedFileViewer::indexComplete()
+{
+    if (indexState.isNull()) return false;
+    return (indexState->done.loadAcquire() != 0);
+}
+
+void PagedFileViewer::goToLine(qint64 lineNum)
+{
+    if (theReader == nullptr) return;
+    if (lineNum < 0) lineNum = 0;
+
+    if ((lineNum >= lineCount()) && !indexComplete())
+    {
+        pendingGotoLine = lineNum;
+        pollTimer.start();
+        return;
+    }
+    pendingGotoLine = -1;
+
+    if (lineNum >= lineCount()) lineNum = qMax((qint64) 0, lineCount() - 1);
+    updateScrollRange();
+    verticalScrollBar()->setValue((int) qMax((qint64) 0, lineNum - visibleLineCount() / 3));
+
+    matchLine = lineNum;
+    matchOffset = -1;
+    viewport()->update();
+}
+
+void PagedFileViewer::findNext(QString searchText)
+{
+    if ((theReader == nullptr) || searchText.isEmpty()) return;
+
+    if (!searchState.isNull())
+    {
+        searchState->cancelled.store(1);
+    }
+
+    qint64 startOffset = 0;
+    if (matchOffset >= 0)
+    {
+        startOffset = matchOffset + 1;
+    }
+    else
+    {
+        startOffset = qMax((qint64) 0, lineOffset(verticalScrollBar()->value()));
+    }
+    if (startOffset >= theReader->size()) startOffset = 0;
+
+    searchState = QSharedPointer<SearchState>(new SearchState());
+    searchState->pattern = searchText.toUtf8();
+    searchState->startOffset = startOffset;
+    QThreadPool::globalInstance()->start(new TextSearchTask(theReader->duplicate(), searchState));
+    pollTimer.start();
+}
+
+void PagedFileViewer::paintEvent(QPaintEvent *)
+{
+    QPainter painter(viewport());
+    if (theReader == nullptr) return;
+
+    int lineHeight = fontMetrics().lineSpacing();
+    int gutter = gutterWidth();
+    int textStart = gutter - horizontalScrollBar()->value();
+    int widestLine = 0;
+
+    qint64 firstLine = verticalScrollBar()->value();
+    qint64 offset = lineOffset(firstLine);
+
+    for (int row = 0; row <= visibleLineCount(); row++)
+    {
+        if ((offset < 0) || (offset >= theReader->size())) break;
+
+        qint64 nextOffset = -1;
+        QString rowText = QString::fromUtf8(lineText(offset, &nextOffset));
+        rowText.replace('\t', "    ");
+        qint64 rowLine = firstLine + row;
+        int rowTop = row * lineHeight;
+
+        if (rowLine == matchLine)
+        {
+            painter.fillRect(0, rowTop, viewport()->width(), lineHeight, palette().highlight());
+        }
+
+        painter.setClipRect(gutter, 0, viewport()->width() - gutter, viewport()->height());
+        painter.setPen(palette().color((rowLine == matchLine) ? QPalette::HighlightedText : QPalette::Text));
+        painter.drawText(textStart, rowTop + fontMetrics().ascent(), rowText);
+        widestLine = qMax(widestLine, fontMetrics().width(rowText));
+
+        painter.setClipping(false);
+        painter.setPen(palette().color(QPalette::Mid));
+        painter.drawText(0, rowTop, gutter - 6, lineHeight, Qt::AlignRight | Qt::AlignVCenter, QString::number(rowLine + 1));
+
+        offset = nextOffset;
+    }
+
+    int newHorizontalMax = qMax(0, widestLine + gutter + 8 - viewport()->width());
+    if (newHorizontalMax > horizontalScrollBar()->maximum())
+    {
+        horizontalScrollBar()->setRange(0, newHorizontalMax);
+    }
+    horizontalScrollBar()->setPageStep(viewport()->width());
+}
+
+void PagedFileViewer::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange();
+}
+
+void PagedFileViewer::scrollContentsBy(int, int)
+{
+    //Scroll values are in lines, not pixels, so the view is simply redrawn
+    viewport()->update();
+}
+
+void PagedFileViewer::checkBackgroundWork()
+{
+    bool workLeft = false;
+
+    if (!indexState.isNull())
+    {
+        bool indexDone = indexComplete();
+        if (indexDone && indexStale)
+        {
+            continueIndex();
+            indexDone = false;
+        }
+        updateScrollRange();
+        if (followEnd)
+        {
+            verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+            if (indexDone) followEnd = false;
+        }
+        viewport()->update();
+        emit indexProgress(lineCount(), indexDone);
+
+        if ((pendingGotoLine >= 0) && ((pendingGotoLine < lineCount()) || indexDone))
+        {
+            goToLine(pendingGotoLine);
+        }
+        if (!indexDone) workLeft = true;
+    }
+
+    if (!searchState.isNull() && (searchState->done.loadAcquire() != 0))
+    {
+        if (searchState->foundOffset < 0)
+        {
+            searchState.clear();
+            emit searchFinished(false, -1);
+        }
+        else
+        {
+            //The match is shown once the index has reached it
+            qint64 foundLine = lineForOffset(searchState->foundOffset);
+            if (foundLine >= 0)
+            {
+                qint64 foundOffset = searchState->foundOffset;
+                searchState.clear();
+
+                goToLine(foundLine);
+                matchOffset = foundOffset;
+                emit searchFinished(true, foundLine);
+            }
+        }
+    }
+    if (!searchState.isNull()) workLeft = true;
+
+    if (!workLeft && (pendingGotoLine < 0)) pollTimer.stop();
+}
+
+qint64 PagedFileViewer::lineOffset(qint64 lineNum)
+{
+    if (indexState.isNull() || (lineNum < 0)) return -1;
+
+    qint64 offset;
+    {
+        QMutexLocker stateLock(&(indexState->indexLock));
+        qint64 checkpointNum = lineNum / linesPerCheckpoint;
+        if (checkpointNum >= indexState->checkpoints.size()) return -1;
+        offset = indexState->checkpoints.at((int) checkpointNum);
+    }
+
+    for (qint64 i = 0; (i < lineNum % linesPerCheckpoint) && (offset >= 0); i++)
+    {
+        offset = nextLineStart(offset);
+    }
+    return offset;
+}
+
+qint64 PagedFileViewer::lineForOffset(qint64 offset)
+{
+    if (indexState.isNull() || (offset < 0)) return -1;
+
+    qint64 checkpointNum;
+    qint64 scanOffset;
+    {
+        QMutexLocker stateLock(&(indexState->indexLock));
+        if ((indexState->done.loadAcquire() == 0) && (offset >= indexState->bytesScanned)) return -1;
+
+        const QVector<qint64> &checkpoints = indexState->checkpoints;
+        checkpointNum = (std::upper_bound(checkpoints.constBegin(), checkpoints.constEnd(), offset) - checkpoints.constBegin()) - 1;
+        scanOffset = checkpoints.at((int) checkpointNum);
+    }
+
+    qint64 ret = checkpointNum * linesPerCheckpoint;
+    while (true)
+    {
+        scanOffset = nextLineStart(scanOffset);
+        if ((scanOffset < 0) || (scanOffset > offset)) break;
+        ret++;
+    }
+    return ret;
+}
+
+qint64 PagedFileViewer::nextLineStart(qint64 offset)
+{
+    while (offset < theReader->size())
+    {
+        qint64 bytesAvailable = 0;
+        const char * pageData = theReader->dataAt(offset, &bytesAvailable);
+        if (pageData == nullptr) return -1;
+
+        const char * newline = (const char *) memchr(pageData, '\n', bytesAvailable);
+        if (newline != nullptr)
+        {
+            qint64 ret = offset + (newline - pageData) + 1;
+            if (ret >= theReader->size()) return -1;
+            return ret;
+        }
+        offset += bytesAvailable;
+    }
+    return -1;
+}
+
+QByteArray PagedFileViewer::lineText(qint64 offset, qint64 * nextOffset)
+{
+    QByteArray ret = theReader->read(offset, maxLineDisplay);
+
+    int newlineIndex = ret.indexOf('\n');
+    if (newlineIndex >= 0)
+    {
+        ret.truncate(newlineIndex);
+        *nextOffset = offset + newlineIndex + 1;
+    }
+    else if (ret.size() < maxLineDisplay)
+    {
+        *nextOffset = theReader->size();
+    }
+    else
+    {
+        //Very long lines are cut off for display
+        *nextOffset = nextLineStart(offset + maxLineDisplay);
+    }
+
+    if (ret.endsWith('\r')) ret.chop(1);
+    return ret;
+}
+
+void PagedFileViewer::updateScrollRange()
+{
+    int visibleLines = visibleLineCount();
+    qint64 maxTopLine = qMax((qint64) 0, lineCount() - visibleLines);
+
+    verticalScrollBar()->setRange(0, (int) qMin(maxTopLine, (qint64) INT_MAX));
+    verticalScrollBar()->setPageStep(visibleLines);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+void PagedFileViewer::continueIndex()
+{
+    indexStale = false;
+    indexState->done.storeRelease(0);
+    QThreadPool::globalInstance()->start(new LineIndexTask(theReader->duplicate(), indexState, theReader->size()));
+    pollTimer.start();
+}
+
+void PagedFileViewer::cancelBackgroundWork()
+{
+    if (!indexState.isNull()) indexState->cancelled.store(1);
+    if (!searchState.isNull()) searchState->cancelled.store(1);
+
+    indexState.clear();
+    searchState.clear();
+    pollTimer.stop();
+}
+
+int PagedFileViewer::visibleLineCount()
+{
+    return qMax(1, viewport()->height() / fontMetrics().lineSpacing());
+}
+
+int PagedFileViewer::gutterWidth()
+{
+    return fontMetrics().width(QString::number(qMax((qint64) 1, lineCount()))) + 12;
+}
@@ -0,0 +1,142 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PAGEDFILEVIEWER_H
+#define PAGEDFILEVIEWER_H
+
+#include <QAbstractScrollArea>
+#include <QSharedPointer>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QTimer>
+
+class PagedFileReader;
+
+/*! \brief The PagedFileViewer is a read-only text view for files too large to load into a text widget.
+ *
+ *  Only the lines on screen are read from the PagedFileReader, at paint time. A line index is built in the background on a QThreadPool thread. To keep the index small for files of several GB, it records only the offset of every linesPerCheckpoint-th line, and lines in between are found by scanning forward from the nearest checkpoint.
+ *
+ *  Searches also run in the background, and wrap around the end of the file once.
+ */
+
+class PagedFileViewer : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit PagedFileViewer(QWidget *parent = nullptr);
+    ~PagedFileViewer();
+
+    /*! \brief Shows the content of newReader. The viewer takes ownership of the reader.
+     */
+    void setReader(PagedFileReader * newReader);
+
+    /*! \brief Shows bytes appended to the file since it was opened. Only the new bytes are indexed, and a view scrolled to the bottom follows the new lines.
+     */
+    void fileGrew();
+
+    qint64 lineCount();
+    bool indexComplete();
+
+    /*! \brief Scrolls so that lineNum (counting from 0) is at the top. If the index has not reached that line yet, the jump happens when it does.
+     */
+    void goToLine(qint64 lineNum);
+
+    /*! \brief Searches for searchText, starting after the last match, or at the top line if there is none.
+     */
+    void findNext(QString searchText);
+
+    static const int linesPerCheckpoint = 64;
+    static const int maxLineDisplay = 4096;
+
+signals:
+    void indexProgress(qint64 linesIndexed, bool done);
+    void searchFinished(bool found, qint64 lineNum);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void scrollContentsBy(int dx, int dy);
+
+private slots:
+    void checkBackgroundWork();
+
+private:
+    struct LineIndexState
+    {
+        QMutex indexLock;
+        QVector<qint64> checkpoints;
+        qint64 linesKnown = 0;
+        qint64 bytesScanned = 0;
+        QAtomicInt done;
+        QAtomicInt cancelled;
+    };
+
+    struct SearchState
+    {
+        QByteArray pattern;
+        qint64 startOffset = 0;
+        qint64 foundOffset = -1;
+        QAtomicInt done;
+        QAtomicInt cancelled;
+    };
+
+    class LineIndexTask;
+    class TextSearchTask;
+
+    qint64 lineOffset(qint64 lineNum);
+    qint64 lineForOffset(qint64 offset);
+    qint64 nextLineStart(qint64 offset);
+    QByteArray lineText(qint64 offset, qint64 * nextOffset);
+
+    void updateScrollRange();
+    void continueIndex();
+    void cancelBackgroundWork();
+    int visibleLineCount();
+    int gutterWidth();
+
+    PagedFileReader * theReader = nullptr;
+    QSharedPointer<LineIndexState> indexState;
+    QSharedPointer<SearchState> searchState;
+    QTimer pollTimer;
+
+    bool indexStale = false;
+    bool followEnd = false;
+    qint64 pendingGotoLine = -1;
+    qint64 matchOffset = -1;
+    qint64 matchLine = -1;
+};
+
+#endif // PAGEDFILEVIEWER_H
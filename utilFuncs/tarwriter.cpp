@@ -0,0 +1,214 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "tarwriter.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <cstring>
+
+const qint64 TarWriter::maxFileSize;
+
+static const int tarBlockSize = 512;
+static const qint64 copyBlockSize = 1024 * 1024;
+
+TarWriter::TarWriter(QString archivePath) : archiveFile(archivePath) {}
+
+TarWriter::~TarWriter()
+{
+    if (archiveOpen) archiveFile.close();
+}
+
+bool TarWriter::open()
+{
+    if (!archiveFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return fail(QString("Unable to create archive: %1").arg(archiveFile.fileName()));
+    }
+    archiveOpen = true;
+    return true;
+}
+
+bool TarWriter::addFolder(QString archiveName)
+{
+    if (!archiveName.endsWith('/')) archiveName.append('/');
+    return writeHeader(archiveName.toUtf8(), '5', 0, QDateTime::currentDateTime().toMSecsSinceEpoch() / 1000, 0755);
+}
+
+bool TarWriter::addFile(QString localPath, QString archiveName)
+{
+    QFile inputFile(localPath);
+    if (!inputFile.open(QIODevice::ReadOnly))
+    {
+        return fail(QString("Unable to read file: %1").arg(localPath));
+    }
+
+    QFileInfo inputInfo(localPath);
+    qint64 fileSize = inputFile.size();
+    if (fileSize > maxFileSize)
+    {
+        return fail(QString("File too large for archive: %1").arg(localPath));
+    }
+
+    int fileMode = inputInfo.permission(QFile::ExeOwner) ? 0755 : 0644;
+    if (!writeHeader(archiveName.toUtf8(), '0', fileSize, inputInfo.lastModified().toMSecsSinceEpoch() / 1000, fileMode))
+    {
+        return false;
+    }
+
+    qint64 bytesCopied = 0;
+    while (bytesCopied < fileSize)
+    {
+        QByteArray block = inputFile.read(qMin(copyBlockSize, fileSize - bytesCopied));
+        if (block.isEmpty()) break;
+        if (archiveFile.write(block) != block.size())
+        {
+            return fail(QString("Unable to write archive: %1").arg(archiveFile.fileName()));
+        }
+        bytesCopied += block.size();
+    }
+
+    //The header already gave the size, so a file which shrank while being read spoils the archive
+    if (bytesCopied != fileSize)
+    {
+        return fail(QString("File changed while being archived: %1").arg(localPath));
+    }
+    return writePadding(fileSize);
+}
+
+bool TarWriter::finish()
+{
+    if (!archiveOpen) return false;
+
+    QByteArray endBlocks(2 * tarBlockSize, '\0');
+    if (archiveFile.write(endBlocks) != endBlocks.size())
+    {
+        return fail(QString("Unable to write archive: %1").arg(archiveFile.fileName()));
+    }
+    archiveFile.close();
+    archiveOpen = false;
+    return true;
+}
+
+QString TarWriter::errorString()
+{
+    return lastError;
+}
+
+qint64 TarWriter::bytesWritten()
+{
+    return archiveFile.size();
+}
+
+bool TarWriter::writeHeader(QByteArray archiveName, char typeFlag, qint64 fileSize, qint64 modTime, int fileMode)
+{
+    if (!archiveOpen) return fail("Archive is not open.");
+
+    QByteArray namePart = archiveName;
+    QByteArray prefixPart;
+    if (namePart.size() > 100)
+    {
+        //Long names are split at a '/', with the front part in the prefix field
+        int splitPoint = archiveName.lastIndexOf('/', qMin(155, archiveName.size() - 2));
+        if ((splitPoint <= 0) || (archiveName.size() - splitPoint - 1 > 100))
+        {
+            return fail(QString("Path too long for archive: %1").arg(QString::fromUtf8(archiveName)));
+        }
+        prefixPart = archiveName.left(splitPoint);
+        namePart = archiveName.mid(splitPoint + 1);
+    }
+
+    char header[tarBlockSize];
+    memset(header, 0, tarBlockSize);
+
+    memcpy(header, namePart.constData(), namePart.size());
+    writeOctal(header + 100, 8, fileMode);
+    writeOctal(header + 108, 8, 0);
+    writeOctal(header + 116, 8, 0);
+    writeOctal(header + 124, 12, fileSize);
+    writeOctal(header + 136, 12, modTime);
+    header[156] = typeFlag;
+    memcpy(header + 257, "ustar", 6);
+    memcpy(header + 263, "00", 2);
+    memcpy(header + 345, prefixPart.constData(), prefixPart.size());
+
+    //The checksum is taken with its own field set to spaces
+    memset(header + 148, ' ', 8);
+    unsigned int checksum = 0;
+    for (int i = 0; i < tarBlockSize; i++)
+    {
+        checksum += (unsigned char) header[i];
+    }
+    writeOctal(header + 148, 7, checksum);
+    header[155] = ' ';
+
+    if (archiveFile.write(header, tarBlockSize) != tarBlockSize)
+    {
+        return fail(QString("Unable to write archive: %1").arg(archiveFile.fileName()));
+    }
+    return true;
+}
+
+bool TarWriter::writePadding(qint64 dataSize)
+{
+    int paddingSize = (int) ((tarBlockSize - (dataSize % tarBlockSize)) % tarBlockSize);
+    if (paddingSize == 0) return true;
+
+    QByteArray padding(paddingSize, '\0');
+    if (archiveFile.write(padding) != paddingSize)
+    {
+        return fail(QString("Unable to write archive: %1").arg(archiveFile.fileName()));
+    }
+    return true;
+}
+
+bool TarWriter::fail(QString reason)
+{
+    lastError = reason;
+    if (archiveOpen)
+    {
+        archiveFile.close();
+        archiveOpen = false;
+    }
+    return false;
+}
+
+void TarWriter::writeOctal(char * field, int fieldSize, qint64 value)
+{
+    //Zero padded octal digits, ending in a NUL
+    QByteArray digits = QByteArray::number(value, 8).rightJustified(fieldSize - 1, '0');
+    memcpy(field, digits.constData(), fieldSize - 1);
+    field[fieldSize - 1] = '\0';
+}
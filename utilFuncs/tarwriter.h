@@ -0,0 +1,80 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TARWRITER_H
+#define TARWRITER_H
+
+#include <QFile>
+#include <QString>
+
+/*! \brief The TarWriter writes an uncompressed USTAR archive, streaming each file into it in fixed-size blocks.
+ *
+ *  Memory use does not depend on the size of the files added. Archive names use '/' separators, and may be up to 255 bytes long, if they can be split at a '/' into the USTAR prefix and name fields. Files larger than 8 GB cannot be stored.
+ */
+
+class TarWriter
+{
+public:
+    explicit TarWriter(QString archivePath);
+    ~TarWriter();
+
+    bool open();
+    bool addFolder(QString archiveName);
+    bool addFile(QString localPath, QString archiveName);
+
+    /*! \brief Writes the end-of-archive blocks and closes the file.
+     */
+    bool finish();
+
+    QString errorString();
+    qint64 bytesWritten();
+
+    static const qint64 maxFileSize = 077777777777LL;
+
+private:
+    Q_DISABLE_COPY(TarWriter)
+
+    bool writeHeader(QByteArray archiveName, char typeFlag, qint64 fileSize, qint64 modTime, int fileMode);
+    bool writePadding(qint64 dataSize);
+    bool fail(QString reason);
+
+    static void writeOctal(char * field, int fieldSize, qint64 value);
+
+    QFile archiveFile;
+    QString lastError;
+    bool archiveOpen = false;
+};
+
+#endif // TARWRITER_H